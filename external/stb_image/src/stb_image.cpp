@@ -1,2 +1,8 @@
 #define STB_IMAGE_IMPLEMENTATION
+// 解码在多个线程上并发进行；v2.22 的失败原因是全局变量，关闭以避免数据竞争
+#define STBI_NO_FAILURE_STRINGS
+// 关闭失败原因后 stbi__err 函数不再被引用，只在这个第三方源文件里忽略对应的警告
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
 #include "stb_image.h"
\ No newline at end of file
@@ -1,16 +1,92 @@
 #include "Application.h"
+#include "GeoJsonTiler.h"
+#include "Profiler.h"
+#include "TileArchive.h"
 #include "TileRenderer.h"
+#include "TileSource.h"
 
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
 #include <iostream>
+#include <memory>
 
-Application::Application() : renderer(nullptr)
+namespace
+{
+// 帧统计的报告周期（秒）
+constexpr double kReportInterval = 5.0;
+// 有在途瓦片请求时，空闲等待的最长时间（秒），到达后检查是否有新的瓦片可以上传
+constexpr double kTilePollInterval = 1.0 / 60.0;
+// 按键平移/缩放的缓动时长（秒）
+constexpr double kKeyEaseDuration = 0.25;
+// 过渡因子 0 <-> 1 完整切换的时长（秒）
+constexpr double kTransitionSweepDuration = 1.5;
+// 帧统计报告中列出的耗时最多的性能分析区段数
+constexpr size_t kReportedZones = 8;
+// C 键导出的 Chrome trace 文件
+const char* const kTraceFile = "trace.json";
+
+// F 键依次飞往的位置：经度、纬度、缩放
+const CameraAnimator::Camera kFlyToTargets[] = {
+    { 116.4f, 39.9f, 5.0f, 0.0f },
+    { -74.0f, 40.7f, 5.0f, 0.0f },
+    { 151.2f, -33.9f, 4.0f, 0.0f },
+    { 0.0f, 0.0f, 1.0f, 1.0f },
+};
+
+/**
+ * .geojson / .json 按 GeoJSON 切片，其他普通文件按瓦片归档打开，目录按 z/x/y 读取；打不开时返回 nullptr
+ */
+std::shared_ptr<const TileSource> openTileSource(const std::string& path)
+{
+    std::filesystem::path file(path);
+    if (file.extension() == ".geojson" || file.extension() == ".json")
+    {
+        // GeoJSON 在进程内按需切片（打开时读取整个文件并建立索引）
+        auto geojson = std::make_shared<GeoJsonTileSource>(path);
+        if (!geojson->isOpen())
+        {
+            std::cerr << geojson->getError() << std::endl;
+            return nullptr;
+        }
+        GeoJsonTiler::Stats stats = geojson->getTiler().getStats();
+        std::cout << "GeoJSON: " << stats.features << " features, " << stats.points << " points, indexed in "
+                  << (stats.parseSeconds + stats.indexSeconds) * 1000.0 << " ms" << std::endl;
+        return geojson;
+    }
+    if (std::filesystem::is_regular_file(file))
+    {
+        auto archive = std::make_shared<ArchiveTileSource>(path);
+        if (!archive->isOpen())
+        {
+            std::cerr << archive->getError() << std::endl;
+            return nullptr;
+        }
+        return archive;
+    }
+    return std::make_shared<DirectoryTileSource>(path);
+}
+} // namespace
+
+Application::Application(const std::string& rasterPath, const std::string& vectorPath) : renderer(nullptr)
 {
     initGLFW();
     initOpenGL();
-    // OpenGL 上下文创建后，初始化 renderer
-    renderer = new TileRenderer();
+    PROFILE_THREAD_NAME("GL");
+    // OpenGL 上下文创建后，初始化 renderer（shader 程序二进制缓存在工作目录下）
+    renderer = new TileRenderer("shader_cache");
+    renderer->setViewportHeight(windowHeight);
+    animator.setViewportSize(windowWidth, windowHeight);
+    if (!rasterPath.empty())
+    {
+        std::cout << "Raster tiles: " << rasterPath << std::endl;
+        renderer->setRasterSource(openTileSource(rasterPath));
+    }
+    if (!vectorPath.empty())
+    {
+        std::cout << "Vector tiles: " << vectorPath << std::endl;
+        renderer->setVectorSource(openTileSource(vectorPath));
+    }
 }
 
 Application::~Application()
@@ -25,14 +101,53 @@ void Application::run()
     std::cout << "UP/DOWN: pan latitude" << std::endl;
     std::cout << "LEFT/RIGHT: pan longitude" << std::endl;
     std::cout << "W/S: adjust transition (0=flat, 1=globe)" << std::endl;
+    std::cout << "T: sweep transition to the other end" << std::endl;
     std::cout << "+/-: zoom" << std::endl;
+    std::cout << "F: fly to the next location" << std::endl;
+    std::cout << "P: toggle pipelined frame preparation" << std::endl;
+    std::cout << "C: write a Chrome trace of recent frames to " << kTraceFile << std::endl;
     std::cout << "ESC: quit\n" << std::endl;
     
+    frameStats = FrameStats(glfwGetTime());
     while (!glfwWindowShouldClose(window))
     {
-        render();
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        double now = glfwGetTime();
+        // 动画结束的那一帧 update 返回 false，但相机已经写到终点，仍需重绘
+        bool animating = animator.isAnimating();
+        animator.update(projection, now);
+        if (animating || renderer->needsRedraw())
+        {
+            dirty = true;
+        }
+        
+        if (dirty)
+        {
+            dirty = false;
+            render();
+            glfwSwapBuffers(window);
+            frameStats.frameRendered(now);
+            if (Profiler::kEnabled)
+            {
+                Profiler::shared().collect();
+            }
+        }
+        if (now - frameStats.getPeriodStart() >= kReportInterval)
+        {
+            reportFrameStats(now);
+        }
+        
+        // 动画进行中或还有要显示的内容时只处理事件不等待（由 swap interval 控制节奏），否则阻塞到下一个事件
+        if (animator.isAnimating() || renderer->needsRedraw())
+        {
+            glfwPollEvents();
+            continue;
+        }
+        double timeout = std::max(0.0, frameStats.getPeriodStart() + kReportInterval - now);
+        if (renderer->hasPendingTiles())
+        {
+            timeout = std::min(timeout, kTilePollInterval);
+        }
+        glfwWaitEventsTimeout(timeout);
     }
 }
 
@@ -57,6 +172,7 @@ void Application::initGLFW()
     }
     
     glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);  // 动画期间按显示器刷新率绘制
     glfwSetWindowUserPointer(window, this);
     glfwSetKeyCallback(window, keyCallback);
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
@@ -82,7 +198,52 @@ void Application::render()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     float aspect = static_cast<float>(windowWidth) / windowHeight;
-    renderer->render(projection, aspect);
+    if (pipelined)
+    {
+        renderer->renderPipelined(projection, aspect);
+    }
+    else
+    {
+        renderer->render(projection, aspect);
+    }
+}
+
+void Application::reportFrameStats(double now)
+{
+    FrameStats::Summary summary = frameStats.summarize(now);
+    // 连续空闲时只报告一次
+    if (summary.frames == 0 && reportedIdle)
+    {
+        return;
+    }
+    reportedIdle = summary.frames == 0;
+    std::cout << "Frames: " << summary.frames << " in " << summary.seconds << " s (" << summary.framesPerSecond << " fps)"
+              << " | interval avg " << summary.averageInterval * 1000.0 << " ms, p95 " << summary.p95Interval * 1000.0
+              << " ms, max " << summary.maxInterval * 1000.0 << " ms"
+              << " | CPU " << summary.cpuPercent << "% | idle " << summary.idleFraction * 100.0 << "%" << std::endl;
+    
+    if (Profiler::kEnabled && summary.frames > 0)
+    {
+        std::vector<Profiler::ZoneSummary> zones = Profiler::shared().summarize(summary.seconds);
+        for (size_t i = 0; i < zones.size() && i < kReportedZones; i++)
+        {
+            const Profiler::ZoneSummary& zone = zones[i];
+            std::cout << "  " << zone.name << (zone.lane.empty() ? "" : " [" + zone.lane + "]") << ": " << zone.count << " calls"
+                      << " | " << zone.totalMilliseconds / summary.frames << " ms/frame | avg " << zone.averageMilliseconds
+                      << " ms | max " << zone.maxMilliseconds << " ms" << std::endl;
+        }
+    }
+}
+
+void Application::animateBy(float dLon, float dLat, float dZoom, float dTransition)
+{
+    // 连续按键时在上一个动画的终点上累加
+    CameraAnimator::Camera target = animator.isAnimating() ? animator.getTarget() : CameraAnimator::fromProjection(projection);
+    target.centerLon += dLon;  // 不 wrap，允许连续旋转
+    target.centerLat = std::clamp(target.centerLat + dLat, -85.0f, 85.0f);
+    target.zoom = std::clamp(target.zoom + dZoom, 0.0f, 6.0f);
+    target.transition = std::clamp(target.transition + dTransition, 0.0f, 1.0f);
+    animator.easeTo(projection, target, kKeyEaseDuration, glfwGetTime());
 }
 
 void Application::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -93,42 +254,100 @@ void Application::keyCallback(GLFWwindow* window, int key, int scancode, int act
         switch (key)
         {
         case GLFW_KEY_UP:
-            app->projection.centerLat = std::min(85.0f, app->projection.centerLat + 3);
+            app->animateBy(0.0f, 3.0f, 0.0f, 0.0f);
             break;
         case GLFW_KEY_DOWN:
-            app->projection.centerLat = std::max(-85.0f, app->projection.centerLat - 3);
+            app->animateBy(0.0f, -3.0f, 0.0f, 0.0f);
             break;
         case GLFW_KEY_LEFT:
-            app->projection.centerLon -= 5;  // 不 wrap，允许连续旋转
+            app->animateBy(-5.0f, 0.0f, 0.0f, 0.0f);
             break;
         case GLFW_KEY_RIGHT:
-            app->projection.centerLon += 5;
+            app->animateBy(5.0f, 0.0f, 0.0f, 0.0f);
             break;
         case GLFW_KEY_W:
-            app->projection.transition = std::min(1.0f, app->projection.transition + 0.02f);
+            app->animateBy(0.0f, 0.0f, 0.0f, 0.02f);
             break;
         case GLFW_KEY_S:
-            app->projection.transition = std::max(0.0f, app->projection.transition - 0.02f);
+            app->animateBy(0.0f, 0.0f, 0.0f, -0.02f);
             break;
         case GLFW_KEY_EQUAL:
         case GLFW_KEY_KP_ADD:
-            app->projection.zoom = std::min(6.0f, app->projection.zoom + 0.2f);
+            app->animateBy(0.0f, 0.0f, 0.2f, 0.0f);
             break;
         case GLFW_KEY_MINUS:
         case GLFW_KEY_KP_SUBTRACT:
-            app->projection.zoom = std::max(0.0f, app->projection.zoom - 0.2f);
+            app->animateBy(0.0f, 0.0f, -0.2f, 0.0f);
+            break;
+        case GLFW_KEY_T:
+            if (action == GLFW_PRESS)
+            {
+                CameraAnimator::Camera target = CameraAnimator::fromProjection(app->projection);
+                target.transition = app->projection.transition < 0.5f ? 1.0f : 0.0f;
+                app->animator.easeTo(app->projection, target, kTransitionSweepDuration, glfwGetTime());
+            }
+            break;
+        case GLFW_KEY_F:
+            if (action == GLFW_PRESS)
+            {
+                const size_t count = sizeof(kFlyToTargets) / sizeof(kFlyToTargets[0]);
+                app->animator.flyTo(app->projection, kFlyToTargets[app->flyToIndex++ % count], glfwGetTime());
+            }
+            break;
+        case GLFW_KEY_P:
+            if (action == GLFW_PRESS)
+            {
+                app->pipelined = !app->pipelined;
+                std::cout << "Pipelined frame preparation: " << (app->pipelined ? "on" : "off") << std::endl;
+            }
+            break;
+        case GLFW_KEY_C:
+            if (action == GLFW_PRESS)
+            {
+                if (!Profiler::kEnabled)
+                {
+                    std::cout << "Profiler is compiled out (configure with -DGLOBE_PROFILER=ON)" << std::endl;
+                }
+                else if (Profiler::shared().writeChromeTrace(kTraceFile))
+                {
+                    std::cout << "Chrome trace written to " << kTraceFile << std::endl;
+                }
+                else
+                {
+                    std::cerr << "Cannot write " << kTraceFile << std::endl;
+                }
+            }
             break;
         case GLFW_KEY_ESCAPE:
             glfwSetWindowShouldClose(window, true);
             break;
         }
+        app->dirty = true;
         
         // 显示当前状态
         float displayLon = fmod(app->projection.centerLon, 360.0f);
         if (displayLon > 180.0f) displayLon -= 360.0f;
         if (displayLon < -180.0f) displayLon += 360.0f;
-
-        std::cout << "Transition: " << app->projection.transition << " | Lon: " << displayLon << " | Lat: " << app->projection.centerLat << " | Zoom: " << app->projection.zoom << std::endl;
+        
+        const TileCuller::Stats& cullStats = app->renderer->getCullStats();
+        std::cout << "Transition: " << app->projection.transition << " | Lon: " << displayLon << " | Lat: " << app->projection.centerLat << " | Zoom: " << app->projection.zoom
+                  << " | Tiles: " << app->renderer->getTileCount() << " (culled frustum " << cullStats.culledFrustum << ", horizon " << cullStats.culledHorizon << ")" << std::endl;
+        if (const RasterTileLoader* loader = app->renderer->getRasterLoader())
+        {
+            RasterTileLoader::Stats rasterStats = loader->getStats();
+            std::cout << "  Raster: decoded " << rasterStats.decoded << " (" << rasterStats.tilesPerSecond() << " tiles/s)"
+                      << " | missing " << rasterStats.failed << " | in flight " << loader->getInFlightCount()
+                      << " | queue latency avg " << rasterStats.averageQueueLatency() * 1000.0 << " ms"
+                      << " | uploaded " << app->renderer->getRasterTextureStats().uploads << std::endl;
+            const TileTextureCache& textureCache = app->renderer->getRasterTextureCache();
+            std::cout << "  Textures: " << textureCache.getResidentCount() << "/" << textureCache.getSlotCount() << " layers ("
+                      << textureCache.getResidentBytes() / (1024 * 1024) << "/" << textureCache.getMemoryBudget() / (1024 * 1024) << " MB)"
+                      << " | parent fallbacks " << textureCache.getStats().fallbacks << " | evictions " << textureCache.getStats().evictions << std::endl;
+            const TilePrefetcher::Stats& prefetchStats = app->renderer->getPrefetchStats();
+            std::cout << "  Prefetch: issued " << prefetchStats.prefetched << " | hit rate " << prefetchStats.hitRate() * 100.0 << "%"
+                      << " | late " << prefetchStats.late << " | wasted " << prefetchStats.wasted << " | cancelled " << prefetchStats.cancelled
+                      << " | misses/frame " << prefetchStats.averageMisses() << " (last " << prefetchStats.frameMisses << ")" << std::endl;
+        }
     }
 }
 
@@ -138,5 +357,11 @@ void Application::framebufferSizeCallback(GLFWwindow* window, int width, int hei
     app->windowWidth = width;
     app->windowHeight = height;
     glViewport(0, 0, width, height);
+    app->animator.setViewportSize(width, height);
+    app->dirty = true;
+    if (app->renderer)
+    {
+        app->renderer->setViewportHeight(height);
+    }
 }
 
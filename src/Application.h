@@ -1,7 +1,10 @@
 #pragma once
+#include "CameraAnimator.h"
+#include "FrameStats.h"
 #include "GlobeProjection.h"
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
+#include <string>
 
 class TileRenderer;
 
@@ -13,9 +16,17 @@ private:
     
     GlobeProjection projection;
     TileRenderer* renderer;  // 使用指针，延迟初始化
+    bool pipelined = true;   // 在工作线程上构建下一帧（画面晚一帧），P 键切换为串行
+    
+    // 按需渲染：只有相机、过渡因子或瓦片数据变化时才重绘，其余时间阻塞在事件等待中
+    CameraAnimator animator;
+    FrameStats frameStats;
+    bool dirty = true;
+    bool reportedIdle = false;
+    size_t flyToIndex = 0;
     
 public:
-    Application();
+    explicit Application(const std::string& rasterPath = "", const std::string& vectorPath = "");
     ~Application();
     
     void run();
@@ -24,6 +35,8 @@ private:
     void initGLFW();
     void initOpenGL();
     void render();
+    void reportFrameStats(double now);
+    void animateBy(float dLon, float dLat, float dZoom, float dTransition);
     
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
@@ -0,0 +1,385 @@
+#include "BatchProjector.h"
+
+#include "GlobeProjection.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+// AVX2 内核：GCC / Clang 用 target 属性单独编译该函数，MSVC x64 不需要额外选项，运行时检测 CPU 后才调用。
+// 只开 avx2、不开 fma，避免乘加被合并为 FMA 而与 SSE2 / 标量路径的舍入不同
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_PROJECTOR_AVX2 1
+#define BATCH_PROJECTOR_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_M_X64) || defined(__AVX2__)
+#define BATCH_PROJECTOR_AVX2 1
+#define BATCH_PROJECTOR_AVX2_TARGET
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define BATCH_PROJECTOR_SSE2 1
+#endif
+
+#if defined(BATCH_PROJECTOR_AVX2) || defined(BATCH_PROJECTOR_SSE2)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER) && defined(BATCH_PROJECTOR_AVX2)
+#include <intrin.h>
+#endif
+
+namespace
+{
+bool cpuSupportsAvx2()
+{
+#if defined(BATCH_PROJECTOR_AVX2) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(BATCH_PROJECTOR_AVX2) && defined(_MSC_VER)
+    // CPUID.7.EBX[5] = AVX2，且操作系统保存 YMM 寄存器（OSXSAVE + XCR0 的 bit 1、2）
+    int info[4];
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(BATCH_PROJECTOR_AVX2)
+    return true;   // 其他编译器只在以 AVX2 为编译目标时启用该内核
+#else
+    return false;
+#endif
+}
+
+// 每个分块的点数：中间结果留在栈上，避免额外分配
+constexpr size_t kChunkSize = 256;
+// 少于该点数时不启用多线程
+constexpr size_t kMinPointsPerThread = 16384;
+} // namespace
+
+struct BatchProjector::Chunk
+{
+    // 第一步的输出：墨卡托坐标和单位球坐标
+    float mercX[kChunkSize];
+    float mercY[kChunkSize];
+    float sphereX[kChunkSize];
+    float sphereY[kChunkSize];
+    float sphereZ[kChunkSize];
+    // 第二步的输出：裁剪空间坐标
+    float clipX[kChunkSize];
+    float clipY[kChunkSize];
+    float clipZ[kChunkSize];
+    float clipW[kChunkSize];
+    uint8_t visible[kChunkSize];
+};
+
+BatchProjector::BatchProjector(std::shared_ptr<const ProjectionState> state, int viewportWidth, int viewportHeight)
+    : state(std::move(state))
+    , viewportWidth(static_cast<float>(viewportWidth))
+    , viewportHeight(static_cast<float>(viewportHeight))
+    , simdPath(detectSimdPath())
+{
+    const glm::mat4& flatMatrix = this->state->getMercatorBaseMatrix();
+    const glm::mat4& globeMatrix = this->state->getGlobeMatrix();
+    const int rows[3] = {0, 1, 3};  // x, y, w
+    for (int r = 0; r < 3; r++)
+    {
+        flat[r][0] = flatMatrix[0][rows[r]];
+        flat[r][1] = flatMatrix[1][rows[r]];
+        flat[r][2] = flatMatrix[3][rows[r]];
+        for (int c = 0; c < 4; c++)
+        {
+            globe[r][c] = globeMatrix[c][rows[r]];
+        }
+    }
+    const glm::vec4& clippingPlane = this->state->getClippingPlane();
+    for (int i = 0; i < 4; i++)
+    {
+        plane[i] = clippingPlane[i];
+    }
+    // 纯 Globe 分支等价于 transition = 1, zMix = 1
+    transition = this->state->isPureGlobe() ? 1.0f : this->state->getTransition();
+    zMix = this->state->getZMix();
+}
+
+BatchProjector::SimdPath BatchProjector::detectSimdPath()
+{
+    static const SimdPath path = cpuSupportsAvx2() ? SimdPath::Avx2
+#if defined(BATCH_PROJECTOR_SSE2)
+                                                   : SimdPath::Sse2;
+#else
+                                                   : SimdPath::Scalar;
+#endif
+    return path;
+}
+
+const char* BatchProjector::simdPathName(SimdPath path)
+{
+    switch (path)
+    {
+    case SimdPath::Avx2:
+        return "avx2";
+    case SimdPath::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+void BatchProjector::setSimdPath(SimdPath path)
+{
+    // AVX2 不可用时 detectSimdPath 为 SSE2 或标量；SSE2 不可用时为标量
+    simdPath = std::min(path, detectSimdPath());
+}
+
+void BatchProjector::projectToClip(const float* lon, const float* lat, size_t count, const ClipOutput& out, unsigned threadCount) const
+{
+    parallelFor(count, threadCount, [&](size_t begin, size_t end) {
+        projectRange(lon, lat, begin, end, &out, nullptr);
+    });
+}
+
+void BatchProjector::projectToScreen(const float* lon, const float* lat, size_t count, const ScreenOutput& out, unsigned threadCount) const
+{
+    parallelFor(count, threadCount, [&](size_t begin, size_t end) {
+        projectRange(lon, lat, begin, end, nullptr, &out);
+    });
+}
+
+template <typename Fn>
+void BatchProjector::parallelFor(size_t count, unsigned threadCount, Fn&& fn)
+{
+    size_t maxThreads = std::max<size_t>(1, count / kMinPointsPerThread);
+    size_t threads = std::min<size_t>(std::max(1u, threadCount), maxThreads);
+    if (threads <= 1)
+    {
+        fn(size_t(0), count);
+        return;
+    }
+    
+    // 按分块大小对齐切分，每段是连续的若干分块，交给共享的 JobSystem 执行
+    size_t chunks = (count + kChunkSize - 1) / kChunkSize;
+    JobSystem::shared().parallelFor(chunks, 1, [&fn, count](size_t first, size_t last) {
+        fn(first * kChunkSize, std::min(count, last * kChunkSize));
+    }, static_cast<unsigned>(threads));
+}
+
+void BatchProjector::projectRange(const float* lon, const float* lat, size_t begin, size_t end, const ClipOutput* clip, const ScreenOutput* screen) const
+{
+    Chunk chunk;
+    for (size_t base = begin; base < end; base += kChunkSize)
+    {
+        size_t count = std::min(kChunkSize, end - base);
+        
+        // 第一步（标量）：经纬度 -> 墨卡托（选最近的 wrap）和单位球
+        // 单位球坐标直接由经纬度计算，与 shader 中墨卡托 -> atan(exp) 的往返在数学上等价
+        for (size_t i = 0; i < count; i++)
+        {
+            float lonRad = lon[base + i] * (Constants::PI / 180.0f);
+            float latRad = lat[base + i] * (Constants::PI / 180.0f);
+            float cosLat = std::cos(latRad);
+            chunk.mercX[i] = state->nearestWrapMercX(lon[base + i] / 360.0f + 0.5f);
+            chunk.mercY[i] = GlobeProjection::mercatorYFromLat(lat[base + i]);
+            chunk.sphereX[i] = std::sin(lonRad) * cosLat;
+            chunk.sphereY[i] = std::sin(latRad);
+            chunk.sphereZ[i] = std::cos(lonRad) * cosLat;
+        }
+        
+        // 第二步（SIMD）：矩阵变换、混合、可见性
+        transformChunk(chunk, count);
+        
+        if (clip)
+        {
+            if (clip->x) std::copy(chunk.clipX, chunk.clipX + count, clip->x + base);
+            if (clip->y) std::copy(chunk.clipY, chunk.clipY + count, clip->y + base);
+            if (clip->z) std::copy(chunk.clipZ, chunk.clipZ + count, clip->z + base);
+            if (clip->w) std::copy(chunk.clipW, chunk.clipW + count, clip->w + base);
+            if (clip->visible) std::copy(chunk.visible, chunk.visible + count, clip->visible + base);
+        }
+        if (screen)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                float invW = 1.0f / chunk.clipW[i];
+                if (screen->x) screen->x[base + i] = (chunk.clipX[i] * invW * 0.5f + 0.5f) * viewportWidth;
+                if (screen->y) screen->y[base + i] = (0.5f - chunk.clipY[i] * invW * 0.5f) * viewportHeight;
+                if (screen->depth) screen->depth[base + i] = chunk.clipZ[i] * invW;
+            }
+            if (screen->visible) std::copy(chunk.visible, chunk.visible + count, screen->visible + base);
+        }
+    }
+}
+
+void BatchProjector::transformChunk(Chunk& chunk, size_t count) const
+{
+    size_t i = 0;
+    switch (simdPath)
+    {
+    case SimdPath::Avx2:
+        i = transformChunkAvx2(chunk, count);
+        break;
+    case SimdPath::Sse2:
+        i = transformChunkSse2(chunk, count);
+        break;
+    default:
+        break;
+    }
+    
+    // 标量路径（以及 SIMD 之后剩余的点）
+    const float t = transition;
+    const float oneMinusT = 1.0f - t;
+    for (; i < count; i++)
+    {
+        float mx = chunk.mercX[i], my = chunk.mercY[i];
+        float sx = chunk.sphereX[i], sy = chunk.sphereY[i], sz = chunk.sphereZ[i];
+        float result[3];
+        float z = 0.0f;
+        for (int r = 0; r < 3; r++)
+        {
+            float f = flat[r][0] * mx + flat[r][1] * my + flat[r][2];
+            float g = (globe[r][0] * sx + globe[r][1] * sy) + (globe[r][2] * sz + globe[r][3]);
+            result[r] = f * oneMinusT + g * t;
+            if (r == 2)
+            {
+                float dot = (plane[0] * sx + plane[1] * sy) + (plane[2] * sz + plane[3]);
+                z = (1.0f - dot) * g * zMix;
+            }
+        }
+        chunk.clipX[i] = result[0];
+        chunk.clipY[i] = result[1];
+        chunk.clipZ[i] = z;
+        chunk.clipW[i] = result[2];
+        chunk.visible[i] = ProjectionState::isInsideClipVolume(glm::vec4(result[0], result[1], z, result[2])) ? 1 : 0;
+    }
+}
+
+#if defined(BATCH_PROJECTOR_AVX2)
+BATCH_PROJECTOR_AVX2_TARGET
+size_t BatchProjector::transformChunkAvx2(Chunk& chunk, size_t count) const
+{
+    const float t = transition;
+    const float oneMinusT = 1.0f - t;
+    size_t i = 0;
+    const __m256 vt = _mm256_set1_ps(t);
+    const __m256 vOneMinusT = _mm256_set1_ps(oneMinusT);
+    const __m256 vZMix = _mm256_set1_ps(zMix);
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+    const __m256 vSignMask = _mm256_set1_ps(-0.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 mx = _mm256_loadu_ps(chunk.mercX + i);
+        __m256 my = _mm256_loadu_ps(chunk.mercY + i);
+        __m256 sx = _mm256_loadu_ps(chunk.sphereX + i);
+        __m256 sy = _mm256_loadu_ps(chunk.sphereY + i);
+        __m256 sz = _mm256_loadu_ps(chunk.sphereZ + i);
+        
+        __m256 result[3];
+        __m256 z = _mm256_setzero_ps();
+        for (int r = 0; r < 3; r++)
+        {
+            __m256 f = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(flat[r][0]), mx),
+                                                   _mm256_mul_ps(_mm256_set1_ps(flat[r][1]), my)),
+                                     _mm256_set1_ps(flat[r][2]));
+            __m256 g = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(globe[r][0]), sx),
+                                                   _mm256_mul_ps(_mm256_set1_ps(globe[r][1]), sy)),
+                                     _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(globe[r][2]), sz),
+                                                   _mm256_set1_ps(globe[r][3])));
+            result[r] = _mm256_add_ps(_mm256_mul_ps(f, vOneMinusT), _mm256_mul_ps(g, vt));
+            if (r == 2)
+            {
+                // globe.w 用于 clipping Z
+                __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[0]), sx),
+                                                         _mm256_mul_ps(_mm256_set1_ps(plane[1]), sy)),
+                                           _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[2]), sz),
+                                                         _mm256_set1_ps(plane[3])));
+                z = _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(vOne, dot), g), vZMix);
+            }
+        }
+        _mm256_storeu_ps(chunk.clipX + i, result[0]);
+        _mm256_storeu_ps(chunk.clipY + i, result[1]);
+        _mm256_storeu_ps(chunk.clipZ + i, z);
+        _mm256_storeu_ps(chunk.clipW + i, result[2]);
+        
+        // |x| <= w && |y| <= w && |z| <= w
+        __m256 w = result[2];
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(_mm256_andnot_ps(vSignMask, result[0]), w, _CMP_LE_OQ),
+                                      _mm256_cmp_ps(_mm256_andnot_ps(vSignMask, result[1]), w, _CMP_LE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_andnot_ps(vSignMask, z), w, _CMP_LE_OQ));
+        int mask = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            chunk.visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+    return i;
+}
+#else
+size_t BatchProjector::transformChunkAvx2(Chunk&, size_t) const
+{
+    return 0;
+}
+#endif
+
+#if defined(BATCH_PROJECTOR_SSE2)
+size_t BatchProjector::transformChunkSse2(Chunk& chunk, size_t count) const
+{
+    const float t = transition;
+    const float oneMinusT = 1.0f - t;
+    size_t i = 0;
+    const __m128 vt = _mm_set1_ps(t);
+    const __m128 vOneMinusT = _mm_set1_ps(oneMinusT);
+    const __m128 vZMix = _mm_set1_ps(zMix);
+    const __m128 vOne = _mm_set1_ps(1.0f);
+    const __m128 vSignMask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 mx = _mm_loadu_ps(chunk.mercX + i);
+        __m128 my = _mm_loadu_ps(chunk.mercY + i);
+        __m128 sx = _mm_loadu_ps(chunk.sphereX + i);
+        __m128 sy = _mm_loadu_ps(chunk.sphereY + i);
+        __m128 sz = _mm_loadu_ps(chunk.sphereZ + i);
+        
+        __m128 result[3];
+        __m128 z = _mm_setzero_ps();
+        for (int r = 0; r < 3; r++)
+        {
+            __m128 f = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(flat[r][0]), mx),
+                                             _mm_mul_ps(_mm_set1_ps(flat[r][1]), my)),
+                                  _mm_set1_ps(flat[r][2]));
+            __m128 g = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(globe[r][0]), sx),
+                                             _mm_mul_ps(_mm_set1_ps(globe[r][1]), sy)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(globe[r][2]), sz),
+                                             _mm_set1_ps(globe[r][3])));
+            result[r] = _mm_add_ps(_mm_mul_ps(f, vOneMinusT), _mm_mul_ps(g, vt));
+            if (r == 2)
+            {
+                // globe.w 用于 clipping Z
+                __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), sx),
+                                                   _mm_mul_ps(_mm_set1_ps(plane[1]), sy)),
+                                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[2]), sz),
+                                                   _mm_set1_ps(plane[3])));
+                z = _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(vOne, dot), g), vZMix);
+            }
+        }
+        _mm_storeu_ps(chunk.clipX + i, result[0]);
+        _mm_storeu_ps(chunk.clipY + i, result[1]);
+        _mm_storeu_ps(chunk.clipZ + i, z);
+        _mm_storeu_ps(chunk.clipW + i, result[2]);
+        
+        // |x| <= w && |y| <= w && |z| <= w
+        __m128 w = result[2];
+        __m128 inside = _mm_and_ps(_mm_cmple_ps(_mm_andnot_ps(vSignMask, result[0]), w),
+                                   _mm_cmple_ps(_mm_andnot_ps(vSignMask, result[1]), w));
+        inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_andnot_ps(vSignMask, z), w));
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            chunk.visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+    return i;
+}
+#else
+size_t BatchProjector::transformChunkSse2(Chunk&, size_t) const
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+#include "ProjectionState.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * 批量正向投影（CPU，SoA）
+ *
+ * 把大量经纬度点（车辆、传感器等叠加数据）投影到混合后的裁剪空间或屏幕坐标，
+ * 并给出可见性掩码。数学与顶点 shader 完全一致（见 ProjectionState::projectToClip）：
+ * mix(flatPosition, globePosition, transition)、clipping Z 和 Z 值延迟混合。
+ * 每个点选择离 center 最近的 wrap。
+ *
+ * 实现分两步：逐点的超越函数（经纬度 -> 墨卡托/单位球）走标量循环，
+ * 之后的矩阵变换、混合和可见性测试走 AVX2 / SSE2 / 标量路径。AVX2 内核单独按 avx2 目标编译，
+ * 运行时按 CPU 支持选择，构建本身不需要 -mavx2。
+ */
+class BatchProjector
+{
+public:
+    enum class SimdPath : uint8_t
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+    
+    /**
+     * 输出数组（SoA），不需要的分量可以传 nullptr
+     */
+    struct ClipOutput
+    {
+        float* x = nullptr;
+        float* y = nullptr;
+        float* z = nullptr;
+        float* w = nullptr;
+        uint8_t* visible = nullptr;
+    };
+    
+    struct ScreenOutput
+    {
+        float* x = nullptr;         // 像素，原点在左上角
+        float* y = nullptr;
+        float* depth = nullptr;     // NDC z
+        uint8_t* visible = nullptr;
+    };
+    
+    BatchProjector(std::shared_ptr<const ProjectionState> state, int viewportWidth, int viewportHeight);
+    
+    /**
+     * 经纬度（度）-> 裁剪空间
+     * threadCount > 1 时在 JobSystem::shared() 上最多分成 threadCount 段并行
+     */
+    void projectToClip(const float* lon, const float* lat, size_t count, const ClipOutput& out, unsigned threadCount = 1) const;
+    
+    /**
+     * 经纬度（度）-> 屏幕像素坐标
+     */
+    void projectToScreen(const float* lon, const float* lat, size_t count, const ScreenOutput& out, unsigned threadCount = 1) const;
+    
+    /**
+     * 本机 CPU 支持的最快路径（第一次调用时检测）
+     */
+    static SimdPath detectSimdPath();
+    static const char* simdPathName(SimdPath path);
+    
+    /**
+     * 指定使用的路径（用于对比基准和测试）；超出本机支持的路径降为 detectSimdPath()
+     */
+    void setSimdPath(SimdPath path);
+    SimdPath getSimdPath() const { return simdPath; }
+    
+private:
+    struct Chunk;
+    
+    void projectRange(const float* lon, const float* lat, size_t begin, size_t end, const ClipOutput* clip, const ScreenOutput* screen) const;
+    void transformChunk(Chunk& chunk, size_t count) const;
+    
+    // 处理 count 中能整除向量宽度的部分，返回处理的点数；剩余的点由标量路径处理
+    size_t transformChunkAvx2(Chunk& chunk, size_t count) const;
+    size_t transformChunkSse2(Chunk& chunk, size_t count) const;
+    
+    template <typename Fn>
+    static void parallelFor(size_t count, unsigned threadCount, Fn&& fn);
+    
+    std::shared_ptr<const ProjectionState> state;
+    float viewportWidth;
+    float viewportHeight;
+    SimdPath simdPath;
+    
+    // 展开后的系数，SIMD 路径直接广播
+    float flat[3][3];      // flat.{x,y,w} = m0 * mercX + m1 * mercY + m3
+    float globe[3][4];     // globe.{x,y,w} = m0 * sx + m1 * sy + m2 * sz + m3
+    float plane[4];        // clipping plane
+    float transition;
+    float zMix;
+};
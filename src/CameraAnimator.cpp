@@ -0,0 +1,181 @@
+#include "CameraAnimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// maplibre 的瓦片尺寸约定，只用于把墨卡托距离换算成与视口可比的像素
+constexpr double kWorldTileSize = 512.0;
+
+double lerp(double a, double b, double t)
+{
+    return a + (b - a) * t;
+}
+
+// 三次贝塞尔分量 B(t)，端点为 0 和 1
+double bezier(double p1, double p2, double t)
+{
+    double u = 1.0 - t;
+    return 3.0 * u * u * t * p1 + 3.0 * u * t * t * p2 + t * t * t;
+}
+
+double bezierDerivative(double p1, double p2, double t)
+{
+    double u = 1.0 - t;
+    return 3.0 * u * u * p1 + 6.0 * u * t * (p2 - p1) + 3.0 * t * t * (1.0 - p2);
+}
+} // namespace
+
+CameraAnimator::Camera CameraAnimator::fromProjection(const GlobeProjection& projection)
+{
+    Camera camera;
+    camera.centerLon = projection.centerLon;
+    camera.centerLat = projection.centerLat;
+    camera.zoom = projection.zoom;
+    camera.transition = projection.transition;
+    return camera;
+}
+
+void CameraAnimator::setViewportSize(int width, int height)
+{
+    viewportWidth = std::max(1, width);
+    viewportHeight = std::max(1, height);
+}
+
+double CameraAnimator::ease(double t)
+{
+    const double x1 = 0.25, y1 = 0.1, x2 = 0.25, y2 = 1.0;
+    if (t <= 0.0) return 0.0;
+    if (t >= 1.0) return 1.0;
+    
+    // 先解 x(s) = t（牛顿迭代，导数过小时退回二分），再求 y(s)
+    double s = t;
+    for (int i = 0; i < 8; i++)
+    {
+        double error = bezier(x1, x2, s) - t;
+        double slope = bezierDerivative(x1, x2, s);
+        if (std::abs(error) < 1e-7 || std::abs(slope) < 1e-6)
+        {
+            break;
+        }
+        s -= error / slope;
+    }
+    if (s < 0.0 || s > 1.0 || std::abs(bezier(x1, x2, s) - t) > 1e-5)
+    {
+        double low = 0.0, high = 1.0;
+        s = t;
+        for (int i = 0; i < 32; i++)
+        {
+            double x = bezier(x1, x2, s);
+            if (x < t) low = s; else high = s;
+            s = 0.5 * (low + high);
+        }
+    }
+    return bezier(y1, y2, s);
+}
+
+void CameraAnimator::easeTo(const GlobeProjection& projection, const Camera& target, double duration, double now)
+{
+    start = fromProjection(projection);
+    this->target = target;
+    this->target.centerLat = std::clamp(target.centerLat, -85.0f, 85.0f);
+    this->target.transition = std::clamp(target.transition, 0.0f, 1.0f);
+    
+    // 经度走最短方向：终点移到离起点 ±180° 以内
+    float delta = std::fmod(this->target.centerLon - start.centerLon, 360.0f);
+    if (delta > 180.0f) delta -= 360.0f;
+    if (delta < -180.0f) delta += 360.0f;
+    this->target.centerLon = start.centerLon + delta;
+    
+    startX = start.centerLon / 360.0;
+    startY = GlobeProjection::mercatorYFromLat(start.centerLat);
+    endX = this->target.centerLon / 360.0;
+    endY = GlobeProjection::mercatorYFromLat(this->target.centerLat);
+    
+    mode = Mode::Ease;
+    startTime = now;
+    this->duration = std::max(0.0, duration);
+    animating = true;
+}
+
+void CameraAnimator::flyTo(const GlobeProjection& projection, const Camera& target, double now, double duration)
+{
+    easeTo(projection, target, duration, now);
+    
+    // 与 maplibre flyTo 相同：w 为视口覆盖的世界宽度（像素），u 为沿路径移动的距离
+    rho = flyOptions.curve;
+    double rho2 = rho * rho;
+    double scale = std::pow(2.0, this->target.zoom - start.zoom);
+    double worldSize = kWorldTileSize * std::pow(2.0, start.zoom);
+    w0 = std::max(viewportWidth, viewportHeight);
+    double w1 = w0 / scale;
+    u1 = std::hypot((endX - startX) * worldSize, (endY - startY) * worldSize);
+    
+    auto r = [&](int i) {
+        double b = (w1 * w1 - w0 * w0 + (i ? -1.0 : 1.0) * rho2 * rho2 * u1 * u1) / (2.0 * (i ? w1 : w0) * rho2 * u1);
+        return std::log(std::sqrt(b * b + 1.0) - b);
+    };
+    zoomOnly = false;
+    r0 = r(0);
+    pathLength = (r(1) - r0) / rho;
+    if (std::abs(u1) < 1e-6 || !std::isfinite(pathLength))
+    {
+        // 中心不动：缩放不变时退化为 easeTo，否则只沿缩放方向指数变化
+        if (std::abs(w0 - w1) < 1e-6)
+        {
+            return;
+        }
+        zoomOnly = true;
+        zoomDirection = w1 < w0 ? -1 : 1;
+        pathLength = std::abs(std::log(w1 / w0)) / rho;
+    }
+    
+    if (duration <= 0.0)
+    {
+        this->duration = std::min<double>(pathLength / flyOptions.speed, flyOptions.maxDuration);
+    }
+    mode = Mode::Fly;
+}
+
+bool CameraAnimator::update(GlobeProjection& projection, double now)
+{
+    if (!animating)
+    {
+        return false;
+    }
+    double t = duration > 0.0 ? std::clamp((now - startTime) / duration, 0.0, 1.0) : 1.0;
+    if (t >= 1.0)
+    {
+        projection.centerLon = target.centerLon;
+        projection.centerLat = target.centerLat;
+        projection.zoom = target.zoom;
+        projection.transition = target.transition;
+        animating = false;
+        return false;
+    }
+    
+    double k = ease(t);
+    double x = 0.0, y = 0.0, zoom = 0.0;
+    if (mode == Mode::Ease)
+    {
+        x = lerp(startX, endX, k);
+        y = lerp(startY, endY, k);
+        zoom = lerp(start.zoom, target.zoom, k);
+    }
+    else
+    {
+        double s = k * pathLength;
+        double w = zoomOnly ? std::exp(zoomDirection * rho * s) : std::cosh(r0) / std::cosh(r0 + rho * s);
+        double u = zoomOnly ? 0.0 : w0 * ((std::cosh(r0) * std::tanh(r0 + rho * s) - std::sinh(r0)) / (rho * rho)) / u1;
+        x = lerp(startX, endX, u);
+        y = lerp(startY, endY, u);
+        zoom = start.zoom + std::log2(1.0 / w);
+    }
+    
+    projection.centerLon = static_cast<float>(x * 360.0);
+    projection.centerLat = GlobeProjection::latFromMercatorY(static_cast<float>(y));
+    projection.zoom = static_cast<float>(zoom);
+    projection.transition = static_cast<float>(lerp(start.transition, target.transition, k));
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "GlobeProjection.h"
+
+/**
+ * 相机动画（不依赖 GL），对应 maplibre 的 easeTo / flyTo
+ *
+ * - easeTo：中心（墨卡托空间）、缩放、过渡因子同时按缓动曲线插值
+ * - flyTo：van Wijk & Nuij 的缩放-平移路径，先缩小再飞向目标再放大，
+ *   长距离移动时画面速度感知上保持恒定
+ * - 经度走最短方向（目标经度移到离起点 ±180° 以内），纬度限制在 ±85°
+ *
+ * 时间由调用方传入（秒，单调时钟），update 把当前时刻的相机写回 GlobeProjection。
+ */
+class CameraAnimator
+{
+public:
+    struct Camera
+    {
+        float centerLon = 0.0f;
+        float centerLat = 0.0f;
+        float zoom = 2.0f;
+        float transition = 0.0f;
+    };
+    
+    /**
+     * flyTo 路径参数（与 maplibre 默认值一致）
+     */
+    struct FlyOptions
+    {
+        float curve = 1.42f;        // rho：越大缩小得越多
+        float speed = 1.2f;         // 每秒经过的"屏幕"数，duration 为 0 时用于计算时长
+        float maxDuration = 8.0f;   // 自动计算的时长上限（秒）
+    };
+    
+    FlyOptions flyOptions;
+    
+    static Camera fromProjection(const GlobeProjection& projection);
+    
+    /**
+     * 从 projection 当前的相机缓动到 target；duration 秒
+     */
+    void easeTo(const GlobeProjection& projection, const Camera& target, double duration, double now);
+    
+    /**
+     * 从 projection 当前的相机沿缩放-平移路径飞到 target；duration 为 0 时按 flyOptions.speed 自动计算
+     */
+    void flyTo(const GlobeProjection& projection, const Camera& target, double now, double duration = 0.0);
+    
+    /**
+     * 写入 now 时刻的相机，返回动画是否仍在进行（结束的那一帧写入终点并返回 false）
+     */
+    bool update(GlobeProjection& projection, double now);
+    
+    void cancel() { animating = false; }
+    bool isAnimating() const { return animating; }
+    
+    /**
+     * 正在进行的动画的终点（没有动画时为最后一次的终点）；连续按键时在此基础上累加
+     */
+    const Camera& getTarget() const { return target; }
+    
+    /**
+     * flyTo 用视口尺寸（像素）换算路径长度
+     */
+    void setViewportSize(int width, int height);
+    
+    /**
+     * maplibre 默认缓动 cubic-bezier(0.25, 0.1, 0.25, 1)
+     */
+    static double ease(double t);
+    
+private:
+    enum class Mode
+    {
+        Ease,
+        Fly,
+    };
+    
+    Mode mode = Mode::Ease;
+    bool animating = false;
+    double startTime = 0.0;
+    double duration = 0.0;
+    Camera start;
+    Camera target;
+    
+    // 墨卡托空间中的起点与终点（x 不 wrap，终点已按最短方向调整）
+    double startX = 0.0, startY = 0.0;
+    double endX = 0.0, endY = 0.0;
+    
+    // flyTo 路径（见 van Wijk & Nuij, "Smooth and efficient zooming and panning"）
+    double rho = 1.42;
+    double r0 = 0.0;
+    double w0 = 1.0;
+    double u1 = 0.0;
+    double pathLength = 0.0;   // S
+    bool zoomOnly = false;     // 起点与终点重合时只缩放
+    int zoomDirection = 1;
+    
+    int viewportWidth = 1920;
+    int viewportHeight = 1080;
+};
@@ -0,0 +1,127 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+void CameraPath::add(double seconds, const CameraAnimator::Camera& camera)
+{
+    Keyframe keyframe;
+    keyframe.seconds = seconds;
+    keyframe.camera = camera;
+    auto position = std::upper_bound(keyframes.begin(), keyframes.end(), seconds,
+                                     [](double value, const Keyframe& k) { return value < k.seconds; });
+    keyframes.insert(position, keyframe);
+}
+
+void CameraPath::sample(double seconds, GlobeProjection& projection) const
+{
+    if (keyframes.empty())
+    {
+        return;
+    }
+    
+    // 找到 seconds 所在的区间 [a, b]
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), seconds,
+                                 [](double value, const Keyframe& k) { return value < k.seconds; });
+    const Keyframe& a = next == keyframes.begin() ? *next : *(next - 1);
+    const Keyframe& b = next == keyframes.end() ? keyframes.back() : *next;
+    float t = b.seconds > a.seconds ? static_cast<float>((seconds - a.seconds) / (b.seconds - a.seconds)) : 0.0f;
+    t = std::clamp(t, 0.0f, 1.0f);
+    
+    projection.centerLon = a.camera.centerLon + (b.camera.centerLon - a.camera.centerLon) * t;
+    projection.centerLat = a.camera.centerLat + (b.camera.centerLat - a.camera.centerLat) * t;
+    projection.zoom = a.camera.zoom + (b.camera.zoom - a.camera.zoom) * t;
+    projection.transition = a.camera.transition + (b.camera.transition - a.camera.transition) * t;
+}
+
+bool CameraPath::load(const std::string& path, CameraPath& out, std::string* error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        if (error) *error = "Cannot open camera path " + path;
+        return false;
+    }
+    
+    out = CameraPath();
+    out.name = path;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+        {
+            line.erase(comment);
+        }
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        
+        std::istringstream fields(line);
+        double seconds = 0.0;
+        CameraAnimator::Camera camera;
+        if (!(fields >> seconds >> camera.centerLon >> camera.centerLat >> camera.zoom >> camera.transition))
+        {
+            if (error) *error = path + ":" + std::to_string(lineNumber) + ": expected 'seconds lon lat zoom transition'";
+            return false;
+        }
+        out.add(seconds, camera);
+    }
+    if (out.keyframes.empty())
+    {
+        if (error) *error = path + ": no keyframes";
+        return false;
+    }
+    return true;
+}
+
+bool CameraPath::builtin(const std::string& name, CameraPath& out)
+{
+    out = CameraPath();
+    out.name = name;
+    if (name == "pan")
+    {
+        // 中等缩放下沿纬线平移一周，墨卡托与半过渡各一段
+        out.add(0.0, { 0.0f, 20.0f, 4.0f, 0.0f });
+        out.add(5.0, { 180.0f, 20.0f, 4.0f, 0.0f });
+        out.add(5.5, { 180.0f, 20.0f, 4.0f, 0.5f });
+        out.add(10.5, { 360.0f, 20.0f, 4.0f, 0.5f });
+    }
+    else if (name == "zoom")
+    {
+        out.add(0.0, { 10.0f, 45.0f, 0.0f, 0.3f });
+        out.add(5.0, { 10.0f, 45.0f, 8.0f, 0.3f });
+        out.add(10.0, { 10.0f, 45.0f, 0.0f, 0.3f });
+    }
+    else if (name == "blend")
+    {
+        // 完整的 0 -> 1 -> 0 过渡，同时缓慢旋转
+        out.add(0.0, { 0.0f, 30.0f, 3.0f, 0.0f });
+        out.add(4.0, { 40.0f, 30.0f, 3.0f, 1.0f });
+        out.add(8.0, { 80.0f, 30.0f, 3.0f, 0.0f });
+    }
+    else if (name == "poles")
+    {
+        // Globe 模式下从南向北经过北极（纬度到 85° 后经度转 180° 从另一侧下来），再经过南极
+        out.add(0.0, { 30.0f, -40.0f, 3.0f, 1.0f });
+        out.add(3.0, { 30.0f, 85.0f, 3.0f, 1.0f });
+        out.add(4.0, { 210.0f, 85.0f, 3.0f, 1.0f });
+        out.add(8.0, { 210.0f, -85.0f, 3.0f, 1.0f });
+        out.add(9.0, { 390.0f, -85.0f, 3.0f, 0.6f });
+        out.add(11.0, { 390.0f, 0.0f, 3.0f, 0.6f });
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> CameraPath::builtinNames()
+{
+    return { "pan", "zoom", "blend", "poles" };
+}
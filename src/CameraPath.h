@@ -0,0 +1,54 @@
+#pragma once
+#include "CameraAnimator.h"
+#include "GlobeProjection.h"
+#include <string>
+#include <vector>
+
+/**
+ * 脚本化相机路径（不依赖 GL），供无窗口基准测试回放
+ *
+ * 路径是按时间排序的关键帧，关键帧之间对经纬度、缩放和过渡因子线性插值
+ * （经度不 wrap，可以表示连续旋转）。文本格式每行一个关键帧，# 开头为注释：
+ *
+ *   # 秒 经度 纬度 缩放 过渡因子
+ *   0   0    20   4    0
+ *   10  360  20   4    0
+ *
+ * 内置路径：pan（平移一周）、zoom（缩放 0 -> 8 -> 0）、blend（过渡因子 0 -> 1 -> 0）、
+ * poles（Globe 模式下经过南北极）。
+ */
+class CameraPath
+{
+public:
+    struct Keyframe
+    {
+        double seconds = 0.0;
+        CameraAnimator::Camera camera;
+    };
+    
+    std::string name;
+    
+    void add(double seconds, const CameraAnimator::Camera& camera);
+    
+    /**
+     * 写入 seconds 时刻的相机（超出范围时取首尾关键帧）
+     */
+    void sample(double seconds, GlobeProjection& projection) const;
+    
+    double getDuration() const { return keyframes.empty() ? 0.0 : keyframes.back().seconds; }
+    const std::vector<Keyframe>& getKeyframes() const { return keyframes; }
+    
+    /**
+     * 从文本文件读取；失败时返回 false 并写入 error
+     */
+    static bool load(const std::string& path, CameraPath& out, std::string* error = nullptr);
+    
+    /**
+     * 内置路径；名字未知时返回 false
+     */
+    static bool builtin(const std::string& name, CameraPath& out);
+    static std::vector<std::string> builtinNames();
+    
+private:
+    std::vector<Keyframe> keyframes;
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include <atomic>
+
+/**
+ * 协作式取消标记：发起方调用 cancel，执行方在开始工作前检查 isCancelled
+ *
+ * 通过 std::shared_ptr 在线程间共享，已经开始的工作不会被打断。
+ */
+class CancellationToken
+{
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    
+private:
+    std::atomic<bool> cancelled{ false };
+};
@@ -0,0 +1,161 @@
+#include "CollisionGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+CollisionGrid::CollisionGrid(float cellSize)
+    : cellSize(std::max(cellSize, 1.0f))
+{
+    reset(this->cellSize, this->cellSize);
+}
+
+void CollisionGrid::reset(float width, float height)
+{
+    int newColumns = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+    int newRows = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+    if (newColumns != columns || newRows != rows)
+    {
+        columns = newColumns;
+        rows = newRows;
+        cells.resize(static_cast<size_t>(columns) * rows);
+    }
+    for (std::vector<uint32_t>& cell : cells)
+    {
+        cell.clear();
+    }
+    entries.clear();
+    seen.clear();
+    removedCount = 0;
+    queryStamp = 0;
+}
+
+CollisionGrid::CellRange CollisionGrid::cellRange(const glm::vec4& box) const
+{
+    auto column = [&](float x) { return std::clamp(static_cast<int>(std::floor(x / cellSize)), 0, columns - 1); };
+    auto row = [&](float y) { return std::clamp(static_cast<int>(std::floor(y / cellSize)), 0, rows - 1); };
+    return { column(box.x), row(box.y), column(box.z), row(box.w) };
+}
+
+uint32_t CollisionGrid::insert(const Entry& entry, const glm::vec4& box)
+{
+    uint32_t index = static_cast<uint32_t>(entries.size());
+    entries.push_back(entry);
+    seen.push_back(0);
+    CellRange range = cellRange(box);
+    for (int y = range.y1; y <= range.y2; ++y)
+    {
+        for (int x = range.x1; x <= range.x2; ++x)
+        {
+            cells[static_cast<size_t>(y) * columns + x].push_back(index);
+        }
+    }
+    return index;
+}
+
+uint32_t CollisionGrid::insertBox(const glm::vec4& box, uint32_t key)
+{
+    return insert({ box, key, Shape::Box }, box);
+}
+
+uint32_t CollisionGrid::insertCircle(const glm::vec2& center, float radius, uint32_t key)
+{
+    return insert({ glm::vec4(center, radius, 0.0f), key, Shape::Circle },
+                  glm::vec4(center.x - radius, center.y - radius, center.x + radius, center.y + radius));
+}
+
+void CollisionGrid::remove(uint32_t entry)
+{
+    if (entry < entries.size() && entries[entry].shape != Shape::Removed)
+    {
+        entries[entry].shape = Shape::Removed;
+        ++removedCount;
+    }
+}
+
+bool CollisionGrid::overlaps(const Entry& entry, const glm::vec4& box, const glm::vec2& center, float radius, bool circle)
+{
+    const glm::vec4& b = entry.bounds;
+    if (entry.shape == Shape::Box)
+    {
+        if (!circle)
+        {
+            return b.x < box.z && box.x < b.z && b.y < box.w && box.y < b.w;
+        }
+        // 圆心到矩形的最近点
+        float dx = center.x - std::clamp(center.x, b.x, b.z);
+        float dy = center.y - std::clamp(center.y, b.y, b.w);
+        return dx * dx + dy * dy < radius * radius;
+    }
+    if (entry.shape == Shape::Circle)
+    {
+        if (circle)
+        {
+            float dx = center.x - b.x;
+            float dy = center.y - b.y;
+            float sum = radius + b.z;
+            return dx * dx + dy * dy < sum * sum;
+        }
+        float dx = b.x - std::clamp(b.x, box.x, box.z);
+        float dy = b.y - std::clamp(b.y, box.y, box.w);
+        return dx * dx + dy * dy < b.z * b.z;
+    }
+    return false;
+}
+
+template <typename Fn>
+bool CollisionGrid::forEachCandidate(const glm::vec4& box, Fn&& fn) const
+{
+    if (entries.empty())
+    {
+        return false;
+    }
+    
+    // 序号回绕时清零，避免把很久以前的查询误认为本次
+    if (++queryStamp == 0)
+    {
+        std::fill(seen.begin(), seen.end(), 0);
+        queryStamp = 1;
+    }
+    CellRange range = cellRange(box);
+    for (int y = range.y1; y <= range.y2; ++y)
+    {
+        for (int x = range.x1; x <= range.x2; ++x)
+        {
+            for (uint32_t index : cells[static_cast<size_t>(y) * columns + x])
+            {
+                if (seen[index] == queryStamp)
+                {
+                    continue;
+                }
+                seen[index] = queryStamp;
+                if (fn(entries[index]))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool CollisionGrid::hitTestBox(const glm::vec4& box) const
+{
+    return forEachCandidate(box, [&](const Entry& entry) { return overlaps(entry, box, glm::vec2(0.0f), 0.0f, false); });
+}
+
+bool CollisionGrid::hitTestCircle(const glm::vec2& center, float radius) const
+{
+    glm::vec4 box(center.x - radius, center.y - radius, center.x + radius, center.y + radius);
+    return forEachCandidate(box, [&](const Entry& entry) { return overlaps(entry, box, center, radius, true); });
+}
+
+void CollisionGrid::queryBox(const glm::vec4& box, std::vector<uint32_t>& out) const
+{
+    forEachCandidate(box, [&](const Entry& entry) {
+        if (overlaps(entry, box, glm::vec2(0.0f), 0.0f, false))
+        {
+            out.push_back(entry.key);
+        }
+        return false;
+    });
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 屏幕空间的碰撞网格（maplibre GridIndex 的做法，不依赖 GL）
+ *
+ * - 视口按 cellSize 像素划分为均匀网格，每个矩形 / 圆登记到它的外接框覆盖的所有格子
+ *   （超出视口的部分夹到边缘的格子）
+ * - 查询只检查覆盖到的格子中的条目；跨多个格子的条目用查询序号去重，每次查询只测试一次
+ * - reset 保留各格子的容量，每帧重建不再分配内存；remove 只把条目标记为删除，下次 reset 时回收
+ *
+ * 查询会更新去重用的序号，同一个网格不能在多个线程上同时使用。
+ */
+class CollisionGrid
+{
+public:
+    static constexpr uint32_t kInvalidEntry = UINT32_MAX;
+    
+    explicit CollisionGrid(float cellSize = 64.0f);
+    
+    /**
+     * 清空并按视口大小（像素）重新划分
+     */
+    void reset(float width, float height);
+    
+    /**
+     * 登记矩形 (x1, y1, x2, y2) / 圆，返回条目编号（remove 的参数）；key 由调用方定义，查询时返回
+     */
+    uint32_t insertBox(const glm::vec4& box, uint32_t key);
+    uint32_t insertCircle(const glm::vec2& center, float radius, uint32_t key);
+    void remove(uint32_t entry);
+    
+    /**
+     * 是否与任何条目重叠（边界相接不算）
+     */
+    bool hitTestBox(const glm::vec4& box) const;
+    bool hitTestCircle(const glm::vec2& center, float radius) const;
+    
+    /**
+     * 与矩形重叠的所有条目的 key，追加到 out
+     */
+    void queryBox(const glm::vec4& box, std::vector<uint32_t>& out) const;
+    
+    size_t getEntryCount() const { return entries.size() - removedCount; }
+    float getCellSize() const { return cellSize; }
+    
+private:
+    enum class Shape : uint8_t
+    {
+        Box,
+        Circle,
+        Removed
+    };
+    
+    struct Entry
+    {
+        glm::vec4 bounds;       // Box：(x1, y1, x2, y2)；Circle：(cx, cy, r, 0)
+        uint32_t key;
+        Shape shape;
+    };
+    
+    struct CellRange
+    {
+        int x1, y1, x2, y2;
+    };
+    
+    CellRange cellRange(const glm::vec4& box) const;
+    uint32_t insert(const Entry& entry, const glm::vec4& box);
+    static bool overlaps(const Entry& entry, const glm::vec4& box, const glm::vec2& center, float radius, bool circle);
+    
+    template <typename Fn>
+    bool forEachCandidate(const glm::vec4& box, Fn&& fn) const;
+    
+    float cellSize;
+    int columns = 0;
+    int rows = 0;
+    std::vector<std::vector<uint32_t>> cells;
+    std::vector<Entry> entries;
+    size_t removedCount = 0;
+    
+    mutable std::vector<uint32_t> seen;     // 每个条目最近一次被测试的查询序号
+    mutable uint32_t queryStamp = 0;
+};
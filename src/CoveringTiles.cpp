@@ -0,0 +1,154 @@
+#include "CoveringTiles.h"
+
+#include "GlobeProjection.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace
+{
+// 与 GlobeProjection 中 glm::perspective 使用的垂直视场角一致
+constexpr float kFieldOfViewY = Constants::PI / 4.0f;
+// 相机距离的下限，避免 tile 紧贴相机时误差趋于无穷
+constexpr float kMinDistance = 1e-3f;
+
+struct Candidate
+{
+    TileID tile;
+    float error;
+    
+    bool operator<(const Candidate& other) const
+    {
+        return error < other.error;
+    }
+};
+
+bool tileLess(const TileID& a, const TileID& b)
+{
+    if (a.z != b.z) return a.z < b.z;
+    if (a.y != b.y) return a.y < b.y;
+    if (a.x != b.x) return a.x < b.x;
+    return a.wrap < b.wrap;
+}
+} // namespace
+
+std::vector<TileID> CoveringTiles::select(const ProjectionState& state, TileCuller* culler) const
+{
+    PROFILE_ZONE("CoveringTiles::select");
+    std::priority_queue<Candidate> candidates;
+    std::vector<TileID> result;
+    
+    auto push = [&](const TileID& tile) {
+        if (culler && !culler->isVisible(tile))
+        {
+            return;
+        }
+        candidates.push({tile, screenSpaceError(state, tile)});
+    };
+    
+    if (state.isFlat())
+    {
+        for (int wrap = -1; wrap <= 1; wrap++)
+        {
+            push({0, 0, 0, wrap});
+        }
+    }
+    else
+    {
+        push({0, 0, 0, state.wrapForTile(0, 0)});
+    }
+    
+    while (!candidates.empty())
+    {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+        
+        // 当前叶子数 = 已确定的 tile + 待处理的候选（含自身），细分一次净增 3 个
+        const TileID& tile = candidate.tile;
+        size_t leafCount = result.size() + candidates.size() + 1;
+        bool needsSplit = tile.z < options.minZoom || candidate.error > options.maxScreenSpaceError;
+        bool canSplit = tile.z < options.maxZoom && leafCount + 3 <= options.maxTiles;
+        
+        if (needsSplit && canSplit)
+        {
+            TileID children[4];
+            getChildren(state, tile, children);
+            for (const TileID& child : children)
+            {
+                push(child);
+            }
+        }
+        else
+        {
+            result.push_back(tile);
+        }
+    }
+    
+    std::sort(result.begin(), result.end(), tileLess);
+    return result;
+}
+
+float CoveringTiles::screenSpaceError(const ProjectionState& state, const TileID& tile) const
+{
+    float numTiles = ProjectionState::tileCount(tile.z);
+    float worldScale = state.getWorldScale();
+    float dist = state.getCameraDistance();
+    
+    // center 在归一化 Mercator 空间的位置
+    float centerMercX = state.getCenterMercX();
+    float centerMercY = state.getCenterMercY();
+    
+    // tile 范围（包含 wrap 偏移）
+    float tileMinX = (tile.x + tile.wrap * numTiles) / numTiles;
+    float tileMinY = tile.y / numTiles;
+    float tileSize = 1.0f / numTiles;
+    
+    // tile 内离 center 最近的点
+    float nearestX = std::clamp(centerMercX, tileMinX, tileMinX + tileSize);
+    float nearestY = std::clamp(centerMercY, tileMinY, tileMinY + tileSize);
+    
+    // 平面部分：相机位于 center 正上方 dist 处
+    float dx = (nearestX - centerMercX) * worldScale;
+    float dy = (nearestY - centerMercY) * worldScale;
+    float flatDistance = sqrt(dx * dx + dy * dy + dist * dist);
+    float flatSize = worldScale * tileSize;
+    
+    float distance = flatDistance;
+    float size = flatSize;
+    if (!state.isFlat())
+    {
+        // Globe 部分：相机位于 center 方向、距球心 dist 处
+        float globeRadius = state.getGlobeRadius();
+        float lon = (nearestX - 0.5f) * 2.0f * Constants::PI;
+        float lat = GlobeProjection::latFromMercatorY(nearestY) * Constants::PI / 180.0f;
+        
+        glm::vec3 point(sin(lon) * cos(lat), sin(lat), cos(lon) * cos(lat));
+        float globeDistance = glm::length(state.getCenterDirection() * dist - point * globeRadius);
+        // 墨卡托 tile 在球面上的实际尺寸随纬度按 cos 缩小（周长 = worldScale）
+        float globeSize = flatSize * cos(lat);
+        
+        distance = flatDistance + (globeDistance - flatDistance) * state.getTransition();
+        size = flatSize + (globeSize - flatSize) * state.getTransition();
+    }
+    
+    float pixelsPerUnit = options.viewportHeight / (2.0f * tan(kFieldOfViewY * 0.5f));
+    return size / std::max(distance, kMinDistance) * pixelsPerUnit;
+}
+
+void CoveringTiles::getChildren(const ProjectionState& state, const TileID& tile, TileID children[4])
+{
+    int index = 0;
+    for (int dy = 0; dy < 2; dy++)
+    {
+        for (int dx = 0; dx < 2; dx++)
+        {
+            TileID child{tile.x * 2 + dx, tile.y * 2 + dy, tile.z + 1, tile.wrap};
+            if (!state.isFlat())
+            {
+                child.wrap = state.wrapForTile(child.x, child.z);
+            }
+            children[index++] = child;
+        }
+    }
+}
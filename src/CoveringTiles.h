@@ -0,0 +1,56 @@
+#pragma once
+#include "ProjectionState.h"
+#include "TileCuller.h"
+#include "TileID.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * 覆盖 tile 选择器（四叉树 + 屏幕空间误差 LOD）
+ *
+ * 从 z0 开始向下细分，每次优先细分屏幕空间误差最大的 tile，
+ * 直到所有 tile 误差都低于阈值、到达 maxZoom 或达到 tile 数量上限。
+ * 结果可以包含混合的 zoom 层级，不依赖 GL，可以直接单独测试。
+ *
+ * wrap 规则与 TileRenderer 原有逻辑一致：
+ * 1. 纯 Mercator 模式：z0 在 wrap=-1, 0, 1 各一个根节点，子 tile 继承父 tile 的 wrap
+ * 2. Globe 过渡模式：每个 tile 通过 wrapForTile 选择最接近 center 的 wrap
+ */
+class CoveringTiles
+{
+public:
+    struct Options
+    {
+        float maxScreenSpaceError = 768.0f;  // tile 在屏幕上允许的最大尺寸（像素），超过则细分
+        int viewportHeight = 1080;           // 视口高度（像素），用于把世界尺寸换算成像素
+        int minZoom = 0;                     // 至少细分到该层级
+        int maxZoom = 16;                    // 最多细分到该层级
+        size_t maxTiles = 256;               // 硬性 tile 数量上限
+    };
+    
+    Options options;
+    
+    /**
+     * 根据当前投影状态（过渡因子、中心点、缩放）选出本帧的 tile 集合
+     * 返回结果按 z, y, x, wrap 排序，保证同一状态下输出稳定
+     *
+     * 传入 culler 时，不可见的 tile 在遍历中直接丢弃，不再细分也不占用 tile 预算
+     * （包围测试是保守的，父 tile 不可见则所有子 tile 也不可见）
+     */
+    std::vector<TileID> select(const ProjectionState& state, TileCuller* culler = nullptr) const;
+    
+    /**
+     * 计算 tile 的屏幕空间误差（像素）
+     *
+     * 以 tile 离相机最近的点为参考：
+     * - 平面部分：tile 在 Mercator 平面上的尺寸 / 到相机的距离
+     * - Globe 部分：tile 在球面上的弧长（随纬度按 cos 缩小）/ 到相机的距离
+     * 过渡状态下两者按过渡因子混合
+     */
+    float screenSpaceError(const ProjectionState& state, const TileID& tile) const;
+    
+    /**
+     * 给定 tile 的子 tile（Globe 过渡模式下按 wrapForTile 重新选择 wrap）
+     */
+    static void getChildren(const ProjectionState& state, const TileID& tile, TileID children[4]);
+};
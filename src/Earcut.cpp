@@ -0,0 +1,648 @@
+#include "Earcut.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+// 顶点数超过该值时建立 z-order 索引（与 earcut 相同）
+constexpr size_t kHashingThreshold = 80;
+
+int sign(double value)
+{
+    return (0.0 < value) - (value < 0.0);
+}
+} // namespace
+
+size_t Earcut::triangulate(const glm::vec2* points, const uint32_t* ringEnds, size_t ringCount,
+                           std::vector<uint32_t>& indices, uint32_t baseIndex)
+{
+    usedBlocks = 0;
+    usedInBlock = kBlockSize;
+    output = &indices;
+    outputBase = baseIndex;
+    triangles = 0;
+    if (ringCount == 0 || ringEnds[0] < 3)
+    {
+        return 0;
+    }
+    
+    Node* outerNode = linkedList(points, 0, ringEnds[0], true);
+    if (!outerNode || outerNode->prev == outerNode->next)
+    {
+        return 0;
+    }
+    if (ringCount > 1)
+    {
+        outerNode = eliminateHoles(points, ringEnds, ringCount, outerNode);
+    }
+    
+    hashing = ringEnds[ringCount - 1] > kHashingThreshold;
+    if (hashing)
+    {
+        // z-order 按外环的包围盒归一化到 0..32767
+        double maxX = points[0].x, maxY = points[0].y;
+        minX = maxX;
+        minY = maxY;
+        for (uint32_t i = 1; i < ringEnds[0]; i++)
+        {
+            minX = std::min<double>(minX, points[i].x);
+            minY = std::min<double>(minY, points[i].y);
+            maxX = std::max<double>(maxX, points[i].x);
+            maxY = std::max<double>(maxY, points[i].y);
+        }
+        invSize = std::max(maxX - minX, maxY - minY);
+        invSize = invSize != 0.0 ? 32767.0 / invSize : 0.0;
+    }
+    
+    earcutLinked(outerNode);
+    output = nullptr;
+    return triangles;
+}
+
+Earcut::Node* Earcut::createNode(uint32_t i, double x, double y)
+{
+    if (usedInBlock == kBlockSize)
+    {
+        if (usedBlocks == blocks.size())
+        {
+            blocks.emplace_back(new Node[kBlockSize]);
+        }
+        usedBlocks++;
+        usedInBlock = 0;
+    }
+    Node* node = &blocks[usedBlocks - 1][usedInBlock++];
+    *node = Node{ i, x, y, nullptr, nullptr, 0, nullptr, nullptr, false };
+    return node;
+}
+
+Earcut::Node* Earcut::insertNode(uint32_t i, const glm::vec2& point, Node* last)
+{
+    Node* p = createNode(i, point.x, point.y);
+    if (!last)
+    {
+        p->prev = p;
+        p->next = p;
+    }
+    else
+    {
+        p->next = last->next;
+        p->prev = last;
+        last->next->prev = p;
+        last->next = p;
+    }
+    return p;
+}
+
+void Earcut::removeNode(Node* p)
+{
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+    if (p->prevZ)
+    {
+        p->prevZ->nextZ = p->nextZ;
+    }
+    if (p->nextZ)
+    {
+        p->nextZ->prevZ = p->prevZ;
+    }
+}
+
+Earcut::Node* Earcut::linkedList(const glm::vec2* points, uint32_t begin, uint32_t end, bool clockwise)
+{
+    // 按指定方向建立环形链表（外环与洞方向相反）
+    double sum = 0.0;
+    for (uint32_t i = begin, j = end - 1; i < end; j = i++)
+    {
+        sum += (static_cast<double>(points[j].x) - points[i].x) * (static_cast<double>(points[i].y) + points[j].y);
+    }
+    Node* last = nullptr;
+    if (clockwise == (sum > 0.0))
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            last = insertNode(i, points[i], last);
+        }
+    }
+    else
+    {
+        for (uint32_t i = end; i-- > begin;)
+        {
+            last = insertNode(i, points[i], last);
+        }
+    }
+    if (last && equals(last, last->next))
+    {
+        removeNode(last);
+        last = last->next;
+    }
+    return last;
+}
+
+Earcut::Node* Earcut::filterPoints(Node* start, Node* end)
+{
+    // 去掉重复点和共线点
+    if (!end)
+    {
+        end = start;
+    }
+    Node* p = start;
+    bool again;
+    do
+    {
+        again = false;
+        if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0))
+        {
+            removeNode(p);
+            p = end = p->prev;
+            if (p == p->next)
+            {
+                break;
+            }
+            again = true;
+        }
+        else
+        {
+            p = p->next;
+        }
+    } while (again || p != end);
+    return end;
+}
+
+void Earcut::earcutLinked(Node* ear, int pass)
+{
+    if (!ear)
+    {
+        return;
+    }
+    if (pass == 0 && hashing)
+    {
+        indexCurve(ear);
+    }
+    
+    Node* stop = ear;
+    while (ear->prev != ear->next)
+    {
+        Node* prev = ear->prev;
+        Node* next = ear->next;
+        if (hashing ? isEarHashed(ear) : isEar(ear))
+        {
+            emit(prev, ear, next);
+            removeNode(ear);
+            // 跳过下一个顶点，得到的三角形更匀称
+            ear = next->next;
+            stop = next->next;
+            continue;
+        }
+        ear = next;
+        
+        // 转了一圈没有切下耳朵：依次尝试更激进的处理
+        if (ear == stop)
+        {
+            if (pass == 0)
+            {
+                earcutLinked(filterPoints(ear), 1);
+            }
+            else if (pass == 1)
+            {
+                ear = cureLocalIntersections(filterPoints(ear));
+                earcutLinked(ear, 2);
+            }
+            else if (pass == 2)
+            {
+                splitEarcut(ear);
+            }
+            break;
+        }
+    }
+}
+
+bool Earcut::isEar(Node* ear) const
+{
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+    if (area(a, b, c) >= 0.0)
+    {
+        return false;   // 凹角
+    }
+    // 其余顶点都不在三角形内
+    for (const Node* p = ear->next->next; p != ear->prev; p = p->next)
+    {
+        if (pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && area(p->prev, p, p->next) >= 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Earcut::isEarHashed(Node* ear) const
+{
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+    if (area(a, b, c) >= 0.0)
+    {
+        return false;
+    }
+    
+    // 三角形包围盒对应的 z-order 范围
+    const double minTX = std::min({ a->x, b->x, c->x });
+    const double minTY = std::min({ a->y, b->y, c->y });
+    const double maxTX = std::max({ a->x, b->x, c->x });
+    const double maxTY = std::max({ a->y, b->y, c->y });
+    const int32_t minZ = zOrder(minTX, minTY);
+    const int32_t maxZ = zOrder(maxTX, maxTY);
+    
+    // 沿 z-order 向两个方向查找
+    const Node* p = ear->prevZ;
+    const Node* n = ear->nextZ;
+    auto inside = [&](const Node* q) {
+        return q != ear->prev && q != ear->next
+            && pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, q->x, q->y) && area(q->prev, q, q->next) >= 0.0;
+    };
+    while (p && p->z >= minZ && n && n->z <= maxZ)
+    {
+        if (inside(p))
+        {
+            return false;
+        }
+        p = p->prevZ;
+        if (inside(n))
+        {
+            return false;
+        }
+        n = n->nextZ;
+    }
+    for (; p && p->z >= minZ; p = p->prevZ)
+    {
+        if (inside(p))
+        {
+            return false;
+        }
+    }
+    for (; n && n->z <= maxZ; n = n->nextZ)
+    {
+        if (inside(n))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+Earcut::Node* Earcut::cureLocalIntersections(Node* start)
+{
+    // a-p 与 p.next-b 相交时输出三角形 a,p,b 并去掉 p 和 p.next
+    Node* p = start;
+    do
+    {
+        Node* a = p->prev;
+        Node* b = p->next->next;
+        if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a))
+        {
+            emit(a, p, b);
+            removeNode(p);
+            removeNode(p->next);
+            p = start = b;
+        }
+        p = p->next;
+    } while (p != start);
+    return filterPoints(p);
+}
+
+void Earcut::splitEarcut(Node* start)
+{
+    // 找一条有效对角线把多边形拆成两半，分别三角化
+    Node* a = start;
+    do
+    {
+        Node* b = a->next->next;
+        while (b != a->prev)
+        {
+            if (a->i != b->i && isValidDiagonal(a, b))
+            {
+                Node* c = splitPolygon(a, b);
+                a = filterPoints(a, a->next);
+                c = filterPoints(c, c->next);
+                earcutLinked(a);
+                earcutLinked(c);
+                return;
+            }
+            b = b->next;
+        }
+        a = a->next;
+    } while (a != start);
+}
+
+Earcut::Node* Earcut::eliminateHoles(const glm::vec2* points, const uint32_t* ringEnds, size_t ringCount, Node* outerNode)
+{
+    holeQueue.clear();
+    for (size_t ring = 1; ring < ringCount; ring++)
+    {
+        Node* list = ringEnds[ring] > ringEnds[ring - 1] ? linkedList(points, ringEnds[ring - 1], ringEnds[ring], false) : nullptr;
+        if (list)
+        {
+            if (list == list->next)
+            {
+                list->steiner = true;
+            }
+            holeQueue.push_back(getLeftmost(list));
+        }
+    }
+    // 从左到右处理洞
+    std::sort(holeQueue.begin(), holeQueue.end(), [](const Node* a, const Node* b) {
+        return a->x < b->x || (a->x == b->x && a->y < b->y);
+    });
+    for (Node* hole : holeQueue)
+    {
+        outerNode = eliminateHole(hole, outerNode);
+    }
+    return outerNode;
+}
+
+Earcut::Node* Earcut::eliminateHole(Node* hole, Node* outerNode)
+{
+    Node* bridge = findHoleBridge(hole, outerNode);
+    if (!bridge)
+    {
+        return outerNode;
+    }
+    Node* bridgeReverse = splitPolygon(bridge, hole);
+    // 去掉桥两端的共线点；输入节点可能被去掉，返回桥上仍在链表中的节点
+    filterPoints(bridgeReverse, bridgeReverse->next);
+    return filterPoints(bridge, bridge->next);
+}
+
+Earcut::Node* Earcut::findHoleBridge(Node* hole, Node* outerNode) const
+{
+    // 从洞的最左点向左的射线与外环相交的最近一条边
+    Node* p = outerNode;
+    const double hx = hole->x;
+    const double hy = hole->y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node* m = nullptr;
+    do
+    {
+        if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+        {
+            double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            if (x <= hx && x > qx)
+            {
+                qx = x;
+                m = p->x < p->next->x ? p : p->next;
+                if (x == hx)
+                {
+                    return m;   // 洞的顶点在外环的边上
+                }
+            }
+        }
+        p = p->next;
+    } while (p != outerNode);
+    if (!m)
+    {
+        return nullptr;
+    }
+    
+    // 洞点、交点和边端点构成的三角形内若有外环顶点，选与射线夹角最小的一个
+    const Node* stop = m;
+    const double mx = m->x;
+    const double my = m->y;
+    double tanMin = std::numeric_limits<double>::infinity();
+    p = m;
+    do
+    {
+        if (hx >= p->x && p->x >= mx && hx != p->x
+            && pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+        {
+            double tanCur = std::abs(hy - p->y) / (hx - p->x);
+            if (locallyInside(p, hole)
+                && (tanCur < tanMin || (tanCur == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+            {
+                m = p;
+                tanMin = tanCur;
+            }
+        }
+        p = p->next;
+    } while (p != stop);
+    return m;
+}
+
+void Earcut::indexCurve(Node* start) const
+{
+    Node* p = start;
+    do
+    {
+        p->z = p->z ? p->z : zOrder(p->x, p->y);
+        p->prevZ = p->prev;
+        p->nextZ = p->next;
+        p = p->next;
+    } while (p != start);
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+    sortLinked(p);
+}
+
+Earcut::Node* Earcut::sortLinked(Node* list)
+{
+    // 链表归并排序（Simon Tatham）
+    size_t inSize = 1;
+    while (true)
+    {
+        Node* p = list;
+        Node* tail = nullptr;
+        size_t numMerges = 0;
+        list = nullptr;
+        while (p)
+        {
+            numMerges++;
+            Node* q = p;
+            size_t pSize = 0;
+            for (size_t i = 0; i < inSize && q; i++)
+            {
+                pSize++;
+                q = q->nextZ;
+            }
+            size_t qSize = inSize;
+            while (pSize > 0 || (qSize > 0 && q))
+            {
+                Node* e;
+                if (pSize == 0)
+                {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+                else if (qSize == 0 || !q || p->z <= q->z)
+                {
+                    e = p;
+                    p = p->nextZ;
+                    pSize--;
+                }
+                else
+                {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+                if (tail)
+                {
+                    tail->nextZ = e;
+                }
+                else
+                {
+                    list = e;
+                }
+                e->prevZ = tail;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->nextZ = nullptr;
+        if (numMerges <= 1)
+        {
+            return list;
+        }
+        inSize *= 2;
+    }
+}
+
+int32_t Earcut::zOrder(double x, double y) const
+{
+    // 坐标归一化到 15 位后交错比特；洞可能超出外环的包围盒，先截断（单调，不影响范围查找）
+    uint32_t ix = static_cast<uint32_t>(std::clamp((x - minX) * invSize, 0.0, 32767.0));
+    uint32_t iy = static_cast<uint32_t>(std::clamp((y - minY) * invSize, 0.0, 32767.0));
+    ix = (ix | (ix << 8)) & 0x00FF00FF;
+    ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+    ix = (ix | (ix << 2)) & 0x33333333;
+    ix = (ix | (ix << 1)) & 0x55555555;
+    iy = (iy | (iy << 8)) & 0x00FF00FF;
+    iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+    iy = (iy | (iy << 2)) & 0x33333333;
+    iy = (iy | (iy << 1)) & 0x55555555;
+    return static_cast<int32_t>(ix | (iy << 1));
+}
+
+Earcut::Node* Earcut::splitPolygon(Node* a, Node* b)
+{
+    // 用对角线 a-b 把环拆成两个；返回新环中 b 的副本
+    Node* a2 = createNode(a->i, a->x, a->y);
+    Node* b2 = createNode(b->i, b->x, b->y);
+    Node* an = a->next;
+    Node* bp = b->prev;
+    a->next = b;
+    b->prev = a;
+    a2->next = an;
+    an->prev = a2;
+    b2->next = a2;
+    a2->prev = b2;
+    bp->next = b2;
+    b2->prev = bp;
+    return b2;
+}
+
+void Earcut::emit(const Node* a, const Node* b, const Node* c)
+{
+    output->push_back(outputBase + a->i);
+    output->push_back(outputBase + b->i);
+    output->push_back(outputBase + c->i);
+    triangles++;
+}
+
+Earcut::Node* Earcut::getLeftmost(Node* start)
+{
+    Node* p = start;
+    Node* leftmost = start;
+    do
+    {
+        if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+        {
+            leftmost = p;
+        }
+        p = p->next;
+    } while (p != start);
+    return leftmost;
+}
+
+bool Earcut::sectorContainsSector(const Node* m, const Node* p)
+{
+    return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0;
+}
+
+bool Earcut::isValidDiagonal(Node* a, Node* b)
+{
+    return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b)
+        // 局部可见，且不产生方向相反的扇区
+        && ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+             && (area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0))
+            // 零长度的特殊情况
+            || (equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0));
+}
+
+bool Earcut::intersectsPolygon(const Node* a, const Node* b)
+{
+    const Node* p = a;
+    do
+    {
+        if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && intersects(p, p->next, a, b))
+        {
+            return true;
+        }
+        p = p->next;
+    } while (p != a);
+    return false;
+}
+
+bool Earcut::locallyInside(const Node* a, const Node* b)
+{
+    return area(a->prev, a, a->next) < 0.0
+        ? area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0
+        : area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0;
+}
+
+bool Earcut::middleInside(const Node* a, const Node* b)
+{
+    const Node* p = a;
+    bool inside = false;
+    const double px = (a->x + b->x) / 2.0;
+    const double py = (a->y + b->y) / 2.0;
+    do
+    {
+        if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y
+            && (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+        {
+            inside = !inside;
+        }
+        p = p->next;
+    } while (p != a);
+    return inside;
+}
+
+bool Earcut::intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2)
+{
+    int o1 = sign(area(p1, q1, p2));
+    int o2 = sign(area(p1, q1, q2));
+    int o3 = sign(area(p2, q2, p1));
+    int o4 = sign(area(p2, q2, q1));
+    if (o1 != o2 && o3 != o4)
+    {
+        return true;
+    }
+    // 共线时检查端点是否落在另一条线段上
+    return (o1 == 0 && onSegment(p1, p2, q1)) || (o2 == 0 && onSegment(p1, q2, q1))
+        || (o3 == 0 && onSegment(p2, p1, q2)) || (o4 == 0 && onSegment(p2, q1, q2));
+}
+
+bool Earcut::onSegment(const Node* p, const Node* q, const Node* r)
+{
+    return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x)
+        && q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+}
+
+bool Earcut::pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py)
+        && (ax - px) * (by - py) >= (bx - px) * (ay - py)
+        && (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * 多边形三角化（mapbox/earcut 算法的移植）
+ *
+ * - 外环与洞用双向链表表示，洞按最左点依次桥接到外环，之后逐个切耳
+ * - 顶点较多时按 z-order 曲线建立空间索引，切耳检测只看三角形包围盒内的点
+ * - 切不下去时依次：去掉共线点、修复局部自相交、沿有效对角线拆成两半分别处理，
+ *   因此对自相交、重复点等不规范的输入也总能输出三角形（可能不完全覆盖）
+ *
+ * 链表节点放在分块的对象池中，实例在多次调用之间复用，稳定后不再分配内存；
+ * 一个实例同一时刻只能被一个线程使用。
+ */
+class Earcut
+{
+public:
+    Earcut() = default;
+    
+    Earcut(const Earcut&) = delete;
+    Earcut& operator=(const Earcut&) = delete;
+    
+    /**
+     * points 依次存放各环的顶点（第一个为外环，其余为洞，首点不重复），ringEnds[i] 为第 i 个环的结束下标；
+     * 三角形的顶点下标（相对 points，加上 baseIndex）追加到 indices，返回追加的三角形数
+     */
+    size_t triangulate(const glm::vec2* points, const uint32_t* ringEnds, size_t ringCount,
+                       std::vector<uint32_t>& indices, uint32_t baseIndex = 0);
+                       
+private:
+    struct Node
+    {
+        uint32_t i;              // 顶点下标（相对 points）
+        double x, y;
+        Node* prev;
+        Node* next;
+        int32_t z;               // z-order 值
+        Node* prevZ;
+        Node* nextZ;
+        bool steiner;            // 退化为一个点的洞，不参与去除共线点
+    };
+    
+    static constexpr size_t kBlockSize = 1024;
+    
+    Node* createNode(uint32_t i, double x, double y);
+    Node* insertNode(uint32_t i, const glm::vec2& point, Node* last);
+    static void removeNode(Node* p);
+    
+    Node* linkedList(const glm::vec2* points, uint32_t begin, uint32_t end, bool clockwise);
+    Node* filterPoints(Node* start, Node* end = nullptr);
+    void earcutLinked(Node* ear, int pass = 0);
+    bool isEar(Node* ear) const;
+    bool isEarHashed(Node* ear) const;
+    Node* cureLocalIntersections(Node* start);
+    void splitEarcut(Node* start);
+    Node* eliminateHoles(const glm::vec2* points, const uint32_t* ringEnds, size_t ringCount, Node* outerNode);
+    Node* eliminateHole(Node* hole, Node* outerNode);
+    Node* findHoleBridge(Node* hole, Node* outerNode) const;
+    void indexCurve(Node* start) const;
+    static Node* sortLinked(Node* list);
+    int32_t zOrder(double x, double y) const;
+    Node* splitPolygon(Node* a, Node* b);
+    void emit(const Node* a, const Node* b, const Node* c);
+    
+    static Node* getLeftmost(Node* start);
+    static bool sectorContainsSector(const Node* m, const Node* p);
+    static bool isValidDiagonal(Node* a, Node* b);
+    static bool intersectsPolygon(const Node* a, const Node* b);
+    static bool locallyInside(const Node* a, const Node* b);
+    static bool middleInside(const Node* a, const Node* b);
+    static bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2);
+    static bool onSegment(const Node* p, const Node* q, const Node* r);
+    static bool equals(const Node* a, const Node* b) { return a->x == b->x && a->y == b->y; }
+    static double area(const Node* p, const Node* q, const Node* r)
+    {
+        return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+    }
+    static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py);
+    
+    // 节点池：按块分配，triangulate 开始时整体回收
+    std::vector<std::unique_ptr<Node[]>> blocks;
+    size_t usedBlocks = 0;
+    size_t usedInBlock = kBlockSize;
+    
+    std::vector<Node*> holeQueue;
+    std::vector<uint32_t>* output = nullptr;
+    uint32_t outputBase = 0;
+    size_t triangles = 0;
+    
+    bool hashing = false;
+    double minX = 0.0, minY = 0.0, invSize = 0.0;
+};
@@ -0,0 +1,43 @@
+#include "FrameBuilder.h"
+
+#include "Profiler.h"
+#include <chrono>
+#include <cstring>
+
+FrameBuilder::FrameBuilder(const TileMesh& mesh)
+    : geometryCache(mesh), frameIndex(0)
+{
+}
+
+std::shared_ptr<const FramePacket> FrameBuilder::build(const GlobeProjection& projection, float aspect)
+{
+    PROFILE_ZONE("FrameBuilder::build");
+    auto start = std::chrono::steady_clock::now();
+    auto packet = std::make_shared<FramePacket>();
+    packet->frameIndex = frameIndex++;
+    packet->projection = projection;
+    packet->aspect = aspect;
+    
+    // 选出本帧覆盖的 tile（遍历时剔除视锥外和地平线后的 tile）并打包实例数据
+    // 投影状态只在相机参数变化时重新计算
+    packet->state = packet->projection.getState(aspect);
+    culler.resetStats();
+    culler.update(packet->state);
+    packet->tiles = coveringTiles.select(*packet->state, &culler);
+    packet->cullStats = culler.getStats();
+    geometryCache.beginFrame();
+    packet->instances.build(*packet->state, packet->tiles, &geometryCache);
+    
+    // 新分配的 slot 在这里计算并复制进包，GL 线程不再访问几何缓存
+    packet->geometrySlots = geometryCache.computePending();
+    size_t slotFloats = static_cast<size_t>(geometryCache.getSlotVertexCount()) * 3;
+    packet->geometryPositions.resize(packet->geometrySlots.size() * slotFloats);
+    for (size_t i = 0; i < packet->geometrySlots.size(); i++)
+    {
+        const float* source = geometryCache.getPositions() + geometryCache.slotFirstVertex(packet->geometrySlots[i]) * 3;
+        std::memcpy(&packet->geometryPositions[i * slotFloats], source, slotFloats * sizeof(float));
+    }
+    
+    packet->buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return packet;
+}
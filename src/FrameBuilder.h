@@ -0,0 +1,66 @@
+#pragma once
+#include "CoveringTiles.h"
+#include "GlobeProjection.h"
+#include "ProjectionState.h"
+#include "TileCuller.h"
+#include "TileGeometryCache.h"
+#include "TileID.h"
+#include "TileInstanceBuffer.h"
+#include "TileMesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * 一帧的 CPU 端准备结果（不依赖 GL），发布后不再修改
+ *
+ * GL 线程只需按包中的数据上传和绘制：tile 列表、实例数据、投影矩阵与 uniform，
+ * 以及本帧新计算的球面坐标（从几何缓存复制出来，之后构建下一帧时缓存可以继续淘汰）。
+ */
+struct FramePacket
+{
+    uint64_t frameIndex = 0;
+    GlobeProjection projection;     // 构建时的相机快照（栅格请求与预取使用）
+    float aspect = 1.0f;
+    std::shared_ptr<const ProjectionState> state;
+    std::vector<TileID> tiles;
+    TileInstanceBuffer instances;
+    TileCuller::Stats cullStats;
+    
+    // 本帧新计算的几何 slot，坐标按 geometrySlots 的顺序连续存放（每个 slot getSlotVertexCount() * 3 个 float）
+    std::vector<int> geometrySlots;
+    std::vector<float> geometryPositions;
+    
+    double buildMilliseconds = 0.0;
+};
+
+/**
+ * 帧构建器（不依赖 GL）：相机快照 -> FramePacket
+ *
+ * 持有覆盖选择、剔除和几何缓存的状态，同一时刻只能有一个 build 在执行；
+ * 可以在工作线程上运行，与 GL 线程提交上一帧重叠。
+ */
+class FrameBuilder
+{
+public:
+    explicit FrameBuilder(const TileMesh& mesh);
+    
+    /**
+     * 选出覆盖的 tile、打包实例数据并计算新的球面坐标
+     */
+    std::shared_ptr<const FramePacket> build(const GlobeProjection& projection, float aspect);
+    
+    /**
+     * 修改选择参数前必须确认没有正在执行的 build
+     */
+    CoveringTiles& getCoveringTiles() { return coveringTiles; }
+    const CoveringTiles& getCoveringTiles() const { return coveringTiles; }
+    const TileGeometryCache& getGeometryCache() const { return geometryCache; }
+    
+private:
+    CoveringTiles coveringTiles;
+    TileCuller culler;
+    TileGeometryCache geometryCache;
+    uint64_t frameIndex;
+};
@@ -0,0 +1,56 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+
+namespace
+{
+// 连续绘制时的帧槽长度，用于估算空闲比例
+constexpr double kFrameSlot = 1.0 / 60.0;
+} // namespace
+
+FrameStats::FrameStats(double now)
+    : periodStart(now), lastFrame(-1.0), periodCpuStart(std::clock()), frames(0)
+{
+}
+
+void FrameStats::frameRendered(double now)
+{
+    if (lastFrame >= 0.0)
+    {
+        intervals.push_back(now - lastFrame);
+    }
+    lastFrame = now;
+    frames++;
+}
+
+FrameStats::Summary FrameStats::summarize(double now)
+{
+    Summary summary;
+    summary.frames = frames;
+    summary.seconds = now - periodStart;
+    if (summary.seconds > 0.0)
+    {
+        summary.framesPerSecond = frames / summary.seconds;
+        std::clock_t cpu = std::clock();
+        summary.cpuPercent = 100.0 * static_cast<double>(cpu - periodCpuStart) / CLOCKS_PER_SEC / summary.seconds;
+        summary.idleFraction = std::max(0.0, 1.0 - frames * kFrameSlot / summary.seconds);
+    }
+    if (!intervals.empty())
+    {
+        double sum = 0.0;
+        for (double interval : intervals)
+        {
+            sum += interval;
+        }
+        summary.averageInterval = sum / intervals.size();
+        std::sort(intervals.begin(), intervals.end());
+        summary.p95Interval = intervals[std::min(intervals.size() - 1, intervals.size() * 95 / 100)];
+        summary.maxInterval = intervals.back();
+    }
+    
+    periodStart = now;
+    periodCpuStart = std::clock();
+    intervals.clear();
+    frames = 0;
+    return summary;
+}
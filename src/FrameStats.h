@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <ctime>
+#include <vector>
+
+/**
+ * 按需渲染的帧统计（不依赖 GL）
+ *
+ * 记录每次实际绘制的时间，按报告周期汇总：帧数、帧间隔分布，
+ * 以及进程 CPU 时间占墙钟时间的比例（所有线程合计，100% 为一个核心）。
+ * 空闲时不绘制，idleFraction 为报告周期内没有绘制的时间比例（按 60Hz 帧槽估算）。
+ */
+class FrameStats
+{
+public:
+    struct Summary
+    {
+        size_t frames = 0;
+        double seconds = 0.0;
+        double framesPerSecond = 0.0;
+        double averageInterval = 0.0;   // 秒，连续绘制之间
+        double p95Interval = 0.0;
+        double maxInterval = 0.0;
+        double cpuPercent = 0.0;
+        double idleFraction = 0.0;
+    };
+    
+    explicit FrameStats(double now = 0.0);
+    
+    void frameRendered(double now);
+    
+    /**
+     * 汇总自上次 summarize 以来的统计并开始新的周期
+     */
+    Summary summarize(double now);
+    
+    double getPeriodStart() const { return periodStart; }
+    
+private:
+    double periodStart;
+    double lastFrame;
+    std::clock_t periodCpuStart;
+    std::vector<double> intervals;
+    size_t frames;
+};
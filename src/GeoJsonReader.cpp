@@ -0,0 +1,492 @@
+#include "GeoJsonReader.h"
+
+#include <charconv>
+
+GeoJsonReader::GeoJsonReader(std::istream& input)
+    : input(input), buffer(kChunkSize)
+{
+}
+
+bool GeoJsonReader::read(const Callback& callback, std::string* error)
+{
+    this->callback = &callback;
+    errorMessage.clear();
+    skipWhitespace();
+    bool ok = false;
+    if (peek() == '{')
+    {
+        ok = parseObject(0);
+        skipWhitespace();
+        if (ok && peek() != -1)
+        {
+            ok = fail("trailing characters after the root object");
+        }
+    }
+    else
+    {
+        fail("root is not a JSON object");
+    }
+    this->callback = nullptr;
+    if (!ok && error)
+    {
+        *error = errorMessage + " (near byte " + std::to_string(bytesRead - (size - position)) + ")";
+    }
+    return ok;
+}
+
+bool GeoJsonReader::refill()
+{
+    if (!input)
+    {
+        return false;
+    }
+    input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    size = static_cast<size_t>(input.gcount());
+    position = 0;
+    bytesRead += size;
+    return size > 0;
+}
+
+int GeoJsonReader::peek()
+{
+    if (position == size && !refill())
+    {
+        return -1;
+    }
+    return static_cast<unsigned char>(buffer[position]);
+}
+
+int GeoJsonReader::get()
+{
+    int c = peek();
+    if (c != -1)
+    {
+        position++;
+    }
+    return c;
+}
+
+void GeoJsonReader::skipWhitespace()
+{
+    for (;;)
+    {
+        int c = peek();
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+        {
+            return;
+        }
+        position++;
+    }
+}
+
+bool GeoJsonReader::expect(char c)
+{
+    skipWhitespace();
+    if (get() != c)
+    {
+        return fail((std::string("expected '") + c + "'").c_str());
+    }
+    return true;
+}
+
+bool GeoJsonReader::fail(const char* message)
+{
+    if (errorMessage.empty())
+    {
+        errorMessage = message;
+    }
+    return false;
+}
+
+bool GeoJsonReader::parseString(std::string& out)
+{
+    // 只需要比较键和类型名：简单转义还原，\uXXXX 用 '?' 代替
+    out.clear();
+    if (!expect('"'))
+    {
+        return false;
+    }
+    for (;;)
+    {
+        int c = get();
+        if (c == -1)
+        {
+            return fail("unterminated string");
+        }
+        if (c == '"')
+        {
+            return true;
+        }
+        if (c != '\\')
+        {
+            out.push_back(static_cast<char>(c));
+            continue;
+        }
+        c = get();
+        switch (c)
+        {
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u':
+            for (int i = 0; i < 4; i++)
+            {
+                if (get() == -1)
+                {
+                    return fail("unterminated string");
+                }
+            }
+            out.push_back('?');
+            break;
+        case -1:
+            return fail("unterminated string");
+        default:
+            out.push_back(static_cast<char>(c));
+            break;
+        }
+    }
+}
+
+bool GeoJsonReader::parseNumber(double& out)
+{
+    skipWhitespace();
+    char text[64];
+    size_t length = 0;
+    for (;;)
+    {
+        int c = peek();
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'))
+        {
+            break;
+        }
+        if (length == sizeof(text))
+        {
+            return fail("number too long");
+        }
+        text[length++] = static_cast<char>(c);
+        position++;
+    }
+    std::from_chars_result result = std::from_chars(text, text + length, out);
+    if (length == 0 || result.ec != std::errc() || result.ptr != text + length)
+    {
+        return fail("invalid number");
+    }
+    return true;
+}
+
+bool GeoJsonReader::skipValue()
+{
+    // 不递归：只数括号层数，字符串整体跳过（其中的括号不算）
+    int depth = 0;
+    do
+    {
+        skipWhitespace();
+        int c = peek();
+        if (c == '"')
+        {
+            if (!parseString(key))
+            {
+                return false;
+            }
+        }
+        else if (c == '{' || c == '[')
+        {
+            position++;
+            depth++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (depth == 0)
+            {
+                return fail("unexpected closing bracket");
+            }
+            position++;
+            depth--;
+        }
+        else if (c == ',' || c == ':')
+        {
+            position++;
+        }
+        else if (c == -1)
+        {
+            return fail("unexpected end of input");
+        }
+        else
+        {
+            // 数字、true / false / null
+            do
+            {
+                position++;
+                c = peek();
+            }
+            while (c != -1 && c != ',' && c != '}' && c != ']' && c != ' ' && c != '\n' && c != '\r' && c != '\t');
+        }
+    }
+    while (depth > 0);
+    return true;
+}
+
+bool GeoJsonReader::parseObject(int depth)
+{
+    if (depth > kMaxDepth)
+    {
+        return fail("nesting too deep");
+    }
+    if (!expect('{'))
+    {
+        return false;
+    }
+    skipWhitespace();
+    if (peek() == '}')
+    {
+        position++;
+        return true;
+    }
+    
+    std::string type;
+    bool hasCoordinates = false;
+    for (;;)
+    {
+        if (!parseString(key) || !expect(':'))
+        {
+            return false;
+        }
+        bool ok = true;
+        skipWhitespace();
+        if (key == "type")
+        {
+            ok = parseString(type);
+        }
+        else if (key == "coordinates")
+        {
+            ok = parseCoordinates();
+            hasCoordinates = ok;
+        }
+        else if ((key == "features" || key == "geometries") && peek() == '[')
+        {
+            ok = parseObjectArray(depth + 1);
+        }
+        else if (key == "geometry" && peek() == '{')
+        {
+            ok = parseObject(depth + 1);
+        }
+        else
+        {
+            ok = skipValue();
+        }
+        if (!ok)
+        {
+            return false;
+        }
+        
+        skipWhitespace();
+        int c = get();
+        if (c == '}')
+        {
+            break;
+        }
+        if (c != ',')
+        {
+            return fail("expected ',' or '}' in object");
+        }
+    }
+    if (hasCoordinates)
+    {
+        emitGeometry(type);
+    }
+    return true;
+}
+
+bool GeoJsonReader::parseObjectArray(int depth)
+{
+    if (!expect('['))
+    {
+        return false;
+    }
+    skipWhitespace();
+    if (peek() == ']')
+    {
+        position++;
+        return true;
+    }
+    for (;;)
+    {
+        skipWhitespace();
+        bool ok = peek() == '{' ? parseObject(depth) : skipValue();
+        if (!ok)
+        {
+            return false;
+        }
+        skipWhitespace();
+        int c = get();
+        if (c == ']')
+        {
+            return true;
+        }
+        if (c != ',')
+        {
+            return fail("expected ',' or ']' in array");
+        }
+    }
+}
+
+bool GeoJsonReader::parseCoordinates()
+{
+    coordinates.clear();
+    lineEnds.clear();
+    polygonEnds.clear();
+    coordinateDepth = parseCoordinateArray(1);
+    return coordinateDepth > 0;
+}
+
+int GeoJsonReader::parseCoordinateArray(int depth)
+{
+    // 返回这一层数组的深度（1 = 单个坐标），出错返回 0
+    if (depth > 4)
+    {
+        fail("coordinates nested too deep");
+        return 0;
+    }
+    if (!expect('['))
+    {
+        return 0;
+    }
+    skipWhitespace();
+    int c = peek();
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        // 坐标：至少两个数，多出的维度丢弃
+        glm::dvec2 point;
+        double extra;
+        if (!parseNumber(point.x) || !expect(',') || !parseNumber(point.y))
+        {
+            return 0;
+        }
+        skipWhitespace();
+        while (peek() == ',')
+        {
+            position++;
+            if (!parseNumber(extra))
+            {
+                return 0;
+            }
+            skipWhitespace();
+        }
+        if (!expect(']'))
+        {
+            return 0;
+        }
+        coordinates.push_back(point);
+        return 1;
+    }
+    
+    // 数组的数组；空数组当作没有坐标的线
+    int childDepth = 1;
+    if (c == ']')
+    {
+        position++;
+    }
+    else
+    {
+        childDepth = 0;
+        for (;;)
+        {
+            int depthOfChild = parseCoordinateArray(depth + 1);
+            if (depthOfChild == 0)
+            {
+                return 0;
+            }
+            if (childDepth != 0 && depthOfChild != childDepth)
+            {
+                fail("mixed coordinate nesting");
+                return 0;
+            }
+            childDepth = depthOfChild;
+            skipWhitespace();
+            c = get();
+            if (c == ']')
+            {
+                break;
+            }
+            if (c != ',')
+            {
+                fail("expected ',' or ']' in coordinates");
+                return 0;
+            }
+        }
+    }
+    if (childDepth == 1)
+    {
+        lineEnds.push_back(static_cast<uint32_t>(coordinates.size()));
+    }
+    else if (childDepth == 2)
+    {
+        polygonEnds.push_back(static_cast<uint32_t>(lineEnds.size()));
+    }
+    return childDepth + 1;
+}
+
+void GeoJsonReader::emitGeometry(const std::string& type)
+{
+    using GeometryType = VectorTile::GeometryType;
+    geometry.points.clear();
+    geometry.parts.clear();
+    geometry.type = GeometryType::Unknown;
+    
+    auto addPart = [this](uint32_t end, bool outer)
+    {
+        GeoJsonGeometry::Part part;
+        part.end = end;
+        part.outer = outer;
+        geometry.parts.push_back(part);
+    };
+    
+    if ((type == "Point" && coordinateDepth == 1) || (type == "MultiPoint" && coordinateDepth == 2))
+    {
+        geometry.type = GeometryType::Point;
+        for (uint32_t i = 0; i < coordinates.size(); i++)
+        {
+            addPart(i + 1, false);
+        }
+    }
+    else if ((type == "LineString" && coordinateDepth == 2) || (type == "MultiLineString" && coordinateDepth == 3))
+    {
+        geometry.type = GeometryType::LineString;
+        for (uint32_t end : lineEnds)
+        {
+            addPart(end, false);
+        }
+    }
+    else if (type == "Polygon" && coordinateDepth == 3)
+    {
+        geometry.type = GeometryType::Polygon;
+        for (size_t ring = 0; ring < lineEnds.size(); ring++)
+        {
+            addPart(lineEnds[ring], ring == 0);
+        }
+    }
+    else if (type == "MultiPolygon" && coordinateDepth == 4)
+    {
+        geometry.type = GeometryType::Polygon;
+        uint32_t firstRing = 0;
+        for (uint32_t polygonEnd : polygonEnds)
+        {
+            for (uint32_t ring = firstRing; ring < polygonEnd; ring++)
+            {
+                addPart(lineEnds[ring], ring == firstRing);
+            }
+            firstRing = polygonEnd;
+        }
+    }
+    else
+    {
+        invalidCount++;
+        return;
+    }
+    geometry.points.swap(coordinates);
+    geometryCount++;
+    (*callback)(geometry);
+    geometry.points.swap(coordinates);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "VectorTile.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * 一个 GeoJSON 几何（经纬度，单位为度）
+ *
+ * Multi* 展开为多个部分：点的每个点、线的每条线、多边形的每个环各是一部分，
+ * 每个多边形的第一个环标记为外环。
+ */
+struct GeoJsonGeometry
+{
+    struct Part
+    {
+        uint32_t end = 0;           // points 中的结束位置
+        bool outer = false;
+    };
+    
+    VectorTile::GeometryType type = VectorTile::GeometryType::Unknown;
+    std::vector<glm::dvec2> points;     // (经度, 纬度)
+    std::vector<Part> parts;
+};
+
+/**
+ * 流式 GeoJSON 读取器：按 kChunkSize 分块读取输入，内存中只保留当前几何的坐标
+ *
+ * - 根可以是 FeatureCollection、Feature 或几何对象；GeometryCollection 展开为其中的各个几何
+ * - 对象的键可以是任意顺序（coordinates 出现在 type 之前时坐标先按嵌套深度记录，对象结束时再解释）
+ * - properties、id、bbox 等其他字段整体跳过；坐标的第三维（高程）忽略
+ * - 类型与坐标嵌套深度不符的几何跳过并计数
+ */
+class GeoJsonReader
+{
+public:
+    static constexpr size_t kChunkSize = 1 << 20;
+    
+    using Callback = std::function<void(const GeoJsonGeometry&)>;
+    
+    explicit GeoJsonReader(std::istream& input);
+    
+    /**
+     * 读完整个输入，每个几何调用一次 callback（参数在回调返回后被复用）。
+     * 语法错误时返回 false 并写入 error，之前的几何已经回调过
+     */
+    bool read(const Callback& callback, std::string* error = nullptr);
+    
+    uint64_t getBytesRead() const { return bytesRead; }
+    uint64_t getGeometryCount() const { return geometryCount; }
+    uint64_t getInvalidCount() const { return invalidCount; }
+    
+private:
+    static constexpr int kMaxDepth = 64;
+    
+    int peek();
+    int get();
+    bool refill();
+    void skipWhitespace();
+    bool expect(char c);
+    bool parseString(std::string& out);
+    bool parseNumber(double& out);
+    bool skipValue();
+    bool parseObject(int depth);
+    bool parseObjectArray(int depth);
+    bool parseCoordinates();
+    int parseCoordinateArray(int depth);
+    void emitGeometry(const std::string& type);
+    bool fail(const char* message);
+    
+    std::istream& input;
+    std::vector<char> buffer;
+    size_t position = 0;
+    size_t size = 0;
+    uint64_t bytesRead = 0;     // 已从输入读入缓冲区的字节
+    std::string errorMessage;
+    const Callback* callback = nullptr;
+    
+    // 最近一次 coordinates 的原始结构：所有坐标、每个坐标数组（线 / 环）的结束位置、每组环（多边形）的结束位置
+    std::vector<glm::dvec2> coordinates;
+    std::vector<uint32_t> lineEnds;
+    std::vector<uint32_t> polygonEnds;
+    int coordinateDepth = 0;    // 1 = 单个坐标，2 = 坐标数组，3 = 环数组，4 = 多边形数组
+    
+    GeoJsonGeometry geometry;
+    std::string key;
+    uint64_t geometryCount = 0;
+    uint64_t invalidCount = 0;
+};
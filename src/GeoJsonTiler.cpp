@@ -0,0 +1,837 @@
+#include "GeoJsonTiler.h"
+
+#include "Constants.h"
+#include "PbfWriter.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+using GeometryType = VectorTile::GeometryType;
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMaxLatitude = 85.051128779806604;   // 墨卡托 y 在 [0, 1] 内的纬度范围
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * 点到线段 ab 的平方距离
+ */
+double squareSegmentDistance(double px, double py, double ax, double ay, double bx, double by)
+{
+    double dx = bx - ax;
+    double dy = by - ay;
+    if (dx != 0.0 || dy != 0.0)
+    {
+        double t = ((px - ax) * dx + (py - ay) * dy) / (dx * dx + dy * dy);
+        if (t > 1.0)
+        {
+            ax = bx;
+            ay = by;
+        }
+        else if (t > 0.0)
+        {
+            ax += dx * t;
+            ay += dy * t;
+        }
+    }
+    dx = px - ax;
+    dy = py - ay;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * MVT 规范的环面积（tile 坐标 y 向下），外环为正
+ */
+double ringArea(const glm::ivec2* points, size_t count)
+{
+    double sum = 0.0;
+    for (size_t i = 0, j = count - 1; i < count; j = i++)
+    {
+        sum += static_cast<double>(points[j].x) * points[i].y - static_cast<double>(points[i].x) * points[j].y;
+    }
+    return sum * 0.5;
+}
+
+uint32_t command(uint32_t id, uint32_t count)
+{
+    return id | (count << 3);
+}
+} // namespace
+
+GeoJsonTiler::GeoJsonTiler()
+    : GeoJsonTiler(Options())
+{
+}
+
+GeoJsonTiler::GeoJsonTiler(const Options& options)
+    : options(options)
+{
+    this->options.maxZoom = std::clamp(this->options.maxZoom, 0, 24);
+    this->options.indexMaxZoom = std::clamp(this->options.indexMaxZoom, 0, this->options.maxZoom);
+}
+
+bool GeoJsonTiler::load(const std::string& path, std::string* error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        if (error)
+        {
+            *error = "cannot open " + path;
+        }
+        return false;
+    }
+    return load(file, error);
+}
+
+bool GeoJsonTiler::load(std::istream& input, std::string* error)
+{
+    PROFILE_ZONE("GeoJsonTiler::load");
+    root.reset();
+    indexLeaves.clear();
+    indexSplit.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.clear();
+        lruOrder.clear();
+        stats = Stats();
+    }
+    
+    // 读取、投影、计算简化重要性
+    auto start = std::chrono::steady_clock::now();
+    std::vector<FeaturePtr> features;
+    uint64_t invalid = 0;
+    GeoJsonReader reader(input);
+    bool ok = reader.read([&](const GeoJsonGeometry& geometry)
+    {
+        if (!addGeometry(geometry, features))
+        {
+            invalid++;
+        }
+    }, error);
+    simplifyStack = std::vector<std::pair<size_t, size_t>>();
+    if (!ok)
+    {
+        return false;
+    }
+    
+    // 世界副本：左右两侧缓冲区内的要素平移一个世界宽度
+    const double buffer = options.buffer / Constants::TILE_EXTENT;
+    auto rootSlice = std::make_shared<Slice>();
+    size_t newBytes = 0;
+    std::vector<FeaturePtr> side;
+    std::vector<FeaturePtr> shifted;
+    clip(features, glm::dvec2(-1.0 - buffer, -1.0), glm::dvec2(buffer, 2.0), side, newBytes);
+    shift(side, 1.0, shifted);
+    side.clear();
+    clip(features, glm::dvec2(1.0 - buffer, -1.0), glm::dvec2(2.0 + buffer, 2.0), side, newBytes);
+    shift(side, -1.0, shifted);
+    clip(features, glm::dvec2(-buffer, -1.0), glm::dvec2(1.0 + buffer, 2.0), rootSlice->features, newBytes);
+    rootSlice->features.insert(rootSlice->features.end(), shifted.begin(), shifted.end());
+    features = std::vector<FeaturePtr>();
+    for (const FeaturePtr& feature : rootSlice->features)
+    {
+        rootSlice->points += feature->points.size();
+    }
+    const uint64_t featureCount = reader.getGeometryCount() - invalid;
+    const uint64_t pointCount = rootSlice->points;
+    root = rootSlice;
+    const double parseSeconds = secondsSince(start);
+    
+    // 初始索引：点数多的瓦片切到 indexMaxZoom，只保留根和叶子
+    start = std::chrono::steady_clock::now();
+    std::vector<SlicePtr> stack = { root };
+    while (!stack.empty())
+    {
+        SlicePtr slice = std::move(stack.back());
+        stack.pop_back();
+        const TileID& tile = slice->tile;
+        if (tile.z >= options.indexMaxZoom || slice->points <= options.indexMaxPoints)
+        {
+            indexLeaves[tile.key()] = slice;
+            continue;
+        }
+        indexSplit.insert(tile.key());
+        for (int child = 0; child < 4; child++)
+        {
+            TileID childTile;
+            childTile.x = tile.x * 2 + (child & 1);
+            childTile.y = tile.y * 2 + (child >> 1);
+            childTile.z = tile.z + 1;
+            SlicePtr childSlice = clipSlice(*slice, childTile);
+            if (!childSlice->features.empty())
+            {
+                stack.push_back(std::move(childSlice));
+            }
+        }
+    }
+    
+    // 保留的要素按指针去重后计算内存
+    size_t indexBytes = 0;
+    std::unordered_set<const Feature*> counted;
+    auto countSlice = [&](const Slice& slice)
+    {
+        indexBytes += sizeof(Slice) + slice.features.capacity() * sizeof(FeaturePtr);
+        for (const FeaturePtr& feature : slice.features)
+        {
+            if (counted.insert(feature.get()).second)
+            {
+                indexBytes += feature->sizeInBytes();
+            }
+        }
+    };
+    countSlice(*root);
+    for (const auto& entry : indexLeaves)
+    {
+        if (entry.second != root)
+        {
+            countSlice(*entry.second);
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.bytesRead = reader.getBytesRead();
+    stats.features = featureCount;
+    stats.invalidGeometries = reader.getInvalidCount() + invalid;
+    stats.points = pointCount;
+    stats.indexTiles = indexLeaves.size() + (indexLeaves.count(root->tile.key()) ? 0 : 1);
+    stats.indexBytes = indexBytes;
+    stats.parseSeconds = parseSeconds;
+    stats.indexSeconds = secondsSince(start);
+    return true;
+}
+
+bool GeoJsonTiler::addGeometry(const GeoJsonGeometry& geometry, std::vector<FeaturePtr>& out)
+{
+    // 最高层级的容差以下的点在任何层级都不会保留，重要性为 0
+    const double sqTolerance = std::pow(options.tolerance / (Constants::TILE_EXTENT * std::exp2(options.maxZoom)), 2.0);
+    const bool polygon = geometry.type == GeometryType::Polygon;
+    Feature feature;
+    feature.type = geometry.type;
+    uint32_t begin = 0;
+    bool outerKept = false;
+    for (const GeoJsonGeometry::Part& part : geometry.parts)
+    {
+        const size_t first = feature.points.size();
+        for (uint32_t i = begin; i < part.end; i++)
+        {
+            const glm::dvec2& lonLat = geometry.points[i];
+            const double lat = std::clamp(lonLat.y, -kMaxLatitude, kMaxLatitude) * kPi / 180.0;
+            Point point;
+            point.x = lonLat.x / 360.0 + 0.5;
+            point.y = 0.5 - std::log(std::tan(kPi / 4.0 + lat / 2.0)) / (2.0 * kPi);
+            point.importance = geometry.type == GeometryType::Point ? 1.0 : 0.0;
+            feature.points.push_back(point);
+        }
+        begin = part.end;
+        
+        if (geometry.type != GeometryType::Point)
+        {
+            // GeoJSON 的环首尾相同；没有闭合的补上首点
+            if (polygon && feature.points.size() > first
+                && (feature.points.back().x != feature.points[first].x || feature.points.back().y != feature.points[first].y))
+            {
+                feature.points.push_back(feature.points[first]);
+            }
+            const size_t count = feature.points.size() - first;
+            // 外环被丢弃时它的洞也丢弃，否则会被当作前一个多边形的洞
+            bool keep = count >= (polygon ? 4u : 2u) && (!polygon || part.outer || outerKept);
+            if (polygon && part.outer)
+            {
+                outerKept = keep;
+            }
+            if (!keep)
+            {
+                feature.points.resize(first);
+                continue;
+            }
+            feature.points[first].importance = 1.0;
+            feature.points.back().importance = 1.0;
+            simplify(feature.points, first, feature.points.size() - 1, sqTolerance, simplifyStack);
+        }
+        Part outPart;
+        outPart.end = static_cast<uint32_t>(feature.points.size());
+        outPart.outer = part.outer;
+        feature.parts.push_back(outPart);
+    }
+    if (feature.parts.empty())
+    {
+        return false;
+    }
+    feature.points.shrink_to_fit();
+    computeBounds(feature);
+    out.push_back(std::make_shared<const Feature>(std::move(feature)));
+    return true;
+}
+
+void GeoJsonTiler::simplify(std::vector<Point>& points, size_t first, size_t last, double sqTolerance,
+                            std::vector<std::pair<size_t, size_t>>& stack)
+{
+    // 迭代的 Douglas-Peucker：离弦最远的点的重要性为该距离的平方；距离相同时取靠近中间的点，
+    // 使规则形状（如圆）的简化结果对称
+    stack.clear();
+    stack.emplace_back(first, last);
+    while (!stack.empty())
+    {
+        const size_t from = stack.back().first;
+        const size_t to = stack.back().second;
+        stack.pop_back();
+        const Point& a = points[from];
+        const Point& b = points[to];
+        double maxDistance = sqTolerance;
+        size_t index = 0;
+        const size_t middle = from + (to - from) / 2;
+        size_t minPositionToMiddle = to - from;
+        for (size_t i = from + 1; i < to; i++)
+        {
+            double distance = squareSegmentDistance(points[i].x, points[i].y, a.x, a.y, b.x, b.y);
+            if (distance > maxDistance)
+            {
+                index = i;
+                maxDistance = distance;
+            }
+            else if (distance == maxDistance)
+            {
+                size_t positionToMiddle = i > middle ? i - middle : middle - i;
+                if (positionToMiddle < minPositionToMiddle)
+                {
+                    index = i;
+                    minPositionToMiddle = positionToMiddle;
+                }
+            }
+        }
+        if (maxDistance > sqTolerance)
+        {
+            points[index].importance = maxDistance;
+            if (index - from > 1)
+            {
+                stack.emplace_back(from, index);
+            }
+            if (to - index > 1)
+            {
+                stack.emplace_back(index, to);
+            }
+        }
+    }
+}
+
+void GeoJsonTiler::computeBounds(Feature& feature)
+{
+    feature.min = glm::dvec2(std::numeric_limits<double>::max());
+    feature.max = glm::dvec2(std::numeric_limits<double>::lowest());
+    for (const Point& point : feature.points)
+    {
+        feature.min = glm::min(feature.min, glm::dvec2(point.x, point.y));
+        feature.max = glm::max(feature.max, glm::dvec2(point.x, point.y));
+    }
+}
+
+void GeoJsonTiler::clip(const std::vector<FeaturePtr>& input, const glm::dvec2& min, const glm::dvec2& max,
+                        std::vector<FeaturePtr>& out, size_t& newBytes)
+{
+    // 完全在范围内的要素直接共享，与范围相交的先按 x 再按 y 裁剪出新要素
+    Feature column;
+    for (const FeaturePtr& feature : input)
+    {
+        if (feature->min.x >= min.x && feature->max.x <= max.x && feature->min.y >= min.y && feature->max.y <= max.y)
+        {
+            out.push_back(feature);
+            continue;
+        }
+        if (feature->max.x < min.x || feature->min.x > max.x || feature->max.y < min.y || feature->min.y > max.y)
+        {
+            continue;
+        }
+        const Feature* current = feature.get();
+        if (current->min.x < min.x || current->max.x > max.x)
+        {
+            clipFeature(*current, min.x, max.x, 0, column);
+            if (column.parts.empty())
+            {
+                continue;
+            }
+            current = &column;
+        }
+        auto clipped = std::make_shared<Feature>();
+        if (current->min.y < min.y || current->max.y > max.y)
+        {
+            clipFeature(*current, min.y, max.y, 1, *clipped);
+            if (clipped->parts.empty())
+            {
+                continue;
+            }
+        }
+        else
+        {
+            *clipped = *current;
+        }
+        clipped->points.shrink_to_fit();
+        clipped->parts.shrink_to_fit();
+        newBytes += clipped->sizeInBytes();
+        out.push_back(std::move(clipped));
+    }
+}
+
+void GeoJsonTiler::clipFeature(const Feature& input, double k1, double k2, int axis, Feature& out)
+{
+    out.type = input.type;
+    out.points.clear();
+    out.parts.clear();
+    uint32_t begin = 0;
+    for (const Part& part : input.parts)
+    {
+        const Point* points = input.points.data() + begin;
+        const size_t count = part.end - begin;
+        begin = part.end;
+        if (input.type == GeometryType::Point)
+        {
+            const double value = axis == 0 ? points[0].x : points[0].y;
+            if (value >= k1 && value <= k2)
+            {
+                out.points.push_back(points[0]);
+                out.parts.push_back({ static_cast<uint32_t>(out.points.size()), false });
+            }
+        }
+        else
+        {
+            clipPart(points, count, k1, k2, axis, input.type == GeometryType::Polygon, part.outer, out);
+        }
+    }
+    computeBounds(out);
+}
+
+void GeoJsonTiler::clipPart(const Point* points, size_t count, double k1, double k2, int axis, bool polygon, bool outer, Feature& out)
+{
+    // geojson-vt 的 clipLine：线在离开范围处断成多段；环始终是一个环，范围外的部分沿边界线连接
+    auto coordinate = [axis](const Point& point) { return axis == 0 ? point.x : point.y; };
+    auto intersect = [&](const Point& a, const Point& b, double k)
+    {
+        const double t = (k - coordinate(a)) / (coordinate(b) - coordinate(a));
+        Point point;
+        point.x = axis == 0 ? k : a.x + (b.x - a.x) * t;
+        point.y = axis == 1 ? k : a.y + (b.y - a.y) * t;
+        point.importance = 1.0;
+        out.points.push_back(point);
+    };
+    size_t start = out.points.size();
+    auto finish = [&]()
+    {
+        if (polygon && out.points.size() > start)
+        {
+            const Point& first = out.points[start];
+            const Point& last = out.points.back();
+            if (first.x != last.x || first.y != last.y)
+            {
+                out.points.push_back(first);
+            }
+        }
+        if (out.points.size() - start < (polygon ? 4u : 2u))
+        {
+            out.points.resize(start);
+        }
+        else
+        {
+            out.parts.push_back({ static_cast<uint32_t>(out.points.size()), outer });
+        }
+        start = out.points.size();
+    };
+    
+    for (size_t i = 0; i + 1 < count; i++)
+    {
+        const Point& a = points[i];
+        const Point& b = points[i + 1];
+        const double ak = coordinate(a);
+        const double bk = coordinate(b);
+        bool exited = false;
+        if (ak < k1)
+        {
+            if (bk > k1)
+            {
+                intersect(a, b, k1);    // ---|-->  |
+            }
+        }
+        else if (ak > k2)
+        {
+            if (bk < k2)
+            {
+                intersect(a, b, k2);    // |  <--|---
+            }
+        }
+        else
+        {
+            out.points.push_back(a);
+        }
+        if (bk < k1 && ak >= k1)
+        {
+            intersect(a, b, k1);        // <--|---  |
+            exited = true;
+        }
+        if (bk > k2 && ak <= k2)
+        {
+            intersect(a, b, k2);        // |  ---|-->
+            exited = true;
+        }
+        if (!polygon && exited)
+        {
+            finish();
+        }
+    }
+    if (count > 0)
+    {
+        const double last = coordinate(points[count - 1]);
+        if (last >= k1 && last <= k2)
+        {
+            out.points.push_back(points[count - 1]);
+        }
+    }
+    finish();
+}
+
+void GeoJsonTiler::shift(const std::vector<FeaturePtr>& input, double offset, std::vector<FeaturePtr>& out)
+{
+    for (const FeaturePtr& feature : input)
+    {
+        auto shifted = std::make_shared<Feature>(*feature);
+        for (Point& point : shifted->points)
+        {
+            point.x += offset;
+        }
+        shifted->min.x += offset;
+        shifted->max.x += offset;
+        out.push_back(std::move(shifted));
+    }
+}
+
+GeoJsonTiler::SlicePtr GeoJsonTiler::clipSlice(const Slice& parent, const TileID& child) const
+{
+    const double scale = std::exp2(child.z);
+    const double buffer = options.buffer / Constants::TILE_EXTENT;
+    auto slice = std::make_shared<Slice>();
+    slice->tile = child;
+    clip(parent.features, glm::dvec2(child.x - buffer, child.y - buffer) / scale,
+         glm::dvec2(child.x + 1 + buffer, child.y + 1 + buffer) / scale, slice->features, slice->bytes);
+    slice->features.shrink_to_fit();
+    slice->bytes += sizeof(Slice) + slice->features.capacity() * sizeof(FeaturePtr);
+    for (const FeaturePtr& feature : slice->features)
+    {
+        slice->points += feature->points.size();
+    }
+    return slice;
+}
+
+std::shared_ptr<GeoJsonTile> GeoJsonTiler::transform(const Slice& slice) const
+{
+    // 按本层级的容差过滤点，转换到整数 tile 坐标，去掉重合的相邻点和小于容差的环
+    const double scale = std::exp2(slice.tile.z);
+    const double sqTolerance = std::pow(options.tolerance / (Constants::TILE_EXTENT * scale), 2.0);
+    const double minArea = options.tolerance * options.tolerance;
+    auto tile = std::make_shared<GeoJsonTile>();
+    tile->tile = slice.tile;
+    auto toTile = [&](const Point& point)
+    {
+        return glm::ivec2(static_cast<int>(std::lround((point.x * scale - slice.tile.x) * Constants::TILE_EXTENT)),
+                          static_cast<int>(std::lround((point.y * scale - slice.tile.y) * Constants::TILE_EXTENT)));
+    };
+    
+    GeoJsonTile::Feature out;
+    for (const FeaturePtr& feature : slice.features)
+    {
+        out.type = feature->type;
+        out.points.clear();
+        out.partEnds.clear();
+        const bool polygon = feature->type == GeometryType::Polygon;
+        bool outerKept = false;
+        uint32_t begin = 0;
+        for (const Part& part : feature->parts)
+        {
+            const size_t start = out.points.size();
+            for (uint32_t i = begin; i < part.end; i++)
+            {
+                const Point& point = feature->points[i];
+                if (feature->type != GeometryType::Point && point.importance <= sqTolerance)
+                {
+                    continue;
+                }
+                glm::ivec2 position = toTile(point);
+                if (feature->type == GeometryType::Point || out.points.size() == start || out.points.back() != position)
+                {
+                    out.points.push_back(position);
+                }
+            }
+            begin = part.end;
+            
+            size_t count = out.points.size() - start;
+            bool keep = count >= 2;
+            if (polygon)
+            {
+                if (count > 1 && out.points.back() == out.points[start])
+                {
+                    out.points.pop_back();
+                    count--;
+                }
+                const double area = count >= 3 ? ringArea(out.points.data() + start, count) : 0.0;
+                keep = std::abs(area) >= minArea && (part.outer || outerKept);
+                if (part.outer)
+                {
+                    outerKept = keep;
+                }
+                if (keep && (area > 0.0) != part.outer)
+                {
+                    std::reverse(out.points.begin() + start, out.points.end());
+                }
+            }
+            else if (feature->type == GeometryType::Point)
+            {
+                keep = count > 0;
+            }
+            if (!keep)
+            {
+                out.points.resize(start);
+                continue;
+            }
+            out.partEnds.push_back(static_cast<uint32_t>(out.points.size()));
+        }
+        if (!out.partEnds.empty())
+        {
+            tile->features.push_back(out);
+        }
+    }
+    return tile;
+}
+
+size_t GeoJsonTiler::tileBytes(const GeoJsonTile& tile)
+{
+    size_t bytes = sizeof(GeoJsonTile) + tile.features.capacity() * sizeof(GeoJsonTile::Feature);
+    for (const GeoJsonTile::Feature& feature : tile.features)
+    {
+        bytes += feature.points.capacity() * sizeof(glm::ivec2) + feature.partEnds.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+void GeoJsonTiler::insertCache(const SlicePtr& slice, size_t sliceBytes, const std::shared_ptr<const GeoJsonTile>& tile) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint64_t key = slice->tile.key();
+    auto found = cache.find(key);
+    if (found == cache.end())
+    {
+        lruOrder.push_front(key);
+        found = cache.emplace(key, CacheEntry()).first;
+        found->second.position = lruOrder.begin();
+        found->second.bytes = sliceBytes;
+    }
+    else
+    {
+        // 已有条目（另一个线程切出了同一个瓦片，或者只缓存了切片）：保留原来的切片字节数
+        lruOrder.splice(lruOrder.begin(), lruOrder, found->second.position);
+        stats.cachedBytes -= found->second.bytes;
+    }
+    CacheEntry& entry = found->second;
+    entry.slice = slice;
+    if (tile && !entry.tile)
+    {
+        entry.tile = tile;
+        entry.bytes += tileBytes(*tile);
+    }
+    stats.cachedBytes += entry.bytes;
+    
+    // 至少保留刚插入的一个
+    while (stats.cachedBytes > options.cacheBytes && cache.size() > 1)
+    {
+        auto oldest = cache.find(lruOrder.back());
+        stats.cachedBytes -= oldest->second.bytes;
+        cache.erase(oldest);
+        lruOrder.pop_back();
+        stats.evictions++;
+    }
+}
+
+std::shared_ptr<const GeoJsonTile> GeoJsonTiler::getTile(const TileID& tile) const
+{
+    PROFILE_ZONE("GeoJsonTiler::getTile");
+    if (tile.z < 0 || tile.z > options.maxZoom || tile.x < 0 || tile.y < 0 || tile.x >= (1 << tile.z) || tile.y >= (1 << tile.z))
+    {
+        return nullptr;
+    }
+    auto start = std::chrono::steady_clock::now();
+    TileID target = tile;
+    target.wrap = 0;
+    
+    // 从目标往上找最近的可用祖先：LRU 或索引叶子；路径经过已切分的索引瓦片而子瓦片不在索引中时为空
+    SlicePtr source;
+    bool sourceIndexed = false;     // 切片属于索引，缓存时不计字节
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.requests++;
+        bool childIndexed = true;
+        for (TileID current = target; root; current = TileID{ current.x >> 1, current.y >> 1, current.z - 1, 0 })
+        {
+            const uint64_t key = current.key();
+            auto cached = cache.find(key);
+            if (cached != cache.end())
+            {
+                lruOrder.splice(lruOrder.begin(), lruOrder, cached->second.position);
+                if (current == target && cached->second.tile)
+                {
+                    stats.cacheHits++;
+                    stats.emptyTiles += cached->second.tile->features.empty() ? 1 : 0;
+                    stats.sliceSeconds += secondsSince(start);
+                    return cached->second.tile;
+                }
+                source = cached->second.slice;
+                break;
+            }
+            auto leaf = indexLeaves.find(key);
+            if (leaf != indexLeaves.end())
+            {
+                source = leaf->second;
+                sourceIndexed = true;
+                break;
+            }
+            const bool split = indexSplit.count(key) != 0;
+            if (split && !childIndexed)
+            {
+                break;
+            }
+            childIndexed = split;
+            if (current.z == 0)
+            {
+                source = root;
+                sourceIndexed = true;
+                break;
+            }
+        }
+    }
+    
+    // 逐级往下裁剪（不持有锁），途经的瓦片放入 LRU 供兄弟和子瓦片复用
+    uint64_t clips = 0;
+    while (source && source->tile.z < target.z && !source->features.empty())
+    {
+        const int levels = target.z - source->tile.z - 1;
+        TileID child{ target.x >> levels, target.y >> levels, source->tile.z + 1, 0 };
+        source = clipSlice(*source, child);
+        sourceIndexed = false;
+        insertCache(source, source->bytes, nullptr);
+        clips++;
+    }
+    
+    std::shared_ptr<GeoJsonTile> result;
+    if (source && source->tile.z == target.z)
+    {
+        result = transform(*source);
+        insertCache(source, sourceIndexed ? 0 : source->bytes, result);
+    }
+    else
+    {
+        // 已知为空的区域不缓存
+        result = std::make_shared<GeoJsonTile>();
+        result->tile = target;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.clippedTiles += clips;
+    stats.emptyTiles += result->features.empty() ? 1 : 0;
+    stats.sliceSeconds += secondsSince(start);
+    return result;
+}
+
+GeoJsonTiler::Stats GeoJsonTiler::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = stats;
+    result.cachedTiles = cache.size();
+    return result;
+}
+
+GeoJsonTileSource::GeoJsonTileSource(const std::string& path)
+    : GeoJsonTileSource(path, GeoJsonTiler::Options())
+{
+}
+
+GeoJsonTileSource::GeoJsonTileSource(const std::string& path, const GeoJsonTiler::Options& options)
+    : tiler(options)
+{
+    open = tiler.load(path, &error);
+}
+
+bool GeoJsonTileSource::read(const TileID& tile, std::vector<uint8_t>& bytes) const
+{
+    if (!open)
+    {
+        return false;
+    }
+    std::shared_ptr<const GeoJsonTile> sliced = tiler.getTile(tile);
+    if (!sliced)
+    {
+        return false;
+    }
+    encode(*sliced, bytes);
+    return true;
+}
+
+void GeoJsonTileSource::encode(const GeoJsonTile& tile, std::vector<uint8_t>& bytes)
+{
+    PbfWriter layer;
+    layer.uint32Field(15, 2);
+    layer.stringField(1, kLayerName);
+    layer.uint32Field(5, Constants::TILE_EXTENT);
+    
+    PbfWriter feature;
+    std::vector<uint32_t> geometry;
+    for (const GeoJsonTile::Feature& source : tile.features)
+    {
+        // 坐标是相对上一个点的 zigzag 增量，游标跨部分延续
+        geometry.clear();
+        glm::ivec2 cursor(0);
+        auto addPoint = [&](const glm::ivec2& point)
+        {
+            geometry.push_back(PbfWriter::zigzag(point.x - cursor.x));
+            geometry.push_back(PbfWriter::zigzag(point.y - cursor.y));
+            cursor = point;
+        };
+        if (source.type == GeometryType::Point)
+        {
+            geometry.push_back(command(1, static_cast<uint32_t>(source.points.size())));
+            for (const glm::ivec2& point : source.points)
+            {
+                addPoint(point);
+            }
+        }
+        else
+        {
+            uint32_t begin = 0;
+            for (uint32_t end : source.partEnds)
+            {
+                geometry.push_back(command(1, 1));
+                addPoint(source.points[begin]);
+                geometry.push_back(command(2, end - begin - 1));
+                for (uint32_t i = begin + 1; i < end; i++)
+                {
+                    addPoint(source.points[i]);
+                }
+                if (source.type == GeometryType::Polygon)
+                {
+                    geometry.push_back(command(7, 1));
+                }
+                begin = end;
+            }
+        }
+        feature.clear();
+        feature.uint32Field(3, static_cast<uint32_t>(source.type));
+        feature.packedField(4, geometry);
+        layer.messageField(2, feature);
+    }
+    
+    PbfWriter encoded;
+    encoded.messageField(3, layer);
+    bytes.swap(encoded.data);
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include "GeoJsonReader.h"
+#include "TileID.h"
+#include "TileSource.h"
+#include "VectorTile.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * 切好的一个瓦片：TILE_EXTENT 坐标，已按瓦片层级简化
+ */
+struct GeoJsonTile
+{
+    struct Feature
+    {
+        VectorTile::GeometryType type = VectorTile::GeometryType::Unknown;
+        std::vector<glm::ivec2> points;
+        std::vector<uint32_t> partEnds;     // 环的末尾不重复首点，外环面积为正、洞为负（MVT 约定）
+    };
+    
+    TileID tile;
+    std::vector<Feature> features;
+};
+
+/**
+ * 进程内的 GeoJSON 切片器（geojson-vt 的做法，不依赖 GL）
+ *
+ * - load 流式读取 GeoJSON，坐标投影到归一化墨卡托（与 calculateTileMercatorCoords 相同的 [0, 1] 空间，
+ *   用 double 保存：z14 的 TILE_EXTENT 坐标需要 27 位精度），并为每个点计算 Douglas-Peucker 重要性
+ *   （该点被保留所需的最大平方容差），此后每个层级的简化只是按阈值过滤
+ * - 跨越经度 ±180 的缓冲区内的要素复制一份到世界的另一侧
+ * - 初始索引只切到 indexMaxZoom，点数不超过 indexMaxPoints 的瓦片不再往下切；
+ *   其余瓦片在 getTile 时从最近的祖先往下逐级裁剪，途经的切片和转换好的目标瓦片进入 LRU（按估算字节数限额）
+ * - 完全落在子瓦片内的要素不复制，父子瓦片共享同一份
+ *
+ * getTile 可以在多个线程上并发调用；load 不能与 getTile 同时进行。
+ */
+class GeoJsonTiler
+{
+public:
+    struct Options
+    {
+        int maxZoom = 14;
+        int indexMaxZoom = 5;               // 初始索引切分的最大层级
+        size_t indexMaxPoints = 100000;     // 点数不超过此值的瓦片不在初始索引中继续切分
+        double tolerance = 6.0;             // 简化容差（TILE_EXTENT 坐标，各层级相同，即层级越低容差越大）
+        double buffer = 128.0;              // 瓦片四周的缓冲区（TILE_EXTENT 坐标），线宽不会在瓦片边界处断开
+        size_t cacheBytes = 256 * 1024 * 1024;  // 按需切出的瓦片的 LRU 上限
+    };
+    
+    /**
+     * 统计（线程安全地读取一份快照）
+     */
+    struct Stats
+    {
+        // 初始索引
+        uint64_t bytesRead = 0;
+        uint64_t features = 0;
+        uint64_t invalidGeometries = 0;     // 类型与坐标不符、点数不足
+        uint64_t points = 0;                // 投影后的点（包括世界副本）
+        size_t indexTiles = 0;              // 保留的索引瓦片（根 + 叶子）
+        size_t indexBytes = 0;              // 要素及索引瓦片的估算内存
+        double parseSeconds = 0.0;          // 读取 + 投影 + 简化
+        double indexSeconds = 0.0;          // 初始切分
+        
+        // 按需切片
+        uint64_t requests = 0;
+        uint64_t cacheHits = 0;             // 转换好的目标瓦片已在 LRU 中
+        uint64_t emptyTiles = 0;            // 没有要素（包括索引已知为空的区域）
+        uint64_t clippedTiles = 0;          // 执行过的单级裁剪
+        uint64_t evictions = 0;
+        size_t cachedTiles = 0;
+        size_t cachedBytes = 0;
+        double sliceSeconds = 0.0;          // 所有 getTile 的耗时之和（包括转换为瓦片坐标）
+    };
+    
+    GeoJsonTiler();
+    explicit GeoJsonTiler(const Options& options);
+    
+    GeoJsonTiler(const GeoJsonTiler&) = delete;
+    GeoJsonTiler& operator=(const GeoJsonTiler&) = delete;
+    
+    /**
+     * 读取 GeoJSON 并建立初始索引（替换之前的数据）；语法错误时返回 false 并写入 error
+     */
+    bool load(std::istream& input, std::string* error = nullptr);
+    bool load(const std::string& path, std::string* error = nullptr);
+    
+    /**
+     * 切出一个瓦片（wrap 忽略）；超出 [0, maxZoom] 或 x/y 越界时返回 nullptr，没有要素时 features 为空
+     */
+    std::shared_ptr<const GeoJsonTile> getTile(const TileID& tile) const;
+    
+    const Options& getOptions() const { return options; }
+    Stats getStats() const;
+    
+private:
+    struct Point
+    {
+        double x;
+        double y;
+        double importance;      // 保留该点所需的最大平方容差（z0 的归一化坐标），端点和裁剪交点为 1
+    };
+    
+    struct Part
+    {
+        uint32_t end;
+        bool outer;
+    };
+    
+    struct Feature
+    {
+        VectorTile::GeometryType type;
+        std::vector<Point> points;
+        std::vector<Part> parts;
+        glm::dvec2 min;
+        glm::dvec2 max;
+        
+        size_t sizeInBytes() const { return sizeof(Feature) + points.capacity() * sizeof(Point) + parts.capacity() * sizeof(Part); }
+    };
+    
+    using FeaturePtr = std::shared_ptr<const Feature>;
+    
+    /**
+     * 一个瓦片范围内（含缓冲区）裁剪好的要素，仍是归一化坐标和完整精度
+     */
+    struct Slice
+    {
+        TileID tile;
+        std::vector<FeaturePtr> features;
+        size_t points = 0;
+        size_t bytes = 0;       // 自身新建的要素 + 指针数组，共享的要素不重复计算
+    };
+    
+    using SlicePtr = std::shared_ptr<const Slice>;
+    
+    struct CacheEntry
+    {
+        SlicePtr slice;
+        std::shared_ptr<const GeoJsonTile> tile;    // 第一次请求该瓦片时转换，之后直接返回
+        size_t bytes = 0;                           // 切片（属于索引的不计）+ 转换后瓦片的估算字节
+        std::list<uint64_t>::iterator position;
+    };
+    
+    bool addGeometry(const GeoJsonGeometry& geometry, std::vector<FeaturePtr>& out);
+    static void simplify(std::vector<Point>& points, size_t first, size_t last, double sqTolerance, std::vector<std::pair<size_t, size_t>>& stack);
+    static void clip(const std::vector<FeaturePtr>& input, const glm::dvec2& min, const glm::dvec2& max, std::vector<FeaturePtr>& out, size_t& newBytes);
+    static void clipFeature(const Feature& input, double k1, double k2, int axis, Feature& out);
+    static void clipPart(const Point* points, size_t count, double k1, double k2, int axis, bool polygon, bool outer, Feature& out);
+    static void computeBounds(Feature& feature);
+    static void shift(const std::vector<FeaturePtr>& input, double offset, std::vector<FeaturePtr>& out);
+    SlicePtr clipSlice(const Slice& parent, const TileID& child) const;
+    std::shared_ptr<GeoJsonTile> transform(const Slice& slice) const;
+    static size_t tileBytes(const GeoJsonTile& tile);
+    void insertCache(const SlicePtr& slice, size_t sliceBytes, const std::shared_ptr<const GeoJsonTile>& tile) const;
+    
+    Options options;
+    SlicePtr root;
+    std::unordered_map<uint64_t, SlicePtr> indexLeaves;
+    std::unordered_set<uint64_t> indexSplit;            // 初始索引中已切分的瓦片：其子瓦片都在索引中，不在的为空
+    
+    std::vector<std::pair<size_t, size_t>> simplifyStack; // 只在 load 中使用
+    
+    mutable std::mutex mutex;                           // 保护 LRU 和按需切片的统计
+    mutable std::list<uint64_t> lruOrder;               // 最近使用的在前
+    mutable std::unordered_map<uint64_t, CacheEntry> cache;
+    mutable Stats stats;
+};
+
+/**
+ * GeoJSON 文件作为矢量瓦片数据源：打开时建立索引，read 按需切片并编码为
+ * 单图层（kLayerName，范围 TILE_EXTENT）的 MVT，之后与其他矢量瓦片走相同的解码、三角化和上传流程
+ */
+class GeoJsonTileSource : public TileSource
+{
+public:
+    static constexpr const char* kLayerName = "geojson";
+    
+    /**
+     * 读取失败时 isOpen() 为 false，所有读取都返回 false
+     */
+    explicit GeoJsonTileSource(const std::string& path);
+    GeoJsonTileSource(const std::string& path, const GeoJsonTiler::Options& options);
+    
+    /**
+     * 没有要素的瓦片也返回一个空图层（解码端把空字节当作失败）
+     */
+    bool read(const TileID& tile, std::vector<uint8_t>& bytes) const override;
+    int getMaxZoom() const override { return tiler.getOptions().maxZoom; }
+    
+    bool isOpen() const { return open; }
+    const std::string& getError() const { return error; }
+    const GeoJsonTiler& getTiler() const { return tiler; }
+    
+    static void encode(const GeoJsonTile& tile, std::vector<uint8_t>& bytes);
+    
+private:
+    GeoJsonTiler tiler;
+    bool open;
+    std::string error;
+};
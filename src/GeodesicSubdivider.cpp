@@ -0,0 +1,283 @@
+#include "GeodesicSubdivider.h"
+
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace
+{
+constexpr uint32_t kEmptySlot = std::numeric_limits<uint32_t>::max();
+// 只在 int16 坐标范围内切分（超出的部分打包顶点时会被截断），损坏的坐标不会产生大量网格线
+constexpr float kCoordinateLimit = 32768.0f;
+
+/**
+ * 严格大于 low 的第一条网格线的编号
+ */
+float firstLine(float low, float cellSize)
+{
+    return std::floor(std::max(low, -kCoordinateLimit) / cellSize) + 1.0f;
+}
+
+uint64_t pointKey(const glm::vec2& point)
+{
+    // 加 0 把 -0 变成 +0，两者的位模式不同但是同一个点
+    const float x = point.x + 0.0f;
+    const float y = point.y + 0.0f;
+    uint32_t bitsX, bitsY;
+    std::memcpy(&bitsX, &x, sizeof(bitsX));
+    std::memcpy(&bitsY, &y, sizeof(bitsY));
+    return (static_cast<uint64_t>(bitsX) << 32) | bitsY;
+}
+
+uint64_t mixKey(uint64_t key)
+{
+    // splitmix64 的终结函数
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    return key ^ (key >> 31);
+}
+
+/**
+ * 线段与直线 (axis 坐标 = value) 的交点；端点按坐标排序后再计算，
+ * 同一条边在相邻三角形中以相反方向出现时得到位模式相同的交点
+ */
+glm::vec2 intersect(glm::vec2 a, glm::vec2 b, int axis, float value)
+{
+    if (b.x < a.x || (b.x == a.x && b.y < a.y))
+    {
+        std::swap(a, b);
+    }
+    const int other = 1 - axis;
+    const float t = (value - a[axis]) / (b[axis] - a[axis]);
+    glm::vec2 result;
+    result[axis] = value;
+    result[other] = a[other] + t * (b[other] - a[other]);
+    return result;
+}
+} // namespace
+
+int GeodesicSubdivider::gridDivisions(int zoom, float tilePixels)
+{
+    // 放大到下一层级时整个球面的周长为 2 · tilePixels · 2^z 像素，半径 R = 周长 / 2π；
+    // 张角 θ 的弦到球面的最大距离为 R(1 - cos(θ/2)) ≈ Rθ²/8，误差 ε 要求 θ ≤ sqrt(8ε / R)
+    const double scale = std::exp2(static_cast<double>(zoom));
+    const double radius = 2.0 * tilePixels * scale / (2.0 * Constants::PI);
+    const double maxAngle = std::sqrt(8.0 * kMaxChordErrorPixels / radius);
+    
+    // 瓦片在赤道处的张角最大（墨卡托保角，南北方向与东西方向相同），格子内最长的边是对角线
+    const double tileDiagonal = 2.0 * Constants::PI / scale * std::sqrt(2.0);
+    int divisions = 1;
+    while (divisions < kMaxDivisions && tileDiagonal / divisions > maxAngle)
+    {
+        divisions *= 2;
+    }
+    return divisions;
+}
+
+void GeodesicSubdivider::subdivideLine(const glm::vec2* points, size_t count, bool closed, int divisions, std::vector<glm::vec2>& out)
+{
+    out.clear();
+    if (count == 0)
+    {
+        return;
+    }
+    const float cellSize = static_cast<float>(Constants::TILE_EXTENT) / divisions;
+    const size_t segments = closed ? count : count - 1;
+    for (size_t i = 0; i < segments; i++)
+    {
+        const glm::vec2& a = points[i];
+        const glm::vec2& b = points[(i + 1) % count];
+        out.push_back(a);
+        
+        // 严格位于两端点之间的竖线和横线，按在线段上的位置排序
+        crossings.clear();
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (a[axis] == b[axis])
+            {
+                continue;
+            }
+            const float low = std::min(a[axis], b[axis]);
+            const float high = std::min(std::max(a[axis], b[axis]), kCoordinateLimit);
+            for (float line = firstLine(low, cellSize); line * cellSize < high; line++)
+            {
+                crossings.push_back((line * cellSize - a[axis]) / (b[axis] - a[axis]));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (float t : crossings)
+        {
+            out.push_back(a + (b - a) * t);
+        }
+    }
+    if (!closed)
+    {
+        out.push_back(points[count - 1]);
+    }
+}
+
+void GeodesicSubdivider::subdivideTriangles(const glm::vec2* points, const uint32_t* indices, size_t indexCount, int divisions,
+                                            std::vector<glm::vec2>& outPoints, std::vector<uint32_t>& outIndices, uint32_t baseIndex)
+{
+    outPoints.clear();
+    outputPoints = &outPoints;
+    outputIndices = &outIndices;
+    outputBase = baseIndex;
+    
+    // 哈希表从输入规模的 2 倍开始（2 的幂），装载超过一半时扩容
+    size_t capacity = 64;
+    while (capacity < indexCount * 2)
+    {
+        capacity *= 2;
+    }
+    rehash(capacity);
+    
+    const float cellSize = static_cast<float>(Constants::TILE_EXTENT) / divisions;
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        polygon.assign({ points[indices[i]], points[indices[i + 1]], points[indices[i + 2]] });
+        const float minX = std::min({ polygon[0].x, polygon[1].x, polygon[2].x });
+        const float maxX = std::min(std::max({ polygon[0].x, polygon[1].x, polygon[2].x }), kCoordinateLimit);
+        
+        // 从左到右依次切下每一列（只用严格穿过三角形内部的竖线），每列再逐行切开
+        for (float line = firstLine(minX, cellSize); line * cellSize < maxX && polygon.size() >= 3; line++)
+        {
+            split(polygon, 0, line * cellSize, column, remainder);
+            splitRows(cellSize);
+            polygon.swap(remainder);
+        }
+        column.swap(polygon);
+        splitRows(cellSize);
+    }
+    outputPoints = nullptr;
+    outputIndices = nullptr;
+}
+
+void GeodesicSubdivider::splitRows(float cellSize)
+{
+    if (column.size() < 3)
+    {
+        return;
+    }
+    float minY = column[0].y;
+    float maxY = column[0].y;
+    for (const glm::vec2& point : column)
+    {
+        minY = std::min(minY, point.y);
+        maxY = std::max(maxY, point.y);
+    }
+    maxY = std::min(maxY, kCoordinateLimit);
+    for (float line = firstLine(minY, cellSize); line * cellSize < maxY && column.size() >= 3; line++)
+    {
+        split(column, 1, line * cellSize, cell, columnRemainder);
+        emitPolygon(cell);
+        column.swap(columnRemainder);
+    }
+    emitPolygon(column);
+}
+
+void GeodesicSubdivider::split(const std::vector<glm::vec2>& input, int axis, float value,
+                               std::vector<glm::vec2>& below, std::vector<glm::vec2>& above)
+{
+    // 凸多边形被直线分成两个凸多边形，线上的点两边都有
+    below.clear();
+    above.clear();
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        const glm::vec2& a = input[i];
+        const glm::vec2& b = input[(i + 1) % input.size()];
+        if (a[axis] <= value)
+        {
+            below.push_back(a);
+        }
+        if (a[axis] >= value)
+        {
+            above.push_back(a);
+        }
+        if ((a[axis] < value && b[axis] > value) || (a[axis] > value && b[axis] < value))
+        {
+            const glm::vec2 point = intersect(a, b, axis, value);
+            below.push_back(point);
+            above.push_back(point);
+        }
+    }
+}
+
+void GeodesicSubdivider::emitPolygon(const std::vector<glm::vec2>& piece)
+{
+    // 凸多边形扇形三角化，绕序与原三角形相同；去重后重合的顶点组成的三角形丢弃
+    if (piece.size() < 3)
+    {
+        return;
+    }
+    const uint32_t first = addPoint(piece[0]);
+    uint32_t previous = addPoint(piece[1]);
+    for (size_t i = 2; i < piece.size(); i++)
+    {
+        const uint32_t current = addPoint(piece[i]);
+        if (first != previous && previous != current && current != first)
+        {
+            outputIndices->insert(outputIndices->end(), { outputBase + first, outputBase + previous, outputBase + current });
+        }
+        previous = current;
+    }
+}
+
+uint32_t GeodesicSubdivider::addPoint(const glm::vec2& point)
+{
+    const uint64_t key = pointKey(point);
+    const size_t mask = slotKeys.size() - 1;
+    for (size_t slot = mixKey(key) & mask;; slot = (slot + 1) & mask)
+    {
+        if (slotValues[slot] == kEmptySlot)
+        {
+            break;
+        }
+        if (slotKeys[slot] == key)
+        {
+            return slotValues[slot];
+        }
+    }
+    
+    const uint32_t index = static_cast<uint32_t>(outputPoints->size());
+    outputPoints->push_back(point);
+    if (outputPoints->size() * 2 > slotKeys.size())
+    {
+        rehash(slotKeys.size() * 2);
+    }
+    else
+    {
+        insertSlot(key, index);
+    }
+    return index;
+}
+
+void GeodesicSubdivider::insertSlot(uint64_t key, uint32_t value)
+{
+    const size_t mask = slotKeys.size() - 1;
+    size_t slot = mixKey(key) & mask;
+    while (slotValues[slot] != kEmptySlot)
+    {
+        slot = (slot + 1) & mask;
+    }
+    slotKeys[slot] = key;
+    slotValues[slot] = value;
+}
+
+void GeodesicSubdivider::rehash(size_t capacity)
+{
+    slotKeys.assign(capacity, 0);
+    slotValues.assign(capacity, kEmptySlot);
+    if (outputPoints)
+    {
+        for (size_t i = 0; i < outputPoints->size(); i++)
+        {
+            insertSlot(pointKey((*outputPoints)[i]), static_cast<uint32_t>(i));
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 矢量几何的球面细分（不依赖 GL，在工作线程上运行）
+ *
+ * 瓦片在 Globe 模式下逐顶点投影到球面，顶点之间仍是直线（弦），长边会穿进球体。
+ * 这里把几何切到瓦片的正方形网格上：
+ * - 网格密度按瓦片层级选择，使格子对角线对应的弦与球面的距离不超过 kMaxChordErrorPixels
+ *   （层级越高格子越少，z12 起不再细分）
+ * - 线在与网格线的交点处插入顶点
+ * - 三角形裁剪到各个格子，每块凸多边形扇形三角化；共享边上的交点按端点排序计算，
+ *   相邻三角形得到完全相同的坐标，据此去重
+ *
+ * 中间缓冲区属于实例，多次调用之间复用；一个实例同一时刻只能被一个线程使用。
+ */
+class GeodesicSubdivider
+{
+public:
+    static constexpr float kMaxChordErrorPixels = 0.5f;
+    static constexpr int kMaxDivisions = 64;    // 与 TileMesh 最细的 LOD 相同
+    
+    /**
+     * 瓦片每边的格子数（2 的幂，1 表示不需要细分）。误差按瓦片放大到下一层级之前
+     * （tilePixels 的两倍）计算
+     */
+    static int gridDivisions(int zoom, float tilePixels);
+    
+    /**
+     * 在线与网格线的交点处插入顶点，结果写入 out（先清空）；
+     * closed 时包括末点回到首点的一段，末尾不重复首点
+     */
+    void subdivideLine(const glm::vec2* points, size_t count, bool closed, int divisions, std::vector<glm::vec2>& out);
+    
+    /**
+     * 把三角形（indices 为 points 的下标，每 3 个一组）裁剪到网格格子内再三角化；
+     * 去重后的顶点写入 outPoints（先清空），三角形下标（outPoints 中的位置加上 baseIndex）追加到 outIndices
+     */
+    void subdivideTriangles(const glm::vec2* points, const uint32_t* indices, size_t indexCount, int divisions,
+                            std::vector<glm::vec2>& outPoints, std::vector<uint32_t>& outIndices, uint32_t baseIndex);
+                            
+private:
+    void splitRows(float cellSize);
+    void emitPolygon(const std::vector<glm::vec2>& piece);
+    uint32_t addPoint(const glm::vec2& point);
+    void insertSlot(uint64_t key, uint32_t value);
+    void rehash(size_t capacity);
+    static void split(const std::vector<glm::vec2>& input, int axis, float value,
+                      std::vector<glm::vec2>& below, std::vector<glm::vec2>& above);
+    
+    std::vector<float> crossings;       // 一条线段与网格线交点的参数
+    std::vector<glm::vec2> polygon;     // 三角形切掉左侧各列之后剩下的部分
+    std::vector<glm::vec2> remainder;
+    std::vector<glm::vec2> column;      // 切下的一列，再逐行切开
+    std::vector<glm::vec2> columnRemainder;
+    std::vector<glm::vec2> cell;
+    
+    // 顶点去重：开放寻址哈希表，key 为坐标的位模式，value 为 outPoints 中的位置
+    std::vector<uint64_t> slotKeys;
+    std::vector<uint32_t> slotValues;
+    std::vector<glm::vec2>* outputPoints = nullptr;
+    std::vector<uint32_t>* outputIndices = nullptr;
+    uint32_t outputBase = 0;
+};
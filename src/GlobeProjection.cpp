@@ -1,5 +1,6 @@
 #include "GlobeProjection.h"
 
+#include "Profiler.h"
 #include <algorithm>
 #include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
@@ -23,8 +24,21 @@ float GlobeProjection::wrapLon(float lon) const
     return lon;
 }
 
+float GlobeProjection::mercatorYFromLat(float lat)
+{
+    float latRad = lat * Constants::PI / 180.0f;
+    return 0.5f - log(tan(Constants::PI/4.0f + latRad/2.0f)) / (2.0f * Constants::PI);
+}
+
+float GlobeProjection::latFromMercatorY(float mercY)
+{
+    // 与 shader 中 projectToSphere 的纬度公式一致
+    return (2.0f * atan(exp(Constants::PI - mercY * Constants::PI * 2.0f)) - Constants::PI * 0.5f) * 180.0f / Constants::PI;
+}
+
 glm::mat4 GlobeProjection::calculateGlobeMatrix(float aspect) const
 {
+    PROFILE_ZONE("GlobeProjection::calculateGlobeMatrix");
     float dist = getCameraDistance();
     float globeRadius = getGlobeRadius();
     
@@ -41,6 +55,7 @@ glm::mat4 GlobeProjection::calculateGlobeMatrix(float aspect) const
 
 glm::mat4 GlobeProjection::calculateMercatorMatrix(int tileX, int tileY, int tileZ, int wrap, float aspect) const
 {
+    PROFILE_ZONE("GlobeProjection::calculateMercatorMatrix");
     float dist = getCameraDistance();
     
     float numTiles = pow(2.0f, tileZ);
@@ -121,6 +136,7 @@ int GlobeProjection::getWrapForTile(int tileX, int tileY, int tileZ) const
 
 glm::vec4 GlobeProjection::calculateClippingPlane() const
 {
+    PROFILE_ZONE("GlobeProjection::calculateClippingPlane");
     float dist = getCameraDistance();
     float globeRadius = getGlobeRadius();
     
@@ -184,3 +200,54 @@ glm::vec4 GlobeProjection::calculateClippingPlane() const
     return glm::vec4(px, py, pz, -tangentPlaneDistanceToC / len);
 }
 
+std::shared_ptr<const ProjectionState> GlobeProjection::getState(float aspect) const
+{
+    if (!cachedState || !cachedState->matches(*this, aspect))
+    {
+        cachedState = std::make_shared<const ProjectionState>(*this, aspect);
+    }
+    return cachedState;
+}
+
+bool GlobeProjection::unproject(float screenX, float screenY, int viewportWidth, int viewportHeight, glm::vec2& lonLat) const
+{
+    float aspect = static_cast<float>(viewportWidth) / viewportHeight;
+    std::shared_ptr<const ProjectionState> state = getState(aspect);
+    
+    glm::vec2 ndc(screenX / viewportWidth * 2.0f - 1.0f, 1.0f - screenY / viewportHeight * 2.0f);
+    glm::vec2 mercator;
+    if (!state->unprojectNdc(ndc, mercator))
+    {
+        return false;
+    }
+    lonLat.x = wrapLon((mercator.x - 0.5f) * 360.0f);
+    lonLat.y = latFromMercatorY(mercator.y);
+    return true;
+}
+
+size_t GlobeProjection::unprojectBatch(const float* screenX, const float* screenY, size_t count, int viewportWidth, int viewportHeight,
+                                       float* outLon, float* outLat, uint8_t* outHit) const
+{
+    float aspect = static_cast<float>(viewportWidth) / viewportHeight;
+    std::shared_ptr<const ProjectionState> state = getState(aspect);
+    
+    size_t hits = 0;
+    bool hasGuess = false;
+    glm::vec2 guess;
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec2 ndc(screenX[i] / viewportWidth * 2.0f - 1.0f, 1.0f - screenY[i] / viewportHeight * 2.0f);
+        glm::vec2 mercator;
+        bool hit = state->unprojectNdc(ndc, mercator, hasGuess ? &guess : nullptr);
+        outHit[i] = hit ? 1 : 0;
+        if (hit)
+        {
+            outLon[i] = wrapLon((mercator.x - 0.5f) * 360.0f);
+            outLat[i] = latFromMercatorY(mercator.y);
+            guess = mercator;
+            hasGuess = true;
+            hits++;
+        }
+    }
+    return hits;
+}
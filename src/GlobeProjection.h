@@ -1,6 +1,10 @@
 #pragma once
 #include "Constants.h"
+#include "ProjectionState.h"
 #include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 
 class GlobeProjection
 {
@@ -27,6 +31,12 @@ public:
      */
     float wrapLon(float lon) const;
     
+    /**
+     * 纬度（度）与归一化墨卡托 Y（0..1，北极在 0）互相转换
+     */
+    static float mercatorYFromLat(float lat);
+    static float latFromMercatorY(float mercY);
+    
     /**
      * 计算 Globe 投影矩阵
      * 
@@ -79,4 +89,30 @@ public:
      * 返回平面方程：[nx, ny, nz, d]，其中 dot(pos, [nx,ny,nz]) + d = 0
      */
     glm::vec4 calculateClippingPlane() const;
+    
+    /**
+     * 获取当前相机参数对应的投影状态快照
+     * 
+     * 参数（transition/centerLon/centerLat/zoom/aspect）与上次相同时直接返回缓存，
+     * 否则重新构建；返回的快照不可变，可以安全地跨帧/跨线程持有
+     */
+    std::shared_ptr<const ProjectionState> getState(float aspect) const;
+    
+    /**
+     * 屏幕像素（原点在左上角）-> 经纬度（度，经度 wrap 到 -180..180）
+     * 
+     * 适用于任意过渡因子；像素上没有地图时返回 false
+     */
+    bool unproject(float screenX, float screenY, int viewportWidth, int viewportHeight, glm::vec2& lonLat) const;
+    
+    /**
+     * 批量反投影（鼠标轨迹、采样网格等），相邻点的解作为下一个点的初值
+     * 
+     * outHit 为每个点是否命中地图，返回命中数量
+     */
+    size_t unprojectBatch(const float* screenX, const float* screenY, size_t count, int viewportWidth, int viewportHeight,
+                          float* outLon, float* outLat, uint8_t* outHit) const;
+    
+private:
+    mutable std::shared_ptr<const ProjectionState> cachedState;
 };
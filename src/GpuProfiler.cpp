@@ -0,0 +1,126 @@
+#include "GpuProfiler.h"
+
+namespace
+{
+// GPU 与 CPU 时钟的重新对齐间隔（纳秒）
+constexpr uint64_t kCalibrationInterval = 1000000000ull;
+// openZones 中表示"没有记录"的区段（未启用或查询不足）
+constexpr size_t kSkippedZone = static_cast<size_t>(-1);
+constexpr uint32_t kNoQuery = static_cast<uint32_t>(-1);
+} // namespace
+
+GpuProfiler::GpuProfiler(size_t queryCount)
+    : profiler(Profiler::shared())
+    , lane(Profiler::shared().createLane("GPU"))
+    , queries(queryCount)
+    , busy(queryCount, false)
+    , nextQuery(0)
+    , zonesPopped(0)
+    , gpuToProfiler(0)
+    , lastCalibration(0)
+    , dropped(0)
+{
+    glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    calibrate();
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+}
+
+bool GpuProfiler::allocate(uint32_t& index)
+{
+    // 按环形顺序分配；下一个查询仍在等待结果说明 GPU 落后了整个环
+    if (busy[nextQuery])
+    {
+        return false;
+    }
+    index = nextQuery;
+    busy[index] = true;
+    nextQuery = (nextQuery + 1) % static_cast<uint32_t>(queries.size());
+    return true;
+}
+
+void GpuProfiler::begin(const char* name)
+{
+    uint32_t query = kNoQuery;
+    if (!profiler.isEnabled() || !allocate(query))
+    {
+        dropped += profiler.isEnabled() ? 1 : 0;
+        openZones.push_back(kSkippedZone);
+        return;
+    }
+    glQueryCounter(queries[query], GL_TIMESTAMP);
+    openZones.push_back(zonesPopped + zones.size());
+    zones.push_back({ name, query, kNoQuery, false });
+}
+
+void GpuProfiler::end()
+{
+    if (openZones.empty())
+    {
+        return;
+    }
+    size_t open = openZones.back();
+    openZones.pop_back();
+    if (open == kSkippedZone)
+    {
+        return;
+    }
+    
+    Zone& zone = zones[open - zonesPopped];
+    zone.ended = true;
+    if (allocate(zone.endQuery))
+    {
+        glQueryCounter(queries[zone.endQuery], GL_TIMESTAMP);
+    }
+    else
+    {
+        zone.endQuery = kNoQuery;
+        dropped++;
+    }
+}
+
+void GpuProfiler::poll()
+{
+    if (profiler.now() - lastCalibration >= kCalibrationInterval)
+    {
+        calibrate();
+    }
+    
+    // 按开始顺序读取；遇到尚未结束或结果不可用的区段就停下，下一帧再读
+    while (!zones.empty() && zones.front().ended)
+    {
+        Zone& zone = zones.front();
+        if (zone.endQuery != kNoQuery)
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[zone.endQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+            {
+                break;
+            }
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(queries[zone.beginQuery], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(queries[zone.endQuery], GL_QUERY_RESULT, &end);
+            int64_t start = static_cast<int64_t>(begin) + gpuToProfiler;
+            if (start >= 0)
+            {
+                profiler.record(lane, zone.name, static_cast<uint64_t>(start), static_cast<uint64_t>(start) + (end - begin));
+            }
+            busy[zone.endQuery] = false;
+        }
+        busy[zone.beginQuery] = false;
+        zones.pop_front();
+        zonesPopped++;
+    }
+}
+
+void GpuProfiler::calibrate()
+{
+    GLint64 gpuTime = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+    lastCalibration = profiler.now();
+    gpuToProfiler = static_cast<int64_t>(lastCalibration) - gpuTime;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Profiler.h"
+#include "glad/glad.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * GPU 区段计时：在区段开始和结束处各插入一个 GL_TIMESTAMP 查询（glQueryCounter），
+ * 每帧 poll 时只读取已经可用的结果（GL_QUERY_RESULT_AVAILABLE），从不等待 GPU
+ *
+ * - 查询对象组成固定大小的环，GPU 落后太多、环中没有空闲查询时丢弃新区段
+ * - GPU 时间戳换算到 Profiler 的时间轴：定期用 glGetInteger64v(GL_TIMESTAMP) 与 CPU 时钟对齐
+ * - 结果写入 Profiler 中名为 "GPU" 的时间线，与 CPU 区段一起汇总和导出
+ *
+ * 只能在创建它的 GL 上下文所在线程上使用。
+ */
+class GpuProfiler
+{
+public:
+    explicit GpuProfiler(size_t queryCount = 512);
+    ~GpuProfiler();
+    
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+    
+    /**
+     * 开始/结束一个区段（可以嵌套，name 必须是静态字符串）
+     */
+    void begin(const char* name);
+    void end();
+    
+    /**
+     * 读取已完成的区段写入 Profiler（每帧调用一次）
+     */
+    void poll();
+    
+    uint64_t getDroppedCount() const { return dropped; }
+    
+private:
+    struct Zone
+    {
+        const char* name;
+        uint32_t beginQuery;      // queries 中的下标
+        uint32_t endQuery;        // 查询不足时没有结束时间戳，区段被丢弃
+        bool ended;
+    };
+    
+    bool allocate(uint32_t& index);
+    void calibrate();
+    
+    Profiler& profiler;
+    Profiler::Lane& lane;
+    std::vector<GLuint> queries;
+    std::vector<bool> busy;           // 查询已发出、结果尚未读取
+    uint32_t nextQuery;
+    std::deque<Zone> zones;           // 按开始顺序，poll 从头部读取
+    std::vector<size_t> openZones;    // 尚未 end 的区段的序号（减去 zonesPopped 为 zones 中的下标）
+    size_t zonesPopped;
+    int64_t gpuToProfiler;            // profiler 时间 = GPU 时间 + gpuToProfiler
+    uint64_t lastCalibration;
+    uint64_t dropped;
+};
+
+/**
+ * RAII GPU 区段
+ */
+class GpuProfileZone
+{
+public:
+    GpuProfileZone(GpuProfiler& profiler, const char* name) : profiler(profiler) { profiler.begin(name); }
+    ~GpuProfileZone() { profiler.end(); }
+    
+    GpuProfileZone(const GpuProfileZone&) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+    
+private:
+    GpuProfiler& profiler;
+};
+
+#ifdef GLOBE_PROFILER
+#define PROFILE_GPU_ZONE(profiler, name) GpuProfileZone PROFILE_CONCAT(gpuProfileZone, __LINE__)(profiler, name)
+#else
+#define PROFILE_GPU_ZONE(profiler, name) ((void)0)
+#endif
@@ -0,0 +1,283 @@
+#include "JobSystem.h"
+
+#include "Profiler.h"
+#include <chrono>
+
+namespace
+{
+// 空闲工作线程的最长休眠时间（兜底 notify 与入队之间的竞争）
+constexpr auto kIdleWait = std::chrono::milliseconds(5);
+
+// 当前线程所属的调度器与队列下标（非工作线程为 nullptr / -1）
+thread_local const JobSystem* currentSystem = nullptr;
+thread_local int currentWorker = -1;
+} // namespace
+
+JobSystem::JobSystem(unsigned threadCount)
+    : nextQueue(0), queuedJobs(0), sleepingWorkers(0), stopping(false), blockedHelpers(0), helperSignal(0),
+      executed(0), stolen(0), cancelled(0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = defaultThreadCount(std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        queues.emplace_back(new WorkerQueue());
+    }
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wakeup.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned JobSystem::defaultThreadCount(unsigned hardwareThreads)
+{
+    return std::max(2u, hardwareThreads) - 1;
+}
+
+JobSystem& JobSystem::shared()
+{
+    static JobSystem system;
+    return system;
+}
+
+JobSystem::JobHandle JobSystem::create(std::function<void()> function, Priority priority, std::shared_ptr<const CancellationToken> token)
+{
+    JobHandle job = std::make_shared<Job>();
+    job->function = std::move(function);
+    job->priority = priority;
+    job->token = std::move(token);
+    return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& dependency)
+{
+    std::lock_guard<std::mutex> lock(dependency->mutex);
+    if (dependency->done.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    job->remaining.fetch_add(1, std::memory_order_relaxed);
+    dependency->dependents.push_back(job);
+}
+
+void JobSystem::submit(const JobHandle& job)
+{
+    if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        enqueue(job);
+    }
+}
+
+JobSystem::JobHandle JobSystem::schedule(std::function<void()> function, Priority priority, std::initializer_list<JobHandle> dependencies)
+{
+    JobHandle job = create(std::move(function), priority);
+    for (const JobHandle& dependency : dependencies)
+    {
+        addDependency(job, dependency);
+    }
+    submit(job);
+    return job;
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    const bool worker = currentSystem == this;
+    while (!job->isDone())
+    {
+        if (runOne())
+        {
+            continue;
+        }
+        if (worker)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        // 非工作线程没有可帮忙的 High 任务：阻塞到任务完成或有新的 High 任务
+        std::unique_lock<std::mutex> lock(helperMutex);
+        blockedHelpers.fetch_add(1);
+        uint64_t signal = helperSignal.load();
+        helperWakeup.wait_for(lock, kIdleWait, [&]() { return job->isDone() || helperSignal.load() != signal; });
+        blockedHelpers.fetch_sub(1);
+    }
+}
+
+bool JobSystem::isDone(const JobHandle& job)
+{
+    return job->isDone();
+}
+
+bool JobSystem::runOne()
+{
+    const bool worker = currentSystem == this;
+    JobHandle job = worker ? take(currentWorker, kPriorityCount - 1) : take(-1, static_cast<int>(Priority::High));
+    if (!job)
+    {
+        return false;
+    }
+    execute(job);
+    return true;
+}
+
+JobSystem::Stats JobSystem::getStats() const
+{
+    Stats stats;
+    stats.executed = executed.load(std::memory_order_relaxed);
+    stats.stolen = stolen.load(std::memory_order_relaxed);
+    stats.cancelled = cancelled.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void JobSystem::workerLoop(unsigned index)
+{
+    currentSystem = this;
+    currentWorker = static_cast<int>(index);
+    PROFILE_THREAD_NAME("Job worker " + std::to_string(index));
+    while (!stopping.load(std::memory_order_relaxed))
+    {
+        if (JobHandle job = take(currentWorker, kPriorityCount - 1))
+        {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+        wakeup.wait_for(lock, kIdleWait, [this]() {
+            return stopping.load(std::memory_order_relaxed) || queuedJobs.load(std::memory_order_relaxed) > 0;
+        });
+        sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void JobSystem::enqueue(JobHandle job)
+{
+    // 工作线程放入自己的队列（之后多半由自己从尾部取出），外部线程轮流分散到各队列
+    unsigned index = currentSystem == this ? static_cast<unsigned>(currentWorker)
+                                           : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    WorkerQueue& queue = *queues[index];
+    int priority = static_cast<int>(job->priority);
+    // 先计数再入队：计数只会暂时偏大（take 多扫一遍），不会让已入队的任务被忽略
+    queuedJobs.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs[priority].push_back(std::move(job));
+    }
+    if (sleepingWorkers.load(std::memory_order_relaxed) > 0)
+    {
+        wakeup.notify_one();
+    }
+    if (priority == static_cast<int>(Priority::High))
+    {
+        notifyHelpers();
+    }
+}
+
+void JobSystem::notifyHelpers()
+{
+    // 与 wait 中先登记 blockedHelpers、再检查完成状态的顺序配对；漏掉的唤醒由 kIdleWait 兜底
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (blockedHelpers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(helperMutex);
+        helperSignal.fetch_add(1);
+        helperWakeup.notify_all();
+    }
+}
+
+JobSystem::JobHandle JobSystem::take(int self, int lowestPriority)
+{
+    if (queuedJobs.load(std::memory_order_acquire) == 0)
+    {
+        return nullptr;
+    }
+    
+    size_t count = queues.size();
+    for (int priority = 0; priority <= lowestPriority; priority++)
+    {
+        // 自己的队列从尾部取
+        if (self >= 0)
+        {
+            WorkerQueue& queue = *queues[self];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            std::deque<JobHandle>& jobs = queue.jobs[priority];
+            if (!jobs.empty())
+            {
+                JobHandle job = std::move(jobs.back());
+                jobs.pop_back();
+                queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        // 其他队列从头部窃取，从相邻的队列开始避免所有线程争抢同一个
+        size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t victim = (start + i) % count;
+            if (static_cast<int>(victim) == self)
+            {
+                continue;
+            }
+            WorkerQueue& queue = *queues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            std::deque<JobHandle>& jobs = queue.jobs[priority];
+            if (!jobs.empty())
+            {
+                JobHandle job = std::move(jobs.front());
+                jobs.pop_front();
+                queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                if (self >= 0)
+                {
+                    stolen.fetch_add(1, std::memory_order_relaxed);
+                }
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+    if (job->token && job->token->isCancelled())
+    {
+        cancelled.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        job->function();
+        executed.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 释放捕获的资源，句柄可能还被等待方持有
+    job->function = nullptr;
+    finish(job);
+}
+
+void JobSystem::finish(const JobHandle& job)
+{
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done.store(true, std::memory_order_release);
+        dependents.swap(job->dependents);
+    }
+    for (const JobHandle& dependent : dependents)
+    {
+        submit(dependent);
+    }
+    notifyHelpers();
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include "CancellationToken.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 工作窃取任务调度器
+ *
+ * - 每个工作线程有自己的双端队列（每个优先级一个）：自己从尾部取（LIFO，缓存友好），
+ *   其他线程从头部窃取（FIFO，先拿最早、通常最大的任务）
+ * - 取任务时按优先级从高到低：先找自己的队列，再从其他线程窃取，才轮到下一个优先级
+ * - 依赖：任务在所有依赖完成后才进入队列；依赖被取消也算完成，后续任务自行检查
+ * - 取消：任务开始前检查 CancellationToken，已取消的不执行函数体
+ * - wait 的调用线程在等待期间也执行排队中的任务；非工作线程（例如 GL 线程）只帮忙执行 High 优先级的，
+ *   不会在等待帧构建时接下 Normal / Low 的解码、细分任务而拖慢提交，没有 High 任务时阻塞等待完成
+ *
+ * 用法：create -> addDependency（可选）-> submit -> wait
+ */
+class JobSystem
+{
+public:
+    enum class Priority : uint8_t
+    {
+        High = 0,      // 帧构建（GL 线程在等待）
+        Normal = 1,    // 可见瓦片的解码
+        Low = 2,       // 预取
+    };
+    static constexpr int kPriorityCount = 3;
+    
+    class Job;
+    using JobHandle = std::shared_ptr<Job>;
+    
+    struct Stats
+    {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;       // 从其他线程的队列窃取执行
+        uint64_t cancelled = 0;    // 开始前已取消，没有执行函数体
+    };
+    
+    /**
+     * threadCount 为 0 时使用 硬件线程数 - 1（等待的线程自己也会执行任务）
+     */
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+    
+    /**
+     * threadCount 为 0 时的工作线程数：hardwareThreads - 1，至少 1（hardware_concurrency 可能返回 0）
+     */
+    static unsigned defaultThreadCount(unsigned hardwareThreads);
+    
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    /**
+     * 进程共享的调度器（第一次使用时创建）
+     */
+    static JobSystem& shared();
+    
+    /**
+     * 创建任务，submit 之前不会执行
+     */
+    JobHandle create(std::function<void()> function, Priority priority = Priority::Normal,
+                     std::shared_ptr<const CancellationToken> token = nullptr);
+    
+    /**
+     * job 在 dependency 完成后才执行；必须在 submit(job) 之前调用
+     */
+    void addDependency(const JobHandle& job, const JobHandle& dependency);
+    
+    /**
+     * 提交任务；所有依赖都已完成时立即入队
+     */
+    void submit(const JobHandle& job);
+    
+    /**
+     * create + 依赖 + submit
+     */
+    JobHandle schedule(std::function<void()> function, Priority priority = Priority::Normal,
+                       std::initializer_list<JobHandle> dependencies = {});
+    
+    /**
+     * 等待任务完成，期间调用线程执行排队中的任务（非工作线程只执行 High 优先级的）
+     */
+    void wait(const JobHandle& job);
+    static bool isDone(const JobHandle& job);
+    
+    /**
+     * 在调用线程上执行一个排队中的任务（非工作线程只取 High 优先级的）；没有任务时返回 false
+     */
+    bool runOne();
+    
+    /**
+     * 把 [0, count) 切成不小于 minChunk 的段并行执行 fn(begin, end)，返回时全部完成
+     * maxParallelism 限制段数（0 表示不限制，按线程数 + 1 切分）
+     */
+    template <typename Fn>
+    void parallelFor(size_t count, size_t minChunk, Fn&& fn, unsigned maxParallelism = 0, Priority priority = Priority::High);
+    
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()); }
+    Stats getStats() const;
+    
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs[kPriorityCount];
+    };
+    
+    void workerLoop(unsigned index);
+    void enqueue(JobHandle job);
+    JobHandle take(int self, int lowestPriority);
+    void notifyHelpers();
+    void execute(const JobHandle& job);
+    void finish(const JobHandle& job);
+    
+    std::vector<std::unique_ptr<WorkerQueue>> queues;   // 每个工作线程一个，外部线程提交时轮流放入
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue;
+    std::atomic<size_t> queuedJobs;
+    
+    // 空闲工作线程的休眠/唤醒
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    std::atomic<unsigned> sleepingWorkers;
+    std::atomic<bool> stopping;
+    
+    // 在 wait 中阻塞的非工作线程：任务完成或 High 任务入队时唤醒
+    std::mutex helperMutex;
+    std::condition_variable helperWakeup;
+    std::atomic<unsigned> blockedHelpers;
+    std::atomic<uint64_t> helperSignal;
+    
+    std::atomic<uint64_t> executed, stolen, cancelled;
+};
+
+class JobSystem::Job
+{
+public:
+    Priority getPriority() const { return priority; }
+    bool isDone() const { return done.load(std::memory_order_acquire); }
+    
+private:
+    friend class JobSystem;
+    
+    std::function<void()> function;
+    Priority priority = Priority::Normal;
+    std::shared_ptr<const CancellationToken> token;
+    
+    // 未完成的依赖数 + 1（submit 前的占位），减到 0 时入队
+    std::atomic<int> remaining{ 1 };
+    std::mutex mutex;                      // 保护 dependents 与 done 的交接
+    std::vector<JobHandle> dependents;
+    std::atomic<bool> done{ false };
+};
+
+template <typename Fn>
+void JobSystem::parallelFor(size_t count, size_t minChunk, Fn&& fn, unsigned maxParallelism, Priority priority)
+{
+    size_t parts = maxParallelism > 0 ? maxParallelism : workers.size() + 1;
+    parts = std::min(parts, count / std::max<size_t>(1, minChunk));
+    if (parts <= 1)
+    {
+        fn(size_t(0), count);
+        return;
+    }
+    
+    // 第一段在调用线程执行，其余段作为 join 任务的依赖
+    size_t span = (count + parts - 1) / parts;
+    JobHandle join = create([]() {}, priority);
+    for (size_t begin = span; begin < count; begin += span)
+    {
+        size_t end = std::min(count, begin + span);
+        JobHandle part = create([&fn, begin, end]() { fn(begin, end); }, priority);
+        addDependency(join, part);
+        submit(part);
+    }
+    submit(join);
+    fn(size_t(0), std::min(count, span));
+    wait(join);
+}
@@ -0,0 +1,376 @@
+#include "LabelPlacer.h"
+
+#include "BatchProjector.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+LabelPlacer::LabelPlacer()
+    : LabelPlacer(Options())
+{
+}
+
+LabelPlacer::LabelPlacer(const Options& options)
+    : options(options)
+    , grid(options.cellSize)
+{
+}
+
+uint32_t LabelPlacer::add(const Candidate& candidate)
+{
+    uint32_t handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<uint32_t>(candidates.size());
+        candidates.emplace_back();
+        lon.push_back(0.0f);
+        lat.push_back(0.0f);
+        alive.push_back(0);
+        screenX.push_back(0.0f);
+        screenY.push_back(0.0f);
+        depth.push_back(0.0f);
+        inView.push_back(0);
+        target.push_back(0);
+        opacity.push_back(0.0f);
+        gridEntries.push_back(CollisionGrid::kInvalidEntry);
+    }
+    candidates[handle] = candidate;
+    lon[handle] = candidate.lon;
+    lat[handle] = candidate.lat;
+    alive[handle] = 1;
+    inView[handle] = 0;
+    target[handle] = 0;
+    opacity[handle] = 0.0f;
+    gridEntries[handle] = CollisionGrid::kInvalidEntry;
+    if (handle < placedBefore.size())
+    {
+        placedBefore[handle] = 0;
+    }
+    added.push_back(handle);
+    ++stats.candidates;
+    return handle;
+}
+
+void LabelPlacer::remove(uint32_t handle)
+{
+    if (handle >= alive.size() || !alive[handle])
+    {
+        return;
+    }
+    alive[handle] = 0;
+    if (gridEntries[handle] != CollisionGrid::kInvalidEntry)
+    {
+        grid.remove(gridEntries[handle]);
+        gridEntries[handle] = CollisionGrid::kInvalidEntry;
+        retryBlocked = true;
+    }
+    if (target[handle])
+    {
+        --stats.placed;
+    }
+    target[handle] = 0;
+    opacity[handle] = 0.0f;
+    removedHandles.push_back(handle);
+    --stats.candidates;
+}
+
+void LabelPlacer::clear()
+{
+    candidates.clear();
+    lon.clear();
+    lat.clear();
+    alive.clear();
+    screenX.clear();
+    screenY.clear();
+    depth.clear();
+    inView.clear();
+    target.clear();
+    opacity.clear();
+    gridEntries.clear();
+    placedBefore.clear();
+    order.clear();
+    added.clear();
+    freeHandles.clear();
+    removedHandles.clear();
+    visible.clear();
+    retryBlocked = false;
+    lastState.reset();
+    stats = Stats();
+}
+
+bool LabelPlacer::orderBefore(uint32_t a, uint32_t b) const
+{
+    const Candidate& ca = candidates[a];
+    const Candidate& cb = candidates[b];
+    if (ca.priority != cb.priority)
+    {
+        return ca.priority > cb.priority;
+    }
+    if (ca.id != cb.id)
+    {
+        return ca.id < cb.id;
+    }
+    return a < b;
+}
+
+void LabelPlacer::rebuildOrder()
+{
+    // 删除的句柄移出 order 之后才能复用，否则同一句柄会在 order 中出现两次
+    if (!removedHandles.empty())
+    {
+        order.erase(std::remove_if(order.begin(), order.end(), [&](uint32_t handle) { return !alive[handle]; }), order.end());
+        freeHandles.insert(freeHandles.end(), removedHandles.begin(), removedHandles.end());
+        removedHandles.clear();
+    }
+    // 加入后未经 update 就删除的不进入 order
+    added.erase(std::remove_if(added.begin(), added.end(), [&](uint32_t handle) { return !alive[handle]; }), added.end());
+    if (!added.empty())
+    {
+        auto less = [&](uint32_t a, uint32_t b) { return orderBefore(a, b); };
+        std::sort(added.begin(), added.end(), less);
+        size_t middle = order.size();
+        order.insert(order.end(), added.begin(), added.end());
+        std::inplace_merge(order.begin(), order.begin() + middle, order.end(), less);
+    }
+}
+
+void LabelPlacer::project(const std::vector<uint32_t>* subset)
+{
+    auto start = std::chrono::steady_clock::now();
+    BatchProjector projector(lastState, lastWidth, lastHeight);
+    if (!subset)
+    {
+        BatchProjector::ScreenOutput out;
+        out.x = screenX.data();
+        out.y = screenY.data();
+        out.depth = depth.data();
+        out.visible = inView.data();
+        projector.projectToScreen(lon.data(), lat.data(), lon.size(), out, options.threadCount);
+    }
+    else
+    {
+        // 新增的候选分散在各处，收集到连续数组后投影
+        const size_t count = subset->size();
+        std::vector<float> subsetLon(count), subsetLat(count), x(count), y(count), z(count);
+        std::vector<uint8_t> mask(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            subsetLon[i] = lon[(*subset)[i]];
+            subsetLat[i] = lat[(*subset)[i]];
+        }
+        BatchProjector::ScreenOutput out;
+        out.x = x.data();
+        out.y = y.data();
+        out.depth = z.data();
+        out.visible = mask.data();
+        projector.projectToScreen(subsetLon.data(), subsetLat.data(), count, out, options.threadCount);
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t handle = (*subset)[i];
+            screenX[handle] = x[i];
+            screenY[handle] = y[i];
+            depth[handle] = z[i];
+            inView[handle] = mask[i];
+        }
+    }
+    stats.projectMilliseconds = millisecondsSince(start);
+}
+
+void LabelPlacer::tryPlace(uint32_t handle)
+{
+    ++stats.tested;
+    if (!inView[handle])
+    {
+        // clipping Z 把球背面的点推到远平面之外
+        ++(depth[handle] > 1.0f ? stats.beyondHorizon : stats.outsideView);
+        return;
+    }
+    
+    const Candidate& candidate = candidates[handle];
+    const glm::vec2 center = glm::vec2(screenX[handle], screenY[handle]) + candidate.offset;
+    if (candidate.shape == Shape::Circle)
+    {
+        const float radius = candidate.size.x + options.padding;
+        if (!candidate.allowOverlap && grid.hitTestCircle(center, radius))
+        {
+            reject(handle, glm::vec4(center - radius, center + radius));
+            return;
+        }
+        gridEntries[handle] = grid.insertCircle(center, radius, handle);
+    }
+    else
+    {
+        const glm::vec2 half = candidate.size * 0.5f + options.padding;
+        const glm::vec4 box(center - half, center + half);
+        if (!candidate.allowOverlap && grid.hitTestBox(box))
+        {
+            reject(handle, box);
+            return;
+        }
+        gridEntries[handle] = grid.insertBox(box, handle);
+    }
+    target[handle] = 1;
+    ++stats.placed;
+}
+
+void LabelPlacer::reject(uint32_t handle, const glm::vec4& bounds)
+{
+    ++stats.collided;
+    if (!checkBlockers || blockedByLower)
+    {
+        return;
+    }
+    // 整体放置时优先级更低的条目排在后面，挡不住它。外接框的查询可能多报圆形，多报只会多一次整体放置
+    blockers.clear();
+    grid.queryBox(bounds, blockers);
+    const float priority = candidates[handle].priority;
+    for (uint32_t blocker : blockers)
+    {
+        if (candidates[blocker].priority < priority)
+        {
+            blockedByLower = true;
+            return;
+        }
+    }
+}
+
+void LabelPlacer::placeAll()
+{
+    rebuildOrder();
+    added.clear();
+    retryBlocked = false;
+    placedBefore.swap(target);
+    target.assign(candidates.size(), 0);
+    std::fill(gridEntries.begin(), gridEntries.end(), CollisionGrid::kInvalidEntry);
+    grid.reset(static_cast<float>(lastWidth), static_cast<float>(lastHeight));
+    stats.placed = 0;
+    placeInOrder(order, placedBefore);
+}
+
+void LabelPlacer::placeInOrder(const std::vector<uint32_t>& handles, const std::vector<uint8_t>& placedBefore)
+{
+    // 同一优先级分两遍：上一次已放置的先放，保持它们的位置，再放其余的
+    for (size_t begin = 0; begin < handles.size();)
+    {
+        const float priority = candidates[handles[begin]].priority;
+        size_t end = begin + 1;
+        while (end < handles.size() && candidates[handles[end]].priority == priority)
+        {
+            ++end;
+        }
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                uint32_t handle = handles[i];
+                bool before = handle < placedBefore.size() && placedBefore[handle];
+                if (alive[handle] && before == (pass == 0))
+                {
+                    tryPlace(handle);
+                }
+            }
+        }
+        begin = end;
+    }
+}
+
+void LabelPlacer::update(std::shared_ptr<const ProjectionState> state, int viewportWidth, int viewportHeight)
+{
+    PROFILE_ZONE("LabelPlacer::update");
+    
+    const bool full = state != lastState || viewportWidth != lastWidth || viewportHeight != lastHeight;
+    lastState = std::move(state);
+    lastWidth = viewportWidth;
+    lastHeight = viewportHeight;
+    stats.incremental = !full;
+    stats.tested = 0;
+    stats.outsideView = 0;
+    stats.beyondHorizon = 0;
+    stats.collided = 0;
+    stats.projectMilliseconds = 0.0;
+    
+    if (full)
+    {
+        project(nullptr);
+        auto start = std::chrono::steady_clock::now();
+        placeAll();
+        stats.placeMilliseconds = millisecondsSince(start);
+        return;
+    }
+    
+    // 增量：新增的候选放入现有网格；有删除时之前被挡住的候选再试一次
+    auto start = std::chrono::steady_clock::now();
+    checkBlockers = true;
+    blockedByLower = false;
+    std::vector<uint32_t> newHandles;
+    newHandles.swap(added);
+    if (!newHandles.empty())
+    {
+        project(&newHandles);
+        std::sort(newHandles.begin(), newHandles.end(), [&](uint32_t a, uint32_t b) { return orderBefore(a, b); });
+        placeInOrder(newHandles, {});
+        added.swap(newHandles);
+        rebuildOrder();
+        added.clear();
+    }
+    if (retryBlocked && !blockedByLower)
+    {
+        retryBlocked = false;
+        for (uint32_t handle : order)
+        {
+            if (alive[handle] && !target[handle] && inView[handle])
+            {
+                tryPlace(handle);
+            }
+        }
+    }
+    checkBlockers = false;
+    if (blockedByLower)
+    {
+        // 投影仍然有效，只重新放置；统计改为描述这次整体放置
+        stats.incremental = false;
+        stats.tested = 0;
+        stats.outsideView = 0;
+        stats.beyondHorizon = 0;
+        stats.collided = 0;
+        placeAll();
+    }
+    stats.placeMilliseconds = millisecondsSince(start) - stats.projectMilliseconds;
+}
+
+void LabelPlacer::advance(float seconds)
+{
+    const float step = options.fadeDuration > 0.0f ? seconds / options.fadeDuration : 1.0f;
+    visible.clear();
+    stats.fading = 0;
+    for (size_t handle = 0; handle < candidates.size(); ++handle)
+    {
+        if (!alive[handle])
+        {
+            continue;
+        }
+        float& value = opacity[handle];
+        value = target[handle] ? std::min(1.0f, value + step) : std::max(0.0f, value - step);
+        if (value > 0.0f && value < 1.0f)
+        {
+            ++stats.fading;
+        }
+        if (value > 0.0f && inView[handle])
+        {
+            visible.push_back({ static_cast<uint32_t>(handle), candidates[handle].id, glm::vec2(screenX[handle], screenY[handle]), value });
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include "CollisionGrid.h"
+#include "ProjectionState.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * 标注 / 图标的屏幕空间放置：碰撞检测 + 淡入淡出（不依赖 GL）
+ *
+ * - 锚点用 BatchProjector 投影，数学与顶点 shader 相同（Globe/Mercator 混合、clipping Z、视锥测试），
+ *   在球背面（被裁剪平面推到远平面之外）或视口外的锚点在碰撞检测之前直接排除
+ * - 按优先级从高到低放进 CollisionGrid；同一优先级内上一次已放置的先放、再按 id，
+ *   相机连续移动时结果稳定，不会在相互遮挡的标注之间来回切换
+ * - 放置结果只决定目标不透明度，实际不透明度按 fadeDuration 线性过渡；淡出中的标注不再占用网格
+ * - 相机（ProjectionState 快照）和视口不变时，update 只处理增量：新增的候选按优先级放入现有网格，
+ *   删除的候选释放它的网格条目，之前被挡住的候选再尝试一次；相机变化时整体重新放置。
+ *   增量中某个候选被优先级更低的条目挡住时（整体放置会先放它），改为不重新投影的整体放置，
+ *   因此增量的结果总是与整体重新放置相同
+ */
+class LabelPlacer
+{
+public:
+    static constexpr uint32_t kInvalidHandle = UINT32_MAX;
+    
+    enum class Shape : uint8_t
+    {
+        Box,
+        Circle
+    };
+    
+    struct Candidate
+    {
+        float lon = 0.0f;                       // 锚点（度）
+        float lat = 0.0f;
+        Shape shape = Shape::Box;
+        glm::vec2 size = glm::vec2(0.0f);       // Box：宽高（像素）；Circle：x 为半径
+        glm::vec2 offset = glm::vec2(0.0f);     // 形状中心相对锚点的偏移（像素，y 向下）
+        float priority = 0.0f;                  // 越大越先放置
+        uint32_t id = 0;                        // 调用方的 id，同优先级时的次序
+        bool allowOverlap = false;              // 不做碰撞测试、总是显示（仍占用网格）
+    };
+    
+    struct Options
+    {
+        float cellSize = 64.0f;         // 碰撞网格的格子大小（像素）
+        float padding = 2.0f;           // 形状四周额外留出的间距（像素）
+        float fadeDuration = 0.3f;      // 从完全不透明到完全透明的时间（秒），0 表示立即切换
+        unsigned threadCount = 1;       // 投影锚点的最大并行段数（BatchProjector）
+    };
+    
+    /**
+     * 本帧要绘制的标注（不透明度大于 0 且锚点可见）
+     */
+    struct Visible
+    {
+        uint32_t handle;
+        uint32_t id;
+        glm::vec2 screen;               // 锚点的屏幕坐标（像素，原点在左上角）
+        float opacity;
+    };
+    
+    struct Stats
+    {
+        bool incremental = false;       // 最近一次 update 是否只处理了增量
+        size_t candidates = 0;
+        size_t tested = 0;              // 最近一次 update 尝试放置的候选
+        size_t placed = 0;              // 当前放置的（目标不透明度为 1）
+        size_t outsideView = 0;         // 最近一次 update 中锚点在视口外的
+        size_t beyondHorizon = 0;       // 最近一次 update 中锚点在球背面的
+        size_t collided = 0;            // 最近一次 update 中因碰撞未放置的
+        size_t fading = 0;              // 不透明度在 (0, 1) 之间的
+        double projectMilliseconds = 0.0;
+        double placeMilliseconds = 0.0;
+    };
+    
+    LabelPlacer();
+    explicit LabelPlacer(const Options& options);
+    
+    /**
+     * 新增候选，返回句柄；新候选从完全透明淡入
+     */
+    uint32_t add(const Candidate& candidate);
+    void remove(uint32_t handle);
+    void clear();
+    
+    /**
+     * 每帧调用一次：按本帧的投影状态和视口（像素）放置
+     */
+    void update(std::shared_ptr<const ProjectionState> state, int viewportWidth, int viewportHeight);
+    
+    /**
+     * 推进淡入淡出并生成本帧的可见列表
+     */
+    void advance(float seconds);
+    
+    const std::vector<Visible>& getVisible() const { return visible; }
+    bool isPlaced(uint32_t handle) const { return handle < alive.size() && alive[handle] && target[handle]; }
+    float getOpacity(uint32_t handle) const { return handle < alive.size() && alive[handle] ? opacity[handle] : 0.0f; }
+    const Candidate& getCandidate(uint32_t handle) const { return candidates[handle]; }
+    glm::vec2 getScreenPosition(uint32_t handle) const { return glm::vec2(screenX[handle], screenY[handle]); }
+    size_t getHandleCount() const { return candidates.size(); }
+    const CollisionGrid& getGrid() const { return grid; }
+    const Options& getOptions() const { return options; }
+    const Stats& getStats() const { return stats; }
+    
+private:
+    bool orderBefore(uint32_t a, uint32_t b) const;
+    void project(const std::vector<uint32_t>* subset);
+    void placeInOrder(const std::vector<uint32_t>& handles, const std::vector<uint8_t>& placedBefore);
+    void tryPlace(uint32_t handle);
+    void reject(uint32_t handle, const glm::vec4& bounds);
+    void placeAll();
+    void rebuildOrder();
+    
+    Options options;
+    Stats stats;
+    CollisionGrid grid;
+    
+    // 按句柄索引（SoA），lon / lat 直接作为 BatchProjector 的输入
+    std::vector<Candidate> candidates;
+    std::vector<float> lon;
+    std::vector<float> lat;
+    std::vector<uint8_t> alive;
+    std::vector<float> screenX;
+    std::vector<float> screenY;
+    std::vector<float> depth;               // NDC z，背面的锚点大于 1
+    std::vector<uint8_t> inView;            // 锚点在裁剪体内
+    std::vector<uint8_t> target;            // 已放置（目标不透明度为 1）
+    std::vector<float> opacity;
+    std::vector<uint32_t> gridEntries;
+    
+    std::vector<uint32_t> order;            // 放置次序：优先级从高到低、id 从小到大（可能含已删除的句柄）
+    std::vector<uint32_t> added;            // 上次 update 之后新增的
+    std::vector<uint32_t> freeHandles;      // 可以复用的句柄（已从 order 中移除）
+    std::vector<uint32_t> removedHandles;   // 已删除、仍留在 order 中的句柄，下次整体放置时回收
+    bool retryBlocked = false;
+    bool checkBlockers = false;             // 增量放置中：被挡住时检查挡住它的条目的优先级
+    bool blockedByLower = false;            // 增量放置中有候选被优先级更低的条目挡住
+    std::vector<uint32_t> blockers;
+    std::vector<uint8_t> placedBefore;      // 整体放置时上一次的放置结果
+    std::vector<Visible> visible;
+    
+    std::shared_ptr<const ProjectionState> lastState;
+    int lastWidth = 0;
+    int lastHeight = 0;
+};
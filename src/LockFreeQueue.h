@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * 有界多生产者多消费者无锁队列（Dmitry Vyukov 的 bounded MPMC 算法）
+ *
+ * - 容量向上取整到 2 的幂，构造时一次性分配，运行中不再分配内存
+ * - 每个 cell 带一个序号：生产者/消费者各自 CAS 推进位置，再通过序号交接数据，
+ *   不需要任何锁，push/pop 在队列满/空时立即返回 false
+ * - T 需要可默认构造和移动赋值
+ */
+template <typename T>
+class LockFreeQueue
+{
+public:
+    explicit LockFreeQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePosition.store(0, std::memory_order_relaxed);
+        dequeuePosition.store(0, std::memory_order_relaxed);
+    }
+    
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+    
+    /**
+     * 入队；队列已满时返回 false，value 保持不变
+     */
+    bool push(T&& value)
+    {
+        Cell* cell;
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    
+    bool push(const T& value)
+    {
+        T copy = value;
+        return push(std::move(copy));
+    }
+    
+    /**
+     * 出队；队列为空时返回 false
+     */
+    bool pop(T& value)
+    {
+        Cell* cell;
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0)
+            {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->value = T();
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+    
+    size_t capacity() const { return mask + 1; }
+    
+    /**
+     * 近似元素数（并发修改时只作参考）
+     */
+    size_t sizeApprox() const
+    {
+        size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+        size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+    
+    bool emptyApprox() const { return sizeApprox() == 0; }
+    
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    // 生产者和消费者的位置分别独占缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> enqueuePosition;
+    alignas(64) std::atomic<size_t> dequeuePosition;
+};
@@ -0,0 +1,263 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Protocol Buffers 线格式的只读解析器（不分配内存，不复制数据）
+ *
+ * 只是一对指针上的游标：next 读取下一个字段的编号和线类型，再按类型调用 varint / fixed32 /
+ * bytes / message 等读取值，不需要的字段用 skip 跳过。嵌套消息和 packed 数组返回指向原缓冲区的子视图。
+ *
+ * 数据损坏（越界、未知线类型、varint 过长）时设置 hasError，之后 next 总是返回 false；
+ * 读取函数在出错时返回 0 / 空视图，调用方只需在循环结束后检查一次 hasError。
+ */
+class PbfReader
+{
+public:
+    enum WireType : uint32_t
+    {
+        Varint = 0,
+        Fixed64 = 1,
+        LengthDelimited = 2,
+        Fixed32 = 5,
+    };
+    
+    /**
+     * packed repeated uint32（例如 MVT 的 geometry 和 tags）：逐个读取的视图
+     */
+    class PackedUint32
+    {
+    public:
+        PackedUint32() = default;
+        PackedUint32(const uint8_t* begin, const uint8_t* end) : cursor(begin), end(end) {}
+        
+        bool empty() const { return cursor >= end; }
+        bool hasError() const { return error; }
+        
+        /**
+         * 读取下一个值；没有更多值或数据损坏时返回 false
+         */
+        bool next(uint32_t& value)
+        {
+            uint64_t result = 0;
+            if (cursor >= end)
+            {
+                return false;
+            }
+            if (!readVarint(cursor, end, result))
+            {
+                error = true;
+                cursor = end;
+                return false;
+            }
+            value = static_cast<uint32_t>(result);
+            return true;
+        }
+        
+    private:
+        const uint8_t* cursor = nullptr;
+        const uint8_t* end = nullptr;
+        bool error = false;
+    };
+    
+    PbfReader() = default;
+    PbfReader(const uint8_t* data, size_t size) : cursor(data), end(data + size) {}
+    
+    /**
+     * 前进到下一个字段；到达末尾或出错时返回 false
+     */
+    bool next()
+    {
+        if (error || cursor >= end)
+        {
+            return false;
+        }
+        uint64_t key = 0;
+        if (!readVarint(cursor, end, key) || (key >> 3) == 0)
+        {
+            return fail();
+        }
+        fieldTag = static_cast<uint32_t>(key >> 3);
+        fieldType = static_cast<uint32_t>(key & 7);
+        if (fieldType != Varint && fieldType != Fixed64 && fieldType != LengthDelimited && fieldType != Fixed32)
+        {
+            return fail();
+        }
+        return true;
+    }
+    
+    /**
+     * 前进到下一个编号为 tag 的字段，跳过其他字段
+     */
+    bool next(uint32_t tag)
+    {
+        while (next())
+        {
+            if (fieldTag == tag)
+            {
+                return true;
+            }
+            skip();
+        }
+        return false;
+    }
+    
+    uint32_t tag() const { return fieldTag; }
+    uint32_t wireType() const { return fieldType; }
+    bool hasError() const { return error; }
+    
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        if (fieldType != Varint || !readVarint(cursor, end, value))
+        {
+            fail();
+            return 0;
+        }
+        return value;
+    }
+    
+    uint32_t uint32() { return static_cast<uint32_t>(varint()); }
+    int64_t int64() { return static_cast<int64_t>(varint()); }
+    bool boolean() { return varint() != 0; }
+    
+    /**
+     * sint32 / sint64（zigzag 编码）
+     */
+    int64_t svarint()
+    {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+    
+    uint32_t fixed32()
+    {
+        uint32_t value = 0;
+        if (fieldType != Fixed32 || end - cursor < 4)
+        {
+            fail();
+            return 0;
+        }
+        std::memcpy(&value, cursor, 4);   // 小端，与目标平台一致
+        cursor += 4;
+        return value;
+    }
+    
+    uint64_t fixed64()
+    {
+        uint64_t value = 0;
+        if (fieldType != Fixed64 || end - cursor < 8)
+        {
+            fail();
+            return 0;
+        }
+        std::memcpy(&value, cursor, 8);
+        cursor += 8;
+        return value;
+    }
+    
+    float floatValue()
+    {
+        uint32_t bits = fixed32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    double doubleValue()
+    {
+        uint64_t bits = fixed64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    /**
+     * length-delimited 字段的原始字节（字符串、嵌套消息、packed 数组），指向原缓冲区
+     */
+    bool bytes(const uint8_t*& data, size_t& size)
+    {
+        uint64_t length = 0;
+        if (fieldType != LengthDelimited || !readVarint(cursor, end, length) || length > static_cast<uint64_t>(end - cursor))
+        {
+            fail();
+            data = nullptr;
+            size = 0;
+            return false;
+        }
+        data = cursor;
+        size = static_cast<size_t>(length);
+        cursor += size;
+        return true;
+    }
+    
+    PbfReader message()
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        bytes(data, size);
+        return PbfReader(data, size);
+    }
+    
+    PackedUint32 packedUint32()
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        bytes(data, size);
+        return PackedUint32(data, data + size);
+    }
+    
+    void skip()
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        switch (fieldType)
+        {
+        case Varint:
+            varint();
+            break;
+        case Fixed64:
+            fixed64();
+            break;
+        case LengthDelimited:
+            bytes(data, size);
+            break;
+        case Fixed32:
+            fixed32();
+            break;
+        default:
+            fail();
+            break;
+        }
+    }
+    
+    static bool readVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && cursor < end; shift += 7)
+        {
+            uint8_t byte = *cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+private:
+    bool fail()
+    {
+        error = true;
+        cursor = end;
+        return false;
+    }
+    
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+    uint32_t fieldTag = 0;
+    uint32_t fieldType = 0;
+    bool error = false;
+};
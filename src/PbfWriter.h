@@ -0,0 +1,65 @@
+#pragma once
+#include "PbfReader.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Protocol Buffers 线格式的最小写入器（PbfReader 的反方向）
+ *
+ * 字段按调用顺序追加到 data；嵌套消息先写入另一个 PbfWriter，再用 messageField 作为长度前缀的字节写入。
+ */
+class PbfWriter
+{
+public:
+    /**
+     * sint32 的 zigzag 编码（MVT 几何的坐标增量也使用它）
+     */
+    static uint32_t zigzag(int32_t value)
+    {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+    
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            data.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        data.push_back(static_cast<uint8_t>(value));
+    }
+    
+    void key(uint32_t tag, uint32_t wireType) { varint((static_cast<uint64_t>(tag) << 3) | wireType); }
+    void uint32Field(uint32_t tag, uint32_t value)
+    {
+        key(tag, PbfReader::Varint);
+        varint(value);
+    }
+    
+    void bytesField(uint32_t tag, const void* bytes, size_t size)
+    {
+        key(tag, PbfReader::LengthDelimited);
+        varint(size);
+        const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+        data.insert(data.end(), begin, begin + size);
+    }
+    
+    void stringField(uint32_t tag, const std::string& text) { bytesField(tag, text.data(), text.size()); }
+    void messageField(uint32_t tag, const PbfWriter& message) { bytesField(tag, message.data.data(), message.data.size()); }
+    
+    void packedField(uint32_t tag, const std::vector<uint32_t>& values)
+    {
+        PbfWriter packed;
+        for (uint32_t value : values)
+        {
+            packed.varint(value);
+        }
+        messageField(tag, packed);
+    }
+    
+    void clear() { data.clear(); }
+    
+    std::vector<uint8_t> data;
+};
@@ -0,0 +1,758 @@
+#include "PointClusterIndex.h"
+
+#include "Constants.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMaxLatitude = 85.051128779806604;   // 墨卡托 y 在 [0, 1] 内的纬度范围
+constexpr double kFixedScale = 4294967296.0;           // 2^32：归一化墨卡托 -> 定点
+constexpr int8_t kNotAbsorbed = -1;
+constexpr size_t kParallelSortMin = 1 << 16;           // 小于此数的子树不再拆成并行任务
+constexpr size_t kParallelClusterMin = 1 << 14;        // 可见实体少于此数的层级顺序聚类
+constexpr size_t kProjectChunk = 1 << 16;
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t toFixed(double value)
+{
+    return static_cast<uint32_t>(std::clamp(value * kFixedScale, 0.0, kFixedScale - 1.0));
+}
+
+double fromFixed(uint32_t value)
+{
+    return value / kFixedScale;
+}
+
+uint32_t projectX(float lon)
+{
+    double x = lon / 360.0 + 0.5;
+    return toFixed(x - std::floor(x));
+}
+
+uint32_t projectY(float lat)
+{
+    double phi = std::clamp(static_cast<double>(lat), -kMaxLatitude, kMaxLatitude) * kPi / 180.0;
+    return toFixed(0.5 - std::log(std::tan(kPi / 4.0 + phi / 2.0)) / (2.0 * kPi));
+}
+
+/**
+ * 隐式 KD 树的遍历：[begin, end) 的中位数 m 是节点，左右子树为 [begin, m) 和 [m + 1, end)，
+ * 不超过 nodeSize 的子树是叶子。coord(i, axis) 读取第 i 项的坐标，visit(i) 处理框内的项
+ */
+template <typename Coord, typename Visit>
+void queryRange(size_t size, uint32_t nodeSize, uint32_t minX, uint32_t minY, uint32_t maxX, uint32_t maxY,
+                const Coord& coord, const Visit& visit)
+{
+    struct Node
+    {
+        size_t begin;
+        size_t end;
+        int axis;
+    };
+    
+    std::array<Node, 128> stack;
+    size_t top = 0;
+    stack[top++] = { 0, size, 0 };
+    while (top > 0)
+    {
+        Node node = stack[--top];
+        if (node.end - node.begin <= nodeSize)
+        {
+            for (size_t i = node.begin; i < node.end; ++i)
+            {
+                uint32_t px = coord(i, 0);
+                uint32_t py = coord(i, 1);
+                if (px >= minX && px <= maxX && py >= minY && py <= maxY)
+                {
+                    visit(i);
+                }
+            }
+            continue;
+        }
+        
+        size_t m = node.begin + (node.end - node.begin) / 2;
+        uint32_t px = coord(m, 0);
+        uint32_t py = coord(m, 1);
+        if (px >= minX && px <= maxX && py >= minY && py <= maxY)
+        {
+            visit(m);
+        }
+        uint32_t split = node.axis == 0 ? px : py;
+        if ((node.axis == 0 ? minX : minY) <= split)
+        {
+            stack[top++] = { node.begin, m, 1 - node.axis };
+        }
+        if ((node.axis == 0 ? maxX : maxY) >= split)
+        {
+            stack[top++] = { m + 1, node.end, 1 - node.axis };
+        }
+    }
+}
+
+/**
+ * 圆内查询：先按外接框遍历，再按距离过滤（double，定点坐标差的平方超出 64 位整数）
+ */
+template <typename Coord, typename Visit>
+void queryWithin(size_t size, uint32_t nodeSize, uint32_t qx, uint32_t qy, double radius, const Coord& coord, const Visit& visit)
+{
+    auto lower = [&](uint32_t v) { return static_cast<uint32_t>(std::max(0.0, std::ceil(v - radius))); };
+    auto upper = [&](uint32_t v) { return static_cast<uint32_t>(std::min(kFixedScale - 1.0, std::floor(v + radius))); };
+    double r2 = radius * radius;
+    queryRange(size, nodeSize, lower(qx), lower(qy), upper(qx), upper(qy), coord, [&](size_t i) {
+        double dx = static_cast<double>(coord(i, 0)) - qx;
+        double dy = static_cast<double>(coord(i, 1)) - qy;
+        if (dx * dx + dy * dy <= r2)
+        {
+            visit(i);
+        }
+    });
+}
+
+/**
+ * 归一化坐标的查询框转换为定点（闭区间），框与 [0, 1] 不相交时返回 false
+ */
+bool toFixedBox(double minX, double minY, double maxX, double maxY, std::array<uint32_t, 4>& box)
+{
+    if (maxX < 0.0 || maxY < 0.0 || minX >= 1.0 || minY >= 1.0 || minX > maxX || minY > maxY)
+    {
+        return false;
+    }
+    auto lower = [](double v) { return static_cast<uint32_t>(std::clamp(std::ceil(v * kFixedScale), 0.0, kFixedScale - 1.0)); };
+    auto upper = [](double v) { return static_cast<uint32_t>(std::clamp(std::floor(v * kFixedScale), 0.0, kFixedScale - 1.0)); };
+    box = { lower(minX), lower(minY), upper(maxX), upper(maxY) };
+    return true;
+}
+}
+
+PointClusterIndex::PointClusterIndex()
+    : PointClusterIndex(Options())
+{
+}
+
+PointClusterIndex::PointClusterIndex(const Options& options)
+    : options(options)
+{
+    this->options.maxZoom = std::clamp(options.maxZoom, 0, 30);
+    this->options.minZoom = std::clamp(options.minZoom, 0, this->options.maxZoom);
+    this->options.minPoints = std::max<uint32_t>(options.minPoints, 2);
+    this->options.nodeSize = std::max<uint32_t>(options.nodeSize, 1);
+}
+
+JobSystem& PointClusterIndex::jobs() const
+{
+    return options.jobSystem ? *options.jobSystem : JobSystem::shared();
+}
+
+int PointClusterIndex::parallelDepth() const
+{
+    if (options.maxParallelism == 1)
+    {
+        return 0;
+    }
+    // 子树数为并行段数的 4 倍左右，段之间的负载差异可以互相抵消
+    unsigned parts = options.maxParallelism > 0 ? options.maxParallelism : jobs().getThreadCount() + 1;
+    int depth = 2;
+    while ((1u << depth) < parts * 4 && depth < 16)
+    {
+        ++depth;
+    }
+    return depth;
+}
+
+void PointClusterIndex::sortItems(Item* items, size_t begin, size_t end, int axis, int depth) const
+{
+    if (end - begin <= options.nodeSize)
+    {
+        return;
+    }
+    
+    size_t m = begin + (end - begin) / 2;
+    if (axis == 0)
+    {
+        std::nth_element(items + begin, items + m, items + end, [](const Item& a, const Item& b) { return a.x < b.x; });
+    }
+    else
+    {
+        std::nth_element(items + begin, items + m, items + end, [](const Item& a, const Item& b) { return a.y < b.y; });
+    }
+    
+    if (depth > 0 && end - begin >= kParallelSortMin)
+    {
+        jobs().parallelFor(2, 1, [&](size_t first, size_t last) {
+            for (size_t half = first; half < last; ++half)
+            {
+                if (half == 0)
+                {
+                    sortItems(items, begin, m, 1 - axis, depth - 1);
+                }
+                else
+                {
+                    sortItems(items, m + 1, end, 1 - axis, depth - 1);
+                }
+            }
+        }, 2);
+    }
+    else
+    {
+        sortItems(items, begin, m, 1 - axis, 0);
+        sortItems(items, m + 1, end, 1 - axis, 0);
+    }
+}
+
+void PointClusterIndex::build(const float* lon, const float* lat, size_t count)
+{
+    PROFILE_ZONE("PointClusterIndex::build");
+    
+    count = std::min(count, kMaxPoints);
+    pointCount = static_cast<uint32_t>(count);
+    x.clear();
+    y.clear();
+    parents.clear();
+    absorbed.clear();
+    sources.clear();
+    counts.clear();
+    origins.clear();
+    clusterBegin.assign(options.maxZoom + 2, 0);
+    clusterEnd.assign(options.maxZoom + 2, 0);
+    snapshots.assign(options.maxZoom + 2, {});
+    stats = Stats();
+    stats.points = count;
+    stats.visible.assign(options.maxZoom + 2, 0);
+    
+    // 投影 + 原始点的 KD 排序
+    auto start = std::chrono::steady_clock::now();
+    unsigned parallelism = options.maxParallelism;
+    int depth = parallelDepth();
+    std::vector<Item> visible(count);
+    jobs().parallelFor(count, kProjectChunk, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            visible[i] = { projectX(lon[i]), projectY(lat[i]), static_cast<uint32_t>(i) };
+        }
+    }, parallelism);
+    sortItems(visible.data(), 0, count, 0, depth);
+    
+    x.resize(count);
+    y.resize(count);
+    sources.resize(count);
+    parents.assign(count, 0);
+    absorbed.assign(count, kNotAbsorbed);
+    jobs().parallelFor(count, kProjectChunk, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            x[i] = visible[i].x;
+            y[i] = visible[i].y;
+            sources[i] = visible[i].id;
+            visible[i].id = static_cast<uint32_t>(i);
+        }
+    }, parallelism);
+    stats.projectSeconds = secondsSince(start);
+    
+    // 逐级聚类。scan 为不建新快照时查询该层级要扫描的实体数（最近的快照 + 其间的聚类块）
+    start = std::chrono::steady_clock::now();
+    stats.visible[options.maxZoom + 1] = count;
+    size_t scan = count;
+    std::vector<Item> next;
+    for (int zoom = options.maxZoom; zoom >= options.minZoom; --zoom)
+    {
+        clusterLevel(zoom, visible, next);
+        visible.swap(next);
+        stats.visible[zoom] = visible.size();
+        scan += clusterEnd[zoom] - clusterBegin[zoom];
+        if (visible.size() * 2 < scan)
+        {
+            std::vector<uint32_t>& snapshot = snapshots[zoom];
+            snapshot.resize(visible.size());
+            for (size_t i = 0; i < visible.size(); ++i)
+            {
+                snapshot[i] = visible[i].id;
+            }
+            scan = visible.size();
+            ++stats.snapshots;
+            stats.snapshotEntries += snapshot.size();
+        }
+    }
+    for (int zoom = 0; zoom < options.minZoom; ++zoom)
+    {
+        stats.visible[zoom] = stats.visible[options.minZoom];
+    }
+    stats.clusterSeconds = secondsSince(start);
+    
+    x.shrink_to_fit();
+    y.shrink_to_fit();
+    parents.shrink_to_fit();
+    absorbed.shrink_to_fit();
+    counts.shrink_to_fit();
+    origins.shrink_to_fit();
+    buildPlans();
+    
+    stats.clusters = counts.size();
+    stats.memoryBytes = (x.capacity() + y.capacity() + parents.capacity() + sources.capacity() + counts.capacity() + origins.capacity()) * sizeof(uint32_t) +
+                        absorbed.capacity() * sizeof(int8_t) + stats.snapshotEntries * sizeof(uint32_t);
+}
+
+void PointClusterIndex::clusterLevel(int zoom, std::vector<Item>& visible, std::vector<Item>& next)
+{
+    PROFILE_ZONE("PointClusterIndex::clusterLevel");
+    
+    const size_t size = visible.size();
+    const double radius = radiusAt(zoom);
+    std::vector<uint8_t> claimed(size, 0);     // 1 = 作为种子处理过但没有形成聚类，2 = 合并进了本级的聚类
+    
+    // 第一阶段：KD 树顶层的子树各自并行处理离子树边界超过半径的种子
+    struct Cell
+    {
+        size_t begin;
+        size_t end;
+        double minX, minY, maxX, maxY;
+        std::vector<NewCluster> clusters;
+    };
+    
+    std::vector<Cell> cells;
+    int depth = size >= kParallelClusterMin ? parallelDepth() : 0;
+    if (depth > 0)
+    {
+        struct Pending
+        {
+            size_t begin;
+            size_t end;
+            int axis;
+            int depth;
+            double minX, minY, maxX, maxY;
+        };
+        
+        std::vector<Pending> pending{ { 0, size, 0, depth, 0.0, 0.0, kFixedScale, kFixedScale } };
+        while (!pending.empty())
+        {
+            Pending node = pending.back();
+            pending.pop_back();
+            if (node.depth == 0 || node.end - node.begin <= options.nodeSize)
+            {
+                cells.push_back({ node.begin, node.end, node.minX, node.minY, node.maxX, node.maxY, {} });
+                continue;
+            }
+            
+            // 中位数本身不属于任何子树，留给第二阶段
+            size_t m = node.begin + (node.end - node.begin) / 2;
+            double split = node.axis == 0 ? visible[m].x : visible[m].y;
+            Pending left = { node.begin, m, 1 - node.axis, node.depth - 1, node.minX, node.minY, node.maxX, node.maxY };
+            Pending right = { m + 1, node.end, 1 - node.axis, node.depth - 1, node.minX, node.minY, node.maxX, node.maxY };
+            (node.axis == 0 ? left.maxX : left.maxY) = split;
+            (node.axis == 0 ? right.minX : right.minY) = split;
+            pending.push_back(left);
+            pending.push_back(right);
+        }
+        
+        jobs().parallelFor(cells.size(), 1, [&](size_t first, size_t last) {
+            Scratch scratch;
+            for (size_t c = first; c < last; ++c)
+            {
+                Cell& cell = cells[c];
+                Range range = { cell.begin, cell.end, cell.minX, cell.minY, cell.maxX, cell.maxY, radius };
+                clusterRange(zoom, cell.begin, cell.end, range, visible, claimed, cell.clusters, scratch);
+            }
+        }, options.maxParallelism);
+    }
+    
+    // 各块的聚类序号加上偏移
+    std::vector<NewCluster> clusters;
+    std::vector<uint32_t> offsets(cells.size());
+    for (size_t c = 0; c < cells.size(); ++c)
+    {
+        offsets[c] = static_cast<uint32_t>(clusters.size());
+        clusters.insert(clusters.end(), cells[c].clusters.begin(), cells[c].clusters.end());
+    }
+    if (!cells.empty())
+    {
+        jobs().parallelFor(cells.size(), 1, [&](size_t first, size_t last) {
+            for (size_t c = first; c < last; ++c)
+            {
+                for (size_t i = cells[c].begin; i < cells[c].end; ++i)
+                {
+                    if (claimed[i] == 2)
+                    {
+                        parents[visible[i].id] += offsets[c];
+                    }
+                }
+            }
+        }, options.maxParallelism);
+        cells.clear();
+        cells.shrink_to_fit();
+    }
+    
+    // 第二阶段：其余种子顺序处理
+    Scratch scratch;
+    Range all = { 0, size, -kFixedScale, -kFixedScale, 2.0 * kFixedScale, 2.0 * kFixedScale, radius };
+    clusterRange(zoom, 0, size, all, visible, claimed, clusters, scratch);
+    
+    // 本级的聚类按 KD 树排序，追加到实体表
+    const uint32_t base = static_cast<uint32_t>(x.size());
+    const size_t created = clusters.size();
+    std::vector<Item> block(created);
+    for (size_t k = 0; k < created; ++k)
+    {
+        NewCluster& cluster = clusters[k];
+        cluster.x /= cluster.count;
+        cluster.y /= cluster.count;
+        block[k] = { static_cast<uint32_t>(cluster.x), static_cast<uint32_t>(cluster.y), static_cast<uint32_t>(k) };
+    }
+    sortItems(block.data(), 0, created, 0, parallelDepth());
+    
+    std::vector<uint32_t> position(created);
+    x.resize(base + created);
+    y.resize(base + created);
+    parents.resize(base + created, 0);
+    absorbed.resize(base + created, kNotAbsorbed);
+    counts.resize(base + created - pointCount);
+    origins.resize(base + created - pointCount);
+    for (size_t k = 0; k < created; ++k)
+    {
+        const NewCluster& cluster = clusters[block[k].id];
+        position[block[k].id] = static_cast<uint32_t>(k);
+        x[base + k] = block[k].x;
+        y[base + k] = block[k].y;
+        counts[base + k - pointCount] = cluster.count;
+        origins[base + k - pointCount] = cluster.origin;
+    }
+    clusterBegin[zoom] = base;
+    clusterEnd[zoom] = static_cast<uint32_t>(base + created);
+    
+    // 子实体指向排序后的聚类；本级可见的 = 没有被合并的 + 新聚类
+    next.clear();
+    next.reserve(size - std::count(claimed.begin(), claimed.end(), uint8_t(2)) + created);
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (claimed[i] == 2)
+        {
+            uint32_t& parent = parents[visible[i].id];
+            parent = base + position[parent];
+        }
+        else
+        {
+            next.push_back(visible[i]);
+        }
+    }
+    for (size_t k = 0; k < created; ++k)
+    {
+        next.push_back({ block[k].x, block[k].y, static_cast<uint32_t>(base + k) });
+    }
+    sortItems(next.data(), 0, next.size(), 0, parallelDepth());
+}
+
+void PointClusterIndex::clusterRange(int zoom, size_t begin, size_t end, const Range& range, const std::vector<Item>& visible,
+                                     std::vector<uint8_t>& claimed, std::vector<NewCluster>& out, Scratch& scratch)
+{
+    // 与 sortItems 相同的划分，按数组顺序访问：左子树、中位数、右子树
+    if (end - begin <= options.nodeSize)
+    {
+        clusterGroup(zoom, begin, end, range, visible, claimed, out, scratch);
+        return;
+    }
+    size_t m = begin + (end - begin) / 2;
+    clusterRange(zoom, begin, m, range, visible, claimed, out, scratch);
+    clusterGroup(zoom, m, m + 1, range, visible, claimed, out, scratch);
+    clusterRange(zoom, m + 1, end, range, visible, claimed, out, scratch);
+}
+
+void PointClusterIndex::clusterGroup(int zoom, size_t begin, size_t end, const Range& range, const std::vector<Item>& visible,
+                                     std::vector<uint8_t>& claimed, std::vector<NewCluster>& out, Scratch& scratch)
+{
+    const double radius = range.radius;
+    auto eligible = [&](size_t i) {
+        const Item& seed = visible[i];
+        return claimed[i] == 0 && seed.x - radius > range.minX && seed.x + radius < range.maxX &&
+               seed.y - radius > range.minY && seed.y + radius < range.maxY;
+    };
+    
+    // 一组（一片 KD 树叶子）的种子共用一次范围查询：取出外接框加半径内、属于本块且未被合并的候选
+    uint32_t minX = UINT32_MAX;
+    uint32_t minY = UINT32_MAX;
+    uint32_t maxX = 0;
+    uint32_t maxY = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (eligible(i))
+        {
+            minX = std::min(minX, visible[i].x);
+            minY = std::min(minY, visible[i].y);
+            maxX = std::max(maxX, visible[i].x);
+            maxY = std::max(maxY, visible[i].y);
+        }
+    }
+    if (minX > maxX)
+    {
+        return;
+    }
+    
+    auto lower = [&](uint32_t v) { return static_cast<uint32_t>(std::max(0.0, std::ceil(v - radius))); };
+    auto upper = [&](uint32_t v) { return static_cast<uint32_t>(std::min(kFixedScale - 1.0, std::floor(v + radius))); };
+    auto coord = [&](size_t i, int axis) { return axis == 0 ? visible[i].x : visible[i].y; };
+    scratch.candidates.clear();
+    queryRange(visible.size(), options.nodeSize, lower(minX), lower(minY), upper(maxX), upper(maxY), coord, [&](size_t i) {
+        if (i >= range.begin && i < range.end && claimed[i] == 0)
+        {
+            scratch.candidates.push_back({ visible[i].x, visible[i].y, static_cast<uint32_t>(i) });
+        }
+    });
+    
+    const double r2 = radius * radius;
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (!eligible(i))
+        {
+            continue;
+        }
+        const Item& seed = visible[i];
+        uint64_t total = countOf(seed.id);
+        scratch.neighbors.clear();
+        for (const Item& candidate : scratch.candidates)
+        {
+            double dx = static_cast<double>(candidate.x) - seed.x;
+            double dy = static_cast<double>(candidate.y) - seed.y;
+            if (dx * dx + dy * dy <= r2 && candidate.id != i && claimed[candidate.id] == 0)
+            {
+                scratch.neighbors.push_back(candidate.id);
+                total += countOf(visible[candidate.id].id);
+            }
+        }
+        if (scratch.neighbors.empty() || total < options.minPoints)
+        {
+            claimed[i] = 1;
+            continue;
+        }
+        
+        uint32_t ordinal = static_cast<uint32_t>(out.size());     // 在 out 中的序号，排序后换成实体下标
+        NewCluster cluster = { 0, 0, static_cast<uint32_t>(total), seed.id };
+        scratch.neighbors.push_back(static_cast<uint32_t>(i));
+        for (uint32_t neighbor : scratch.neighbors)
+        {
+            const Item& child = visible[neighbor];
+            uint32_t weight = countOf(child.id);
+            cluster.x += static_cast<uint64_t>(child.x) * weight;
+            cluster.y += static_cast<uint64_t>(child.y) * weight;
+            claimed[neighbor] = 2;
+            parents[child.id] = ordinal;
+            absorbed[child.id] = static_cast<int8_t>(zoom);
+        }
+        out.push_back(cluster);
+    }
+}
+
+void PointClusterIndex::buildPlans()
+{
+    // 层级 z 扫描最近的快照 s >= z（没有时为原始点），以及 [z, s) 各级的聚类块
+    plans.assign(options.maxZoom + 2, {});
+    for (int zoom = options.minZoom; zoom <= options.maxZoom + 1; ++zoom)
+    {
+        std::vector<View>& views = plans[zoom];
+        int s = zoom;
+        while (s <= options.maxZoom && snapshots[s].empty())
+        {
+            ++s;
+        }
+        if (s > options.maxZoom)
+        {
+            views.push_back({ nullptr, 0, pointCount });
+        }
+        else
+        {
+            views.push_back({ snapshots[s].data(), 0, static_cast<uint32_t>(snapshots[s].size()) });
+        }
+        for (int level = zoom; level < s; ++level)
+        {
+            if (clusterEnd[level] > clusterBegin[level])
+            {
+                views.push_back({ nullptr, clusterBegin[level], clusterEnd[level] - clusterBegin[level] });
+            }
+        }
+    }
+}
+
+int PointClusterIndex::createdZoom(uint32_t id) const
+{
+    if (id < pointCount)
+    {
+        return options.maxZoom + 1;
+    }
+    for (int zoom = options.minZoom; zoom <= options.maxZoom; ++zoom)
+    {
+        if (id >= clusterBegin[zoom] && id < clusterEnd[zoom])
+        {
+            return zoom;
+        }
+    }
+    return -1;
+}
+
+double PointClusterIndex::radiusAt(int zoom) const
+{
+    return options.radius / (options.extent * std::ldexp(1.0, zoom)) * kFixedScale;
+}
+
+PointClusterIndex::Feature PointClusterIndex::makeFeature(uint32_t id) const
+{
+    Feature feature;
+    feature.id = id < pointCount ? sources[id] : id;
+    feature.count = countOf(id);
+    feature.mercator = glm::dvec2(fromFixed(x[id]), fromFixed(y[id]));
+    return feature;
+}
+
+void PointClusterIndex::queryBox(const std::vector<View>& views, int zoom, double minX, double minY, double maxX, double maxY,
+                                 double shift, const TileID& tile, std::vector<Feature>& out) const
+{
+    std::array<uint32_t, 4> box;
+    if (!toFixedBox(minX, minY, maxX, maxY, box))
+    {
+        return;
+    }
+    
+    const double scale = std::ldexp(1.0, tile.z);
+    auto visit = [&](uint32_t id) {
+        if (absorbed[id] >= zoom)
+        {
+            return;
+        }
+        Feature feature = makeFeature(id);
+        feature.mercator.x += shift;
+        feature.position = glm::ivec2(static_cast<int>(std::lround((feature.mercator.x * scale - tile.x) * Constants::TILE_EXTENT)),
+                                      static_cast<int>(std::lround((feature.mercator.y * scale - tile.y) * Constants::TILE_EXTENT)));
+        feature.mercator.x += tile.wrap;
+        out.push_back(feature);
+    };
+    
+    for (const View& view : views)
+    {
+        if (view.ids)
+        {
+            auto coord = [&](size_t i, int axis) { return axis == 0 ? x[view.ids[i]] : y[view.ids[i]]; };
+            queryRange(view.size, options.nodeSize, box[0], box[1], box[2], box[3], coord, [&](size_t i) { visit(view.ids[i]); });
+        }
+        else
+        {
+            const uint32_t* vx = x.data() + view.begin;
+            const uint32_t* vy = y.data() + view.begin;
+            auto coord = [&](size_t i, int axis) { return axis == 0 ? vx[i] : vy[i]; };
+            queryRange(view.size, options.nodeSize, box[0], box[1], box[2], box[3], coord,
+                       [&](size_t i) { visit(view.begin + static_cast<uint32_t>(i)); });
+        }
+    }
+}
+
+void PointClusterIndex::getTile(const TileID& tile, std::vector<Feature>& out) const
+{
+    out.clear();
+    if (plans.empty() || tile.z < 0 || tile.z > 30)
+    {
+        return;
+    }
+    
+    const int zoom = std::clamp(tile.z, options.minZoom, options.maxZoom + 1);
+    const std::vector<View>& views = plans[zoom];
+    const double scale = std::ldexp(1.0, tile.z);
+    const double padding = options.buffer / options.extent;
+    const double minX = (tile.x - padding) / scale;
+    const double maxX = (tile.x + 1 + padding) / scale;
+    const double minY = (tile.y - padding) / scale;
+    const double maxY = (tile.y + 1 + padding) / scale;
+    
+    queryBox(views, zoom, minX, minY, maxX, maxY, 0.0, tile, out);
+    // 缓冲区越过经度 ±180 的部分到世界的另一侧去取
+    if (minX < 0.0)
+    {
+        queryBox(views, zoom, minX + 1.0, minY, 1.0, maxY, -1.0, tile, out);
+    }
+    if (maxX > 1.0)
+    {
+        queryBox(views, zoom, 0.0, minY, maxX - 1.0, maxY, 1.0, tile, out);
+    }
+}
+
+bool PointClusterIndex::getChildren(uint32_t clusterId, std::vector<Feature>& out) const
+{
+    out.clear();
+    if (clusterId < pointCount || clusterId >= x.size())
+    {
+        return false;
+    }
+    
+    // 子实体都在种子的聚类半径内（加 1 抵消加权中心的取整），且在下一层级可见
+    const int zoom = createdZoom(clusterId);
+    const uint32_t seed = origins[clusterId - pointCount];
+    const double radius = radiusAt(zoom) + 1.0;
+    auto visit = [&](uint32_t id) {
+        if (parents[id] == clusterId && absorbed[id] == zoom)
+        {
+            out.push_back(makeFeature(id));
+        }
+    };
+    
+    for (const View& view : plans[zoom + 1])
+    {
+        if (view.ids)
+        {
+            auto coord = [&](size_t i, int axis) { return axis == 0 ? x[view.ids[i]] : y[view.ids[i]]; };
+            queryWithin(view.size, options.nodeSize, x[seed], y[seed], radius, coord, [&](size_t i) { visit(view.ids[i]); });
+        }
+        else
+        {
+            const uint32_t* vx = x.data() + view.begin;
+            const uint32_t* vy = y.data() + view.begin;
+            auto coord = [&](size_t i, int axis) { return axis == 0 ? vx[i] : vy[i]; };
+            queryWithin(view.size, options.nodeSize, x[seed], y[seed], radius, coord,
+                        [&](size_t i) { visit(view.begin + static_cast<uint32_t>(i)); });
+        }
+    }
+    return true;
+}
+
+int PointClusterIndex::getExpansionZoom(uint32_t clusterId) const
+{
+    // 聚类跨层级保持同一个实体，在产生它的下一层级就分开
+    int zoom = createdZoom(clusterId);
+    return zoom < 0 ? options.maxZoom + 1 : std::min(zoom + 1, options.maxZoom + 1);
+}
+
+size_t PointClusterIndex::getLeaves(uint32_t clusterId, size_t limit, size_t offset, std::vector<uint32_t>& out) const
+{
+    size_t before = out.size();
+    if (clusterId >= pointCount && clusterId < x.size() && limit > 0)
+    {
+        appendLeaves(clusterId, before + limit, offset, out);
+    }
+    return out.size() - before;
+}
+
+void PointClusterIndex::appendLeaves(uint32_t clusterId, size_t limit, size_t& offset, std::vector<uint32_t>& out) const
+{
+    std::vector<Feature> children;
+    getChildren(clusterId, children);
+    for (const Feature& child : children)
+    {
+        if (offset >= child.count)
+        {
+            offset -= child.count;
+        }
+        else if (child.count == 1)
+        {
+            out.push_back(child.id);
+        }
+        else
+        {
+            appendLeaves(child.id, limit, offset, out);
+        }
+        if (out.size() >= limit)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include "JobSystem.h"
+#include "TileID.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 点聚类索引（supercluster 的做法，不依赖 GL）
+ *
+ * - build 从 SoA 的经纬度数组建立索引：坐标投影为 32 位定点的归一化墨卡托，
+ *   从 maxZoom 到 minZoom 逐级把 radius 像素内的点 / 聚类合并为按点数加权的聚类
+ * - 所有实体（原始点 + 聚类）共用一张 SoA 表。聚类跨层级保持同一个实体，
+ *   每一级只新增本级产生的聚类，按 KD 树（KDBush 的隐式布局：按中位数原地排序，不存节点）排序成一块
+ * - 某一级可见的实体 = 更高层级产生且尚未被合并的实体。查询时扫描最近的快照（可见实体按 KD 树排序的下标）
+ *   和其间各级的聚类块，按合并层级过滤；可见实体少于扫描量的一半时建立新快照，
+ *   因此范围查询为 O(log n + k)，扫描量不超过可见量的 2 倍
+ * - 内存：原始点 17 字节，聚类 21 字节（聚类总数小于点数），快照每项 4 字节（总项数小于 2 倍点数），
+ *   每个输入点合计小于 kMaxBytesPerPoint
+ * - 构建时每一级按 KD 树顶层的子树分块并行聚类：离子树边界超过半径的种子只会与同一子树内的点合并，
+ *   各块互不干扰；其余种子之后顺序处理。种子按 KD 树叶子分组，一组共用一次范围查询取出候选
+ *
+ * build 之后的查询只读，可以在多个线程上并发调用。
+ */
+class PointClusterIndex
+{
+public:
+    static constexpr size_t kMaxBytesPerPoint = 48;
+    static constexpr size_t kMaxPoints = size_t(1) << 31;  // 实体编号（点 + 聚类）为 uint32
+    
+    struct Options
+    {
+        int minZoom = 0;
+        int maxZoom = 16;               // 超过该层级不再聚类，返回原始点
+        float radius = 40.0f;           // 聚类半径（像素）
+        float extent = 512.0f;          // 瓦片边长（像素），把 radius、buffer 换算为墨卡托长度
+        float buffer = 64.0f;           // getTile 四周的缓冲区（像素），标注不会在瓦片边界处截断
+        uint32_t minPoints = 2;         // 少于该点数不形成聚类
+        uint32_t nodeSize = 64;         // KD 树叶子大小
+        JobSystem* jobSystem = nullptr; // nullptr 表示使用 JobSystem::shared()
+        unsigned maxParallelism = 0;    // 构建的最大并行段数，0 表示不限制，1 表示单线程
+    };
+    
+    struct Feature
+    {
+        uint32_t id = 0;                // 小于点数时是原始数组中的下标，否则为聚类 id（getChildren 等的参数）
+        uint32_t count = 0;             // 包含的原始点数
+        glm::dvec2 mercator = glm::dvec2(0.0);  // 归一化墨卡托坐标；getTile 的结果已加上瓦片的 wrap
+        glm::ivec2 position = glm::ivec2(0);    // 仅 getTile：瓦片内的 TILE_EXTENT 坐标（缓冲区内的超出 [0, TILE_EXTENT)）
+    };
+    
+    struct Stats
+    {
+        size_t points = 0;
+        size_t clusters = 0;
+        size_t snapshots = 0;
+        size_t snapshotEntries = 0;
+        size_t memoryBytes = 0;
+        double projectSeconds = 0.0;    // 投影 + 原始点的 KD 排序
+        double clusterSeconds = 0.0;    // 逐级聚类（包括聚类块和可见集合的 KD 排序）
+        std::vector<size_t> visible;    // 每个层级（下标为 zoom，到 maxZoom + 1）的可见实体数
+        
+        double bytesPerPoint() const { return points > 0 ? static_cast<double>(memoryBytes) / points : 0.0; }
+    };
+    
+    PointClusterIndex();
+    explicit PointClusterIndex(const Options& options);
+    
+    /**
+     * 建立索引（替换之前的数据）；lon / lat 为度，超出 kMaxPoints 的部分忽略
+     */
+    void build(const float* lon, const float* lat, size_t count);
+    
+    /**
+     * 瓦片（含缓冲区）内的可见点和聚类，结果写入 out（先清空）。
+     * tile.wrap 取自覆盖选择（Globe 过渡时为 getWrapForTile 选出的世界副本），只影响 mercator；
+     * 瓦片贴着经度 ±180 时，缓冲区内另一侧的点也会返回
+     */
+    void getTile(const TileID& tile, std::vector<Feature>& out) const;
+    
+    /**
+     * 聚类在下一层级分成的点 / 聚类（至少两个），写入 out（先清空）；不是聚类 id 时返回 false
+     */
+    bool getChildren(uint32_t clusterId, std::vector<Feature>& out) const;
+    
+    /**
+     * 聚类展开（分成多个）的层级
+     */
+    int getExpansionZoom(uint32_t clusterId) const;
+    
+    /**
+     * 聚类包含的原始点下标，跳过前 offset 个，最多 limit 个，追加到 out；返回追加的个数
+     */
+    size_t getLeaves(uint32_t clusterId, size_t limit, size_t offset, std::vector<uint32_t>& out) const;
+    
+    const Options& getOptions() const { return options; }
+    const Stats& getStats() const { return stats; }
+    
+private:
+    struct Item
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t id;
+    };
+    
+    /**
+     * 一棵 KD 树：ids 为 nullptr 时是实体表中连续的一段 [begin, begin + size)，否则为快照（实体下标）
+     */
+    struct View
+    {
+        const uint32_t* ids;
+        uint32_t begin;
+        uint32_t size;
+    };
+    
+    struct NewCluster
+    {
+        uint64_t x;                 // 聚类时为加权和，结束时除以 count
+        uint64_t y;
+        uint32_t count;
+        uint32_t origin;
+    };
+    
+    /**
+     * 聚类时可以访问的范围：下标在 [begin, end) 内；种子离边界超过 radius 时才处理（第一阶段的子树）
+     */
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+        double minX, minY, maxX, maxY;
+        double radius;
+    };
+    
+    struct Scratch
+    {
+        std::vector<Item> candidates;       // id 为 visible 中的下标
+        std::vector<uint32_t> neighbors;
+    };
+    
+    JobSystem& jobs() const;
+    int parallelDepth() const;
+    void sortItems(Item* items, size_t begin, size_t end, int axis, int depth) const;
+    void clusterLevel(int zoom, std::vector<Item>& visible, std::vector<Item>& next);
+    void clusterRange(int zoom, size_t begin, size_t end, const Range& range, const std::vector<Item>& visible,
+                      std::vector<uint8_t>& claimed, std::vector<NewCluster>& out, Scratch& scratch);
+    void clusterGroup(int zoom, size_t begin, size_t end, const Range& range, const std::vector<Item>& visible,
+                      std::vector<uint8_t>& claimed, std::vector<NewCluster>& out, Scratch& scratch);
+    void buildPlans();
+    
+    uint32_t countOf(uint32_t id) const { return id < pointCount ? 1 : counts[id - pointCount]; }
+    int createdZoom(uint32_t id) const;
+    double radiusAt(int zoom) const;
+    Feature makeFeature(uint32_t id) const;
+    void queryBox(const std::vector<View>& views, int zoom, double minX, double minY, double maxX, double maxY,
+                  double shift, const TileID& tile, std::vector<Feature>& out) const;
+    void appendLeaves(uint32_t clusterId, size_t limit, size_t& offset, std::vector<uint32_t>& out) const;
+    
+    Options options;
+    Stats stats;
+    uint32_t pointCount = 0;
+    
+    // 实体表：[0, pointCount) 为原始点（KD 排序），之后按层级从高到低是各级的聚类块
+    std::vector<uint32_t> x;
+    std::vector<uint32_t> y;
+    std::vector<uint32_t> parents;          // 合并进的聚类
+    std::vector<int8_t> absorbed;           // 被合并的层级（在该层级及以下不可见），-1 表示没有被合并
+    std::vector<uint32_t> sources;          // 原始点在输入数组中的下标
+    std::vector<uint32_t> counts;           // 聚类（下标减 pointCount）包含的点数
+    std::vector<uint32_t> origins;          // 聚类的种子实体：它的子实体都在种子的 radius 内
+    std::vector<uint32_t> clusterBegin;     // 每个层级的聚类块
+    std::vector<uint32_t> clusterEnd;
+    
+    std::vector<std::vector<uint32_t>> snapshots;  // 每个层级（没有快照的为空）
+    std::vector<std::vector<View>> plans;          // 每个层级查询时扫描的 KD 树
+};
@@ -0,0 +1,230 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+namespace
+{
+static_assert((Profiler::kLaneCapacity & (Profiler::kLaneCapacity - 1)) == 0, "lane capacity must be a power of two");
+
+std::string jsonString(const std::string& text)
+{
+    std::string result = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+        result += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    return result + "\"";
+}
+} // namespace
+
+Profiler::Profiler()
+    : epoch(std::chrono::steady_clock::now()), enabled(true), historyStart(0), recorded(0)
+{
+    history.reserve(kHistoryCapacity);
+}
+
+Profiler& Profiler::shared()
+{
+    // 不析构：进程退出时工作线程（JobSystem::shared）可能仍在记录区段
+    static Profiler* profiler = new Profiler();
+    return *profiler;
+}
+
+Profiler::Lane& Profiler::threadLane()
+{
+    // 时间线归 Profiler 所有，线程退出后保留（尚未收集的事件仍然有效）
+    thread_local Lane* lane = nullptr;
+    if (!lane)
+    {
+        std::lock_guard<std::mutex> lock(lanesMutex);
+        lanes.emplace_back(new Lane(static_cast<uint32_t>(lanes.size()), "Thread " + std::to_string(lanes.size())));
+        lane = lanes.back().get();
+    }
+    return *lane;
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+    Lane& lane = threadLane();
+    std::lock_guard<std::mutex> lock(lanesMutex);
+    lane.name = name;
+}
+
+Profiler::Lane& Profiler::createLane(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(lanesMutex);
+    lanes.emplace_back(new Lane(static_cast<uint32_t>(lanes.size()), name));
+    return *lanes.back();
+}
+
+void Profiler::record(Lane& lane, const char* name, uint64_t start, uint64_t end)
+{
+    uint64_t head = lane.head.load(std::memory_order_relaxed);
+    if (head - lane.tail.load(std::memory_order_acquire) >= kLaneCapacity)
+    {
+        lane.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Event& event = lane.events[head & (kLaneCapacity - 1)];
+    event.name = name;
+    event.start = start;
+    event.duration = end > start ? end - start : 0;
+    event.lane = lane.index;
+    lane.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::collect()
+{
+    std::lock_guard<std::mutex> lanesLock(lanesMutex);
+    std::lock_guard<std::mutex> historyLock(historyMutex);
+    for (const std::unique_ptr<Lane>& lane : lanes)
+    {
+        uint64_t tail = lane->tail.load(std::memory_order_relaxed);
+        uint64_t head = lane->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++)
+        {
+            const Event& event = lane->events[tail & (kLaneCapacity - 1)];
+            if (history.size() < kHistoryCapacity)
+            {
+                history.push_back(event);
+            }
+            else
+            {
+                history[historyStart] = event;
+                historyStart = (historyStart + 1) % kHistoryCapacity;
+            }
+            recorded++;
+        }
+        lane->tail.store(tail, std::memory_order_release);
+    }
+}
+
+std::vector<Profiler::ZoneSummary> Profiler::summarize(double seconds) const
+{
+    std::vector<std::string> laneNames;
+    {
+        std::lock_guard<std::mutex> lock(lanesMutex);
+        for (const std::unique_ptr<Lane>& lane : lanes)
+        {
+            laneNames.push_back(lane->name);
+        }
+    }
+    
+    // 按名字聚合（名字是静态字符串，但不同翻译单元中的相同字面量地址可能不同，按内容比较）
+    struct Accumulator
+    {
+        ZoneSummary summary;
+        uint32_t lane = 0;
+        bool multipleLanes = false;
+    };
+    std::map<std::string, Accumulator> zones;
+    uint64_t since = now() - std::min<uint64_t>(now(), static_cast<uint64_t>(seconds * 1e9));
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        for (const Event& event : history)
+        {
+            if (event.start + event.duration < since)
+            {
+                continue;
+            }
+            auto inserted = zones.emplace(event.name, Accumulator());
+            Accumulator& zone = inserted.first->second;
+            if (inserted.second)
+            {
+                zone.lane = event.lane;
+            }
+            zone.multipleLanes = zone.multipleLanes || zone.lane != event.lane;
+            double milliseconds = event.duration / 1e6;
+            zone.summary.count++;
+            zone.summary.totalMilliseconds += milliseconds;
+            zone.summary.maxMilliseconds = std::max(zone.summary.maxMilliseconds, milliseconds);
+        }
+    }
+    
+    std::vector<ZoneSummary> result;
+    for (auto& entry : zones)
+    {
+        ZoneSummary summary = entry.second.summary;
+        summary.name = entry.first;
+        summary.averageMilliseconds = summary.totalMilliseconds / summary.count;
+        if (!entry.second.multipleLanes && entry.second.lane < laneNames.size())
+        {
+            summary.lane = laneNames[entry.second.lane];
+        }
+        result.push_back(summary);
+    }
+    std::sort(result.begin(), result.end(), [](const ZoneSummary& a, const ZoneSummary& b) {
+        return a.totalMilliseconds > b.totalMilliseconds;
+    });
+    return result;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path)
+{
+    collect();
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    
+    // 完整事件（ph X），时间单位为微秒；每条时间线是一个 tid，附带 thread_name 元数据
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const char* separator = "\n";
+    {
+        std::lock_guard<std::mutex> lock(lanesMutex);
+        for (const std::unique_ptr<Lane>& lane : lanes)
+        {
+            file << separator << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << lane->index
+                 << ",\"name\":\"thread_name\",\"args\":{\"name\":" << jsonString(lane->name) << "}}";
+            separator = ",\n";
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        char line[96];
+        for (size_t i = 0; i < history.size(); i++)
+        {
+            const Event& event = history[(historyStart + i) % history.size()];
+            std::snprintf(line, sizeof(line), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                          event.lane, event.start / 1e3, event.duration / 1e3);
+            file << separator << "{\"name\":" << jsonString(event.name) << line;
+            separator = ",\n";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lanesLock(lanesMutex);
+    std::lock_guard<std::mutex> historyLock(historyMutex);
+    for (const std::unique_ptr<Lane>& lane : lanes)
+    {
+        lane->tail.store(lane->head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    history.clear();
+    historyStart = 0;
+}
+
+Profiler::Stats Profiler::getStats() const
+{
+    Stats stats;
+    std::lock_guard<std::mutex> lanesLock(lanesMutex);
+    std::lock_guard<std::mutex> historyLock(historyMutex);
+    stats.recorded = recorded;
+    stats.lanes = lanes.size();
+    for (const std::unique_ptr<Lane>& lane : lanes)
+    {
+        stats.dropped += lane->dropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
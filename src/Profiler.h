@@ -0,0 +1,191 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * 热路径性能分析（不依赖 GL；GPU 区段见 GpuProfiler）
+ *
+ * - 区段：PROFILE_ZONE("名字") 在作用域开始和结束时各取一次单调时钟，结束时写入
+ *   当前线程自己的环形缓冲区（单生产者单消费者，无锁），名字必须是静态字符串
+ * - 收集：GL 线程每帧调用 collect，把各线程缓冲区中的事件移入有界的历史记录
+ *   （满时丢弃最旧的）；线程缓冲区满时丢弃新事件并计数
+ * - 输出：writeChromeTrace 导出 chrome://tracing / Perfetto 可读的 JSON，
+ *   summarize 按区段名汇总最近若干秒（调用次数、总耗时、平均、最大）
+ *
+ * 编译时定义 GLOBE_PROFILER（CMake 选项 -DGLOBE_PROFILER=ON）才启用区段宏；
+ * 未定义时宏展开为空语句，不产生任何代码。启用后还可以用 setEnabled 在运行时开关。
+ */
+class Profiler
+{
+public:
+#ifdef GLOBE_PROFILER
+    static constexpr bool kEnabled = true;
+#else
+    static constexpr bool kEnabled = false;
+#endif
+    
+    /**
+     * 一条事件的时间线（一个线程，或者 GPU）；只能由一个线程写入
+     */
+    class Lane;
+    
+    struct Event
+    {
+        const char* name = nullptr;
+        uint64_t start = 0;      // 纳秒，相对 Profiler 创建时刻
+        uint64_t duration = 0;
+        uint32_t lane = 0;
+    };
+    
+    struct ZoneSummary
+    {
+        std::string name;
+        std::string lane;        // 只有一个时间线记录了该区段时为其名字，否则为空
+        size_t count = 0;
+        double totalMilliseconds = 0.0;
+        double averageMilliseconds = 0.0;
+        double maxMilliseconds = 0.0;
+    };
+    
+    struct Stats
+    {
+        uint64_t recorded = 0;   // 已移入历史记录
+        uint64_t dropped = 0;    // 线程缓冲区已满
+        size_t lanes = 0;
+    };
+    
+    static Profiler& shared();
+    
+    void setEnabled(bool enabled) { this->enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    
+    /**
+     * 单调时钟，纳秒，相对 Profiler 创建时刻（与事件的 start 同一时间轴）
+     */
+    uint64_t now() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+    
+    /**
+     * 当前线程的时间线（第一次调用时创建，名字为 "Thread N"）
+     */
+    Lane& threadLane();
+    void setThreadName(const std::string& name);
+    
+    /**
+     * 新建一条不属于任何线程的时间线（例如 GPU），由调用方保证只有一个线程写入
+     */
+    Lane& createLane(const std::string& name);
+    
+    /**
+     * 写入一个区段；缓冲区已满时丢弃
+     */
+    void record(Lane& lane, const char* name, uint64_t start, uint64_t end);
+    
+    /**
+     * 把所有时间线中的新事件移入历史记录（只在一个线程上调用，通常是 GL 线程每帧一次）
+     */
+    void collect();
+    
+    /**
+     * 最近 seconds 秒内（按事件结束时间）各区段的汇总，按总耗时从大到小排序
+     */
+    std::vector<ZoneSummary> summarize(double seconds) const;
+    
+    /**
+     * 导出历史记录为 Chrome trace JSON（先 collect），失败时返回 false
+     */
+    bool writeChromeTrace(const std::string& path);
+    
+    /**
+     * 清空历史记录（线程缓冲区中尚未收集的事件一并丢弃）
+     */
+    void clear();
+    
+    Stats getStats() const;
+    
+    // 每条时间线的缓冲区容量（事件数，2 的幂）与历史记录容量
+    static constexpr size_t kLaneCapacity = 16384;
+    static constexpr size_t kHistoryCapacity = 262144;
+    
+private:
+    Profiler();
+    
+    const std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> enabled;
+    
+    // 时间线注册（很少发生）与收集互斥；record 不加锁
+    mutable std::mutex lanesMutex;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    
+    // 历史记录：环形，history[(historyStart + i) % capacity]
+    mutable std::mutex historyMutex;
+    std::vector<Event> history;
+    size_t historyStart;
+    uint64_t recorded;
+};
+
+class Profiler::Lane
+{
+public:
+    const std::string& getName() const { return name; }
+    
+private:
+    friend class Profiler;
+    
+    Lane(uint32_t index, std::string name) : index(index), name(std::move(name)), events(kLaneCapacity) {}
+    
+    const uint32_t index;
+    std::string name;                 // 在 lanesMutex 下修改
+    std::vector<Event> events;
+    std::atomic<uint64_t> head{ 0 };  // 写入方推进
+    std::atomic<uint64_t> tail{ 0 };  // collect 推进
+    std::atomic<uint64_t> dropped{ 0 };
+};
+
+/**
+ * RAII 区段：构造时记录开始时间，析构时写入当前线程的时间线
+ */
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+        : profiler(Profiler::shared()), name(name), active(profiler.isEnabled()), start(active ? profiler.now() : 0)
+    {
+    }
+    
+    ~ProfileZone()
+    {
+        if (active)
+        {
+            profiler.record(profiler.threadLane(), name, start, profiler.now());
+        }
+    }
+    
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+    
+private:
+    Profiler& profiler;
+    const char* name;
+    bool active;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef GLOBE_PROFILER
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::shared().setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,375 @@
+#include "ProjectionState.h"
+
+#include "GlobeProjection.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+// 牛顿迭代：NDC 残差收敛阈值（1080p 下约 0.005 像素）与最大迭代次数
+constexpr float kUnprojectTolerance = 1e-5f;
+constexpr int kUnprojectMaxIterations = 16;
+// 牛顿迭代未收敛时，延拓法从平面解到目标混合因子的步数
+constexpr int kUnprojectContinuationSteps = 8;
+// 球面求交：掠射视线判别式的相对容差
+constexpr float kGrazingTolerance = 1e-5f;
+} // namespace
+
+ProjectionState::ProjectionState(const GlobeProjection& projection, float aspect)
+    : transition(projection.transition)
+    , centerLon(projection.centerLon)
+    , centerLat(projection.centerLat)
+    , zoom(projection.zoom)
+    , aspect(aspect)
+{
+    PROFILE_ZONE("ProjectionState::ProjectionState");
+    cameraDistance = projection.getCameraDistance();
+    globeRadius = projection.getGlobeRadius();
+    worldScale = 2.0f * pow(2.0f, zoom);
+    wrappedLon = projection.wrapLon(centerLon);
+    centerMercX = wrappedLon / 360.0f + 0.5f;
+    centerMercY = GlobeProjection::mercatorYFromLat(centerLat);
+    
+    float lonRad = wrappedLon * Constants::PI / 180.0f;
+    float latRad = centerLat * Constants::PI / 180.0f;
+    centerDirection = glm::vec3(sin(lonRad) * cos(latRad), sin(latRad), cos(lonRad) * cos(latRad));
+    
+    projectionMatrix = glm::perspective(Constants::PI / 4.0f, aspect, 0.01f, 100.0f);
+    glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, -cameraDistance));
+    mercatorBaseMatrix = projectionMatrix * view
+                         * glm::scale(glm::mat4(1.0f), glm::vec3(worldScale, -worldScale, 1.0f))
+                         * glm::translate(glm::mat4(1.0f), glm::vec3(-centerMercX, -centerMercY, 0.0f));
+    
+    globeMatrix = projection.calculateGlobeMatrix(aspect);
+    inverseGlobeMatrix = glm::inverse(globeMatrix);
+    clippingPlane = projection.calculateClippingPlane();
+}
+
+bool ProjectionState::matches(const GlobeProjection& projection, float aspect) const
+{
+    return transition == projection.transition
+        && centerLon == projection.centerLon
+        && centerLat == projection.centerLat
+        && zoom == projection.zoom
+        && this->aspect == aspect;
+}
+
+float ProjectionState::tileCount(int tileZ)
+{
+    return static_cast<float>(1u << tileZ);
+}
+
+glm::mat4 ProjectionState::mercatorMatrix(const TileID& tile) const
+{
+    // base * translate(offset) * scale(s)：只影响前两列和平移列
+    float numTiles = tileCount(tile.z);
+    float tileOffsetX = (tile.x + tile.wrap * numTiles) / numTiles;
+    float tileOffsetY = tile.y / numTiles;
+    float scale = 1.0f / numTiles / Constants::TILE_EXTENT;
+    
+    glm::mat4 m = mercatorBaseMatrix;
+    m[3] = mercatorBaseMatrix[0] * tileOffsetX + mercatorBaseMatrix[1] * tileOffsetY + mercatorBaseMatrix[3];
+    m[0] = mercatorBaseMatrix[0] * scale;
+    m[1] = mercatorBaseMatrix[1] * scale;
+    return m;
+}
+
+glm::vec4 ProjectionState::tileMercatorCoords(const TileID& tile) const
+{
+    float numTiles = tileCount(tile.z);
+    return glm::vec4(
+        (tile.x + tile.wrap * numTiles) / numTiles,
+        tile.y / numTiles,
+        1.0f / numTiles / Constants::TILE_EXTENT,
+        1.0f / numTiles / Constants::TILE_EXTENT
+        );
+}
+
+int ProjectionState::wrapForTile(int tileX, int tileZ) const
+{
+    // 与 GlobeProjection::getWrapForTile 相同的算法，centerMercX 已预先计算
+    float numTiles = tileCount(tileZ);
+    float tileMercSize = 1.0f / numTiles;
+    float tileX_merc = tileX / numTiles;
+    
+    auto distanceToTile = [](float point, float tile, float tileSize) -> float {
+        float delta = point - tile;
+        return (delta < 0) ? -delta : std::max(0.0f, delta - tileSize);
+    };
+    
+    float distCurrent = distanceToTile(centerMercX, tileX_merc, tileMercSize);
+    float distLeft = distanceToTile(centerMercX, tileX_merc - 1.0f, tileMercSize);
+    float distRight = distanceToTile(centerMercX, tileX_merc + 1.0f, tileMercSize);
+    
+    float distSmallest = std::min({distCurrent, distLeft, distRight});
+    if (distSmallest == distRight)
+    {
+        return 1;
+    }
+    if (distSmallest == distLeft)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+float ProjectionState::getZMix() const
+{
+    if (isPureGlobe())
+    {
+        return 1.0f;
+    }
+    return std::clamp((transition - Constants::Z_GLOBENESS_THRESHOLD) / (1.0f - Constants::Z_GLOBENESS_THRESHOLD), 0.0f, 1.0f);
+}
+
+float ProjectionState::nearestWrapMercX(float mercX) const
+{
+    return mercX - std::floor(mercX - centerMercX + 0.5f);
+}
+
+glm::vec3 ProjectionState::sphereFromMercator(const glm::vec2& mercator)
+{
+    float lon = mercator.x * Constants::PI * 2.0f + Constants::PI;
+    float lat = 2.0f * std::atan(std::exp(Constants::PI - mercator.y * Constants::PI * 2.0f)) - Constants::PI * 0.5f;
+    float len = std::cos(lat);
+    return glm::vec3(std::sin(lon) * len, std::sin(lat), std::cos(lon) * len);
+}
+
+glm::vec4 ProjectionState::projectToClip(const glm::vec2& mercator) const
+{
+    glm::vec3 spherePos = sphereFromMercator(mercator);
+    
+    // Globe 裁剪空间坐标，Z 替换为 clipping Z
+    glm::vec4 globePosition = globeMatrix * glm::vec4(spherePos, 1.0f);
+    float clippingZ = 1.0f - (glm::dot(spherePos, glm::vec3(clippingPlane)) + clippingPlane.w);
+    globePosition.z = clippingZ * globePosition.w;
+    if (isPureGlobe())
+    {
+        return globePosition;
+    }
+    
+    glm::vec4 flatPosition = mercatorBaseMatrix * glm::vec4(mercator, 0.0f, 1.0f);
+    glm::vec4 result = glm::mix(flatPosition, globePosition, transition);
+    result.z = globePosition.z * getZMix();
+    return result;
+}
+
+bool ProjectionState::isInsideClipVolume(const glm::vec4& clip)
+{
+    return clip.x >= -clip.w && clip.x <= clip.w
+        && clip.y >= -clip.w && clip.y <= clip.w
+        && clip.z >= -clip.w && clip.z <= clip.w;
+}
+
+bool ProjectionState::unprojectFlat(const glm::vec2& ndc, glm::vec2& mercator) const
+{
+    // ndc.x * w = x，ndc.y * w = y，对 (mercX, mercY) 是线性方程组
+    const glm::mat4& m = mercatorBaseMatrix;
+    float a00 = m[0][0] - ndc.x * m[0][3];
+    float a01 = m[1][0] - ndc.x * m[1][3];
+    float b0 = ndc.x * m[3][3] - m[3][0];
+    float a10 = m[0][1] - ndc.y * m[0][3];
+    float a11 = m[1][1] - ndc.y * m[1][3];
+    float b1 = ndc.y * m[3][3] - m[3][1];
+    float det = a00 * a11 - a01 * a10;
+    if (std::abs(det) < 1e-12f)
+    {
+        return false;
+    }
+    mercator.x = (b0 * a11 - a01 * b1) / det;
+    mercator.y = (a00 * b1 - b0 * a10) / det;
+    return true;
+}
+
+bool ProjectionState::unprojectGlobe(const glm::vec2& ndc, glm::vec2& mercator) const
+{
+    // 视线：近、远平面上的两点变换回单位球空间
+    glm::vec4 nearPoint = inverseGlobeMatrix * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseGlobeMatrix * glm::vec4(ndc, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+    
+    // |origin + s * direction| = 1
+    float b = glm::dot(origin, direction);
+    float c = glm::dot(origin, origin) - 1.0f;
+    float discriminant = b * b - c;
+    // 掠射视线的判别式受 float 误差影响会略小于 0，按相切处理
+    if (discriminant < -kGrazingTolerance * b * b)
+    {
+        return false;
+    }
+    discriminant = std::max(discriminant, 0.0f);
+    float s = -b - std::sqrt(discriminant);
+    if (s < 0.0f)
+    {
+        s = -b + std::sqrt(discriminant);
+        if (s < 0.0f)
+        {
+            return false;
+        }
+    }
+    glm::vec3 spherePos = glm::normalize(origin + direction * s);
+    
+    // 裁剪平面背面的点在 shader 中被远平面裁掉
+    if (glm::dot(spherePos, glm::vec3(clippingPlane)) + clippingPlane.w < 0.0f)
+    {
+        return false;
+    }
+    
+    // 单位球 -> 经纬度 -> 墨卡托（与 sphereFromMercator 互逆）
+    float lon = std::atan2(spherePos.x, spherePos.z);
+    float lat = std::asin(std::clamp(spherePos.y, -1.0f, 1.0f));
+    mercator.x = nearestWrapMercX(lon / (2.0f * Constants::PI) + 0.5f);
+    mercator.y = GlobeProjection::mercatorYFromLat(lat * 180.0f / Constants::PI);
+    return true;
+}
+
+bool ProjectionState::unprojectNdc(const glm::vec2& ndc, glm::vec2& mercator, const glm::vec2* guess) const
+{
+    // 解是否对应屏幕上实际绘制的点；可见时换算到离 center 最近的副本写入 mercator
+    enum class Hit
+    {
+        Visible,
+        OffMap,     // 超出墨卡托范围或绘制的世界副本：该像素没有地图
+        Clipped     // 深度被裁剪（过渡后期背面）：可能还有另一个可见的解
+    };
+    auto classify = [&](glm::vec2 m) {
+        // 平面和过渡状态下绘制 wrap = -1、0、+1 三个世界副本（CoveringTiles），解可以落在两侧的副本上
+        if (m.y < 0.0f || m.y > 1.0f || m.x < -1.0f || m.x > 2.0f)
+        {
+            return Hit::OffMap;
+        }
+        // 按解所在的副本检查
+        if (!isInsideClipVolume(projectToClip(m)))
+        {
+            return Hit::Clipped;
+        }
+        mercator = glm::vec2(nearestWrapMercX(m.x), m.y);
+        return Hit::Visible;
+    };
+    
+    if (isPureGlobe())
+    {
+        glm::vec2 m;
+        return unprojectGlobe(ndc, m) && classify(m) == Hit::Visible;
+    }
+    
+    // 任意混合因子 t 下的残差（只用 x、y、w，与 projectToClip 在 t = transition 时相同）
+    auto residualAt = [&](const glm::vec2& m, float t) -> glm::vec2 {
+        glm::vec4 globePosition = globeMatrix * glm::vec4(sphereFromMercator(m), 1.0f);
+        glm::vec4 flatPosition = mercatorBaseMatrix * glm::vec4(m, 0.0f, 1.0f);
+        glm::vec4 clip = glm::mix(flatPosition, globePosition, t);
+        return glm::vec2(clip.x, clip.y) / clip.w - ndc;
+    };
+    
+    // 牛顿迭代，雅可比矩阵用中心差分，残差变大时步长减半；返回最终残差
+    const float h = 1e-3f / worldScale;
+    auto solve = [&](glm::vec2& m, float t) -> float {
+        float error = glm::length(residualAt(m, t));
+        for (int iteration = 0; iteration < kUnprojectMaxIterations && error > kUnprojectTolerance; iteration++)
+        {
+            glm::vec2 dx = (residualAt(m + glm::vec2(h, 0.0f), t) - residualAt(m - glm::vec2(h, 0.0f), t)) / (2.0f * h);
+            glm::vec2 dy = (residualAt(m + glm::vec2(0.0f, h), t) - residualAt(m - glm::vec2(0.0f, h), t)) / (2.0f * h);
+            float det = dx.x * dy.y - dy.x * dx.y;
+            if (std::abs(det) < 1e-20f)
+            {
+                break;
+            }
+            glm::vec2 r = residualAt(m, t);
+            glm::vec2 step((r.x * dy.y - dy.x * r.y) / det, (dx.x * r.y - r.x * dx.y) / det);
+            
+            float stepScale = 1.0f;
+            bool improved = false;
+            for (int halving = 0; halving < 8; halving++)
+            {
+                glm::vec2 next = m - step * stepScale;
+                float nextError = glm::length(residualAt(next, t));
+                if (nextError < error)
+                {
+                    m = next;
+                    error = nextError;
+                    improved = true;
+                    break;
+                }
+                stepScale *= 0.5f;
+            }
+            if (!improved)
+            {
+                break;
+            }
+        }
+        return error;
+    };
+    const float acceptError = kUnprojectTolerance * 100.0f;
+    
+    // 初值：平面解、球面解、外部提供的猜测。isFlat() 时平面解已是（或几乎是）精确解，球面解没有意义；
+    // transition 恰为 0 时残差为 0，不再迭代。球面解和猜测都已换算到离 center 最近的副本，
+    // 再各取一份离平面解最近的副本：像素落在两侧的副本上时平面解给出了正确的副本
+    glm::vec2 seeds[5];
+    float seedErrors[5];
+    int seedCount = 0;
+    auto addSeed = [&](const glm::vec2& m) {
+        seeds[seedCount] = m;
+        seedErrors[seedCount] = glm::length(residualAt(m, transition));
+        seedCount++;
+    };
+    glm::vec2 flatSolution;
+    const bool hasFlat = unprojectFlat(ndc, flatSolution);
+    auto addWrappedSeed = [&](const glm::vec2& m) {
+        addSeed(m);
+        float shift = hasFlat ? std::round(flatSolution.x - m.x) : 0.0f;
+        if (shift != 0.0f)
+        {
+            addSeed(glm::vec2(m.x + shift, m.y));
+        }
+    };
+    glm::vec2 candidate;
+    if (hasFlat) addSeed(flatSolution);
+    if (!isFlat() && unprojectGlobe(ndc, candidate)) addWrappedSeed(candidate);
+    if (guess) addWrappedSeed(*guess);
+    
+    // 按初始残差从小到大求解，第一个收敛且可见的解即为结果；收敛到地图之外说明像素上没有地图。
+    // 过渡状态下混合后的曲面可能折叠，同一像素有深度被裁剪的解，这时继续尝试其他初值
+    // 最多 5 个初值，直接插入排序（残差相同时保持加入的顺序）
+    int order[5];
+    for (int i = 0; i < seedCount; i++)
+    {
+        int j = i;
+        for (; j > 0 && seedErrors[order[j - 1]] > seedErrors[i]; j--)
+        {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+    bool converged = false;
+    for (int i = 0; i < seedCount; i++)
+    {
+        glm::vec2 m = seeds[order[i]];
+        if (solve(m, transition) < acceptError)
+        {
+            Hit hit = classify(m);
+            if (hit != Hit::Clipped)
+            {
+                return hit == Hit::Visible;
+            }
+            converged = true;
+        }
+    }
+    
+    // 初值离解太远（视口边缘、球的轮廓附近）时牛顿迭代可能停在局部极小：
+    // 从平面的精确解出发，把混合因子分步增加到 transition，每一步以上一步的解为初值（延拓法）
+    if (!converged && hasFlat && !isFlat())
+    {
+        glm::vec2 m = flatSolution;
+        float error = 0.0f;
+        for (int k = 1; k <= kUnprojectContinuationSteps; k++)
+        {
+            error = solve(m, transition * k / kUnprojectContinuationSteps);
+        }
+        return error < acceptError && classify(m) == Hit::Visible;
+    }
+    return false;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include "Constants.h"
+#include "TileID.h"
+#include <glm/glm.hpp>
+
+class GlobeProjection;
+
+/**
+ * 每帧的投影状态快照（不可变）
+ *
+ * 相机参数变化时由 GlobeProjection::getState 重新构建一次，
+ * 缓存所有 tile 共享的量：相机距离、Globe 半径、worldScale、wrap 后的中心经度、
+ * 中心点墨卡托坐标、投影/视图矩阵、Globe 矩阵和裁剪平面。
+ * 每个 tile 的矩阵和坐标只需要在共享矩阵上做少量乘加，不再有 pow/log/tan/perspective。
+ */
+class ProjectionState
+{
+public:
+    ProjectionState(const GlobeProjection& projection, float aspect);
+    
+    /**
+     * 判断快照是否仍然对应给定的相机参数（用于脏检查）
+     */
+    bool matches(const GlobeProjection& projection, float aspect) const;
+    
+    float getTransition() const { return transition; }
+    float getCenterLon() const { return centerLon; }
+    float getCenterLat() const { return centerLat; }
+    float getZoom() const { return zoom; }
+    float getAspect() const { return aspect; }
+    
+    float getCameraDistance() const { return cameraDistance; }
+    float getGlobeRadius() const { return globeRadius; }
+    float getWorldScale() const { return worldScale; }
+    float getWrappedLon() const { return wrappedLon; }
+    float getCenterMercX() const { return centerMercX; }
+    float getCenterMercY() const { return centerMercY; }
+    
+    /**
+     * center 在单位球上的方向（相机位于该方向、距球心 cameraDistance 处）
+     */
+    const glm::vec3& getCenterDirection() const { return centerDirection; }
+    
+    const glm::mat4& getProjectionMatrix() const { return projectionMatrix; }
+    /**
+     * 归一化墨卡托坐标（整个世界）-> Mercator 裁剪空间
+     */
+    const glm::mat4& getMercatorBaseMatrix() const { return mercatorBaseMatrix; }
+    const glm::mat4& getGlobeMatrix() const { return globeMatrix; }
+    const glm::vec4& getClippingPlane() const { return clippingPlane; }
+    
+    /**
+     * 纯 Mercator 模式（渲染所有 wrap）
+     */
+    bool isFlat() const { return transition < 0.001f; }
+    
+    /**
+     * 纯 Globe 模式（使用 Globe shader 变体，见 ShaderManager::selectProjection）
+     */
+    bool isPureGlobe() const { return transition > 0.999f; }
+    
+    /**
+     * 以下为每个 tile 的廉价推导，结果与 GlobeProjection 中同名计算一致
+     */
+    glm::mat4 mercatorMatrix(const TileID& tile) const;
+    glm::vec4 tileMercatorCoords(const TileID& tile) const;
+    int wrapForTile(int tileX, int tileZ) const;
+    
+    /**
+     * 2^z（tile 层级的 tile 数）
+     */
+    static float tileCount(int tileZ);
+    
+    /**
+     * Z 值延迟混合因子（对应 shader 中的 zMix）
+     */
+    float getZMix() const;
+    
+    /**
+     * 把归一化墨卡托 X 平移整数个世界宽度，使其离 center 最近（与 wrap 选择一致）
+     */
+    float nearestWrapMercX(float mercX) const;
+    
+    /**
+     * 归一化墨卡托坐标 -> 单位球坐标（与 shader 中 projectToSphere 相同的公式）
+     */
+    static glm::vec3 sphereFromMercator(const glm::vec2& mercator);
+    
+    /**
+     * CPU 端复刻顶点 shader：归一化墨卡托坐标 -> 混合后的裁剪空间坐标
+     * 包括纯 Globe 分支、clipping Z 和 Z 值延迟混合；wrap 由调用方决定
+     */
+    glm::vec4 projectToClip(const glm::vec2& mercator) const;
+    
+    /**
+     * 裁剪空间坐标是否在视锥内（与 GL 的裁剪规则一致）
+     */
+    static bool isInsideClipVolume(const glm::vec4& clip);
+    
+    /**
+     * 反投影：NDC（x, y ∈ [-1, 1]）-> 归一化墨卡托坐标（wrap 取离 center 最近的世界副本）
+     *
+     * - 纯 Globe：视线与单位球求交（取近交点），并检查裁剪平面
+     * - 平面（isFlat）：Mercator 平面的精确逆为初值，transition 不为 0 时再做几步牛顿迭代
+     * - 过渡状态：以平面/球面的精确解为初值做牛顿迭代，求解 shader 混合后的投影
+     * - 平面和过渡状态下两侧的世界副本（wrap = ±1）同样可以命中，结果换算到离 center 最近的副本
+     *
+     * guess 不为空时作为额外初值（例如相邻采样点的解），加速收敛
+     * 返回 false 表示该像素没有地图（天空、背面被裁剪或超出墨卡托范围）
+     */
+    bool unprojectNdc(const glm::vec2& ndc, glm::vec2& mercator, const glm::vec2* guess = nullptr) const;
+    
+    /**
+     * 解析初值：Mercator 平面精确逆 / Globe 射线求交
+     */
+    bool unprojectFlat(const glm::vec2& ndc, glm::vec2& mercator) const;
+    bool unprojectGlobe(const glm::vec2& ndc, glm::vec2& mercator) const;
+    
+private:
+    float transition;
+    float centerLon;
+    float centerLat;
+    float zoom;
+    float aspect;
+    
+    float cameraDistance;
+    float globeRadius;
+    float worldScale;
+    float wrappedLon;
+    float centerMercX;
+    float centerMercY;
+    glm::vec3 centerDirection;
+    
+    glm::mat4 projectionMatrix;
+    glm::mat4 mercatorBaseMatrix;  // proj * view * scale(worldScale, -worldScale) * translate(-center)
+    glm::mat4 globeMatrix;
+    glm::mat4 inverseGlobeMatrix;
+    glm::vec4 clippingPlane;
+};
@@ -0,0 +1,194 @@
+#include "RasterTileLoader.h"
+
+#include "Profiler.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+double secondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+} // namespace
+
+RasterTileLoader::RasterTileLoader(std::shared_ptr<const TileSource> source)
+    : RasterTileLoader(std::move(source), Options())
+{
+}
+
+RasterTileLoader::RasterTileLoader(std::shared_ptr<const TileSource> source, const Options& options)
+    : source(std::move(source)),
+      jobs(options.jobSystem ? *options.jobSystem : JobSystem::shared()),
+      results(options.queueCapacity),
+      stopping(false),
+      inFlight(0),
+      pendingJobs(0),
+      startTime(std::chrono::steady_clock::now()),
+      requested(0), rejected(0), decoded(0), failed(0), delivered(0), cancelled(0),
+      encodedBytes(0), decodedBytes(0),
+      decodeSeconds(0.0),
+      queueLatencySum(0.0), queueLatencyMax(0.0),
+      deliveryLatencySum(0.0), deliveryLatencyMax(0.0)
+{
+}
+
+RasterTileLoader::~RasterTileLoader()
+{
+    // 尚未开始的任务看到 stopping 后直接结束；等待期间帮调度器执行任务
+    stopping.store(true);
+    while (pendingJobs.load(std::memory_order_acquire) > 0)
+    {
+        if (!jobs.runOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool RasterTileLoader::request(const TileID& tile, TilePriority priority, std::shared_ptr<const CancellationToken> token)
+{
+    requested.fetch_add(1, std::memory_order_relaxed);
+    // 在途数量不超过结果队列容量，任务写结果时就不会遇到队列已满
+    if (inFlight.fetch_add(1, std::memory_order_relaxed) >= results.capacity())
+    {
+        inFlight.fetch_sub(1, std::memory_order_relaxed);
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    // 取消标记由 process 检查（需要返回 cancelled 结果），不交给调度器
+    Request request{ tile, priority, std::move(token), std::chrono::steady_clock::now() };
+    pendingJobs.fetch_add(1, std::memory_order_relaxed);
+    jobs.schedule([this, request]() {
+        if (!stopping.load(std::memory_order_relaxed))
+        {
+            process(request);
+        }
+        pendingJobs.fetch_sub(1, std::memory_order_release);
+    }, priority == TilePriority::Visible ? JobSystem::Priority::Normal : JobSystem::Priority::Low);
+    return true;
+}
+
+bool RasterTileLoader::poll(DecodedTile& out)
+{
+    if (!results.pop(out))
+    {
+        return false;
+    }
+    inFlight.fetch_sub(1, std::memory_order_relaxed);
+    delivered.fetch_add(1, std::memory_order_relaxed);
+    double latency = secondsBetween(out.requestTime, std::chrono::steady_clock::now());
+    atomicAdd(deliveryLatencySum, latency);
+    atomicMax(deliveryLatencyMax, latency);
+    return true;
+}
+
+RasterTileLoader::Stats RasterTileLoader::getStats() const
+{
+    Stats stats;
+    stats.requested = requested.load(std::memory_order_relaxed);
+    stats.rejected = rejected.load(std::memory_order_relaxed);
+    stats.decoded = decoded.load(std::memory_order_relaxed);
+    stats.failed = failed.load(std::memory_order_relaxed);
+    stats.delivered = delivered.load(std::memory_order_relaxed);
+    stats.cancelled = cancelled.load(std::memory_order_relaxed);
+    stats.encodedBytes = encodedBytes.load(std::memory_order_relaxed);
+    stats.decodedBytes = decodedBytes.load(std::memory_order_relaxed);
+    stats.decodeSeconds = decodeSeconds.load(std::memory_order_relaxed);
+    stats.queueLatencySum = queueLatencySum.load(std::memory_order_relaxed);
+    stats.queueLatencyMax = queueLatencyMax.load(std::memory_order_relaxed);
+    stats.deliveryLatencySum = deliveryLatencySum.load(std::memory_order_relaxed);
+    stats.deliveryLatencyMax = deliveryLatencyMax.load(std::memory_order_relaxed);
+    stats.elapsedSeconds = secondsBetween(startTime, std::chrono::steady_clock::now());
+    return stats;
+}
+
+bool RasterTileLoader::decode(const uint8_t* bytes, size_t size, DecodedTile& out)
+{
+    int width = 0, height = 0, channels = 0;
+    stbi_uc* pixels = stbi_load_from_memory(bytes, static_cast<int>(size), &width, &height, &channels, 4);
+    if (!pixels)
+    {
+        return false;
+    }
+    out.width = width;
+    out.height = height;
+    out.pixels.resize(static_cast<size_t>(width) * height * 4);
+    std::memcpy(out.pixels.data(), pixels, out.pixels.size());
+    stbi_image_free(pixels);
+    return true;
+}
+
+void RasterTileLoader::process(const Request& request)
+{
+    PROFILE_ZONE("RasterTileLoader::process");
+    auto start = std::chrono::steady_clock::now();
+    double queueLatency = secondsBetween(request.requestTime, start);
+    atomicAdd(queueLatencySum, queueLatency);
+    atomicMax(queueLatencyMax, queueLatency);
+    
+    DecodedTile result;
+    result.tile = request.tile;
+    result.priority = request.priority;
+    result.requestTime = request.requestTime;
+    if (request.token && request.token->isCancelled())
+    {
+        result.cancelled = true;
+        result.decodedTime = start;
+        cancelled.fetch_add(1, std::memory_order_relaxed);
+        while (!results.push(std::move(result)))
+        {
+            std::this_thread::yield();
+        }
+        return;
+    }
+    
+    // 优先零拷贝读取，否则读入每个线程复用的缓冲
+    thread_local std::vector<uint8_t> buffer;
+    const uint8_t* encoded = nullptr;
+    size_t encodedSize = 0;
+    if (!source->view(request.tile, encoded, encodedSize) && source->read(request.tile, buffer))
+    {
+        encoded = buffer.data();
+        encodedSize = buffer.size();
+    }
+    result.failed = !encoded || !decode(encoded, encodedSize, result);
+    
+    result.decodedTime = std::chrono::steady_clock::now();
+    atomicAdd(decodeSeconds, secondsBetween(start, result.decodedTime));
+    if (result.failed)
+    {
+        failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        decoded.fetch_add(1, std::memory_order_relaxed);
+        encodedBytes.fetch_add(encodedSize, std::memory_order_relaxed);
+        decodedBytes.fetch_add(result.sizeInBytes(), std::memory_order_relaxed);
+    }
+    
+    // request 限制了在途数量，这里正常情况下一次成功；失败只可能是并发 pop 尚未完成交接
+    while (!results.push(std::move(result)))
+    {
+        std::this_thread::yield();
+    }
+}
+
+void RasterTileLoader::atomicAdd(std::atomic<double>& target, double value)
+{
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void RasterTileLoader::atomicMax(std::atomic<double>& target, double value)
+{
+    double current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
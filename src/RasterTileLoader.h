@@ -0,0 +1,150 @@
+#pragma once
+#include "CancellationToken.h"
+#include "JobSystem.h"
+#include "LockFreeQueue.h"
+#include "TileID.h"
+#include "TileSource.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * 请求优先级：可见瓦片总是先于预取瓦片解码
+ */
+enum class TilePriority : uint8_t
+{
+    Visible = 0,
+    Prefetch = 1,
+};
+
+/**
+ * 解码完成的栅格瓦片（RGBA8，第一行是瓦片北侧）
+ */
+struct DecodedTile
+{
+    TileID tile;
+    TilePriority priority = TilePriority::Visible;
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+    bool failed = false;            // 数据源没有该瓦片或解码失败
+    bool cancelled = false;         // 开始解码前已被取消，没有像素
+    
+    std::chrono::steady_clock::time_point requestTime;
+    std::chrono::steady_clock::time_point decodedTime;
+    
+    size_t sizeInBytes() const { return pixels.size(); }
+};
+
+/**
+ * 异步栅格瓦片加载器（不依赖 GL）
+ *
+ * - request 由渲染线程调用，每个请求作为一个 JobSystem 任务提交，立即返回
+ *   （可见瓦片为 Normal 优先级，预取为 Low，帧构建的 High 任务总是先执行）
+ * - 任务中 TileSource 读字节，stb_image 解码为 RGBA8
+ * - 带取消标记的请求在解码前检查标记，已取消的直接以 cancelled 结果返回
+ * - 结果进入无锁队列，渲染线程每帧用 poll 取出并在自己的预算内上传
+ */
+class RasterTileLoader
+{
+public:
+    struct Options
+    {
+        JobSystem* jobSystem = nullptr; // nullptr 表示使用 JobSystem::shared()
+        size_t queueCapacity = 1024;    // 在途请求上限，也是结果队列的容量
+    };
+    
+    /**
+     * 累计统计（线程安全地读取一份快照）
+     */
+    struct Stats
+    {
+        uint64_t requested = 0;
+        uint64_t rejected = 0;          // 在途请求已达上限
+        uint64_t decoded = 0;
+        uint64_t failed = 0;
+        uint64_t delivered = 0;         // 已被 poll 取走
+        uint64_t cancelled = 0;         // 解码前被取消
+        uint64_t encodedBytes = 0;
+        uint64_t decodedBytes = 0;
+        double decodeSeconds = 0.0;     // 所有解码线程的读取 + 解码耗时之和
+        double queueLatencySum = 0.0;   // 请求 -> 解码线程开始处理
+        double queueLatencyMax = 0.0;
+        double deliveryLatencySum = 0.0; // 请求 -> 被 poll 取走
+        double deliveryLatencyMax = 0.0;
+        double elapsedSeconds = 0.0;    // 加载器创建至今
+        
+        double tilesPerSecond() const { return elapsedSeconds > 0.0 ? decoded / elapsedSeconds : 0.0; }
+        double decodedMegabytesPerSecond() const { return elapsedSeconds > 0.0 ? decodedBytes / elapsedSeconds / (1024.0 * 1024.0) : 0.0; }
+        double averageQueueLatency() const { return (decoded + failed + cancelled) > 0 ? queueLatencySum / (decoded + failed + cancelled) : 0.0; }
+        double averageDeliveryLatency() const { return delivered > 0 ? deliveryLatencySum / delivered : 0.0; }
+    };
+    
+    RasterTileLoader(std::shared_ptr<const TileSource> source, const Options& options);
+    explicit RasterTileLoader(std::shared_ptr<const TileSource> source);
+    ~RasterTileLoader();
+    
+    RasterTileLoader(const RasterTileLoader&) = delete;
+    RasterTileLoader& operator=(const RasterTileLoader&) = delete;
+    
+    /**
+     * 请求解码一个瓦片；在途请求已达上限时返回 false（调用方下一帧重试）
+     * token 被取消后，尚未开始的请求不再读取和解码
+     */
+    bool request(const TileID& tile, TilePriority priority = TilePriority::Visible,
+                 std::shared_ptr<const CancellationToken> token = nullptr);
+    
+    /**
+     * 取出一个解码结果（包括失败的）；没有结果时返回 false
+     */
+    bool poll(DecodedTile& out);
+    
+    /**
+     * 已请求但尚未被 poll 取走的瓦片数
+     */
+    size_t getInFlightCount() const { return inFlight.load(std::memory_order_relaxed); }
+    
+    /**
+     * 是否有已完成、等待 poll 的结果（近似值，用于决定是否需要重绘）
+     */
+    bool hasResults() const { return !results.emptyApprox(); }
+    unsigned getThreadCount() const { return jobs.getThreadCount(); }
+    const TileSource& getSource() const { return *source; }
+    
+    Stats getStats() const;
+    
+    /**
+     * 同步解码一段 PNG/JPEG 字节为 RGBA8（解码线程和测试共用）
+     */
+    static bool decode(const uint8_t* bytes, size_t size, DecodedTile& out);
+    
+private:
+    struct Request
+    {
+        TileID tile;
+        TilePriority priority = TilePriority::Visible;
+        std::shared_ptr<const CancellationToken> token;
+        std::chrono::steady_clock::time_point requestTime;
+    };
+    
+    void process(const Request& request);
+    static void atomicMax(std::atomic<double>& target, double value);
+    static void atomicAdd(std::atomic<double>& target, double value);
+    
+    std::shared_ptr<const TileSource> source;
+    JobSystem& jobs;
+    LockFreeQueue<DecodedTile> results;
+    std::atomic<bool> stopping;
+    std::atomic<size_t> inFlight;
+    std::atomic<size_t> pendingJobs;     // 已提交、尚未结束的任务（析构时等待归零）
+    
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<uint64_t> requested, rejected, decoded, failed, delivered, cancelled;
+    std::atomic<uint64_t> encodedBytes, decodedBytes;
+    std::atomic<double> decodeSeconds;
+    std::atomic<double> queueLatencySum, queueLatencyMax;
+    std::atomic<double> deliveryLatencySum, deliveryLatencyMax;
+};
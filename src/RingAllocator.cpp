@@ -0,0 +1,102 @@
+#include "RingAllocator.h"
+
+#include <cassert>
+
+namespace
+{
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+} // namespace
+
+RingAllocator::RingAllocator(size_t capacity)
+    : capacity(0), head(0), tail(0), frameStart(0), carriedBytes(0), nextFrame(0), demand(), largest(), currentLargest(0)
+{
+    reset(capacity);
+}
+
+void RingAllocator::reset(size_t capacity)
+{
+    // 当前帧在旧空间里已经分配的部分仍计入该帧的用量
+    carriedBytes = currentFrameBytes();
+    this->capacity = static_cast<size_t>(alignUp(capacity, kMaxAlignment));
+    head = 0;
+    tail = 0;
+    frameStart = 0;
+    frames.clear();
+}
+
+size_t RingAllocator::allocate(size_t bytes, size_t alignment)
+{
+    assert(alignment > 0 && alignment <= kMaxAlignment && (alignment & (alignment - 1)) == 0);
+    if (capacity == 0 || bytes > capacity)
+    {
+        stats.failures++;
+        return kInvalidOffset;
+    }
+    
+    uint64_t start = alignUp(head, alignment);
+    size_t offset = static_cast<size_t>(start % capacity);
+    bool wrapped = false;
+    if (offset + bytes > capacity)
+    {
+        // 尾部放不下：跳到环的开头
+        start += capacity - offset;
+        offset = 0;
+        wrapped = true;
+    }
+    if (start + bytes - tail > capacity)
+    {
+        stats.failures++;
+        return kInvalidOffset;
+    }
+    
+    head = start + bytes;
+    stats.allocations++;
+    stats.wraps += wrapped ? 1 : 0;
+    stats.largestAllocation = std::max(stats.largestAllocation, bytes);
+    currentLargest = std::max(currentLargest, bytes);
+    return offset;
+}
+
+uint64_t RingAllocator::endFrame()
+{
+    demand[stats.frames % kDemandWindow] = currentFrameBytes();
+    largest[stats.frames % kDemandWindow] = currentLargest;
+    stats.frames++;
+    carriedBytes = 0;
+    currentLargest = 0;
+    frames.push_back({ nextFrame, head });
+    frameStart = head;
+    return nextFrame++;
+}
+
+void RingAllocator::retire(uint64_t frame)
+{
+    while (!frames.empty() && frames.front().frame <= frame)
+    {
+        tail = frames.front().end;
+        frames.pop_front();
+    }
+}
+
+size_t RingAllocator::getPeakFrameBytes() const
+{
+    size_t peak = currentFrameBytes();
+    for (size_t i = 0; i < recentFrames(); i++)
+    {
+        peak = std::max(peak, demand[i]);
+    }
+    return peak;
+}
+
+size_t RingAllocator::requiredCapacity(size_t framesInFlight) const
+{
+    size_t largestRecent = currentLargest;
+    for (size_t i = 0; i < recentFrames(); i++)
+    {
+        largestRecent = std::max(largestRecent, largest[i]);
+    }
+    return static_cast<size_t>(alignUp(getPeakFrameBytes() * framesInFlight + largestRecent, kMaxAlignment));
+}
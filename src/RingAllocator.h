@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+/**
+ * 流式缓冲区的环形分配（不依赖 GL，GPU 同步由 StreamBuffer 负责）
+ *
+ * - 每帧的分配在环中连续前进，放不下时跳到环的开头（尾部剩余的空间本帧不再使用）
+ * - endFrame 结束一帧并返回帧号，调用方在 GPU 用完该帧的数据后 retire，空间才被复用
+ * - 记录最近若干帧每帧的用量（包括对齐和跳转浪费的空间），requiredCapacity
+ *   给出同时容纳若干帧所需的容量，用于按实测需求调整缓冲区大小
+ */
+class RingAllocator
+{
+public:
+    static constexpr size_t kInvalidOffset = static_cast<size_t>(-1);
+    // 支持的最大对齐；容量总是它的整数倍，偏移在环中回绕后仍然对齐
+    static constexpr size_t kMaxAlignment = 256;
+    // 统计每帧用量的帧数
+    static constexpr size_t kDemandWindow = 128;
+    
+    struct Stats
+    {
+        uint64_t frames = 0;
+        uint64_t allocations = 0;
+        uint64_t wraps = 0;           // 跳到环开头的次数
+        uint64_t failures = 0;        // 空间不足（调用方需要等待 GPU 或扩容）
+        size_t largestAllocation = 0;
+    };
+    
+    explicit RingAllocator(size_t capacity = 0);
+    
+    /**
+     * 设置新容量（向上取整为 kMaxAlignment 的倍数）并丢弃所有在途的帧；每帧用量的记录保留
+     */
+    void reset(size_t capacity);
+    
+    /**
+     * 分配 bytes 字节（alignment 为不超过 kMaxAlignment 的 2 的幂），返回环中的偏移；
+     * 与未 retire 的帧重叠时返回 kInvalidOffset
+     */
+    size_t allocate(size_t bytes, size_t alignment = kMaxAlignment);
+    
+    /**
+     * 结束当前帧，返回其帧号（从 0 开始递增）
+     */
+    uint64_t endFrame();
+    
+    /**
+     * GPU 已用完帧号不大于 frame 的所有帧，回收它们的空间
+     */
+    void retire(uint64_t frame);
+    
+    size_t getCapacity() const { return capacity; }
+    size_t getUsedBytes() const { return static_cast<size_t>(head - tail); }
+    size_t getFramesInFlight() const { return frames.size(); }
+    uint64_t getOldestFrameInFlight() const { return frames.empty() ? nextFrame : frames.front().frame; }
+    
+    /**
+     * 最近 kDemandWindow 帧中（包括进行中的一帧）单帧的最大用量
+     */
+    size_t getPeakFrameBytes() const;
+    
+    /**
+     * 同时容纳 framesInFlight 帧峰值用量所需的容量（另加一次跳转可能浪费的空间，
+     * 即最近 kDemandWindow 帧中最大的一次分配）
+     */
+    size_t requiredCapacity(size_t framesInFlight) const;
+    
+    const Stats& getStats() const { return stats; }
+    
+private:
+    struct Frame
+    {
+        uint64_t frame;
+        uint64_t end;       // 该帧最后一次分配的结束位置
+    };
+    
+    size_t currentFrameBytes() const { return static_cast<size_t>(head - frameStart) + carriedBytes; }
+    size_t recentFrames() const { return static_cast<size_t>(std::min<uint64_t>(stats.frames, kDemandWindow)); }
+    
+    size_t capacity;
+    // 位置为单调增加的字节计数，环中的偏移为 position % capacity
+    uint64_t head;          // 下一次分配的起点
+    uint64_t tail;          // 最旧的在途帧的起点
+    uint64_t frameStart;    // 当前帧的起点
+    size_t carriedBytes;    // 当前帧在 reset 之前已经分配的字节数
+    uint64_t nextFrame;
+    std::deque<Frame> frames;
+    
+    // 最近 kDemandWindow 帧每帧的用量与最大的一次分配（按帧号取模）
+    size_t demand[kDemandWindow];
+    size_t largest[kDemandWindow];
+    size_t currentLargest;
+    Stats stats;
+};
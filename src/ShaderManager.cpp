@@ -1,20 +1,39 @@
 #include "ShaderManager.h"
 
+#include "ProjectionState.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <vector>
 
 namespace
 {
-const char* kVertexShaderSource = R"(
-#version 330 core
+const char* kVersion = "#version 330 core\n";
 
+const char* kVertexShaderSource = R"(
 layout(location = 0) in vec2 a_pos;
 
-// 双矩阵系统：Globe 和 Mercator 投影矩阵
+// 每个 tile 的参数通过实例属性传入（见 TileInstance）
+layout(location = 1) in mat4 a_projection_fallback_matrix;      // Mercator 投影矩阵（投影 tile 坐标），占用 location 1..4
+layout(location = 5) in vec4 a_projection_tile_mercator_coords; // Tile 墨卡托坐标: [offsetX, offsetY, scaleX, scaleY]
+layout(location = 6) in vec4 a_color;                           // Tile 填充色
+layout(location = 7) in int a_sphere_offset;                    // 预计算球面坐标相对 gl_VertexID 的偏移（可以为负）
+layout(location = 8) in int a_texture_layer;                    // 栅格纹理数组的层（-1 表示使用填充色）
+layout(location = 9) in vec4 a_texture_rect;                    // 纹理坐标变换 uv * xy + zw（祖先回退时为子矩形）
+layout(location = 10) in int a_sphere_cached;                   // 1 表示使用预计算球面坐标，0 表示现算
+
+// 双矩阵系统：Globe 矩阵每帧共享，Mercator 矩阵按 tile 变化
 uniform mat4 u_projection_matrix;              // Globe 投影矩阵（投影单位球）
-uniform mat4 u_projection_fallback_matrix;      // Mercator 投影矩阵（投影 tile 坐标）
-uniform vec4 u_projection_tile_mercator_coords; // Tile 墨卡托坐标: [offsetX, offsetY, scaleX, scaleY]
 uniform float u_projection_transition;          // 过渡因子 (0=墨卡托, 1=Globe)
 uniform vec4 u_projection_clipping_plane;      // 裁剪平面（用于 Globe 背面裁剪）
+uniform samplerBuffer u_sphere_positions;      // CPU 预计算的单位球坐标（TileGeometryCache）
+
+flat out vec4 v_color;
+flat out int v_texture_layer;
+out vec2 v_tile_uv;
 
 #define PI 3.14159265358979323846
 
@@ -24,8 +43,8 @@ uniform vec4 u_projection_clipping_plane;      // 裁剪平面（用于 Globe 
  */
 vec3 projectToSphere(vec2 posInTile) {
     // tile 坐标 -> 归一化墨卡托
-    vec2 mercatorPos = u_projection_tile_mercator_coords.xy + 
-                       u_projection_tile_mercator_coords.zw * posInTile;
+    vec2 mercatorPos = a_projection_tile_mercator_coords.xy + 
+                       a_projection_tile_mercator_coords.zw * posInTile;
     
     // 归一化墨卡托 -> 球面角度
     vec2 spherical;
@@ -50,22 +69,32 @@ float globeComputeClippingZ(vec3 spherePos) {
 }
 
 void main() {
-    // 计算球面坐标
-    vec3 spherePos = projectToSphere(a_pos);
+    v_color = a_color;
+    v_texture_layer = a_texture_layer;
+    // TILE_EXTENT；瓦片图像第一行在北侧，与 tile 坐标 y 方向一致
+    v_tile_uv = a_pos / 8192.0 * a_texture_rect.xy + a_texture_rect.zw;
+
+#ifdef PROJECTION_MERCATOR
+    // 纯 Mercator：不需要球面坐标，Z 保持为 0（Mercator 的平面深度，与过渡前段一致）
+    gl_Position = a_projection_fallback_matrix * vec4(a_pos, 0.0, 1.0);
+    gl_Position.z = 0.0;
+#else
+    // 球面坐标：优先读取预计算结果，缓存放不下时才现算
+    vec3 spherePos = a_sphere_cached != 0
+        ? texelFetch(u_sphere_positions, a_sphere_offset + gl_VertexID).xyz
+        : projectToSphere(a_pos);
     
     // Globe 裁剪空间坐标
     vec4 globePosition = u_projection_matrix * vec4(spherePos, 1.0);
     // 关键：用自定义 Z 替换，用于裁剪背面
     globePosition.z = globeComputeClippingZ(spherePos) * globePosition.w;
-    
+
+#ifdef PROJECTION_GLOBE
     // 完全 Globe 模式：直接使用 Globe 投影
-    if (u_projection_transition > 0.999) {
-        gl_Position = globePosition;
-        return;
-    }
-    
+    gl_Position = globePosition;
+#else
     // Mercator 裁剪空间坐标
-    vec4 flatPosition = u_projection_fallback_matrix * vec4(a_pos, 0.0, 1.0);
+    vec4 flatPosition = a_projection_fallback_matrix * vec4(a_pos, 0.0, 1.0);
     
     // 关键：Z 值延迟混合策略（maplibre 标准实现）
     // 前 80% 过渡：Z 保持为 0（Mercator 的平面深度）
@@ -86,19 +115,144 @@ void main() {
     result.xyw = mix(flatPosition.xyw, globePosition.xyw, u_projection_transition);
     
     gl_Position = result;
+#endif
+#endif
 }
 )";
 
 const char* kFragmentShaderSource = R"(
-#version 330 core
+flat in vec4 v_color;
+flat in int v_texture_layer;
+in vec2 v_tile_uv;
 out vec4 FragColor;
-uniform vec4 u_color;
+uniform sampler2DArray u_raster_tiles;
 void main() {
-    FragColor = u_color;
+#ifdef WIREFRAME
+    // 线框 pass 统一使用黑色
+    FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+#else
+    if (v_texture_layer >= 0) {
+        FragColor = texture(u_raster_tiles, vec3(v_tile_uv, float(v_texture_layer)));
+    } else {
+        FragColor = v_color;
+    }
+#endif
 }
 )";
+
+// 程序二进制缓存文件：文件头之后是 glGetProgramBinary 的原始数据
+struct CacheHeader
+{
+    char magic[8];
+    uint64_t key;
+    uint32_t format;    // glGetProgramBinary 返回的 binaryFormat
+    uint32_t length;
+};
+const char kCacheMagic[8] = { 'G', 'L', 'B', 'P', 'R', 'O', 'G', '1' };
+
+uint64_t hashString(const std::string& text, uint64_t hash)
+{
+    // FNV-1a
+    for (unsigned char byte : text)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string glString(GLenum name)
+{
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+void printProgramLog(GLuint program, const char* what)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    std::vector<char> log(std::max(length, 1), '\0');
+    glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+    std::cerr << what << ": " << log.data() << std::endl;
+}
+
+const char* kProjectionNames[ShaderManager::kProjectionCount] = { "mercator", "globe", "blend" };
+const char* kProjectionDefines[ShaderManager::kProjectionCount] = { "PROJECTION_MERCATOR", "PROJECTION_GLOBE", "PROJECTION_BLEND" };
 } // namespace
 
+ShaderManager::ShaderManager(const std::string& cacheDirectory) : cacheDirectory(cacheDirectory), binarySupported(false)
+{
+    auto start = std::chrono::steady_clock::now();
+    driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION) + "\n" + glString(GL_SHADING_LANGUAGE_VERSION);
+    if (!this->cacheDirectory.empty() && GLAD_GL_VERSION_4_1)
+    {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        std::error_code error;
+        std::filesystem::create_directories(this->cacheDirectory, error);
+        binarySupported = formats > 0 && std::filesystem::is_directory(this->cacheDirectory, error);
+    }
+    
+    for (size_t projection = 0; projection < kProjectionCount; projection++)
+    {
+        for (bool wireframe : { false, true })
+        {
+            Variant variant;
+            variant.projection = static_cast<Projection>(projection);
+            variant.wireframe = wireframe;
+            programs[indexOf(variant)] = createProgram(variant);
+        }
+    }
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ShaderManager::~ShaderManager()
+{
+    for (const Program& program : programs)
+    {
+        glDeleteProgram(program.program);
+    }
+}
+
+const ShaderManager::Program& ShaderManager::getProgram(const Variant& variant) const
+{
+    // 特化变体创建失败时退回混合变体（对任何过渡因子都正确，只是更慢）
+    const Program& program = programs[indexOf(variant)];
+    if (program.program == 0)
+    {
+        Variant blend = variant;
+        blend.projection = Projection::Blend;
+        return programs[indexOf(blend)];
+    }
+    return program;
+}
+
+ShaderManager::Projection ShaderManager::selectProjection(const ProjectionState& state)
+{
+    // Globe 的阈值与原先 shader 中的分支相同；Mercator 只在过渡因子恰好为 0 时使用，
+    // 过渡刚开始时（isFlat 但不为 0）混合仍会让位置偏移不到一个像素，不能省略
+    if (state.getTransition() <= 0.0f)
+    {
+        return Projection::Mercator;
+    }
+    return state.isPureGlobe() ? Projection::Globe : Projection::Blend;
+}
+
+std::string ShaderManager::getVariantName(const Variant& variant)
+{
+    return std::string(kProjectionNames[static_cast<size_t>(variant.projection)]) + (variant.wireframe ? "-wireframe" : "");
+}
+
+std::string ShaderManager::getDefines(const Variant& variant)
+{
+    std::string defines = "#define " + std::string(kProjectionDefines[static_cast<size_t>(variant.projection)]) + "\n";
+    if (variant.wireframe)
+    {
+        defines += "#define WIREFRAME\n";
+    }
+    return defines;
+}
+
 const char* ShaderManager::getVertexShaderSource()
 {
     return kVertexShaderSource;
@@ -109,28 +263,204 @@ const char* ShaderManager::getFragmentShaderSource()
     return kFragmentShaderSource;
 }
 
-GLuint ShaderManager::compileShader(GLenum type, const char* source)
+GLuint ShaderManager::compileShader(GLenum type, const std::string& source)
 {
     GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, nullptr);
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
     glCompileShader(shader);
     
     int success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
-        char log[512];
-        glGetShaderInfoLog(shader, 512, nullptr, log);
-        std::cerr << "Shader compilation error: " << log << std::endl;
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(std::max(length, 1), '\0');
+        glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "Shader compilation error: " << log.data() << std::endl;
+        glDeleteShader(shader);
+        return 0;
     }
     return shader;
 }
 
-GLuint ShaderManager::createProgram()
+ShaderManager::Program ShaderManager::createProgram(const Variant& variant)
+{
+    std::string defines = getDefines(variant);
+    std::string vertexSource = kVersion + defines + getVertexShaderSource();
+    std::string fragmentSource = kVersion + defines + getFragmentShaderSource();
+    
+    // 缓存键：驱动标识 + 完整源码；文件名带上键，驱动或源码变化后自然不命中
+    std::string path;
+    uint64_t key = 0;
+    GLuint program = 0;
+    if (binarySupported)
+    {
+        key = hashString(fragmentSource, hashString(vertexSource, hashString(driver, 1469598103934665603ull)));
+        char name[32];
+        std::snprintf(name, sizeof(name), "-%016llx.bin", static_cast<unsigned long long>(key));
+        path = cacheDirectory + "/" + getVariantName(variant) + name;
+        program = loadBinary(path, key);
+    }
+    
+    if (program)
+    {
+        stats.loadedFromCache++;
+    }
+    else
+    {
+        program = linkProgram(vertexSource, fragmentSource, binarySupported);
+        if (program)
+        {
+            stats.compiled++;
+            if (binarySupported)
+            {
+                saveBinary(path, key, program);
+            }
+        }
+        else
+        {
+            std::cerr << "Shader variant " << getVariantName(variant) << " failed" << std::endl;
+            stats.failed++;
+        }
+    }
+    
+    Program result;
+    result.program = program;
+    if (program)
+    {
+        result.u_projection_matrix = glGetUniformLocation(program, "u_projection_matrix");
+        result.u_projection_transition = glGetUniformLocation(program, "u_projection_transition");
+        result.u_projection_clipping_plane = glGetUniformLocation(program, "u_projection_clipping_plane");
+        result.u_sphere_positions = glGetUniformLocation(program, "u_sphere_positions");
+        result.u_raster_tiles = glGetUniformLocation(program, "u_raster_tiles");
+    }
+    return result;
+}
+
+GLuint ShaderManager::linkProgram(const std::string& vertexSource, const std::string& fragmentSource, bool retrievable)
 {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vertexShader || !fragmentShader)
+    {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+    
     GLuint program = glCreateProgram();
-    glAttachShader(program, compileShader(GL_VERTEX_SHADER, getVertexShaderSource()));
-    glAttachShader(program, compileShader(GL_FRAGMENT_SHADER, getFragmentShaderSource()));
+    if (retrievable)
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
     glLinkProgram(program);
+    // 链接后着色器对象不再需要（程序保留编译结果）
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        printProgramLog(program, "Shader link error");
+        glDeleteProgram(program);
+        return 0;
+    }
     return program;
 }
 
+GLuint ShaderManager::loadBinary(const std::string& path, uint64_t key)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return 0;
+    }
+    CacheHeader header;
+    std::vector<uint8_t> binary;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) == 0
+        && header.key == key && header.length > 0;
+    if (ok)
+    {
+        binary.resize(header.length);
+        ok = std::fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    std::fclose(file);
+    
+    // 驱动可以拒绝任何二进制（例如同一版本字符串下的不同构建），以链接状态为准
+    GLuint program = 0;
+    if (ok)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (!program)
+    {
+        stats.cacheRejected++;
+    }
+    return program;
+}
+
+void ShaderManager::saveBinary(const std::string& path, uint64_t key, GLuint program)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+    CacheHeader header;
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.key = key;
+    std::vector<uint8_t> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+    
+    // 先写临时文件再改名，另一个进程不会读到写了一半的文件
+    std::string temporary = path + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        return;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fwrite(binary.data(), 1, header.length, file) == header.length;
+    ok = (std::fclose(file) == 0) && ok;
+    std::error_code error;
+    if (ok)
+    {
+        std::filesystem::rename(temporary, path, error);
+    }
+    if (!ok || error)
+    {
+        std::filesystem::remove(temporary, error);
+        return;
+    }
+    
+    // 同一变体旧键的文件（源码或驱动已变化）不会再命中，删除
+    std::filesystem::path saved(path);
+    std::string prefix = saved.filename().string();
+    prefix = prefix.substr(0, prefix.rfind('-') + 1);
+    for (const auto& entry : std::filesystem::directory_iterator(saved.parent_path(), error))
+    {
+        std::string name = entry.path().filename().string();
+        if (name != saved.filename().string() && name.compare(0, prefix.size(), prefix) == 0 && entry.path().extension() == ".bin"
+            && name.find('-', prefix.size()) == std::string::npos)
+        {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
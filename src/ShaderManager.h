@@ -1,10 +1,106 @@
 #pragma once
 #include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
 
+class ProjectionState;
+
+/**
+ * Tile shader 的变体与程序二进制缓存
+ *
+ * - 变体：同一份源码通过注入的宏编译出按投影模式特化的程序（纯 Mercator 不读取球面坐标，
+ *   纯 Globe 不计算 Mercator 位置与混合），每种投影各有填充和线框两个程序；
+ *   每帧用 selectProjection 按过渡因子选择最便宜的变体
+ * - 缓存：指定缓存目录时，链接好的程序用 glGetProgramBinary 保存到磁盘，
+ *   以驱动（GL_VENDOR / GL_RENDERER / GL_VERSION）和变体源码的 hash 为键；
+ *   下次启动直接 glProgramBinary 加载，键不匹配或驱动拒绝二进制时回退为从源码编译并重写缓存
+ *
+ * 所有变体在构造时创建，之后只读；只能在创建它的 GL 上下文所在线程上使用。
+ */
 class ShaderManager {
 public:
+    enum class Projection
+    {
+        Mercator,   // transition = 0
+        Globe,      // transition ≈ 1
+        Blend,      // 过渡中：两套坐标在裁剪空间混合
+    };
+    static constexpr size_t kProjectionCount = 3;
+    
+    struct Variant
+    {
+        Projection projection = Projection::Blend;
+        bool wireframe = false;   // 线框 pass：片元统一输出黑色
+    };
+    
+    /**
+     * 一个链接好的程序及其 uniform 位置（变体中不存在的 uniform 为 -1，glUniform 会忽略）
+     */
+    struct Program
+    {
+        GLuint program = 0;
+        GLint u_projection_matrix = -1;
+        GLint u_projection_transition = -1;
+        GLint u_projection_clipping_plane = -1;
+        GLint u_sphere_positions = -1;
+        GLint u_raster_tiles = -1;
+    };
+    
+    struct Stats
+    {
+        size_t compiled = 0;          // 从源码编译
+        size_t loadedFromCache = 0;   // 从程序二进制加载
+        size_t cacheRejected = 0;     // 缓存文件存在但无法使用（格式不符或驱动拒绝）
+        size_t failed = 0;            // 编译或链接失败
+        double milliseconds = 0.0;    // 创建全部变体的耗时
+    };
+    
+    /**
+     * cacheDirectory 为空时不使用磁盘缓存；目录不存在时自动创建
+     */
+    explicit ShaderManager(const std::string& cacheDirectory = std::string());
+    ~ShaderManager();
+    
+    ShaderManager(const ShaderManager&) = delete;
+    ShaderManager& operator=(const ShaderManager&) = delete;
+    
+    const Program& getProgram(const Variant& variant) const;
+    const Stats& getStats() const { return stats; }
+    
+    /**
+     * 按过渡因子选择投影变体，结果与混合变体逐像素相同
+     */
+    static Projection selectProjection(const ProjectionState& state);
+    
+    /**
+     * 变体名（用于缓存文件名和日志）与注入的宏
+     */
+    static std::string getVariantName(const Variant& variant);
+    static std::string getDefines(const Variant& variant);
+    
+    /**
+     * 不含 #version 行的源码主体，完整源码为 #version + 宏 + 主体
+     */
     static const char* getVertexShaderSource();
     static const char* getFragmentShaderSource();
-    static GLuint compileShader(GLenum type, const char* source);
-    static GLuint createProgram();
+    
+    /**
+     * 编译失败时输出日志并返回 0
+     */
+    static GLuint compileShader(GLenum type, const std::string& source);
+    
+private:
+    static size_t indexOf(const Variant& variant) { return static_cast<size_t>(variant.projection) * 2 + (variant.wireframe ? 1 : 0); }
+    
+    Program createProgram(const Variant& variant);
+    GLuint linkProgram(const std::string& vertexSource, const std::string& fragmentSource, bool retrievable);
+    GLuint loadBinary(const std::string& path, uint64_t key);
+    void saveBinary(const std::string& path, uint64_t key, GLuint program);
+    
+    Program programs[kProjectionCount * 2];
+    std::string cacheDirectory;
+    std::string driver;        // 参与缓存键的驱动标识
+    bool binarySupported;
+    Stats stats;
 };
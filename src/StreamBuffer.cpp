@@ -0,0 +1,150 @@
+#include "StreamBuffer.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+// 等待栅栏时每次的超时（纳秒）；超时后继续等待，只有 GL_WAIT_FAILED 才放弃
+constexpr GLuint64 kWaitTimeout = 100000000ull;
+
+size_t nextPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+} // namespace
+
+StreamBuffer::StreamBuffer(size_t initialCapacity) : buffer(0), mapped(nullptr), framesSinceCreate(0), waits(0), reallocations(0)
+{
+    create(nextPowerOfTwo(std::max(initialCapacity, kMinCapacity)));
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (const Fence& fence : fences)
+    {
+        glDeleteSync(fence.sync);
+    }
+    // 删除缓冲区时映射被隐式解除
+    glDeleteBuffers(1, &buffer);
+    glDeleteBuffers(static_cast<GLsizei>(retiredBuffers.size()), retiredBuffers.data());
+}
+
+void StreamBuffer::beginFrame()
+{
+    // 不等待地回收已完成的帧
+    while (!fences.empty())
+    {
+        GLenum status = glClientWaitSync(fences.front().sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        ring.retire(fences.front().frame);
+        glDeleteSync(fences.front().sync);
+        fences.pop_front();
+    }
+    // 三缓冲：GPU 上最多还有 kFramesInFlight - 1 帧，写入新的一帧前等待最旧的一帧
+    while (fences.size() >= kFramesInFlight)
+    {
+        waitOldest();
+    }
+    
+    // 按最近若干帧的实测用量调整容量：不够时扩容；长期不到四分之一时缩小（保留一倍余量）
+    size_t target = std::max(kMinCapacity, nextPowerOfTwo(ring.requiredCapacity(kFramesInFlight)));
+    bool grow = target > ring.getCapacity();
+    bool shrink = target * 4 <= ring.getCapacity() && framesSinceCreate >= RingAllocator::kDemandWindow;
+    if (grow || shrink)
+    {
+        // 在途的帧仍引用旧缓冲区，删除由 GL 推迟到这些命令完成之后
+        for (const Fence& fence : fences)
+        {
+            glDeleteSync(fence.sync);
+        }
+        fences.clear();
+        glDeleteBuffers(1, &buffer);
+        create(grow ? target : target * 2);
+        reallocations++;
+    }
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(size_t bytes, size_t alignment)
+{
+    size_t offset = ring.allocate(bytes, alignment);
+    while (offset == RingAllocator::kInvalidOffset && !fences.empty())
+    {
+        waitOldest();
+        offset = ring.allocate(bytes, alignment);
+    }
+    if (offset == RingAllocator::kInvalidOffset)
+    {
+        // 本帧的数据本身放不下：换更大的缓冲区，旧缓冲区中本帧已分配的地址保持映射到 endFrame
+        retiredBuffers.push_back(buffer);
+        create(nextPowerOfTwo(std::max(ring.getCapacity() * 2, ring.requiredCapacity(kFramesInFlight) + bytes)));
+        reallocations++;
+        offset = ring.allocate(bytes, alignment);
+    }
+    
+    Allocation allocation;
+    allocation.buffer = buffer;
+    allocation.offset = offset;
+    allocation.pointer = mapped + offset;
+    return allocation;
+}
+
+void StreamBuffer::endFrame()
+{
+    fences.push_back({ ring.endFrame(), glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+    framesSinceCreate++;
+    if (!retiredBuffers.empty())
+    {
+        glDeleteBuffers(static_cast<GLsizei>(retiredBuffers.size()), retiredBuffers.data());
+        retiredBuffers.clear();
+    }
+}
+
+StreamBuffer::Stats StreamBuffer::getStats() const
+{
+    Stats stats;
+    stats.capacity = ring.getCapacity();
+    stats.peakFrameBytes = ring.getPeakFrameBytes();
+    stats.waits = waits;
+    stats.reallocations = reallocations;
+    return stats;
+}
+
+void StreamBuffer::create(size_t capacity)
+{
+    // 不可变存储 + 持久一致映射：写入对 GPU 直接可见，不需要 flush，同步只靠栅栏
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, flags);
+    mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(capacity), flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if (!mapped)
+    {
+        std::cerr << "StreamBuffer: cannot map " << capacity << " bytes" << std::endl;
+    }
+    ring.reset(capacity);
+    framesSinceCreate = 0;
+}
+
+void StreamBuffer::waitOldest()
+{
+    waits++;
+    const Fence& fence = fences.front();
+    GLenum status = GL_TIMEOUT_EXPIRED;
+    while (status == GL_TIMEOUT_EXPIRED)
+    {
+        status = glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, kWaitTimeout);
+    }
+    ring.retire(fence.frame);
+    glDeleteSync(fence.sync);
+    fences.pop_front();
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "RingAllocator.h"
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * 每帧数据的流式上传：glBufferStorage 创建的持久、一致映射缓冲区，按 RingAllocator 环形分配
+ *
+ * - 调用方直接写入映射的内存（没有 glBufferSubData 的驱动端复制），再按返回的缓冲区和偏移
+ *   绑定为顶点属性、或用 glCopyBufferSubData 复制到其他缓冲区
+ * - 每帧结束时插入 glFenceSync，空间在 GPU 越过该帧的栅栏后才被复用；
+ *   最多 kFramesInFlight 帧同时占用（三缓冲），CPU 超前更多时在 beginFrame 等待最旧的一帧
+ * - 容量按实测的每帧用量自动调整：需求超过容量时换成更大的缓冲区，
+ *   长期远小于容量时缩小
+ *
+ * 只能在创建它的 GL 上下文所在线程上使用。
+ */
+class StreamBuffer
+{
+public:
+    static constexpr size_t kFramesInFlight = 3;
+    static constexpr size_t kMinCapacity = 256 * 1024;
+    
+    struct Allocation
+    {
+        GLuint buffer = 0;
+        size_t offset = 0;
+        void* pointer = nullptr;   // 映射的写入地址，只写不读（可能是写合并内存）
+    };
+    
+    struct Stats
+    {
+        size_t capacity = 0;
+        size_t peakFrameBytes = 0;   // 最近若干帧中单帧的最大用量
+        uint64_t waits = 0;          // CPU 等待 GPU 栅栏的次数
+        uint64_t reallocations = 0;  // 更换缓冲区（扩容或缩小）的次数
+    };
+    
+    explicit StreamBuffer(size_t initialCapacity = kMinCapacity);
+    ~StreamBuffer();
+    
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+    
+    /**
+     * 回收 GPU 已用完的帧，必要时等待，并按实测用量调整容量（每帧写入前调用一次）
+     */
+    void beginFrame();
+    
+    /**
+     * 分配 bytes 字节；空间不足时先等待在途的帧，仍不够则换成更大的缓冲区。
+     * 返回的地址在本帧 endFrame 之前有效
+     */
+    Allocation allocate(size_t bytes, size_t alignment = RingAllocator::kMaxAlignment);
+    
+    /**
+     * 本帧引用流式数据的命令都已提交后调用：插入栅栏
+     */
+    void endFrame();
+    
+    GLuint getBuffer() const { return buffer; }
+    Stats getStats() const;
+    
+private:
+    void create(size_t capacity);
+    void waitOldest();
+    
+    struct Fence
+    {
+        uint64_t frame;
+        GLsync sync;
+    };
+    
+    RingAllocator ring;
+    GLuint buffer;
+    uint8_t* mapped;
+    std::deque<Fence> fences;
+    std::vector<GLuint> retiredBuffers;   // 帧中途扩容前的缓冲区，本帧的地址仍可能被写入，endFrame 时删除
+    uint64_t framesSinceCreate;
+    uint64_t waits;
+    uint64_t reallocations;
+};
@@ -0,0 +1,358 @@
+#include "TileArchive.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(TileArchive::Header) == 64, "TileArchive::Header is a fixed on-disk layout");
+static_assert(sizeof(TileArchive::Entry) == 24, "TileArchive::Entry is a fixed on-disk layout");
+
+namespace
+{
+const char kMagic[8] = { 'G', 'M', 'T', 'I', 'L', 'E', 'S', '1' };
+
+// 目录和数据都写在 8 字节对齐的位置，映射后可以直接按结构体访问
+constexpr uint64_t kAlignment = 8;
+
+uint64_t alignUp(uint64_t value)
+{
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+bool fail(std::string* error, const std::string& message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return false;
+}
+
+uint64_t hashBytes(const std::vector<uint8_t>& bytes)
+{
+    // FNV-1a
+    uint64_t hash = 1469598103934665603ull;
+    for (uint8_t byte : bytes)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Hilbert 曲线在 s x s 子块内的旋转/翻转
+void rotate(uint32_t s, uint32_t& x, uint32_t& y, uint32_t rx, uint32_t ry)
+{
+    if (ry == 0)
+    {
+        if (rx != 0)
+        {
+            x = s - 1 - x;
+            y = s - 1 - y;
+        }
+        std::swap(x, y);
+    }
+}
+} // namespace
+
+TileArchive::~TileArchive()
+{
+    close();
+}
+
+bool TileArchive::open(const std::string& path, std::string* error)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return fail(error, "cannot open " + path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(Header)))
+    {
+        CloseHandle(file);
+        return fail(error, path + " is too small to be a tile archive");
+    }
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = fileMapping ? MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (fileMapping)
+        {
+            CloseHandle(fileMapping);
+        }
+        CloseHandle(file);
+        return fail(error, "cannot map " + path);
+    }
+    fileHandle = file;
+    mappingHandle = fileMapping;
+    mapping = view;
+    mappingSize = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return fail(error, "cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        ::close(fd);
+        return fail(error, path + " is too small to be a tile archive");
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后文件描述符就不再需要
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        return fail(error, "cannot map " + path);
+    }
+    mapping = view;
+    mappingSize = static_cast<size_t>(info.st_size);
+#endif
+    
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping);
+    const Header* candidate = reinterpret_cast<const Header*>(bytes);
+    if (std::memcmp(candidate->magic, kMagic, sizeof(kMagic)) != 0 || candidate->version != kVersion)
+    {
+        close();
+        return fail(error, path + " is not a version " + std::to_string(kVersion) + " tile archive");
+    }
+    uint64_t directoryEnd = candidate->directoryOffset + candidate->entryCount * sizeof(Entry);
+    if (candidate->directoryOffset % kAlignment != 0 || candidate->entryCount > mappingSize / sizeof(Entry)
+        || directoryEnd > mappingSize || candidate->dataOffset > mappingSize
+        || candidate->dataLength > mappingSize - candidate->dataOffset || candidate->maxZoom > kMaxZoom)
+    {
+        close();
+        return fail(error, path + " has a corrupt header");
+    }
+    header = candidate;
+    entries = reinterpret_cast<const Entry*>(bytes + header->directoryOffset);
+    data = bytes + header->dataOffset;
+    
+#ifndef _WIN32
+    // 目录每次查找都会访问，提前读入；瓦片数据按需缺页
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t directoryStart = header->directoryOffset / pageSize * pageSize;
+    posix_madvise(static_cast<uint8_t*>(mapping) + directoryStart, directoryEnd - directoryStart, POSIX_MADV_WILLNEED);
+#endif
+    return true;
+}
+
+void TileArchive::close()
+{
+    if (mapping)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(mapping, mappingSize);
+#endif
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    entries = nullptr;
+    data = nullptr;
+}
+
+bool TileArchive::find(const TileID& tile, Span& span) const
+{
+    if (!header || tile.z < header->minZoom || tile.z > header->maxZoom)
+    {
+        return false;
+    }
+    uint64_t tileId = tileIdFromTile(tile.z, tile.x, tile.y);
+    const Entry* end = entries + header->entryCount;
+    const Entry* entry = std::lower_bound(entries, end, tileId, [](const Entry& e, uint64_t id) {
+        return e.tileId < id;
+    });
+    if (entry == end || entry->tileId != tileId
+        || entry->offset > header->dataLength || entry->length > header->dataLength - entry->offset)
+    {
+        return false;
+    }
+    span.data = data + entry->offset;
+    span.size = entry->length;
+    return true;
+}
+
+uint64_t TileArchive::tileIdFromTile(int z, int x, int y)
+{
+    // 低层级的瓦片总数：(4^z - 1) / 3
+    uint64_t tileId = ((uint64_t(1) << (2 * z)) - 1) / 3;
+    uint32_t tx = static_cast<uint32_t>(x);
+    uint32_t ty = static_cast<uint32_t>(y);
+    for (uint32_t s = z > 0 ? uint32_t(1) << (z - 1) : 0; s > 0; s >>= 1)
+    {
+        uint32_t rx = (tx & s) ? 1 : 0;
+        uint32_t ry = (ty & s) ? 1 : 0;
+        tileId += uint64_t(s) * s * ((3 * rx) ^ ry);
+        rotate(s, tx, ty, rx, ry);
+    }
+    return tileId;
+}
+
+TileID TileArchive::tileFromTileId(uint64_t tileId)
+{
+    TileID tile;
+    uint64_t levelStart = 0;
+    // 损坏的编号不能让 z 增长到 32，否则 1 << (2 * z) 未定义
+    while (tile.z < kMaxZoom && levelStart + (uint64_t(1) << (2 * tile.z)) <= tileId)
+    {
+        levelStart += uint64_t(1) << (2 * tile.z);
+        tile.z++;
+    }
+    uint64_t t = tileId - levelStart;
+    uint32_t x = 0, y = 0;
+    for (uint32_t s = 1; s < (uint32_t(1) << tile.z); s <<= 1)
+    {
+        uint32_t rx = static_cast<uint32_t>(1 & (t / 2));
+        uint32_t ry = static_cast<uint32_t>(1 & (t ^ rx));
+        rotate(s, x, y, rx, ry);
+        x += s * rx;
+        y += s * ry;
+        t /= 4;
+    }
+    tile.x = static_cast<int>(x);
+    tile.y = static_cast<int>(y);
+    return tile;
+}
+
+void TileArchiveWriter::add(int z, int x, int y, std::vector<uint8_t> bytes)
+{
+    tiles.push_back(PendingTile{ TileArchive::tileIdFromTile(z, x, y), std::move(bytes) });
+}
+
+bool TileArchiveWriter::write(const std::string& path, TileArchive::TileType tileType, std::string* error) const
+{
+    std::vector<const PendingTile*> sorted;
+    sorted.reserve(tiles.size());
+    for (const PendingTile& tile : tiles)
+    {
+        sorted.push_back(&tile);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const PendingTile* a, const PendingTile* b) {
+        return a->tileId < b->tileId;
+    });
+    
+    // 按 Hilbert 顺序排布数据，内容相同的瓦片只写一次
+    std::vector<TileArchive::Entry> entries;
+    std::vector<const PendingTile*> blobs;
+    std::unordered_multimap<uint64_t, size_t> blobByHash;   // hash -> entries 下标
+    uint64_t dataLength = 0;
+    int minZoom = 255, maxZoom = 0;
+    for (const PendingTile* tile : sorted)
+    {
+        if (!entries.empty() && entries.back().tileId == tile->tileId)
+        {
+            return fail(error, "duplicate tile " + std::to_string(tile->tileId));
+        }
+        TileArchive::Entry entry = {};
+        entry.tileId = tile->tileId;
+        entry.length = static_cast<uint32_t>(tile->bytes.size());
+        
+        uint64_t hash = hashBytes(tile->bytes);
+        bool shared = false;
+        auto range = blobByHash.equal_range(hash);
+        for (auto it = range.first; it != range.second && !shared; ++it)
+        {
+            const TileArchive::Entry& other = entries[it->second];
+            if (other.length == entry.length && sorted[it->second]->bytes == tile->bytes)
+            {
+                entry.offset = other.offset;
+                shared = true;
+            }
+        }
+        if (!shared)
+        {
+            entry.offset = dataLength;
+            dataLength += tile->bytes.size();
+            blobs.push_back(tile);
+            blobByHash.emplace(hash, entries.size());
+        }
+        entries.push_back(entry);
+        
+        TileID id = TileArchive::tileFromTileId(tile->tileId);
+        minZoom = std::min(minZoom, id.z);
+        maxZoom = std::max(maxZoom, id.z);
+    }
+    
+    TileArchive::Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = TileArchive::kVersion;
+    header.tileType = tileType;
+    header.minZoom = static_cast<uint8_t>(entries.empty() ? 0 : minZoom);
+    header.maxZoom = static_cast<uint8_t>(maxZoom);
+    header.directoryOffset = alignUp(sizeof(header));
+    header.entryCount = entries.size();
+    header.dataOffset = alignUp(header.directoryOffset + entries.size() * sizeof(TileArchive::Entry));
+    header.dataLength = dataLength;
+    
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return fail(error, "cannot create " + path);
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && (entries.empty() || std::fwrite(entries.data(), sizeof(TileArchive::Entry), entries.size(), file) == entries.size());
+    static const uint8_t kPadding[kAlignment] = {};
+    uint64_t written = header.directoryOffset + entries.size() * sizeof(TileArchive::Entry);
+    ok = ok && std::fwrite(kPadding, 1, header.dataOffset - written, file) == header.dataOffset - written;
+    for (const PendingTile* blob : blobs)
+    {
+        ok = ok && std::fwrite(blob->bytes.data(), 1, blob->bytes.size(), file) == blob->bytes.size();
+    }
+    ok = (std::fclose(file) == 0) && ok;
+    return ok || fail(error, "cannot write " + path);
+}
+
+ArchiveTileSource::ArchiveTileSource(const std::string& path)
+{
+    archive.open(path, &error);
+}
+
+bool ArchiveTileSource::read(const TileID& tile, std::vector<uint8_t>& bytes) const
+{
+    TileArchive::Span span;
+    if (!archive.find(tile, span))
+    {
+        return false;
+    }
+    bytes.assign(span.data, span.data + span.size);
+    return true;
+}
+
+bool ArchiveTileSource::view(const TileID& tile, const uint8_t*& bytes, size_t& size) const
+{
+    TileArchive::Span span;
+    if (!archive.find(tile, span))
+    {
+        return false;
+    }
+    bytes = span.data;
+    size = span.size;
+    return true;
+}
+
+int ArchiveTileSource::getMaxZoom() const
+{
+    return archive.isOpen() ? archive.getHeader().maxZoom : -1;
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include "TileID.h"
+#include "TileSource.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 单文件瓦片归档（参考 PMTiles 的布局，简化为单级目录）
+ *
+ * 文件布局（小端）：
+ *   [Header 64 字节][目录：Entry 数组，按 tileId 升序][瓦片数据，连续存放]
+ *
+ * - tileId 为 PMTiles 的 Hilbert 编号：低层级的全部瓦片排在前面，同层级内按 Hilbert 曲线排序，
+ *   空间上相邻的瓦片在文件中也相邻，视口内的瓦片读取集中在少量页上
+ * - 内容完全相同的瓦片（海洋、空白）共享同一段数据
+ * - 读取端 mmap 整个文件，目录二分查找，返回指向映射内存的零拷贝 Span
+ */
+class TileArchive
+{
+public:
+    struct Header
+    {
+        char magic[8];              // "GMTILES1"
+        uint32_t version;
+        uint32_t tileType;          // TileType
+        uint8_t minZoom;
+        uint8_t maxZoom;
+        uint8_t reserved[6];
+        uint64_t directoryOffset;
+        uint64_t entryCount;
+        uint64_t dataOffset;
+        uint64_t dataLength;
+        uint64_t reserved2;
+    };
+    
+    struct Entry
+    {
+        uint64_t tileId;
+        uint64_t offset;            // 相对 dataOffset
+        uint32_t length;
+        uint32_t reserved;
+    };
+    
+    enum TileType : uint32_t
+    {
+        Unknown = 0,
+        Png = 1,
+        Jpeg = 2,
+        Mvt = 3,    // Mapbox Vector Tile（可以是 gzip 压缩的）
+    };
+    
+    /**
+     * 映射内存中的一段只读字节，生命周期与 TileArchive 相同
+     */
+    struct Span
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+    
+    static constexpr uint32_t kVersion = 1;
+    static constexpr int kMaxZoom = 31;     // 更高层级的 4^z 超出 tileId 的 64 位
+    
+    TileArchive() = default;
+    ~TileArchive();
+    
+    TileArchive(const TileArchive&) = delete;
+    TileArchive& operator=(const TileArchive&) = delete;
+    
+    /**
+     * 映射并校验归档；失败时返回 false，error 给出原因
+     */
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+    
+    /**
+     * 查找瓦片（忽略 wrap），不存在时返回 false；线程安全
+     */
+    bool find(const TileID& tile, Span& span) const;
+    
+    const Header& getHeader() const { return *header; }
+    size_t getEntryCount() const { return static_cast<size_t>(header->entryCount); }
+    const Entry* getEntries() const { return entries; }
+    size_t getFileSize() const { return mappingSize; }
+    
+    /**
+     * z/x/y 与 Hilbert tileId 互转（与 PMTiles 的 zxy_to_tileid 一致）；z 不超过 kMaxZoom，
+     * 超出 z = kMaxZoom 编号范围的 tileId 按 kMaxZoom 解码（高位丢弃）
+     */
+    static uint64_t tileIdFromTile(int z, int x, int y);
+    static TileID tileFromTileId(uint64_t tileId);
+    
+private:
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+    const Header* header = nullptr;
+    const Entry* entries = nullptr;
+    const uint8_t* data = nullptr;
+};
+
+/**
+ * 归档写入：收集瓦片后一次性写出（目录排序、重复内容合并）
+ */
+class TileArchiveWriter
+{
+public:
+    void add(int z, int x, int y, std::vector<uint8_t> bytes);
+    
+    /**
+     * 写出归档；失败时返回 false
+     */
+    bool write(const std::string& path, TileArchive::TileType tileType, std::string* error = nullptr) const;
+    
+    size_t getTileCount() const { return tiles.size(); }
+    
+private:
+    struct PendingTile
+    {
+        uint64_t tileId;
+        std::vector<uint8_t> bytes;
+    };
+    
+    std::vector<PendingTile> tiles;
+};
+
+/**
+ * 以归档为数据源：view 直接返回映射内存，解码线程不做任何拷贝
+ */
+class ArchiveTileSource : public TileSource
+{
+public:
+    /**
+     * 打开失败时 isOpen() 为 false，所有读取都返回 false
+     */
+    explicit ArchiveTileSource(const std::string& path);
+    
+    bool read(const TileID& tile, std::vector<uint8_t>& bytes) const override;
+    bool view(const TileID& tile, const uint8_t*& bytes, size_t& size) const override;
+    int getMaxZoom() const override;
+    
+    bool isOpen() const { return archive.isOpen(); }
+    const std::string& getError() const { return error; }
+    const TileArchive& getArchive() const { return archive; }
+    
+private:
+    TileArchive archive;
+    std::string error;
+};
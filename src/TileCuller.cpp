@@ -0,0 +1,190 @@
+#include "TileCuller.h"
+
+#include "GlobeProjection.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// 包围体的额外余量，吸收 shader 与 CPU 浮点误差
+constexpr float kBoundsEpsilon = 1e-4f;
+
+glm::vec3 sphereDirection(float lonRad, float latRad)
+{
+    // 与 shader 中 projectToSphere 的坐标约定一致
+    float len = cos(latRad);
+    return glm::vec3(sin(lonRad) * len, sin(latRad), cos(lonRad) * len);
+}
+
+float angleBetween(const glm::vec3& a, const glm::vec3& b)
+{
+    return acos(std::clamp(glm::dot(a, b), -1.0f, 1.0f));
+}
+} // namespace
+
+TileBounds TileBounds::fromTile(const TileID& tile)
+{
+    float numTiles = pow(2.0f, tile.z);
+    float mercMinX = (tile.x + tile.wrap * numTiles) / numTiles;
+    float mercMaxX = mercMinX + 1.0f / numTiles;
+    float mercMinY = tile.y / numTiles;
+    float mercMaxY = mercMinY + 1.0f / numTiles;
+    
+    float lonMin = (mercMinX - 0.5f) * 2.0f * Constants::PI;
+    float lonMax = (mercMaxX - 0.5f) * 2.0f * Constants::PI;
+    float latMax = GlobeProjection::latFromMercatorY(mercMinY) * Constants::PI / 180.0f;
+    float latMin = GlobeProjection::latFromMercatorY(mercMaxY) * Constants::PI / 180.0f;
+    
+    TileBounds bounds;
+    bounds.capAxis = sphereDirection((lonMin + lonMax) * 0.5f, (latMin + latMax) * 0.5f);
+    
+    if (lonMax - lonMin > Constants::PI + kBoundsEpsilon)
+    {
+        // 经度跨度超过半球（z0）：直接用整个球
+        bounds.capAngle = Constants::PI;
+    }
+    else
+    {
+        // 经度跨度不超过 180° 时，经纬矩形内离轴最远的点一定是四个角点之一
+        float angle = 0.0f;
+        angle = std::max(angle, angleBetween(bounds.capAxis, sphereDirection(lonMin, latMin)));
+        angle = std::max(angle, angleBetween(bounds.capAxis, sphereDirection(lonMax, latMin)));
+        angle = std::max(angle, angleBetween(bounds.capAxis, sphereDirection(lonMin, latMax)));
+        angle = std::max(angle, angleBetween(bounds.capAxis, sphereDirection(lonMax, latMax)));
+        bounds.capAngle = angle + kBoundsEpsilon;
+    }
+    
+    if (bounds.capAngle >= Constants::PI * 0.5f)
+    {
+        bounds.sphereCenter = glm::vec3(0.0f);
+        bounds.sphereRadius = 1.0f + kBoundsEpsilon;
+    }
+    else
+    {
+        float capHeight = cos(bounds.capAngle);
+        bounds.sphereCenter = bounds.capAxis * capHeight;
+        bounds.sphereRadius = sin(bounds.capAngle) + kBoundsEpsilon;
+    }
+    return bounds;
+}
+
+void TileCuller::update(std::shared_ptr<const ProjectionState> state)
+{
+    this->state = std::move(state);
+}
+
+TileCuller::Result TileCuller::test(const TileID& tile) const
+{
+    TileBounds bounds = TileBounds::fromTile(tile);
+    const glm::vec4& clippingPlane = state->getClippingPlane();
+    const glm::mat4& globeMatrix = state->getGlobeMatrix();
+    
+    // 地平线：球冠上 dot(p, n) 的最大值 = cos(max(0, 轴与法线夹角 - 角半径))
+    // shader 中 clipping Z = 1 - (dot(p, n) + d)，dot(p, n) + d < 0 的点被远平面裁掉
+    if (state->isPureGlobe())
+    {
+        glm::vec3 normal(clippingPlane);
+        float axisAngle = angleBetween(bounds.capAxis, normal);
+        float maxDot = cos(std::max(0.0f, axisAngle - bounds.capAngle));
+        if (maxDot + clippingPlane.w < -kBoundsEpsilon)
+        {
+            return Result::BeyondHorizon;
+        }
+    }
+    
+    // 视锥：只测试 x/y 四个平面
+    // （过渡状态下 z 被替换为延迟混合的 clipping Z，纯 Globe 的远平面已由地平线测试覆盖）
+    float t = state->getTransition();
+    
+    glm::vec4 flatCorners[4];
+    int flatCount = 0;
+    if (!state->isPureGlobe())
+    {
+        glm::mat4 mercatorMatrix = state->mercatorMatrix(tile);
+        const float extent = static_cast<float>(Constants::TILE_EXTENT);
+        flatCorners[flatCount++] = mercatorMatrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        flatCorners[flatCount++] = mercatorMatrix * glm::vec4(extent, 0.0f, 0.0f, 1.0f);
+        flatCorners[flatCount++] = mercatorMatrix * glm::vec4(0.0f, extent, 0.0f, 1.0f);
+        flatCorners[flatCount++] = mercatorMatrix * glm::vec4(extent, extent, 0.0f, 1.0f);
+    }
+    
+    glm::vec4 globeCorners[8];
+    int globeCount = 0;
+    if (t > 0.0f)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            glm::vec3 corner = bounds.sphereCenter + bounds.sphereRadius * glm::vec3(
+                (i & 1) ? 1.0f : -1.0f,
+                (i & 2) ? 1.0f : -1.0f,
+                (i & 4) ? 1.0f : -1.0f);
+            globeCorners[globeCount++] = globeMatrix * glm::vec4(corner, 1.0f);
+        }
+    }
+    
+    // 混合后的点集：flat 与 globe 角点两两按 t 插值，其凸包包含所有混合后的顶点
+    // 纯模式下退化为单侧角点
+    int outside[4] = {0, 0, 0, 0};
+    int total = 0;
+    auto classify = [&](const glm::vec4& p) {
+        if (p.x > p.w) outside[0]++;
+        if (p.x < -p.w) outside[1]++;
+        if (p.y > p.w) outside[2]++;
+        if (p.y < -p.w) outside[3]++;
+        total++;
+    };
+    
+    if (globeCount == 0)
+    {
+        for (int i = 0; i < flatCount; i++) classify(flatCorners[i]);
+    }
+    else if (flatCount == 0)
+    {
+        for (int j = 0; j < globeCount; j++) classify(globeCorners[j]);
+    }
+    else
+    {
+        for (int i = 0; i < flatCount; i++)
+        {
+            for (int j = 0; j < globeCount; j++)
+            {
+                classify(flatCorners[i] * (1.0f - t) + globeCorners[j] * t);
+            }
+        }
+    }
+    
+    for (int plane = 0; plane < 4; plane++)
+    {
+        if (outside[plane] == total)
+        {
+            return Result::OutsideFrustum;
+        }
+    }
+    return Result::Visible;
+}
+
+bool TileCuller::isVisible(const TileID& tile)
+{
+    Result result = test(tile);
+    stats.tested++;
+    switch (result)
+    {
+    case Result::Visible:
+        stats.kept++;
+        return true;
+    case Result::OutsideFrustum:
+        stats.culledFrustum++;
+        break;
+    case Result::BeyondHorizon:
+        stats.culledHorizon++;
+        break;
+    }
+    return false;
+}
+
+void TileCuller::cull(std::vector<TileID>& tiles)
+{
+    tiles.erase(std::remove_if(tiles.begin(), tiles.end(), [this](const TileID& tile) {
+        return !isVisible(tile);
+    }), tiles.end());
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "ProjectionState.h"
+#include "TileID.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Tile 的保守包围体
+ *
+ * - Globe：单位球上的球冠（轴向 + 角半径），以及包住球冠的包围球
+ *   （球冠内任意两点的弦也在包围球内，所以网格三角形同样被包住）
+ * - Mercator：tile 局部坐标 [0, TILE_EXTENT]² 的矩形，经 Mercator 矩阵变换
+ */
+struct TileBounds
+{
+    glm::vec3 capAxis;        // 球冠中心方向（单位向量）
+    float capAngle;           // 球冠角半径（弧度），>= PI/2 时包围球退化为整个单位球
+    glm::vec3 sphereCenter;   // 包围球球心（单位球空间）
+    float sphereRadius;       // 包围球半径
+    
+    static TileBounds fromTile(const TileID& tile);
+};
+
+/**
+ * CPU 端 tile 剔除
+ *
+ * 在提交前剔除完全不可见的 tile：
+ * 1. 视锥：在裁剪空间中测试 Mercator 角点与 Globe 包围盒角点按过渡因子混合后的凸包，
+ *    与 shader 中 mix(flatPosition, globePosition, transition) 的插值方式一致，任意过渡状态都保守
+ * 2. 地平线：纯 Globe 模式下，球冠整体位于裁剪平面背面时剔除（对应 shader 的 clipping Z）
+ */
+class TileCuller
+{
+public:
+    enum class Result
+    {
+        Visible,
+        OutsideFrustum,
+        BeyondHorizon
+    };
+    
+    struct Stats
+    {
+        size_t tested = 0;
+        size_t kept = 0;
+        size_t culledFrustum = 0;
+        size_t culledHorizon = 0;
+    };
+    
+    /**
+     * 每帧调用一次，持有本帧的投影状态快照
+     */
+    void update(std::shared_ptr<const ProjectionState> state);
+    
+    /**
+     * 测试单个 tile（不修改统计）
+     */
+    Result test(const TileID& tile) const;
+    
+    /**
+     * 测试单个 tile 并累计统计
+     */
+    bool isVisible(const TileID& tile);
+    
+    /**
+     * 原地移除不可见的 tile
+     */
+    void cull(std::vector<TileID>& tiles);
+    
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = Stats(); }
+    
+private:
+    std::shared_ptr<const ProjectionState> state;
+    Stats stats;
+};
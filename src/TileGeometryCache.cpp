@@ -0,0 +1,187 @@
+#include "TileGeometryCache.h"
+
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "ProjectionState.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// 每个并行任务至少计算的 slot 数，少于该数量时直接在当前线程计算
+constexpr size_t kParallelThreshold = 8;
+} // namespace
+
+TileGeometryCache::TileGeometryCache(const TileMesh& mesh, size_t memoryBudget)
+    : mesh(mesh)
+{
+    slotVertexCount = 0;
+    for (int level = 0; level < TileMesh::kLodCount; level++)
+    {
+        slotVertexCount = std::max(slotVertexCount, mesh.getLod(level).vertexCount);
+    }
+    size_t slotBytes = slotVertexCount * 3 * sizeof(float);
+    size_t slotCount = std::max<size_t>(1, memoryBudget / slotBytes);
+    
+    positions.resize(slotCount * slotVertexCount * 3);
+    slots.resize(slotCount);
+    freeSlots.reserve(slotCount);
+    for (size_t i = slotCount; i > 0; i--)
+    {
+        freeSlots.push_back(static_cast<int>(i - 1));
+    }
+}
+
+void TileGeometryCache::beginFrame()
+{
+    frame++;
+}
+
+uint64_t TileGeometryCache::makeKey(const TileID& tile, int lod)
+{
+    // z < 32，x/y < 2^z，足够打包进 64 位
+    return (static_cast<uint64_t>(tile.z) << 59)
+         | (static_cast<uint64_t>(lod) << 56)
+         | (static_cast<uint64_t>(tile.y) << 28)
+         | static_cast<uint64_t>(tile.x);
+}
+
+void TileGeometryCache::unlink(int slot)
+{
+    Slot& s = slots[slot];
+    if (s.prev >= 0) slots[s.prev].next = s.next; else lruHead = s.next;
+    if (s.next >= 0) slots[s.next].prev = s.prev; else lruTail = s.prev;
+    s.prev = s.next = -1;
+}
+
+void TileGeometryCache::pushFront(int slot)
+{
+    Slot& s = slots[slot];
+    s.prev = -1;
+    s.next = lruHead;
+    if (lruHead >= 0) slots[lruHead].prev = slot;
+    lruHead = slot;
+    if (lruTail < 0) lruTail = slot;
+}
+
+int TileGeometryCache::acquire(const TileID& tile, int lod)
+{
+    uint64_t key = makeKey(tile, lod);
+    auto it = lookup.find(key);
+    if (it != lookup.end())
+    {
+        int slot = it->second;
+        slots[slot].lastUsedFrame = frame;
+        unlink(slot);
+        pushFront(slot);
+        stats.hits++;
+        return slot;
+    }
+    
+    int slot = -1;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else if (lruTail >= 0 && slots[lruTail].lastUsedFrame != frame)
+    {
+        // 淘汰最久未使用的 slot（链表尾部）；尾部都已在本帧使用说明缓存已满
+        slot = lruTail;
+        unlink(slot);
+        lookup.erase(slots[slot].key);
+        stats.evictions++;
+    }
+    else
+    {
+        stats.failures++;
+        return -1;
+    }
+    
+    Slot& s = slots[slot];
+    s.key = key;
+    s.tile = tile;
+    s.tile.wrap = 0;
+    s.lod = lod;
+    s.lastUsedFrame = frame;
+    pushFront(slot);
+    lookup[key] = slot;
+    pending.push_back(slot);
+    stats.misses++;
+    return slot;
+}
+
+const std::vector<int>& TileGeometryCache::computePending()
+{
+    PROFILE_ZONE("TileGeometryCache::computePending");
+    computed.swap(pending);
+    pending.clear();
+    
+    auto computeRange = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const Slot& s = slots[computed[i]];
+            computeTile(mesh, s.tile, s.lod, &positions[slotFirstVertex(computed[i]) * 3]);
+        }
+    };
+    
+    JobSystem::shared().parallelFor(computed.size(), kParallelThreshold, computeRange);
+    return computed;
+}
+
+void TileGeometryCache::computeTile(const TileMesh& mesh, const TileID& tile, int lod, float* out)
+{
+    const TileMesh::Lod& meshLod = mesh.getLod(lod);
+    const int divisions = meshLod.divisions;
+    const int step = Constants::TILE_EXTENT / divisions;
+    
+    // 与 shader 相同的 tile 坐标 -> 归一化墨卡托变换（wrap 固定为 0）
+    float numTiles = ProjectionState::tileCount(tile.z);
+    float offsetX = tile.x / numTiles;
+    float offsetY = tile.y / numTiles;
+    float scale = 1.0f / numTiles / Constants::TILE_EXTENT;
+    
+    // 每列的经度、每行的纬度只算一次；表按线程复用（computePending 在多个工作线程上调用），未命中时不再分配
+    thread_local std::vector<float> table;
+    table.resize((divisions + 1) * 4);
+    float* sinLon = table.data();
+    float* cosLon = sinLon + divisions + 1;
+    float* sinLat = cosLon + divisions + 1;
+    float* cosLat = sinLat + divisions + 1;
+    for (int i = 0; i <= divisions; i++)
+    {
+        float mercX = offsetX + scale * (i * step);
+        float mercY = offsetY + scale * (i * step);
+        float lon = mercX * Constants::PI * 2.0f + Constants::PI;
+        float lat = 2.0f * std::atan(std::exp(Constants::PI - mercY * Constants::PI * 2.0f)) - Constants::PI * 0.5f;
+        sinLon[i] = std::sin(lon);
+        cosLon[i] = std::cos(lon);
+        sinLat[i] = std::sin(lat);
+        cosLat[i] = std::cos(lat);
+    }
+    
+    const uint16_t* vertices = mesh.getVertices().data() + meshLod.baseVertex * 2;
+    for (uint32_t v = 0; v < meshLod.vertexCount; v++)
+    {
+        int column = vertices[v * 2 + 0] / step;
+        int row = vertices[v * 2 + 1] / step;
+        out[v * 3 + 0] = sinLon[column] * cosLat[row];
+        out[v * 3 + 1] = sinLat[row];
+        out[v * 3 + 2] = cosLon[column] * cosLat[row];
+    }
+}
+
+glm::vec3 TileGeometryCache::projectToSphereReference(const glm::vec4& tileMercatorCoords, const glm::vec2& posInTile)
+{
+    // tile 坐标 -> 归一化墨卡托
+    glm::vec2 mercatorPos = glm::vec2(tileMercatorCoords.x, tileMercatorCoords.y)
+                            + glm::vec2(tileMercatorCoords.z, tileMercatorCoords.w) * posInTile;
+    
+    // 归一化墨卡托 -> 球面角度
+    float lon = mercatorPos.x * Constants::PI * 2.0f + Constants::PI;
+    float lat = 2.0f * std::atan(std::exp(Constants::PI - mercatorPos.y * Constants::PI * 2.0f)) - Constants::PI * 0.5f;
+    
+    // 球面角度 -> 单位球笛卡尔坐标
+    float len = std::cos(lat);
+    return glm::vec3(std::sin(lon) * len, std::sin(lat), std::cos(lon) * len);
+}
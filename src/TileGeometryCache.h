@@ -0,0 +1,106 @@
+#pragma once
+#include "TileID.h"
+#include "TileMesh.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Tile 单位球坐标缓存（不依赖 GL）
+ *
+ * 球面坐标只取决于 tile 的 z/x/y 和网格 LOD，与相机无关，因此在 CPU 上预先计算，
+ * 作为第二路顶点数据上传，shader 中只需做矩阵混合，不再逐顶点计算 atan/exp/sin/cos。
+ *
+ * - 经度只取决于网格列、纬度只取决于网格行，每个 tile 只需 O(divisions) 次超越函数，
+ *   每个顶点只剩几次乘法
+ * - 存储为固定大小的 slot（按最大 LOD 的顶点数），总内存受 memoryBudget 限制
+ * - LRU 淘汰，本帧已经使用的 slot 不会被淘汰
+ * - wrap 不影响球面坐标（经度相差 2π 的整数倍），key 中不包含 wrap
+ */
+class TileGeometryCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t failures = 0;   // 所有 slot 都被本帧占用，无法分配
+    };
+    
+    TileGeometryCache(const TileMesh& mesh, size_t memoryBudget = 32 * 1024 * 1024);
+    
+    /**
+     * 开始新的一帧：之后 acquire 的 slot 在本帧内不会被淘汰
+     */
+    void beginFrame();
+    
+    /**
+     * 获取 tile 在指定 LOD 下的 slot，未命中时分配（必要时淘汰最久未使用的 slot）
+     * 并登记为待计算；返回 -1 表示缓存已被本帧占满
+     */
+    int acquire(const TileID& tile, int lod);
+    
+    /**
+     * 计算所有待计算的 slot（数量较多时分摊到多个线程）
+     * 返回本次计算过的 slot，供 GL 端上传
+     */
+    const std::vector<int>& computePending();
+    
+    /**
+     * slot 在整个坐标数组中的起始顶点
+     */
+    uint32_t slotFirstVertex(int slot) const { return static_cast<uint32_t>(slot) * slotVertexCount; }
+    uint32_t getSlotVertexCount() const { return slotVertexCount; }
+    int getSlotCount() const { return static_cast<int>(slots.size()); }
+    
+    /**
+     * 所有 slot 的坐标（每个顶点 xyz 三个 float）
+     */
+    const float* getPositions() const { return positions.data(); }
+    size_t getPositionsSizeInBytes() const { return positions.size() * sizeof(float); }
+    
+    const Stats& getStats() const { return stats; }
+    const TileMesh& getMesh() const { return mesh; }
+    
+    /**
+     * 计算一个 tile 在指定 LOD 下所有顶点的单位球坐标，顶点顺序与 TileMesh 一致
+     */
+    static void computeTile(const TileMesh& mesh, const TileID& tile, int lod, float* out);
+    
+    /**
+     * CPU 参考实现：逐句对应 shader 中的 projectToSphere
+     */
+    static glm::vec3 projectToSphereReference(const glm::vec4& tileMercatorCoords, const glm::vec2& posInTile);
+    
+private:
+    struct Slot
+    {
+        uint64_t key = 0;
+        TileID tile;
+        int lod = -1;
+        uint64_t lastUsedFrame = 0;
+        int prev = -1;   // LRU 链表，头部为最近使用
+        int next = -1;
+    };
+    
+    static uint64_t makeKey(const TileID& tile, int lod);
+    void unlink(int slot);
+    void pushFront(int slot);
+    
+    const TileMesh& mesh;
+    uint32_t slotVertexCount;
+    std::vector<float> positions;
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    std::unordered_map<uint64_t, int> lookup;
+    int lruHead = -1;
+    int lruTail = -1;
+    uint64_t frame = 0;
+    
+    std::vector<int> pending;
+    std::vector<int> computed;
+    Stats stats;
+};
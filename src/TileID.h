@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Tile 标识：z/x/y 以及所在的世界副本 wrap
+ */
+struct TileID
+{
+    int x = 0;
+    int y = 0;
+    int z = 0;
+    int wrap = 0;
+
+    bool operator==(const TileID& other) const
+    {
+        return x == other.x && y == other.y && z == other.z && wrap == other.wrap;
+    }
+    bool operator!=(const TileID& other) const { return !(*this == other); }
+    
+    /**
+     * 不含 wrap 的 64 位 key（z:6 | y:29 | x:29），用于按瓦片内容索引的缓存
+     */
+    uint64_t key() const
+    {
+        return (static_cast<uint64_t>(z) << 58) | (static_cast<uint64_t>(y) << 29) | static_cast<uint64_t>(x);
+    }
+};
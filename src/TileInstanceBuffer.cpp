@@ -0,0 +1,64 @@
+#include "TileInstanceBuffer.h"
+
+#include "Profiler.h"
+
+void TileInstanceBuffer::build(const ProjectionState& state, const std::vector<TileID>& tiles, TileGeometryCache* geometryCache)
+{
+    PROFILE_ZONE("TileInstanceBuffer::build");
+    // 按 LOD 计数排序：先统计每个 LOD 的数量，再按偏移写入
+    tileLods.resize(tiles.size());
+    uint32_t counts[TileMesh::kLodCount] = {};
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        tileLods[i] = static_cast<uint8_t>(TileMesh::selectLod(state, tiles[i]));
+        counts[tileLods[i]]++;
+    }
+    uint32_t offset = 0;
+    for (int lod = 0; lod < TileMesh::kLodCount; lod++)
+    {
+        lodRanges[lod].first = offset;
+        lodRanges[lod].count = 0;
+        offset += counts[lod];
+    }
+    
+    instances.resize(tiles.size());
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        const TileID& tile = tiles[i];
+        int lod = tileLods[i];
+        Range& range = lodRanges[lod];
+        TileInstance& instance = instances[range.first + range.count++];
+        instance.mercatorMatrix = state.mercatorMatrix(tile);
+        instance.tileMercatorCoords = state.tileMercatorCoords(tile);
+        instance.color = tileColor(tile);
+        instance.tileID = glm::ivec4(tile.x, tile.y, tile.z, tile.wrap);
+        instance.resources = glm::ivec4(-1, -1, 0, 0);
+        instance.textureRect = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+        
+        int slot = geometryCache ? geometryCache->acquire(tile, lod) : -1;
+        if (slot >= 0)
+        {
+            // gl_VertexID 已包含 LOD 的 baseVertex，这里减掉，换算成 slot 内的顶点序号；
+            // slot 靠前而 baseVertex 较大时偏移为负，是否使用缓存由 z 单独标记
+            const TileMesh::Lod& meshLod = geometryCache->getMesh().getLod(lod);
+            instance.resources.x = static_cast<int>(geometryCache->slotFirstVertex(slot)) - static_cast<int>(meshLod.baseVertex);
+            instance.resources.z = 1;
+        }
+    }
+}
+
+void TileInstanceBuffer::clear()
+{
+    instances.clear();
+    for (Range& range : lodRanges)
+    {
+        range = Range();
+    }
+}
+
+glm::vec4 TileInstanceBuffer::tileColor(const TileID& tile)
+{
+    float r = ((tile.x + tile.y) % 2 == 0) ? 0.3f : 0.5f;
+    float g = ((tile.x + tile.y) % 2 == 0) ? 0.5f : 0.3f;
+    return glm::vec4(r, g, 0.4f, 1.0f);
+}
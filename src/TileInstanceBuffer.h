@@ -0,0 +1,69 @@
+#pragma once
+#include "ProjectionState.h"
+#include "TileGeometryCache.h"
+#include "TileID.h"
+#include "TileMesh.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 单个 tile 的实例数据（紧凑排列，直接作为 instanced 顶点属性上传）
+ */
+struct TileInstance
+{
+    glm::mat4 mercatorMatrix;       // 对应原 u_projection_fallback_matrix
+    glm::vec4 tileMercatorCoords;   // 对应原 u_projection_tile_mercator_coords
+    glm::vec4 color;                // 对应原 u_color（填充色）
+    glm::ivec4 tileID;              // x, y, z, wrap
+    glm::ivec4 resources;           // x: 球面坐标在缓存中的偏移（相对 gl_VertexID，已减去 LOD 的 baseVertex，可以为负）
+                                    // y: 栅格纹理数组的层（-1 表示没有纹理，使用填充色）
+                                    // z: 1 表示球面坐标已在缓存中（x 有效），0 表示由 shader 现算
+    glm::vec4 textureRect;          // tile 纹理坐标变换 uv * xy + zw（使用祖先瓦片时取其子矩形）
+};
+static_assert(sizeof(TileInstance) == 144, "TileInstance must stay tightly packed");
+
+/**
+ * 每帧的 tile 实例缓冲构建器（纯 CPU，不依赖 GL）
+ *
+ * 为每个可见 tile 计算 Mercator 矩阵、墨卡托坐标、wrap 和颜色，
+ * 结果作为一个连续数组交给 GL 端提交。实例按网格 LOD 分组连续存放，
+ * 每个 LOD 一次 instanced draw（通过 baseInstance 定位）。
+ */
+class TileInstanceBuffer
+{
+public:
+    struct Range
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+    
+    /**
+     * 传入 geometryCache 时为每个 tile 获取预计算的球面坐标 slot
+     */
+    void build(const ProjectionState& state, const std::vector<TileID>& tiles, TileGeometryCache* geometryCache = nullptr);
+    void clear();
+    
+    const TileInstance* data() const { return instances.data(); }
+    size_t size() const { return instances.size(); }
+    size_t sizeInBytes() const { return instances.size() * sizeof(TileInstance); }
+    const TileInstance& operator[](size_t i) const { return instances[i]; }
+    TileInstance& operator[](size_t i) { return instances[i]; }
+    
+    /**
+     * 使用指定网格 LOD 的实例范围
+     */
+    const Range& getLodRange(int lod) const { return lodRanges[lod]; }
+    
+    /**
+     * 棋盘格填充色（与原 renderSingleTile 一致）
+     */
+    static glm::vec4 tileColor(const TileID& tile);
+    
+private:
+    std::vector<TileInstance> instances;
+    std::vector<uint8_t> tileLods;
+    Range lodRanges[TileMesh::kLodCount];
+};
@@ -0,0 +1,150 @@
+#include "TileMesh.h"
+
+#include "GlobeProjection.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+namespace
+{
+// 按列带遍历网格：每个带宽 bandWidth 列，带内逐行，行内从左到右
+// 每个格子的两个三角形与原 createTileMesh 相同
+void emitBandOrder(int divisions, int bandWidth, std::vector<uint16_t>& indices)
+{
+    const int stride = divisions + 1;
+    indices.clear();
+    for (int bandStart = 0; bandStart < divisions; bandStart += bandWidth)
+    {
+        int bandEnd = std::min(divisions, bandStart + bandWidth);
+        for (int y = 0; y < divisions; y++)
+        {
+            for (int x = bandStart; x < bandEnd; x++)
+            {
+                uint16_t v00 = static_cast<uint16_t>(y * stride + x);
+                uint16_t v10 = static_cast<uint16_t>(y * stride + x + 1);
+                uint16_t v01 = static_cast<uint16_t>((y + 1) * stride + x);
+                uint16_t v11 = static_cast<uint16_t>((y + 1) * stride + x + 1);
+                indices.insert(indices.end(), {v00, v10, v01});
+                indices.insert(indices.end(), {v10, v11, v01});
+            }
+        }
+    }
+}
+} // namespace
+
+TileMesh::TileMesh()
+{
+    std::vector<uint16_t> lodVertices;
+    std::vector<uint16_t> lodIndices;
+    int divisions = kMinDivisions;
+    for (int level = 0; level < kLodCount; level++, divisions *= 2)
+    {
+        buildGrid(divisions, lodVertices, lodIndices);
+        optimizeGrid(divisions, lodVertices, lodIndices);
+        
+        Lod& lod = lods[level];
+        lod.divisions = divisions;
+        lod.baseVertex = static_cast<uint32_t>(vertices.size() / 2);
+        lod.vertexCount = static_cast<uint32_t>(lodVertices.size() / 2);
+        lod.firstIndex = static_cast<uint32_t>(indices.size());
+        lod.indexCount = static_cast<uint32_t>(lodIndices.size());
+        vertices.insert(vertices.end(), lodVertices.begin(), lodVertices.end());
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+}
+
+int TileMesh::selectLod(const ProjectionState& state, const TileID& tile)
+{
+    if (state.isFlat())
+    {
+        return 0;
+    }
+    
+    // 每格经度跨度 = 360 / 2^z / divisions
+    float tileSpan = 360.0f / ProjectionState::tileCount(tile.z);
+    int level = 0;
+    int divisions = kMinDivisions;
+    while (level < kLodCount - 1 && tileSpan / divisions > kMaxCellAngle)
+    {
+        level++;
+        divisions *= 2;
+    }
+    
+    // 高纬度：经线在球面上快速汇聚，加密一级
+    float numTiles = ProjectionState::tileCount(tile.z);
+    float latNorth = GlobeProjection::latFromMercatorY(tile.y / numTiles);
+    float latSouth = GlobeProjection::latFromMercatorY((tile.y + 1) / numTiles);
+    if (std::max(std::abs(latNorth), std::abs(latSouth)) > kPolarLatitude)
+    {
+        level = std::min(level + 1, kLodCount - 1);
+    }
+    return level;
+}
+
+void TileMesh::buildGrid(int divisions, std::vector<uint16_t>& vertices, std::vector<uint16_t>& indices)
+{
+    // 与原 createTileMesh 的步长一致：divisions 为 2 的幂时每个顶点都是整数
+    const int stride = divisions + 1;
+    const float step = Constants::TILE_EXTENT / (float)divisions;
+    vertices.resize(stride * stride * 2);
+    for (int y = 0; y <= divisions; y++)
+    {
+        for (int x = 0; x <= divisions; x++)
+        {
+            vertices[(y * stride + x) * 2 + 0] = static_cast<uint16_t>(x * step);
+            vertices[(y * stride + x) * 2 + 1] = static_cast<uint16_t>(y * step);
+        }
+    }
+    emitBandOrder(divisions, divisions, indices);
+}
+
+void TileMesh::optimizeGrid(int divisions, std::vector<uint16_t>& vertices, std::vector<uint16_t>& indices)
+{
+    // 带宽的闭式解：FIFO 缓存要同时容纳上一行和当前行带内的 (w + 1) 个顶点，即 2 (w + 1) <= 缓存大小；
+    // 按这个上限需要的带数均分列，避免最后一个带过窄（与逐个带宽模拟 ACMR 选出的结果相同）
+    const int maxBand = std::max(1, kVertexCacheSize / 2 - 1);
+    const int bandCount = (divisions + maxBand - 1) / maxBand;
+    const int bestBand = (divisions + bandCount - 1) / bandCount;
+    emitBandOrder(divisions, bestBand, indices);
+    
+    // 顶点按首次使用顺序重排
+    const uint16_t kUnassigned = 0xFFFF;
+    std::vector<uint16_t> remap(vertices.size() / 2, kUnassigned);
+    std::vector<uint16_t> reordered(vertices.size());
+    uint16_t next = 0;
+    for (uint16_t& index : indices)
+    {
+        if (remap[index] == kUnassigned)
+        {
+            reordered[next * 2 + 0] = vertices[index * 2 + 0];
+            reordered[next * 2 + 1] = vertices[index * 2 + 1];
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+float TileMesh::averageCacheMissRatio(const std::vector<uint16_t>& indices, size_t first, size_t count, int cacheSize)
+{
+    if (count < 3)
+    {
+        return 0.0f;
+    }
+    std::deque<uint16_t> cache;
+    size_t misses = 0;
+    for (size_t i = first; i < first + count; i++)
+    {
+        uint16_t index = indices[i];
+        if (std::find(cache.begin(), cache.end(), index) == cache.end())
+        {
+            misses++;
+            cache.push_back(index);
+            if ((int)cache.size() > cacheSize)
+            {
+                cache.pop_front();
+            }
+        }
+    }
+    return static_cast<float>(misses) / (count / 3);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "ProjectionState.h"
+#include "TileID.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Tile 网格（带索引、量化、顶点缓存友好）
+ *
+ * - 顶点：uint16 的 tile 局部坐标（TILE_EXTENT = 8192 可以精确表示），每个顶点 4 字节
+ * - 索引：uint16，按 LOD 局部编号，绘制时通过 baseVertex 定位
+ * - 三角形顺序：按列带（band）逐行遍历，带宽由 FIFO 顶点缓存大小直接算出；
+ *   顶点再按首次使用顺序重排，提高顶点读取的局部性
+ *
+ * 多个细分级别（LOD）打包在同一组顶点/索引数组中，每个三角形与原
+ * createTileMesh 生成的三角形完全一致（位置和绕序）。
+ */
+class TileMesh
+{
+public:
+    struct Lod
+    {
+        int divisions;
+        uint32_t baseVertex;   // 在顶点数组中的起始顶点
+        uint32_t vertexCount;
+        uint32_t firstIndex;   // 在索引数组中的起始位置
+        uint32_t indexCount;
+    };
+    
+    static constexpr int kLodCount = 5;                           // 4, 8, 16, 32, 64 细分
+    static constexpr int kMinDivisions = 4;
+    static constexpr int kVertexCacheSize = 16;                   // 模拟的后变换顶点缓存大小（保守取值）
+    static constexpr float kMaxCellAngle = 360.0f / 128.0f;       // Globe 模式下每格允许的最大经度跨度（度）
+    static constexpr float kPolarLatitude = 60.0f;                // 超过该纬度的 tile 在 Globe 模式下加密一级
+    
+    TileMesh();
+    
+    const std::vector<uint16_t>& getVertices() const { return vertices; }  // x, y 交错
+    const std::vector<uint16_t>& getIndices() const { return indices; }
+    const Lod& getLod(int level) const { return lods[level]; }
+    
+    /**
+     * 按 tile 层级和纬度选择 LOD：
+     * - 纯 Mercator 模式：平面不需要细分，使用最粗的网格
+     * - Globe/过渡模式：按 tile 经度跨度保证每格不超过 kMaxCellAngle，高纬 tile 再加密一级
+     */
+    static int selectLod(const ProjectionState& state, const TileID& tile);
+    
+    /**
+     * 生成 divisions × divisions 的网格（未排序的行优先顺序）
+     */
+    static void buildGrid(int divisions, std::vector<uint16_t>& vertices, std::vector<uint16_t>& indices);
+    
+    /**
+     * 重排三角形和顶点顺序，提高顶点缓存命中率
+     */
+    static void optimizeGrid(int divisions, std::vector<uint16_t>& vertices, std::vector<uint16_t>& indices);
+    
+    /**
+     * 模拟 FIFO 顶点缓存，返回平均每个三角形的缓存未命中数（ACMR）
+     */
+    static float averageCacheMissRatio(const std::vector<uint16_t>& indices, size_t first, size_t count, int cacheSize);
+    
+private:
+    std::vector<uint16_t> vertices;
+    std::vector<uint16_t> indices;
+    Lod lods[kLodCount];
+};
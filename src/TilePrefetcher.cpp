@@ -0,0 +1,124 @@
+#include "TilePrefetcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 低于该速度（每秒）视为静止：经纬度按度、缩放按级、过渡因子按 0..1
+    constexpr float kMinAngularSpeed = 1e-3f;
+    constexpr float kMinZoomSpeed = 1e-3f;
+    constexpr float kMinTransitionSpeed = 1e-3f;
+}
+
+const std::vector<TileID>& TilePrefetcher::predict(const GlobeProjection& projection, float aspect, double seconds,
+                                                   const CoveringTiles& coveringTiles)
+{
+    predictedTiles.clear();
+    
+    samples.push_back(Sample{ seconds, projection.centerLon, projection.centerLat, projection.zoom, projection.transition });
+    while (samples.size() > 2 && seconds - samples[1].seconds >= options.velocityWindow)
+    {
+        samples.pop_front();
+    }
+    
+    // 窗口首尾两个采样的差分作为速度，对逐帧的抖动不敏感
+    const Sample& first = samples.front();
+    const Sample& last = samples.back();
+    double dt = last.seconds - first.seconds;
+    if (dt <= 0.0)
+    {
+        return predictedTiles;
+    }
+    float lonSpeed = static_cast<float>((last.lon - first.lon) / dt);
+    float latSpeed = static_cast<float>((last.lat - first.lat) / dt);
+    float zoomSpeed = static_cast<float>((last.zoom - first.zoom) / dt);
+    float transitionSpeed = static_cast<float>((last.transition - first.transition) / dt);
+    if (std::abs(lonSpeed) < kMinAngularSpeed && std::abs(latSpeed) < kMinAngularSpeed
+        && std::abs(zoomSpeed) < kMinZoomSpeed && std::abs(transitionSpeed) < kMinTransitionSpeed)
+    {
+        return predictedTiles;
+    }
+    
+    float lookahead = static_cast<float>(options.lookaheadSeconds);
+    predicted.centerLon = projection.centerLon + lonSpeed * lookahead;
+    predicted.centerLat = std::clamp(projection.centerLat + latSpeed * lookahead, -85.0f, 85.0f);
+    predicted.zoom = std::clamp(projection.zoom + zoomSpeed * lookahead, 0.0f, static_cast<float>(coveringTiles.options.maxZoom));
+    predicted.transition = std::clamp(projection.transition + transitionSpeed * lookahead, 0.0f, 1.0f);
+    
+    std::shared_ptr<const ProjectionState> state = predicted.getState(aspect);
+    culler.update(state);
+    predictedTiles = coveringTiles.select(*state, &culler);
+    return predictedTiles;
+}
+
+void TilePrefetcher::onPrefetched(const TileID& tile, double seconds)
+{
+    Record& record = records[tile.key()];
+    record.issuedSeconds = seconds;
+    record.uploaded = false;
+    stats.prefetched++;
+}
+
+void TilePrefetcher::onDelivered(const TileID& tile, bool uploaded)
+{
+    auto it = records.find(tile.key());
+    if (it == records.end())
+    {
+        return;
+    }
+    // 数据源中不存在或上传失败的不计入任何一类
+    if (uploaded) it->second.uploaded = true; else records.erase(it);
+}
+
+void TilePrefetcher::onCancelled(const TileID& tile)
+{
+    if (records.erase(tile.key()))
+    {
+        stats.cancelled++;
+    }
+}
+
+void TilePrefetcher::onVisible(const TileID& tile, bool resident)
+{
+    auto it = records.find(tile.key());
+    if (it == records.end())
+    {
+        return;
+    }
+    if (resident) stats.hits++; else stats.late++;
+    records.erase(it);
+}
+
+void TilePrefetcher::endFrame(double seconds, size_t misses)
+{
+    stats.frames++;
+    stats.frameMisses = misses;
+    stats.totalMisses += misses;
+    
+    for (auto it = records.begin(); it != records.end();)
+    {
+        if (seconds - it->second.issuedSeconds < options.expirySeconds)
+        {
+            ++it;
+            continue;
+        }
+        // 过期但尚未上传的请求还在途，由调用方按预测集合决定是否取消
+        if (it->second.uploaded)
+        {
+            stats.wasted++;
+            it = records.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void TilePrefetcher::reset()
+{
+    samples.clear();
+    predictedTiles.clear();
+    records.clear();
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "CoveringTiles.h"
+#include "GlobeProjection.h"
+#include "TileCuller.h"
+#include "TileID.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 预测式瓦片预取（不依赖 GL）
+ *
+ * 按最近一段时间的相机速度（经纬度、缩放、过渡因子）外推 lookaheadSeconds 后的相机，
+ * 对外推结果运行 CoveringTiles（带剔除），得到即将可见的瓦片集合。
+ * - 请求和取消由调用方完成，这里只给出预测集合并记录每个预取的去向
+ * - 相机静止时不预测，预测集合为空
+ *
+ * 统计口径：
+ * - hits：预取的瓦片第一次可见时已经在纹理缓存中
+ * - late：第一次可见时仍在解码（调用方会把它提升为可见优先级）
+ * - wasted：解码并上传了，但在 expirySeconds 内一直没有可见
+ * - cancelled：预测改变后在解码前取消
+ * - frameMisses：本帧可见瓦片中没有自身纹理的数量（只能使用祖先或棋盘格）
+ */
+class TilePrefetcher
+{
+public:
+    struct Options
+    {
+        double lookaheadSeconds = 0.3;    // 外推时长
+        double velocityWindow = 0.25;     // 速度估计使用的采样时间窗口
+        double expirySeconds = 2.0;       // 预取后多久仍未可见视为浪费
+        size_t maxPrefetchPerFrame = 16;  // 每帧最多发出的预取请求
+        size_t maxInFlight = 64;          // 同时在途的预取请求上限
+    };
+    
+    struct Stats
+    {
+        size_t prefetched = 0;
+        size_t hits = 0;
+        size_t late = 0;
+        size_t wasted = 0;
+        size_t cancelled = 0;
+        size_t frames = 0;
+        size_t frameMisses = 0;           // 最近一帧
+        size_t totalMisses = 0;           // 所有帧累计
+        
+        double hitRate() const { return prefetched > 0 ? static_cast<double>(hits) / prefetched : 0.0; }
+        double averageMisses() const { return frames > 0 ? static_cast<double>(totalMisses) / frames : 0.0; }
+    };
+    
+    Options options;
+    
+    /**
+     * 记录本帧相机，返回预测的覆盖瓦片（使用与渲染相同的 CoveringTiles 参数）
+     * seconds 为单调时钟时间；相机静止或只有一个采样时返回空集合
+     */
+    const std::vector<TileID>& predict(const GlobeProjection& projection, float aspect, double seconds,
+                                       const CoveringTiles& coveringTiles);
+    
+    /**
+     * 外推后的相机（最近一次 predict 有预测时有效）
+     */
+    bool hasPrediction() const { return !predictedTiles.empty(); }
+    const GlobeProjection& getPredictedProjection() const { return predicted; }
+    
+    /**
+     * 预取记录：调用方发出预取请求、收到结果（uploaded 为是否写入了纹理）、取消请求时通知
+     */
+    void onPrefetched(const TileID& tile, double seconds);
+    void onDelivered(const TileID& tile, bool uploaded);
+    void onCancelled(const TileID& tile);
+    
+    /**
+     * 瓦片在本帧可见（resident 为其纹理是否已在缓存中），第一次可见时结算 hit/late
+     */
+    void onVisible(const TileID& tile, bool resident);
+    
+    /**
+     * 帧结束：记录本帧缺失数量，并把过期的预取记为浪费
+     */
+    void endFrame(double seconds, size_t misses);
+    
+    bool isTracked(const TileID& tile) const { return records.count(tile.key()) != 0; }
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = Stats(); }
+    
+    /**
+     * 清空采样和预取记录（切换数据源时）
+     */
+    void reset();
+    
+private:
+    struct Sample
+    {
+        double seconds;
+        float lon, lat, zoom, transition;
+    };
+    
+    struct Record
+    {
+        double issuedSeconds = 0.0;
+        bool uploaded = false;
+    };
+    
+    std::deque<Sample> samples;
+    GlobeProjection predicted;
+    TileCuller culler;
+    std::vector<TileID> predictedTiles;
+    std::unordered_map<uint64_t, Record> records;
+    Stats stats;
+};
@@ -1,158 +1,492 @@
 #include "TileRenderer.h"
 
+#include "Profiler.h"
 #include "ShaderManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <glm/gtc/type_ptr.hpp>
 
-TileRenderer::TileRenderer() : numTiles(4), tileZ(2) {
-    // 创建 tile 网格
-    vertices = createTileMesh(32);
-    
-    // 创建 VAO/VBO
+TileRenderer::TileRenderer(const std::string& shaderCacheDirectory)
+    : shaders(shaderCacheDirectory), frameBuilder(mesh), nextFrameAspect(0.0f), drawCallCount(0), prefetchEnabled(true) {
+    // 创建 VAO/VBO/EBO（所有 LOD 的网格共享同一组缓冲）
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
     
     glBindVertexArray(VAO);
+    const std::vector<uint16_t>& meshVertices = mesh.getVertices();
+    const std::vector<uint16_t>& meshIndices = mesh.getIndices();
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, meshVertices.size() * sizeof(uint16_t), meshVertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshIndices.size() * sizeof(uint16_t), meshIndices.data(), GL_STATIC_DRAW);
     
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    // uint16 tile 坐标，不归一化，shader 中直接得到 0..TILE_EXTENT 的浮点值
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_SHORT, GL_FALSE, 2 * sizeof(uint16_t), (void*)0);
     glEnableVertexAttribArray(0);
     
-    glBindVertexArray(0);
+    // 实例属性：mat4 占用 location 1..4，之后是 tile 墨卡托坐标和颜色；
+    // 数据每帧写在流式缓冲区的不同位置，格式固定，提交时用 glBindVertexBuffer 绑定偏移
+    for (int column = 0; column < 4; column++)
+    {
+        GLuint location = 1 + column;
+        glVertexAttribFormat(location, 4, GL_FLOAT, GL_FALSE, static_cast<GLuint>(offsetof(TileInstance, mercatorMatrix) + column * sizeof(glm::vec4)));
+        glVertexAttribBinding(location, kInstanceBinding);
+        glEnableVertexAttribArray(location);
+    }
+    glVertexAttribFormat(5, 4, GL_FLOAT, GL_FALSE, offsetof(TileInstance, tileMercatorCoords));
+    glVertexAttribFormat(6, 4, GL_FLOAT, GL_FALSE, offsetof(TileInstance, color));
+    glVertexAttribIFormat(7, 1, GL_INT, offsetof(TileInstance, resources));
+    glVertexAttribIFormat(8, 1, GL_INT, offsetof(TileInstance, resources) + sizeof(int));
+    glVertexAttribFormat(9, 4, GL_FLOAT, GL_FALSE, offsetof(TileInstance, textureRect));
+    glVertexAttribIFormat(10, 1, GL_INT, offsetof(TileInstance, resources) + 2 * sizeof(int));
+    for (GLuint location = 5; location <= 10; location++)
+    {
+        glVertexAttribBinding(location, kInstanceBinding);
+        glEnableVertexAttribArray(location);
+    }
+    glVertexBindingDivisor(kInstanceBinding, 1);
     
-    // 创建 shader 程序
-    shaderProgram = ShaderManager::createProgram();
+    glBindVertexArray(0);
     
-    // 获取 uniform 位置
-    u_projection_matrix = glGetUniformLocation(shaderProgram, "u_projection_matrix");
-    u_projection_fallback_matrix = glGetUniformLocation(shaderProgram, "u_projection_fallback_matrix");
-    u_projection_tile_mercator_coords = glGetUniformLocation(shaderProgram, "u_projection_tile_mercator_coords");
-    u_projection_transition = glGetUniformLocation(shaderProgram, "u_projection_transition");
-    u_projection_clipping_plane = glGetUniformLocation(shaderProgram, "u_projection_clipping_plane");
-    u_color = glGetUniformLocation(shaderProgram, "u_color");
+    // 预计算球面坐标：整块缓存对应一个 RGB32F buffer texture，按 slot 增量更新
+    glGenBuffers(1, &sphereBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, sphereBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, frameBuilder.getGeometryCache().getPositionsSizeInBytes(), nullptr, GL_DYNAMIC_DRAW);
+    glGenTextures(1, &sphereTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, sphereTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, sphereBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
 }
 
 TileRenderer::~TileRenderer() {
+    // 流水线中的构建任务引用了 frameBuilder
+    finishPendingFrame();
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    glDeleteProgram(shaderProgram);
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &sphereBuffer);
+    glDeleteTextures(1, &sphereTexture);
 }
 
 void TileRenderer::render(const GlobeProjection& projection, float aspect)
 {
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
+    PROFILE_ZONE("TileRenderer::render");
+    // CPU 端准备（FrameBuilder）与 GL 提交串行执行
+    finishPendingFrame();
+    nextFrame.reset();
+    submitFrame(frameBuilder.build(projection, aspect));
+}
+
+void TileRenderer::renderPipelined(const GlobeProjection& projection, float aspect)
+{
+    PROFILE_ZONE("TileRenderer::renderPipelined");
+    // 取出上一次调用开始构建的帧；第一次调用时同步构建
+    finishPendingFrame();
+    std::shared_ptr<const FramePacket> frame = std::move(nextFrame);
+    if (!frame)
+    {
+        frame = frameBuilder.build(projection, aspect);
+    }
     
-    // 计算裁剪平面（所有 tile 共享）
-    glm::vec4 clippingPlane = projection.calculateClippingPlane();
-    glm::mat4 globeMatrix = projection.calculateGlobeMatrix(aspect);
+    // 相机按值捕获，构建期间 GL 线程可以继续修改自己的相机
+    nextFrameProjection = projection;
+    nextFrameAspect = aspect;
+    nextFrameJob = JobSystem::shared().schedule([this, projection, aspect]() {
+        nextFrame = frameBuilder.build(projection, aspect);
+    }, JobSystem::Priority::High);
+    submitFrame(std::move(frame));
+}
+
+void TileRenderer::finishPendingFrame()
+{
+    if (nextFrameJob)
+    {
+        JobSystem::shared().wait(nextFrameJob);
+        nextFrameJob.reset();
+    }
+}
+
+bool TileRenderer::needsRedraw() const
+{
+    if ((rasterLoader && rasterLoader->hasResults()) || (vectorLayer && vectorLayer->hasResults()))
+    {
+        return true;
+    }
+    if (!nextFrameJob || !currentFrame)
+    {
+        return false;
+    }
+    const GlobeProjection& shown = currentFrame->projection;
+    return nextFrameAspect != currentFrame->aspect
+        || nextFrameProjection.transition != shown.transition || nextFrameProjection.centerLon != shown.centerLon
+        || nextFrameProjection.centerLat != shown.centerLat || nextFrameProjection.zoom != shown.zoom;
+}
+
+void TileRenderer::submitFrame(std::shared_ptr<const FramePacket> frame)
+{
+    PROFILE_ZONE("TileRenderer::submitFrame");
+#ifdef GLOBE_PROFILER
+    gpuProfiler.poll();
+#endif
+    currentFrame = std::move(frame);
+    const ProjectionState& state = *currentFrame->state;
+    drawCallCount = 0;
     
-    // 纯 Mercator 模式：渲染所有 wrap
-    if (projection.transition < 0.001f)
+    // 栅格瓦片：先标记可见瓦片并请求缺失的，再预取预测的瓦片，按预算上传解码结果；
+    // 纹理层在写入实例数据时填入
+    rasterTextures.beginFrame();
+    double seconds = 0.0;
+    if (rasterLoader)
     {
-        for (int wrap = -1; wrap <= 1; wrap++)
-        {
-            renderTilesForWrap(projection, globeMatrix, clippingPlane, wrap, aspect);
-        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        requestRasterTiles();
+        prefetchRasterTiles(currentFrame->projection, currentFrame->aspect, seconds);
+        uploadRasterTiles();
     }
-    else
+    if (vectorLayer)
     {
-        // Globe 过渡模式：为每个 tile 动态选择最接近 center 的 wrap
-        // Mercator 部分需要正确的 wrap 来确保对齐
-        for (int tileY = 0; tileY < numTiles; tileY++)
-        {
-            for (int tileX = 0; tileX < numTiles; tileX++)
-            {
-                int wrap = projection.getWrapForTile(tileX, tileY, tileZ);
-                renderSingleTile(projection, globeMatrix, clippingPlane, tileX, tileY, wrap, aspect);
-            }
-        }
+        vectorLayer->update(*currentFrame, uploadBudget.maxBytes, uploadBudget.maxMilliseconds);
+    }
+    
+    PROFILE_GPU_ZONE(gpuProfiler, "TileRenderer::draw");
+    // 按过渡因子选择最便宜的投影变体（纯 Mercator / 纯 Globe 不做混合）
+    ShaderManager::Variant variant;
+    variant.projection = ShaderManager::selectProjection(state);
+    useProgram(shaders.getProgram(variant), state);
+    glBindVertexArray(VAO);
+    streamBuffer.beginFrame();
+    size_t rasterMisses = uploadInstances();
+    if (rasterLoader)
+    {
+        prefetcher.endFrame(seconds, rasterMisses);
+    }
+    uploadSpherePositions();
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, sphereTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, rasterTextures.getTexture());
+    glActiveTexture(GL_TEXTURE0);
+    
+    drawInstances();
+    if (vectorLayer)
+    {
+        // 矢量几何与 Mercator 填充面共面，在 Globe 上是球面的弦（可能低于填充面），都不做深度测试；
+        // 背面仍由裁剪 Z 去掉。之后恢复 tile 网格的 VAO 供线框 pass 使用
+        glDisable(GL_DEPTH_TEST);
+        drawCallCount += vectorLayer->draw(streamBuffer, state);
+        glEnable(GL_DEPTH_TEST);
+        glBindVertexArray(VAO);
     }
 #if 1
     // 绘制网格线
     glDepthFunc(GL_LEQUAL); // 允许与填充面同深度的线通过
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     glLineWidth(2.0f);
-    if (projection.transition < 0.001f)
+    variant.wireframe = true;
+    useProgram(shaders.getProgram(variant), state);
+    drawInstances();
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glDepthFunc(GL_LESS); // 恢复默认深度测试
+#endif
+    streamBuffer.endFrame();
+}
+
+void TileRenderer::useProgram(const ShaderManager::Program& program, const ProjectionState& state)
+{
+    glUseProgram(program.program);
+    // 纹理单元：0 为预计算球面坐标，1 为栅格纹理数组
+    glUniform1i(program.u_sphere_positions, 0);
+    glUniform1i(program.u_raster_tiles, 1);
+    
+    // Globe 矩阵和裁剪平面（所有 tile 共享）
+    glUniformMatrix4fv(program.u_projection_matrix, 1, GL_FALSE, glm::value_ptr(state.getGlobeMatrix()));
+    glUniform1f(program.u_projection_transition, state.getTransition());
+    glUniform4fv(program.u_projection_clipping_plane, 1, glm::value_ptr(state.getClippingPlane()));
+}
+
+void TileRenderer::setViewportHeight(int height)
+{
+    finishPendingFrame();
+    frameBuilder.getCoveringTiles().options.viewportHeight = height;
+}
+
+void TileRenderer::setRasterSource(std::shared_ptr<const TileSource> source)
+{
+    rasterLoader.reset();
+    pendingRasterTiles.clear();
+    unavailableRasterTiles.clear();
+    prefetcher.reset();
+    if (source)
+    {
+        rasterLoader.reset(new RasterTileLoader(std::move(source)));
+    }
+}
+
+void TileRenderer::setVectorSource(std::shared_ptr<const TileSource> source, const VectorStyle& style)
+{
+    vectorLayer.reset();
+    if (source)
     {
-        for (int wrap = -1; wrap <= 1; wrap++)
+        vectorLayer.reset(new VectorTileLayer(std::move(source), style));
+    }
+}
+
+TileID TileRenderer::rasterTarget(const TileID& tile, int maxZoom) const
+{
+    // 超出数据源层级或数据源中不存在时，使用最近的可用祖先（放大显示）
+    TileID target = tile;
+    target.wrap = 0;
+    while (target.z > 0 && (target.z > maxZoom || unavailableRasterTiles.count(target.key())))
+    {
+        target.x >>= 1;
+        target.y >>= 1;
+        target.z--;
+    }
+    return target;
+}
+
+void TileRenderer::requestRasterTiles()
+{
+    PROFILE_ZONE("TileRenderer::requestRasterTiles");
+    int maxZoom = rasterLoader->getSource().getMaxZoom();
+    bool queueFull = false;
+    visibleRasterTargets.clear();
+    for (const TileID& tile : currentFrame->tiles)
+    {
+        // 先标记本帧要用的瓦片（或回退用的祖先），上传时不会把它们淘汰
+        rasterTextures.pin(tile);
+        
+        TileID target = rasterTarget(tile, maxZoom);
+        uint64_t key = target.key();
+        bool resident = rasterTextures.contains(target);
+        if (visibleRasterTargets.insert(key).second)
+        {
+            prefetcher.onVisible(target, resident);
+        }
+        if (resident || unavailableRasterTiles.count(key))
         {
-            renderTilesForWrap(projection, globeMatrix, clippingPlane, wrap, aspect, true);
+            continue;
+        }
+        auto pending = pendingRasterTiles.find(key);
+        if (queueFull || (pending != pendingRasterTiles.end() && pending->second.priority == TilePriority::Visible))
+        {
+            continue;
+        }
+        // 队列已满时放弃，下一帧再请求
+        if (!rasterLoader->request(target))
+        {
+            queueFull = true;
+            continue;
+        }
+        // 预取中的瓦片已经可见：以可见优先级重新请求，取消尚未开始的预取
+        if (pending != pendingRasterTiles.end())
+        {
+            pending->second.token->cancel();
+            pending->second.priority = TilePriority::Visible;
+            pending->second.token.reset();
+        }
+        else
+        {
+            pendingRasterTiles.emplace(key, PendingRaster{ target, TilePriority::Visible, nullptr });
         }
     }
-    else
+}
+
+void TileRenderer::prefetchRasterTiles(const GlobeProjection& projection, float aspect, double seconds)
+{
+    PROFILE_ZONE("TileRenderer::prefetchRasterTiles");
+    int maxZoom = rasterLoader->getSource().getMaxZoom();
+    // 关闭预取时仍然记录相机采样，重新开启后立即有速度可用
+    const std::vector<TileID>& predictedTiles = prefetcher.predict(projection, aspect, seconds, frameBuilder.getCoveringTiles());
+    predictedRasterTargets.clear();
+    if (prefetchEnabled)
+    {
+        for (const TileID& tile : predictedTiles)
+        {
+            predictedRasterTargets.insert(rasterTarget(tile, maxZoom).key());
+        }
+    }
+    
+    // 预测已经改变（既不在预测集合中也不可见）的预取请求取消；结果返回前保留在 pending 中避免重复请求
+    size_t inFlight = 0;
+    for (auto& entry : pendingRasterTiles)
     {
-        for (int tileY = 0; tileY < numTiles; tileY++)
+        PendingRaster& pending = entry.second;
+        if (pending.priority != TilePriority::Prefetch || pending.token->isCancelled())
         {
-            for (int tileX = 0; tileX < numTiles; tileX++)
+            continue;
+        }
+        if (predictedRasterTargets.count(entry.first) || visibleRasterTargets.count(entry.first))
+        {
+            inFlight++;
+            continue;
+        }
+        pending.token->cancel();
+        prefetcher.onCancelled(pending.tile);
+    }
+    
+    if (predictedRasterTargets.empty())
+    {
+        return;
+    }
+    size_t issued = 0;
+    for (const TileID& tile : predictedTiles)
+    {
+        if (issued >= prefetcher.options.maxPrefetchPerFrame || inFlight >= prefetcher.options.maxInFlight)
+        {
+            break;
+        }
+        TileID target = rasterTarget(tile, maxZoom);
+        uint64_t key = target.key();
+        if (visibleRasterTargets.count(key) || rasterTextures.contains(target)
+            || pendingRasterTiles.count(key) || unavailableRasterTiles.count(key))
+        {
+            continue;
+        }
+        auto token = std::make_shared<CancellationToken>();
+        if (!rasterLoader->request(target, TilePriority::Prefetch, token))
+        {
+            break;
+        }
+        pendingRasterTiles.emplace(key, PendingRaster{ target, TilePriority::Prefetch, token });
+        prefetcher.onPrefetched(target, seconds);
+        issued++;
+        inFlight++;
+    }
+}
+
+void TileRenderer::uploadRasterTiles()
+{
+    PROFILE_ZONE("TileRenderer::uploadRasterTiles");
+    PROFILE_GPU_ZONE(gpuProfiler, "TileRenderer::uploadRasterTiles");
+    auto start = std::chrono::steady_clock::now();
+    size_t uploadedBytes = 0;
+    DecodedTile decoded;
+    while (uploadedBytes < uploadBudget.maxBytes
+           && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < uploadBudget.maxMilliseconds
+           && rasterLoader->poll(decoded))
+    {
+        uint64_t key = decoded.tile.key();
+        auto pending = pendingRasterTiles.find(key);
+        if (decoded.cancelled)
+        {
+            // 已被提升为可见请求的保留，等待可见请求的结果
+            if (pending != pendingRasterTiles.end() && pending->second.priority == TilePriority::Prefetch)
             {
-                int wrap = projection.getWrapForTile(tileX, tileY, tileZ);
-                renderSingleTile(projection, globeMatrix, clippingPlane, tileX, tileY, wrap, aspect, true);
+                pendingRasterTiles.erase(pending);
             }
+            continue;
+        }
+        if (pending != pendingRasterTiles.end())
+        {
+            pendingRasterTiles.erase(pending);
+        }
+        if (decoded.failed)
+        {
+            unavailableRasterTiles.insert(key);
+            prefetcher.onDelivered(decoded.tile, false);
+            continue;
         }
+        // 上传失败（层被本帧占满）时不记录，之后重新请求
+        int layer = rasterTextures.upload(decoded);
+        prefetcher.onDelivered(decoded.tile, layer >= 0);
+        uploadedBytes += decoded.sizeInBytes();
     }
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDepthFunc(GL_LESS); // 恢复默认深度测试
-#endif
 }
 
-void TileRenderer::renderTilesForWrap(const GlobeProjection& projection, const glm::mat4& globeMatrix, const glm::vec4& clippingPlane, int wrap, float aspect, bool wireframe)
+size_t TileRenderer::assignRasterLayers(TileInstance* out)
 {
-    for (int tileY = 0; tileY < numTiles; tileY++)
+    int maxZoom = rasterLoader->getSource().getMaxZoom();
+    const TileInstanceBuffer& instances = currentFrame->instances;
+    size_t misses = 0;
+    for (size_t i = 0; i < instances.size(); i++)
     {
-        for (int tileX = 0; tileX < numTiles; tileX++)
+        TileInstance instance = instances[i];
+        TileID tile;
+        tile.x = instance.tileID.x;
+        tile.y = instance.tileID.y;
+        tile.z = instance.tileID.z;
+        TileTextureCache::Resolved resolved = rasterTextures.resolve(tile);
+        instance.resources.y = resolved.slot;
+        instance.textureRect = resolved.textureRect;
+        // 整个实例一次写出（out 是映射的内存，只写不读）
+        out[i] = instance;
+        
+        // 没有自身纹理（只能用祖先或棋盘格）的可见瓦片计为缺失
+        if (resolved.slot < 0 || resolved.source.key() != rasterTarget(tile, maxZoom).key())
         {
-            renderSingleTile(projection, globeMatrix, clippingPlane, tileX, tileY, wrap, aspect, wireframe);
+            misses++;
         }
     }
+    return misses;
 }
 
-void TileRenderer::renderSingleTile(const GlobeProjection& projection, const glm::mat4& globeMatrix,const glm::vec4& clippingPlane, int tileX, int tileY, int wrap, float aspect, bool wireframe)
+size_t TileRenderer::uploadInstances()
 {
-    glm::mat4 mercatorMatrix = projection.calculateMercatorMatrix(tileX, tileY, tileZ, wrap, aspect);
-    glm::vec4 tileMercCoords = projection.calculateTileMercatorCoords(tileX, tileY, tileZ, wrap);
-    
-    // 设置 uniforms
-    glUniformMatrix4fv(u_projection_matrix, 1, GL_FALSE, glm::value_ptr(globeMatrix));
-    glUniformMatrix4fv(u_projection_fallback_matrix, 1, GL_FALSE, glm::value_ptr(mercatorMatrix));
-    glUniform4fv(u_projection_tile_mercator_coords, 1, glm::value_ptr(tileMercCoords));
-    glUniform1f(u_projection_transition, projection.transition);
-    glUniform4fv(u_projection_clipping_plane, 1, glm::value_ptr(clippingPlane));
-    
-    // 颜色
-    if (wireframe)
+    // 实例数据直接写入流式缓冲区（持久映射，没有驱动端复制），按本帧的偏移绑定实例属性
+    const TileInstanceBuffer& instances = currentFrame->instances;
+    if (instances.size() == 0)
+    {
+        return 0;
+    }
+    StreamBuffer::Allocation allocation = streamBuffer.allocate(instances.sizeInBytes());
+    TileInstance* out = static_cast<TileInstance*>(allocation.pointer);
+    size_t misses = 0;
+    if (rasterLoader)
     {
-        glUniform4f(u_color, 0.0f, 0.0f, 0.0f, 1.0f);
+        misses = assignRasterLayers(out);
     }
     else
     {
-        float r = ((tileX + tileY) % 2 == 0) ? 0.3f : 0.5f;
-        float g = ((tileX + tileY) % 2 == 0) ? 0.5f : 0.3f;
-        glUniform4f(u_color, r, g, 0.4f, 1.0f);
+        std::memcpy(out, instances.data(), instances.sizeInBytes());
     }
-    
-    glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 2);
+    glBindVertexBuffer(kInstanceBinding, allocation.buffer, static_cast<GLintptr>(allocation.offset), sizeof(TileInstance));
+    return misses;
 }
 
-std::vector<float> TileRenderer::createTileMesh(int divisions)
+void TileRenderer::uploadSpherePositions()
 {
-    std::vector<float> verts;
-    float step = Constants::TILE_EXTENT / (float)divisions;
+    // 只上传本帧新计算的 slot（坐标已由 FrameBuilder 复制进帧包）：
+    // 整块写入流式缓冲区，再由 GPU 按 slot 复制到球面坐标缓冲区
+    const std::vector<int>& computed = currentFrame->geometrySlots;
+    if (computed.empty())
+    {
+        return;
+    }
+    const TileGeometryCache& geometryCache = frameBuilder.getGeometryCache();
+    const size_t slotBytes = static_cast<size_t>(geometryCache.getSlotVertexCount()) * 3 * sizeof(float);
+    StreamBuffer::Allocation allocation = streamBuffer.allocate(computed.size() * slotBytes);
+    std::memcpy(allocation.pointer, currentFrame->geometryPositions.data(), computed.size() * slotBytes);
     
-    for (int y = 0; y < divisions; y++)
+    glBindBuffer(GL_COPY_READ_BUFFER, allocation.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, sphereBuffer);
+    for (size_t i = 0; i < computed.size(); i++)
+    {
+        GLintptr offset = geometryCache.slotFirstVertex(computed[i]) * 3 * sizeof(float);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.offset + i * slotBytes), offset, slotBytes);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void TileRenderer::drawInstances()
+{
+    for (int level = 0; level < TileMesh::kLodCount; level++)
     {
-        for (int x = 0; x < divisions; x++)
+        const TileInstanceBuffer::Range& range = currentFrame->instances.getLodRange(level);
+        if (range.count == 0)
         {
-            float x0 = x * step;
-            float y0 = y * step;
-            float x1 = (x + 1) * step;
-            float y1 = (y + 1) * step;
-            
-            // 两个三角形
-            verts.insert(verts.end(), {x0, y0, x1, y0, x0, y1});
-            verts.insert(verts.end(), {x1, y0, x1, y1, x0, y1});
+            continue;
         }
+        const TileMesh::Lod& lod = mesh.getLod(level);
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_SHORT,
+                                                      (void*)(lod.firstIndex * sizeof(uint16_t)),
+                                                      range.count, lod.baseVertex, range.first);
+        drawCallCount++;
     }
-    return verts;
 }
-
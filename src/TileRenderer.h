@@ -1,40 +1,199 @@
 #pragma once
+#include "FrameBuilder.h"
 #include "GlobeProjection.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
+#include "RasterTileLoader.h"
+#include "ShaderManager.h"
+#include "StreamBuffer.h"
+#include "TileCuller.h"
+#include "TileID.h"
+#include "TileInstanceBuffer.h"
+#include "TileMesh.h"
+#include "TilePrefetcher.h"
+#include "TileSource.h"
+#include "TileTextureArray.h"
+#include "VectorTileLayer.h"
 #include "glad/glad.h"
 #include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class TileRenderer {
+public:
+    /**
+     * 每帧栅格瓦片上传预算：任一项用完即停止，剩余结果留在队列里下一帧再传
+     */
+    struct UploadBudget
+    {
+        size_t maxBytes = 8 * 1024 * 1024;
+        double maxMilliseconds = 2.0;
+    };
+    
 private:
-    GLuint shaderProgram;
-    GLuint VAO, VBO;
-    GLuint u_projection_matrix;
-    GLuint u_projection_fallback_matrix;
-    GLuint u_projection_tile_mercator_coords;
-    GLuint u_projection_transition;
-    GLuint u_projection_clipping_plane;
-    GLuint u_color;
-    
-    std::vector<float> vertices;
-    int numTiles;
-    int tileZ;
+    // 实例属性使用的顶点缓冲区绑定点（0 为网格顶点）
+    static constexpr GLuint kInstanceBinding = 1;
+    
+    ShaderManager shaders;     // 按投影模式特化的程序变体（填充 / 线框）
+    GLuint VAO, VBO, EBO;
+    StreamBuffer streamBuffer; // 每帧的实例数据与球面坐标更新（持久映射的环形缓冲区）
+    GLuint sphereBuffer;       // 预计算的单位球坐标（buffer texture）
+    GLuint sphereTexture;
+    
+    TileMesh mesh;
+    
+    // CPU 端帧准备（可以在工作线程上运行），GL 端只提交 FramePacket
+    FrameBuilder frameBuilder;
+    std::shared_ptr<const FramePacket> currentFrame;   // 正在/最近一次提交的帧
+    std::shared_ptr<const FramePacket> nextFrame;      // 流水线中构建好的下一帧
+    JobSystem::JobHandle nextFrameJob;
+    GlobeProjection nextFrameProjection;               // 下一帧构建时的相机
+    float nextFrameAspect;
+    size_t drawCallCount;                              // 最近一次提交的 draw call 数
+    
+    // 已请求、尚未上传的栅格瓦片；预取请求带取消标记，可见后提升优先级
+    struct PendingRaster
+    {
+        TileID tile;
+        TilePriority priority = TilePriority::Visible;
+        std::shared_ptr<CancellationToken> token;
+    };
     
+    // 栅格瓦片：解码在 RasterTileLoader 的线程池中进行，GL 线程只按预算上传
+    std::unique_ptr<RasterTileLoader> rasterLoader;
+    TileTextureArray rasterTextures;
+    std::unordered_map<uint64_t, PendingRaster> pendingRasterTiles;
+    std::unordered_set<uint64_t> unavailableRasterTiles; // 数据源中不存在
+    UploadBudget uploadBudget;
+    
+    // 预测式预取：按相机速度外推的覆盖集合以较低优先级请求
+    TilePrefetcher prefetcher;
+    bool prefetchEnabled;
+    std::unordered_set<uint64_t> visibleRasterTargets;   // 本帧可见瓦片的请求目标
+    std::unordered_set<uint64_t> predictedRasterTargets; // 本帧预测瓦片的请求目标
+    
+    // 矢量瓦片：三角化在工作线程上进行，填充面之上按样式绘制
+    std::unique_ptr<VectorTileLayer> vectorLayer;
+    
+    TileCuller::Stats emptyCullStats;
+
+#ifdef GLOBE_PROFILER
+    GpuProfiler gpuProfiler;   // GPU 区段计时，每次提交时读取已完成的结果
+#endif
+
 public:
-    TileRenderer();
+    /**
+     * shaderCacheDirectory 非空时链接好的 shader 程序缓存到该目录（见 ShaderManager）
+     */
+    explicit TileRenderer(const std::string& shaderCacheDirectory = std::string());
     ~TileRenderer();
     
     /**
      * 渲染所有 tile
      * 
      * 关键逻辑：
-     * 1. 纯 Mercator 模式：渲染 wrap=-1, 0, 1（传统 Mercator 行为）
-     * 2. Globe 过渡模式：为每个 tile 动态选择 wrap（避免重复和缺失）
+     * 1. CoveringTiles 按屏幕空间误差选出混合层级的 tile 集合
+     * 2. 纯 Mercator 模式：覆盖 wrap=-1, 0, 1（传统 Mercator 行为）
+     * 3. Globe 过渡模式：为每个 tile 动态选择 wrap（避免重复和缺失）
+     * 
+     * 所有 tile 的参数打包进一个 instance buffer，填充和线框每个网格 LOD 各一次 instanced draw
      */
     void render(const GlobeProjection& projection, float aspect);
     
-private:
-    void renderTilesForWrap(const GlobeProjection& projection, const glm::mat4& globeMatrix, const glm::vec4& clippingPlane, int wrap, float aspect, bool wireframe = false);
-    void renderSingleTile(const GlobeProjection& projection, const glm::mat4& globeMatrix,const glm::vec4& clippingPlane, int tileX, int tileY, int wrap, float aspect, bool wireframe = false);
+    /**
+     * 流水线渲染：提交上一次调用时构建的帧，同时在 JobSystem 上为当前相机构建下一帧
+     *
+     * 画面比相机晚一帧（不会更多：每次调用都先等待上一次的构建完成）；
+     * 第一次调用时没有构建好的帧，同步构建后立即提交。
+     * 与 render 交替调用是安全的，render 会先等待流水线中的构建。
+     */
+    void renderPipelined(const GlobeProjection& projection, float aspect);
     
-    static std::vector<float> createTileMesh(int divisions = 32);
+    /**
+     * 等待流水线中正在构建的帧（丢弃其结果前或修改选择参数前调用）
+     */
+    void finishPendingFrame();
+    
+    /**
+     * 相机不变时是否仍需要重绘：有解码完成等待上传的瓦片，
+     * 或流水线中构建好的下一帧与已显示的相机不同
+     */
+    bool needsRedraw() const;
+    
+    /**
+     * 是否还有在途的瓦片请求（结果随时可能到达，调用方应定期检查 needsRedraw）
+     */
+    bool hasPendingTiles() const { return !pendingRasterTiles.empty() || (vectorLayer && vectorLayer->hasPendingTiles()); }
+    
+    /**
+     * 视口高度变化时更新 LOD 计算使用的像素尺度
+     */
+    void setViewportHeight(int height);
+    
+    /**
+     * 设置栅格瓦片数据源（nullptr 表示关闭，tile 恢复为棋盘格填充色）
+     */
+    void setRasterSource(std::shared_ptr<const TileSource> source);
+    void setUploadBudget(const UploadBudget& budget) { uploadBudget = budget; }
+    
+    /**
+     * 设置矢量瓦片数据源（MVT，nullptr 表示关闭），按 style 绘制在填充面之上；
+     * 上传与栅格瓦片共用同一份 UploadBudget 的限额（各自计算）
+     */
+    void setVectorSource(std::shared_ptr<const TileSource> source, const VectorStyle& style = VectorStyle::createDefault());
+    
+    /**
+     * 开关预测式预取（默认开启）；关闭时已发出的预取请求会被取消
+     */
+    void setPrefetchEnabled(bool enabled) { prefetchEnabled = enabled; }
+    TilePrefetcher::Options& getPrefetchOptions() { return prefetcher.options; }
+    
+    /**
+     * 栅格流水线统计（未设置数据源时 getRasterLoader 返回 nullptr）
+     */
+    const RasterTileLoader* getRasterLoader() const { return rasterLoader.get(); }
+    const TileTextureArray::Stats& getRasterTextureStats() const { return rasterTextures.getStats(); }
+    const TileTextureCache& getRasterTextureCache() const { return rasterTextures.getCache(); }
+    const TilePrefetcher::Stats& getPrefetchStats() const { return prefetcher.getStats(); }
+    
+    /**
+     * 矢量图层（未设置数据源时为 nullptr）
+     */
+    const VectorTileLayer* getVectorLayer() const { return vectorLayer.get(); }
+    
+    /**
+     * 流式缓冲区的容量、每帧峰值用量与等待 GPU 的次数
+     */
+    StreamBuffer::Stats getStreamStats() const { return streamBuffer.getStats(); }
+    
+    /**
+     * 上一帧的剔除统计、提交的 tile 数与 draw call 数
+     */
+    const TileCuller::Stats& getCullStats() const { return currentFrame ? currentFrame->cullStats : emptyCullStats; }
+    size_t getTileCount() const { return currentFrame ? currentFrame->tiles.size() : 0; }
+    size_t getDrawCallCount() const { return drawCallCount; }
+    
+    /**
+     * shader 变体的创建统计（编译 / 从缓存加载 / 耗时）
+     */
+    const ShaderManager::Stats& getShaderStats() const { return shaders.getStats(); }
+    
+    /**
+     * 最近一次提交的帧（尚未渲染过时为 nullptr）
+     */
+    const FramePacket* getCurrentFrame() const { return currentFrame.get(); }
+    
+private:
+    void submitFrame(std::shared_ptr<const FramePacket> frame);
+    size_t uploadInstances();
+    void uploadSpherePositions();
+    TileID rasterTarget(const TileID& tile, int maxZoom) const;
+    void requestRasterTiles();
+    void prefetchRasterTiles(const GlobeProjection& projection, float aspect, double seconds);
+    void uploadRasterTiles();
+    size_t assignRasterLayers(TileInstance* out);
+    void useProgram(const ShaderManager::Program& program, const ProjectionState& state);
+    void drawInstances();
 };
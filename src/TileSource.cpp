@@ -0,0 +1,55 @@
+#include "TileSource.h"
+
+#include <cstdio>
+#include <utility>
+
+namespace
+{
+const char* const kExtensions[] = { ".png", ".jpg", ".jpeg", ".pbf", ".mvt" };
+} // namespace
+
+DirectoryTileSource::DirectoryTileSource(std::string root, int maxZoom)
+    : root(std::move(root)), maxZoom(maxZoom)
+{
+    // 统一去掉结尾的分隔符，拼接路径时再加
+    while (!this->root.empty() && (this->root.back() == '/' || this->root.back() == '\\'))
+    {
+        this->root.pop_back();
+    }
+}
+
+bool DirectoryTileSource::read(const TileID& tile, std::vector<uint8_t>& bytes) const
+{
+    if (tile.z > maxZoom)
+    {
+        return false;
+    }
+    std::string base = root + "/" + std::to_string(tile.z) + "/" + std::to_string(tile.x) + "/" + std::to_string(tile.y);
+    for (const char* extension : kExtensions)
+    {
+        if (readFile(base + extension, bytes))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DirectoryTileSource::readFile(const std::string& path, std::vector<uint8_t>& bytes)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    bool ok = std::fseek(file, 0, SEEK_END) == 0;
+    long size = ok ? std::ftell(file) : -1;
+    ok = size > 0 && std::fseek(file, 0, SEEK_SET) == 0;
+    if (ok)
+    {
+        bytes.resize(static_cast<size_t>(size));
+        ok = std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    }
+    std::fclose(file);
+    return ok;
+}
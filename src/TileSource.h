@@ -0,0 +1,54 @@
+#pragma once
+#include "TileID.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 瓦片数据源：按 z/x/y 读取编码后的瓦片字节（栅格 PNG/JPEG 或矢量 MVT）
+ *
+ * read 会在解码线程上并发调用，实现必须线程安全。
+ * wrap 只表示世界副本，数据源忽略它。
+ */
+class TileSource
+{
+public:
+    virtual ~TileSource() = default;
+    
+    /**
+     * 读取瓦片的原始字节；瓦片不存在或读取失败时返回 false
+     */
+    virtual bool read(const TileID& tile, std::vector<uint8_t>& bytes) const = 0;
+    
+    /**
+     * 零拷贝读取：返回数据源自身持有的字节（如 mmap 的归档），生命周期与数据源相同。
+     * 不支持时返回 false，调用方改用 read
+     */
+    virtual bool view(const TileID& /*tile*/, const uint8_t*& /*bytes*/, size_t& /*size*/) const { return false; }
+    
+    /**
+     * 数据源包含的最大层级，更深的请求由调用方改用祖先瓦片
+     */
+    virtual int getMaxZoom() const = 0;
+};
+
+/**
+ * 本地目录数据源：root/z/x/y.png、.jpg / .jpeg，或矢量瓦片 .pbf / .mvt（按此顺序尝试）
+ */
+class DirectoryTileSource : public TileSource
+{
+public:
+    explicit DirectoryTileSource(std::string root, int maxZoom = 22);
+    
+    bool read(const TileID& tile, std::vector<uint8_t>& bytes) const override;
+    int getMaxZoom() const override { return maxZoom; }
+    
+    const std::string& getRoot() const { return root; }
+    
+private:
+    static bool readFile(const std::string& path, std::vector<uint8_t>& bytes);
+    
+    std::string root;
+    int maxZoom;
+};
@@ -0,0 +1,74 @@
+#include "TileTextureArray.h"
+
+#include <iostream>
+
+TileTextureArray::TileTextureArray(size_t memoryBudget)
+    : memoryBudget(memoryBudget), texture(0), tileWidth(0), tileHeight(0)
+{
+}
+
+TileTextureArray::~TileTextureArray()
+{
+    if (texture)
+    {
+        glDeleteTextures(1, &texture);
+    }
+}
+
+int TileTextureArray::upload(const DecodedTile& decoded)
+{
+    if (!texture && !allocate(decoded.width, decoded.height))
+    {
+        stats.rejected++;
+        return -1;
+    }
+    if (decoded.width != tileWidth || decoded.height != tileHeight)
+    {
+        stats.rejected++;
+        return -1;
+    }
+    
+    int layer = cache.insert(decoded.tile);
+    if (layer < 0)
+    {
+        stats.rejected++;
+        return -1;
+    }
+    
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, tileWidth, tileHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, decoded.pixels.data());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    
+    stats.uploads++;
+    stats.uploadedBytes += decoded.sizeInBytes();
+    return layer;
+}
+
+bool TileTextureArray::allocate(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return false;
+    }
+    GLint maxLayers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    cache.configure(memoryBudget, static_cast<size_t>(width) * height * 4, maxLayers);
+    if (cache.getSlotCount() == 0)
+    {
+        std::cerr << "Raster tile " << width << "x" << height << " exceeds texture budget" << std::endl;
+        return false;
+    }
+    
+    tileWidth = width;
+    tileHeight = height;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, cache.getSlotCount(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
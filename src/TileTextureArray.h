@@ -0,0 +1,59 @@
+#pragma once
+#include "RasterTileLoader.h"
+#include "TileID.h"
+#include "TileTextureCache.h"
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 栅格瓦片纹理：所有瓦片共享一个 GL_TEXTURE_2D_ARRAY，每个瓦片占一层
+ *
+ * 层的分配、LRU 和祖先回退都由 TileTextureCache 管理，这里只负责 GL 存储：
+ * - 纹理在第一个瓦片上传时按其尺寸分配，层数受显存预算和 GL_MAX_ARRAY_TEXTURE_LAYERS 限制
+ * - 尺寸不同的瓦片被拒绝
+ */
+class TileTextureArray
+{
+public:
+    struct Stats
+    {
+        size_t uploads = 0;
+        size_t uploadedBytes = 0;
+        size_t rejected = 0;   // 尺寸不符或所有层都被本帧占用
+    };
+    
+    explicit TileTextureArray(size_t memoryBudget = 64 * 1024 * 1024);
+    ~TileTextureArray();
+    
+    TileTextureArray(const TileTextureArray&) = delete;
+    TileTextureArray& operator=(const TileTextureArray&) = delete;
+    
+    void beginFrame() { cache.beginFrame(); }
+    
+    /**
+     * 瓦片或最近祖先所在的层与纹理坐标变换（并标记为本帧使用）
+     */
+    TileTextureCache::Resolved resolve(const TileID& tile) { return cache.resolve(tile); }
+    void pin(const TileID& tile) { cache.pin(tile); }
+    bool contains(const TileID& tile) const { return cache.contains(tile); }
+    
+    /**
+     * 把解码结果写入一层（必要时淘汰），返回层号；失败返回 -1
+     */
+    int upload(const DecodedTile& decoded);
+    
+    GLuint getTexture() const { return texture; }
+    const TileTextureCache& getCache() const { return cache; }
+    const Stats& getStats() const { return stats; }
+    
+private:
+    bool allocate(int width, int height);
+    
+    size_t memoryBudget;
+    GLuint texture;
+    int tileWidth;
+    int tileHeight;
+    TileTextureCache cache;
+    Stats stats;
+};
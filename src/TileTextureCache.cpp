@@ -0,0 +1,155 @@
+#include "TileTextureCache.h"
+
+#include <algorithm>
+
+void TileTextureCache::configure(size_t memoryBudget, size_t slotBytes, int maxSlots)
+{
+    this->slotBytes = slotBytes;
+    size_t slotCount = slotBytes > 0 ? std::min<size_t>(std::max(maxSlots, 0), memoryBudget / slotBytes) : 0;
+    
+    slots.assign(slotCount, Slot());
+    freeSlots.clear();
+    freeSlots.reserve(slotCount);
+    for (size_t i = slotCount; i > 0; i--)
+    {
+        freeSlots.push_back(static_cast<int>(i - 1));
+    }
+    lookup.clear();
+    lruHead = lruTail = -1;
+}
+
+void TileTextureCache::beginFrame()
+{
+    frame++;
+}
+
+void TileTextureCache::unlink(int slot)
+{
+    Slot& s = slots[slot];
+    if (s.prev >= 0) slots[s.prev].next = s.next; else lruHead = s.next;
+    if (s.next >= 0) slots[s.next].prev = s.prev; else lruTail = s.prev;
+    s.prev = s.next = -1;
+}
+
+void TileTextureCache::pushFront(int slot)
+{
+    Slot& s = slots[slot];
+    s.prev = -1;
+    s.next = lruHead;
+    if (lruHead >= 0) slots[lruHead].prev = slot;
+    lruHead = slot;
+    if (lruTail < 0) lruTail = slot;
+}
+
+void TileTextureCache::touch(int slot)
+{
+    slots[slot].lastUsedFrame = frame;
+    unlink(slot);
+    pushFront(slot);
+}
+
+int TileTextureCache::findNearest(const TileID& tile, int maxAncestorLevels, TileID& source, int& dz) const
+{
+    source = tile;
+    source.wrap = 0;
+    for (dz = 0; dz <= maxAncestorLevels && source.z >= 0; dz++)
+    {
+        auto it = lookup.find(source.key());
+        if (it != lookup.end())
+        {
+            return it->second;
+        }
+        source.x >>= 1;
+        source.y >>= 1;
+        source.z--;
+    }
+    return -1;
+}
+
+TileTextureCache::Resolved TileTextureCache::resolve(const TileID& tile, int maxAncestorLevels)
+{
+    Resolved resolved;
+    int dz = 0;
+    resolved.slot = findNearest(tile, maxAncestorLevels, resolved.source, dz);
+    if (resolved.slot < 0)
+    {
+        stats.misses++;
+        return resolved;
+    }
+    resolved.textureRect = ancestorRect(tile, dz);
+    touch(resolved.slot);
+    if (dz == 0) stats.hits++; else stats.fallbacks++;
+    return resolved;
+}
+
+void TileTextureCache::pin(const TileID& tile, int maxAncestorLevels)
+{
+    TileID source;
+    int dz = 0;
+    int slot = findNearest(tile, maxAncestorLevels, source, dz);
+    if (slot >= 0)
+    {
+        touch(slot);
+    }
+}
+
+int TileTextureCache::insert(const TileID& tile)
+{
+    uint64_t key = tile.key();
+    auto it = lookup.find(key);
+    if (it != lookup.end())
+    {
+        touch(it->second);
+        return it->second;
+    }
+    
+    int slot = -1;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else if (lruTail >= 0 && slots[lruTail].lastUsedFrame != frame)
+    {
+        // 淘汰最久未使用的 slot（链表尾部）；尾部都已在本帧使用说明可见瓦片已占满预算
+        slot = lruTail;
+        unlink(slot);
+        lookup.erase(slots[slot].key);
+        stats.evictions++;
+    }
+    else
+    {
+        stats.failures++;
+        return -1;
+    }
+    
+    Slot& s = slots[slot];
+    s.key = key;
+    s.lastUsedFrame = frame;
+    pushFront(slot);
+    lookup[key] = slot;
+    stats.inserts++;
+    return slot;
+}
+
+void TileTextureCache::erase(const TileID& tile)
+{
+    auto it = lookup.find(tile.key());
+    if (it == lookup.end())
+    {
+        return;
+    }
+    int slot = it->second;
+    lookup.erase(it);
+    unlink(slot);
+    slots[slot] = Slot();
+    freeSlots.push_back(slot);
+}
+
+glm::vec4 TileTextureCache::ancestorRect(const TileID& tile, int dz)
+{
+    // 子瓦片在祖先中占 1/2^dz，位置由 x/y 的低 dz 位决定
+    float scale = 1.0f / static_cast<float>(1u << dz);
+    int mask = (1 << dz) - 1;
+    return glm::vec4(scale, scale, (tile.x & mask) * scale, (tile.y & mask) * scale);
+}
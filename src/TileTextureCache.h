@@ -0,0 +1,109 @@
+#pragma once
+#include "TileID.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 栅格瓦片纹理的 slot 管理（不依赖 GL）
+ *
+ * 每个 slot 对应纹理数组的一层，所有瓦片尺寸相同，slot 数由显存预算决定。
+ * - LRU 淘汰，本帧 resolve 过的 slot（包括被当作祖先回退的）不会被淘汰
+ * - 瓦片未加载时回退到最近的已加载祖先，并给出子矩形的纹理坐标变换，
+ *   不需要等待子瓦片就能显示（模糊但不空白）
+ * - key 不含 wrap，多个世界副本共享同一个 slot
+ */
+class TileTextureCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;           // resolve 命中瓦片本身
+        size_t fallbacks = 0;      // resolve 使用了祖先
+        size_t misses = 0;         // 瓦片和所有祖先都不在缓存中
+        size_t inserts = 0;
+        size_t evictions = 0;
+        size_t failures = 0;       // 所有 slot 都被本帧占用，无法插入
+    };
+    
+    /**
+     * resolve 的结果：slot 以及 tile 坐标 [0,1] 到 slot 纹理坐标的变换 uv * scale + offset
+     */
+    struct Resolved
+    {
+        int slot = -1;
+        TileID source;             // 实际使用的瓦片（自身或祖先）
+        glm::vec4 textureRect = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);   // xy: scale, zw: offset
+    };
+    
+    /**
+     * 按显存预算和单个 slot 的字节数确定 slot 数（不超过 maxSlots），清空所有内容
+     */
+    void configure(size_t memoryBudget, size_t slotBytes, int maxSlots);
+    bool isConfigured() const { return !slots.empty(); }
+    
+    void beginFrame();
+    
+    /**
+     * 查找瓦片或其最近的祖先（最多向上 maxAncestorLevels 级），并标记为本帧使用
+     */
+    Resolved resolve(const TileID& tile, int maxAncestorLevels = 32);
+    
+    /**
+     * 与 resolve 相同地标记瓦片或祖先为本帧使用（防止被淘汰），但不计入统计
+     */
+    void pin(const TileID& tile, int maxAncestorLevels = 32);
+    
+    /**
+     * 瓦片本身是否已在缓存中（不影响 LRU）
+     */
+    bool contains(const TileID& tile) const { return lookup.count(tile.key()) != 0; }
+    
+    /**
+     * 为瓦片分配 slot（已存在时返回原 slot），必要时淘汰最久未使用的 slot；
+     * 所有 slot 都被本帧占用时返回 -1
+     */
+    int insert(const TileID& tile);
+    
+    /**
+     * 主动移除（例如上传失败），slot 回到空闲列表
+     */
+    void erase(const TileID& tile);
+    
+    int getSlotCount() const { return static_cast<int>(slots.size()); }
+    size_t getSlotBytes() const { return slotBytes; }
+    size_t getResidentCount() const { return lookup.size(); }
+    size_t getResidentBytes() const { return lookup.size() * slotBytes; }
+    size_t getMemoryBudget() const { return slots.size() * slotBytes; }
+    const Stats& getStats() const { return stats; }
+    
+    /**
+     * 祖先瓦片中对应子瓦片的纹理坐标变换（dz 为层级差）
+     */
+    static glm::vec4 ancestorRect(const TileID& tile, int dz);
+    
+private:
+    struct Slot
+    {
+        uint64_t key = 0;
+        uint64_t lastUsedFrame = 0;
+        int prev = -1;   // LRU 链表，头部为最近使用
+        int next = -1;
+    };
+    
+    int findNearest(const TileID& tile, int maxAncestorLevels, TileID& source, int& dz) const;
+    void touch(int slot);
+    void unlink(int slot);
+    void pushFront(int slot);
+    
+    size_t slotBytes = 0;
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    std::unordered_map<uint64_t, int> lookup;
+    int lruHead = -1;
+    int lruTail = -1;
+    uint64_t frame = 0;
+    Stats stats;
+};
@@ -0,0 +1,296 @@
+#include "VectorTessellator.h"
+
+#include "Constants.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+VectorStyle::Layer makeLayer(const char* sourceLayer, VectorStyle::Type type, const glm::vec4& color, float width = 1.0f)
+{
+    VectorStyle::Layer layer;
+    layer.sourceLayer = sourceLayer;
+    layer.type = type;
+    layer.color = color;
+    layer.width = width;
+    return layer;
+}
+
+/**
+ * MVT 规范的环面积（tile 坐标 y 向下），外环为正
+ */
+double ringArea(const glm::vec2* points, size_t count)
+{
+    double sum = 0.0;
+    for (size_t i = 0, j = count - 1; i < count; j = i++)
+    {
+        sum += static_cast<double>(points[j].x) * points[i].y - static_cast<double>(points[i].x) * points[j].y;
+    }
+    return sum * 0.5;
+}
+
+glm::vec2 perpendicular(const glm::vec2& direction)
+{
+    return glm::vec2(-direction.y, direction.x);
+}
+} // namespace
+
+VectorStyle VectorStyle::createDefault()
+{
+    VectorStyle style;
+    style.layers.push_back(makeLayer("landcover", Type::Fill, glm::vec4(0.80f, 0.88f, 0.72f, 1.0f)));
+    style.layers.push_back(makeLayer("landuse", Type::Fill, glm::vec4(0.90f, 0.88f, 0.82f, 1.0f)));
+    style.layers.push_back(makeLayer("park", Type::Fill, glm::vec4(0.72f, 0.86f, 0.62f, 1.0f)));
+    style.layers.push_back(makeLayer("water", Type::Fill, glm::vec4(0.62f, 0.76f, 0.88f, 1.0f)));
+    style.layers.push_back(makeLayer("building", Type::Fill, glm::vec4(0.84f, 0.80f, 0.76f, 1.0f)));
+    style.layers.push_back(makeLayer("waterway", Type::Line, glm::vec4(0.62f, 0.76f, 0.88f, 1.0f), 1.5f));
+    style.layers.push_back(makeLayer("transportation", Type::Line, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 2.0f));
+    style.layers.push_back(makeLayer("boundary", Type::Line, glm::vec4(0.55f, 0.45f, 0.60f, 1.0f), 1.0f));
+    // GeoJsonTileSource 切出的单一图层：面填充并描边，线与描边同色
+    style.layers.push_back(makeLayer("geojson", Type::Fill, glm::vec4(0.96f, 0.72f, 0.48f, 1.0f)));
+    style.layers.push_back(makeLayer("geojson", Type::Line, glm::vec4(0.80f, 0.30f, 0.10f, 1.0f), 1.5f));
+    return style;
+}
+
+void VectorTileMesh::clear()
+{
+    vertices.clear();
+    indices.clear();
+    layers.clear();
+}
+
+bool VectorTessellator::build(const uint8_t* bytes, size_t size, const VectorStyle& style, int zoom, VectorTileMesh& out)
+{
+    PROFILE_ZONE("VectorTessellator::build");
+    out.clear();
+    stats.tiles++;
+    divisions = GeodesicSubdivider::gridDivisions(zoom, kTilePixels);
+    VectorTile tile(bytes, size);
+    for (const VectorStyle::Layer& styleLayer : style.layers)
+    {
+        // 按样式顺序输出，每个样式图层的索引连续；图层头只是视图，重复扫描很便宜
+        VectorTileMesh::Range range;
+        range.firstIndex = static_cast<uint32_t>(out.indices.size());
+        tile.rewind();
+        VectorTile::Layer layer;
+        while (tile.nextLayer(layer))
+        {
+            if (!(layer.name == styleLayer.sourceLayer.c_str()))
+            {
+                continue;
+            }
+            const float scale = static_cast<float>(Constants::TILE_EXTENT) / static_cast<float>(layer.extent);
+            const float halfWidth = styleLayer.width * 0.5f * Constants::TILE_EXTENT / kTilePixels;
+            VectorTile::Feature feature;
+            while (layer.nextFeature(feature))
+            {
+                if (feature.type == VectorTile::GeometryType::Point)
+                {
+                    stats.skippedPoints++;
+                }
+                else if (styleLayer.type == VectorStyle::Type::Fill && feature.type == VectorTile::GeometryType::Polygon)
+                {
+                    addFill(feature, scale, out);
+                }
+                else if (styleLayer.type == VectorStyle::Type::Line && feature.type != VectorTile::GeometryType::Unknown)
+                {
+                    addLine(feature, scale, halfWidth, out);
+                }
+            }
+            if (layer.hasError())
+            {
+                return false;
+            }
+        }
+        if (tile.hasError())
+        {
+            return false;
+        }
+        range.indexCount = static_cast<uint32_t>(out.indices.size()) - range.firstIndex;
+        out.layers.push_back(range);
+    }
+    stats.vertices += out.vertices.size();
+    stats.triangles += out.indices.size() / 3;
+    return true;
+}
+
+void VectorTessellator::addFill(const VectorTile::Feature& feature, float scale, VectorTileMesh& out)
+{
+    points.clear();
+    partEnds.clear();
+    if (!VectorTile::decodeGeometry(feature, scale, points, partEnds))
+    {
+        stats.invalidFeatures++;
+        return;
+    }
+    stats.features++;
+    
+    // 外环（面积为正）开始一个新多边形，之后的负面积环是它的洞；
+    // 第一个环方向错误（MVT 1 的瓦片）时仍当作外环
+    size_t firstRing = 0;
+    for (size_t ring = 0; ring < partEnds.size(); ring++)
+    {
+        uint32_t begin = ring == 0 ? 0 : partEnds[ring - 1];
+        bool exterior = ringArea(points.data() + begin, partEnds[ring] - begin) > 0.0;
+        if (exterior && ring > firstRing)
+        {
+            addPolygon(firstRing, ring, out);
+            firstRing = ring;
+        }
+    }
+    if (firstRing < partEnds.size())
+    {
+        addPolygon(firstRing, partEnds.size(), out);
+    }
+}
+
+void VectorTessellator::addPolygon(size_t firstRing, size_t endRing, VectorTileMesh& out)
+{
+    const uint32_t begin = firstRing == 0 ? 0 : partEnds[firstRing - 1];
+    const uint32_t end = partEnds[endRing - 1];
+    ringEnds.clear();
+    for (size_t ring = firstRing; ring < endRing; ring++)
+    {
+        ringEnds.push_back(partEnds[ring] - begin);
+    }
+    
+    const uint32_t baseVertex = static_cast<uint32_t>(out.vertices.size());
+    if (divisions == 1)
+    {
+        if (earcut.triangulate(points.data() + begin, ringEnds.data(), ringEnds.size(), out.indices, baseVertex) == 0)
+        {
+            return;
+        }
+        for (uint32_t i = begin; i < end; i++)
+        {
+            out.vertices.push_back(pack(points[i]));
+        }
+    }
+    else
+    {
+        // 先对原始轮廓三角化，再把三角形裁剪到细分网格上
+        triangles.clear();
+        if (earcut.triangulate(points.data() + begin, ringEnds.data(), ringEnds.size(), triangles) == 0)
+        {
+            return;
+        }
+        subdivider.subdivideTriangles(points.data() + begin, triangles.data(), triangles.size(), divisions, subdivided, out.indices, baseVertex);
+        for (const glm::vec2& point : subdivided)
+        {
+            out.vertices.push_back(pack(point));
+        }
+        stats.subdividedVertices += subdivided.size() > end - begin ? subdivided.size() - (end - begin) : 0;
+    }
+    stats.polygons++;
+}
+
+void VectorTessellator::addLine(const VectorTile::Feature& feature, float scale, float halfWidth, VectorTileMesh& out)
+{
+    points.clear();
+    partEnds.clear();
+    if (!VectorTile::decodeGeometry(feature, scale, points, partEnds))
+    {
+        stats.invalidFeatures++;
+        return;
+    }
+    stats.features++;
+    
+    // 多边形的环作为闭合线描边
+    const bool closed = feature.type == VectorTile::GeometryType::Polygon;
+    uint32_t begin = 0;
+    for (uint32_t end : partEnds)
+    {
+        if (divisions == 1)
+        {
+            extrude(points.data() + begin, end - begin, closed, halfWidth, out);
+        }
+        else
+        {
+            // 在网格线处插点后再挤出；每个新增的点挤出两个顶点
+            subdivider.subdivideLine(points.data() + begin, end - begin, closed, divisions, subdivided);
+            extrude(subdivided.data(), subdivided.size(), closed, halfWidth, out);
+            stats.subdividedVertices += (subdivided.size() - (end - begin)) * 2;
+        }
+        begin = end;
+    }
+}
+
+void VectorTessellator::extrude(const glm::vec2* input, size_t count, bool closed, float halfWidth, VectorTileMesh& out)
+{
+    // 去掉连续的重复点（零长度的线段没有方向）
+    line.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (line.empty() || input[i] != line.back())
+        {
+            line.push_back(input[i]);
+        }
+    }
+    if (closed && line.size() > 1 && line.front() == line.back())
+    {
+        line.pop_back();
+    }
+    const size_t n = line.size();
+    if (n < 2)
+    {
+        return;
+    }
+    closed = closed && n >= 3;
+    
+    // 每个点沿斜接方向挤出左右两个顶点
+    const uint32_t baseVertex = static_cast<uint32_t>(out.vertices.size());
+    for (size_t i = 0; i < n; i++)
+    {
+        const bool hasPrev = closed || i > 0;
+        const bool hasNext = closed || i + 1 < n;
+        const glm::vec2& point = line[i];
+        glm::vec2 previousNormal = hasPrev ? perpendicular(glm::normalize(point - line[(i + n - 1) % n])) : glm::vec2(0.0f);
+        glm::vec2 nextNormal = hasNext ? perpendicular(glm::normalize(line[(i + 1) % n] - point)) : glm::vec2(0.0f);
+        
+        glm::vec2 offset;
+        if (hasPrev && hasNext)
+        {
+            glm::vec2 miter = previousNormal + nextNormal;
+            float length = glm::length(miter);
+            if (length < 1e-6f)
+            {
+                // 180° 折返：斜接方向不存在，退化为平头
+                offset = nextNormal * halfWidth;
+            }
+            else
+            {
+                miter /= length;
+                float miterLength = std::min(1.0f / std::max(glm::dot(miter, nextNormal), 1e-6f), kMiterLimit);
+                offset = miter * (halfWidth * miterLength);
+            }
+        }
+        else
+        {
+            offset = (hasPrev ? previousNormal : nextNormal) * halfWidth;
+        }
+        out.vertices.push_back(pack(point + offset));
+        out.vertices.push_back(pack(point - offset));
+    }
+    
+    // 每段两个三角形（索引化的三角形带）
+    const size_t segments = closed ? n : n - 1;
+    for (size_t segment = 0; segment < segments; segment++)
+    {
+        uint32_t a = baseVertex + static_cast<uint32_t>(segment * 2);
+        uint32_t b = baseVertex + static_cast<uint32_t>(((segment + 1) % n) * 2);
+        out.indices.insert(out.indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+    }
+    stats.lines++;
+}
+
+VectorVertex VectorTessellator::pack(const glm::vec2& point)
+{
+    const float lowest = static_cast<float>(std::numeric_limits<int16_t>::min());
+    const float highest = static_cast<float>(std::numeric_limits<int16_t>::max());
+    VectorVertex vertex;
+    vertex.x = static_cast<int16_t>(std::lround(std::clamp(point.x, lowest, highest)));
+    vertex.y = static_cast<int16_t>(std::lround(std::clamp(point.y, lowest, highest)));
+    return vertex;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "Earcut.h"
+#include "GeodesicSubdivider.h"
+#include "VectorTile.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 矢量瓦片的绘制样式：按顺序绘制的图层，每层取一个 MVT 图层的要素，以一种颜色填充或描线
+ */
+struct VectorStyle
+{
+    enum class Type
+    {
+        Fill,       // 多边形三角化
+        Line,       // 线（以及多边形的边界）挤出为带宽度的三角形带
+    };
+    
+    struct Layer
+    {
+        std::string sourceLayer;    // MVT 图层名
+        Type type = Type::Fill;
+        glm::vec4 color = glm::vec4(1.0f);
+        float width = 1.0f;         // 线宽（像素，按 512 像素的瓦片换算为 tile 坐标）
+    };
+    
+    std::vector<Layer> layers;
+    
+    /**
+     * OpenMapTiles 结构的默认样式（水域、地表覆盖、建筑、道路、边界），以及 GeoJSON 切片的 geojson 图层
+     */
+    static VectorStyle createDefault();
+};
+
+/**
+ * 打包好的顶点（TILE_EXTENT 坐标，int16 可以容纳瓦片缓冲区以外的部分）
+ */
+struct VectorVertex
+{
+    int16_t x;
+    int16_t y;
+};
+
+/**
+ * 一个瓦片三角化的结果：可直接上传的顶点与索引，按样式图层分段
+ */
+struct VectorTileMesh
+{
+    struct Range
+    {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+    };
+    
+    std::vector<VectorVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Range> layers;      // 与 VectorStyle::layers 一一对应
+    
+    void clear();
+    bool empty() const { return indices.empty(); }
+    size_t sizeInBytes() const { return vertices.size() * sizeof(VectorVertex) + indices.size() * sizeof(uint32_t); }
+};
+
+/**
+ * MVT 字节 -> VectorTileMesh（不依赖 GL，在工作线程上运行）
+ *
+ * - 多边形按环的面积符号分组（正为外环，负为前一个外环的洞），用 Earcut 三角化
+ * - 线在 CPU 上沿斜接方向挤出为三角形带（以索引三角形输出，和多边形共用一种绘制方式），
+ *   斜接长度超过上限时截断
+ * - 点要素没有对应的绘制方式，只计数
+ * - 低层级的瓦片用 GeodesicSubdivider 按球面误差切到网格上（线在挤出前插点，多边形三角化后裁剪），
+ *   结果随瓦片一起缓存，每个瓦片只做一次
+ *
+ * 解码和三角化的中间缓冲区属于实例，多次调用之间复用；一个实例同一时刻只能被一个线程使用。
+ */
+class VectorTessellator
+{
+public:
+    static constexpr float kMiterLimit = 2.0f;
+    // 样式中的线宽按此瓦片像素尺寸换算（与 maplibre 的 512 像素瓦片一致）
+    static constexpr float kTilePixels = 512.0f;
+    
+    /**
+     * 累计统计
+     */
+    struct Stats
+    {
+        uint64_t tiles = 0;
+        uint64_t features = 0;      // 被样式使用的要素
+        uint64_t polygons = 0;
+        uint64_t lines = 0;
+        uint64_t skippedPoints = 0;
+        uint64_t invalidFeatures = 0; // 几何命令损坏
+        uint64_t vertices = 0;
+        uint64_t triangles = 0;
+        uint64_t subdividedVertices = 0;  // 球面细分新增的顶点（包含在 vertices 中）
+    };
+    
+    /**
+     * 按样式三角化一个瓦片（zoom 为瓦片层级，决定球面细分的密度），结果写入 out（先清空，复用其容量）；
+     * 瓦片数据损坏时返回 false
+     */
+    bool build(const uint8_t* bytes, size_t size, const VectorStyle& style, int zoom, VectorTileMesh& out);
+    
+    const Stats& getStats() const { return stats; }
+    
+private:
+    void addFill(const VectorTile::Feature& feature, float scale, VectorTileMesh& out);
+    void addLine(const VectorTile::Feature& feature, float scale, float halfWidth, VectorTileMesh& out);
+    void addPolygon(size_t firstRing, size_t endRing, VectorTileMesh& out);
+    void extrude(const glm::vec2* points, size_t count, bool closed, float halfWidth, VectorTileMesh& out);
+    static VectorVertex pack(const glm::vec2& point);
+    
+    Earcut earcut;
+    GeodesicSubdivider subdivider;
+    int divisions = 1;                // 当前瓦片的细分网格，1 表示不细分
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> partEnds;
+    std::vector<uint32_t> ringEnds;   // 一个多边形的环（相对多边形的第一个点）
+    std::vector<glm::vec2> line;      // 去掉重复点后的线
+    std::vector<uint32_t> triangles;  // 细分前的三角形（相对多边形的第一个点）
+    std::vector<glm::vec2> subdivided;
+    Stats stats;
+};
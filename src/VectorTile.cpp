@@ -0,0 +1,176 @@
+#include "VectorTile.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+// MVT 字段编号
+constexpr uint32_t kTileLayers = 3;
+constexpr uint32_t kLayerName = 1;
+constexpr uint32_t kLayerFeatures = 2;
+constexpr uint32_t kLayerExtent = 5;
+constexpr uint32_t kLayerVersion = 15;
+constexpr uint32_t kFeatureId = 1;
+constexpr uint32_t kFeatureTags = 2;
+constexpr uint32_t kFeatureType = 3;
+constexpr uint32_t kFeatureGeometry = 4;
+
+// 几何命令：低 3 位为命令，其余为重复次数
+constexpr uint32_t kMoveTo = 1;
+constexpr uint32_t kLineTo = 2;
+constexpr uint32_t kClosePath = 7;
+
+int32_t zigzag(uint32_t value)
+{
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+} // namespace
+
+bool VectorTile::nextLayer(Layer& out)
+{
+    if (!reader.next(kTileLayers))
+    {
+        return false;
+    }
+    out = Layer();
+    if (!out.parse(reader.message()))
+    {
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+bool VectorTile::Layer::parse(PbfReader reader)
+{
+    // 名字和 extent 可能出现在要素之后，先完整扫描一遍图层消息
+    message = reader;
+    while (reader.next())
+    {
+        const uint8_t* bytes = nullptr;
+        switch (reader.tag())
+        {
+        case kLayerName:
+            reader.bytes(bytes, name.size);
+            name.data = reinterpret_cast<const char*>(bytes);
+            break;
+        case kLayerExtent:
+            extent = reader.uint32();
+            break;
+        case kLayerVersion:
+            version = reader.uint32();
+            break;
+        default:
+            reader.skip();
+            break;
+        }
+    }
+    error = reader.hasError() || extent == 0;
+    features = message;
+    return !error;
+}
+
+bool VectorTile::Layer::nextFeature(Feature& out)
+{
+    if (error || !features.next(kLayerFeatures))
+    {
+        return false;
+    }
+    PbfReader reader = features.message();
+    out = Feature();
+    while (reader.next())
+    {
+        switch (reader.tag())
+        {
+        case kFeatureId:
+            out.id = reader.varint();
+            break;
+        case kFeatureTags:
+            out.tags = reader.packedUint32();
+            break;
+        case kFeatureType:
+        {
+            uint32_t type = reader.uint32();
+            out.type = type <= static_cast<uint32_t>(GeometryType::Polygon) ? static_cast<GeometryType>(type) : GeometryType::Unknown;
+            break;
+        }
+        case kFeatureGeometry:
+            out.geometry = reader.packedUint32();
+            break;
+        default:
+            reader.skip();
+            break;
+        }
+    }
+    if (reader.hasError())
+    {
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+bool VectorTile::decodeGeometry(const Feature& feature, float scale, std::vector<glm::vec2>& points, std::vector<uint32_t>& partEnds)
+{
+    PbfReader::PackedUint32 geometry = feature.geometry;
+    const bool pointType = feature.type == GeometryType::Point;
+    size_t partStart = points.size();
+    // 增量在 int64 中累加：损坏的数据可以让 int32 溢出
+    int64_t x = 0, y = 0;
+    uint32_t command = 0;
+    while (geometry.next(command))
+    {
+        uint32_t id = command & 7;
+        uint32_t count = command >> 3;
+        if (id == kMoveTo || id == kLineTo)
+        {
+            // MoveTo 开始新的一条线或一个环
+            if (id == kMoveTo && points.size() > partStart)
+            {
+                partEnds.push_back(static_cast<uint32_t>(points.size()));
+                partStart = points.size();
+            }
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint32_t dx = 0, dy = 0;
+                if (!geometry.next(dx) || !geometry.next(dy))
+                {
+                    return false;
+                }
+                // 坐标为相对上一个点的 zigzag 增量
+                x += zigzag(dx);
+                y += zigzag(dy);
+                if (std::min(x, y) < std::numeric_limits<int32_t>::min() || std::max(x, y) > std::numeric_limits<int32_t>::max())
+                {
+                    // MVT 规定坐标为 int32
+                    return false;
+                }
+                points.push_back(glm::vec2(static_cast<float>(x), static_cast<float>(y)) * scale);
+                if (pointType)
+                {
+                    partEnds.push_back(static_cast<uint32_t>(points.size()));
+                    partStart = points.size();
+                }
+            }
+        }
+        else if (id == kClosePath)
+        {
+            // 环的终点即起点，不重复存储
+            if (points.size() > partStart)
+            {
+                partEnds.push_back(static_cast<uint32_t>(points.size()));
+                partStart = points.size();
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (points.size() > partStart)
+    {
+        partEnds.push_back(static_cast<uint32_t>(points.size()));
+    }
+    return !geometry.hasError();
+}
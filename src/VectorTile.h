@@ -0,0 +1,102 @@
+#pragma once
+#include "PbfReader.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Mapbox Vector Tile（MVT 2.1）的只读视图，建立在 PbfReader 之上，不复制、不分配
+ *
+ * - nextLayer / Layer::nextFeature 依次枚举图层与要素，名字和几何都指向原缓冲区
+ * - decodeGeometry 把要素的命令流解码为点列，坐标从图层 extent 换算到 TILE_EXTENT，
+ *   写入调用方复用的缓冲区
+ *
+ * 数据损坏时枚举提前结束，并由 hasError 报告。
+ */
+class VectorTile
+{
+public:
+    enum class GeometryType : uint32_t
+    {
+        Unknown = 0,
+        Point = 1,
+        LineString = 2,
+        Polygon = 3,
+    };
+    
+    /**
+     * 指向原缓冲区的字符串（不以 '\0' 结尾）
+     */
+    struct StringView
+    {
+        const char* data = nullptr;
+        size_t size = 0;
+        
+        bool operator==(const char* text) const { return std::strlen(text) == size && std::memcmp(data, text, size) == 0; }
+    };
+    
+    struct Feature
+    {
+        uint64_t id = 0;
+        GeometryType type = GeometryType::Unknown;
+        PbfReader::PackedUint32 geometry;
+        PbfReader::PackedUint32 tags;     // 属性：交替的 key / value 下标
+    };
+    
+    class Layer
+    {
+    public:
+        StringView name;
+        uint32_t version = 1;
+        uint32_t extent = 4096;           // MVT 默认值
+        
+        /**
+         * 读取下一个要素；没有更多要素或数据损坏时返回 false
+         */
+        bool nextFeature(Feature& out);
+        
+        /**
+         * 重新从第一个要素开始枚举
+         */
+        void rewind() { features = message; }
+        
+        bool hasError() const { return error || features.hasError(); }
+        
+    private:
+        friend class VectorTile;
+        bool parse(PbfReader reader);
+        
+        PbfReader message;                // 整个图层消息
+        PbfReader features;               // 要素枚举的游标
+        bool error = false;
+    };
+    
+    VectorTile(const uint8_t* data, size_t size) : data(data), size(size), reader(data, size) {}
+    
+    /**
+     * 读取下一个图层；没有更多图层或数据损坏时返回 false
+     */
+    bool nextLayer(Layer& out);
+    
+    /**
+     * 重新从第一个图层开始枚举
+     */
+    void rewind() { reader = PbfReader(data, size); }
+    
+    bool hasError() const { return error || reader.hasError(); }
+    
+    /**
+     * 解码要素几何：坐标乘以 scale（TILE_EXTENT / extent）后追加到 points，
+     * 每条线（LineString）或每个环（Polygon，不重复首点）的结束下标追加到 partEnds；
+     * Point 要素每个点为一段。命令流损坏或坐标超出 int32 时返回 false（已解码的部分保留）
+     */
+    static bool decodeGeometry(const Feature& feature, float scale, std::vector<glm::vec2>& points, std::vector<uint32_t>& partEnds);
+    
+private:
+    const uint8_t* data;
+    size_t size;
+    PbfReader reader;
+    bool error = false;
+};
@@ -0,0 +1,279 @@
+#include "VectorTileLayer.h"
+
+#include "Profiler.h"
+#include "TileInstanceBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace
+{
+/**
+ * （瓦片, wrap）的 key：z <= 22 时 y 只用到 TileID::key 中 y 字段的低 22 位，wrap 放在其上方
+ */
+uint64_t drawKey(const TileID& tile)
+{
+    return tile.key() ^ (static_cast<uint64_t>(tile.wrap & 0x7f) << 51);
+}
+} // namespace
+
+VectorTileLayer::VectorTileLayer(std::shared_ptr<const TileSource> source, const VectorStyle& style, size_t memoryBudget)
+    : loader(std::move(source), style), style(style), memoryBudget(memoryBudget), vertexArray(0), frameIndex(0)
+{
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    
+    // int16 tile 坐标，不归一化；顶点和索引缓冲区在绘制每个瓦片时绑定
+    glVertexAttribFormat(0, 2, GL_SHORT, GL_FALSE, 0);
+    glVertexAttribBinding(0, 0);
+    glEnableVertexAttribArray(0);
+    
+    // 实例属性与 TileRenderer 的布局相同（location 1..10）
+    for (int column = 0; column < 4; column++)
+    {
+        GLuint location = 1 + column;
+        glVertexAttribFormat(location, 4, GL_FLOAT, GL_FALSE, static_cast<GLuint>(offsetof(TileInstance, mercatorMatrix) + column * sizeof(glm::vec4)));
+        glVertexAttribBinding(location, kInstanceBinding);
+        glEnableVertexAttribArray(location);
+    }
+    glVertexAttribFormat(5, 4, GL_FLOAT, GL_FALSE, offsetof(TileInstance, tileMercatorCoords));
+    glVertexAttribFormat(6, 4, GL_FLOAT, GL_FALSE, offsetof(TileInstance, color));
+    glVertexAttribIFormat(7, 1, GL_INT, offsetof(TileInstance, resources));
+    glVertexAttribIFormat(8, 1, GL_INT, offsetof(TileInstance, resources) + sizeof(int));
+    glVertexAttribFormat(9, 4, GL_FLOAT, GL_FALSE, offsetof(TileInstance, textureRect));
+    glVertexAttribIFormat(10, 1, GL_INT, offsetof(TileInstance, resources) + 2 * sizeof(int));
+    for (GLuint location = 5; location <= 10; location++)
+    {
+        glVertexAttribBinding(location, kInstanceBinding);
+        glEnableVertexAttribArray(location);
+    }
+    glVertexBindingDivisor(kInstanceBinding, 1);
+    glBindVertexArray(0);
+}
+
+VectorTileLayer::~VectorTileLayer()
+{
+    for (auto& entry : tiles)
+    {
+        glDeleteBuffers(1, &entry.second.vertexBuffer);
+        glDeleteBuffers(1, &entry.second.indexBuffer);
+    }
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+TileID VectorTileLayer::requestTarget(const TileID& tile) const
+{
+    // 超出数据源层级或数据源中不存在时，请求最近的祖先（放大显示）
+    int maxZoom = loader.getSource().getMaxZoom();
+    TileID target = tile;
+    target.wrap = 0;
+    while (target.z > 0 && (target.z > maxZoom || unavailableTiles.count(target.key())))
+    {
+        target.x >>= 1;
+        target.y >>= 1;
+        target.z--;
+    }
+    return target;
+}
+
+void VectorTileLayer::update(const FramePacket& frame, size_t maxUploadBytes, double maxUploadMilliseconds)
+{
+    PROFILE_ZONE("VectorTileLayer::update");
+    frameIndex++;
+    
+    // 先上传已完成的结果，本帧就能用上
+    auto start = std::chrono::steady_clock::now();
+    size_t uploadedBytes = 0;
+    VectorTileData data;
+    while (uploadedBytes < maxUploadBytes
+           && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < maxUploadMilliseconds
+           && loader.poll(data))
+    {
+        uint64_t key = data.tile.key();
+        pendingTiles.erase(key);
+        if (data.failed)
+        {
+            unavailableTiles.insert(key);
+            continue;
+        }
+        uploadedBytes += data.sizeInBytes();
+        upload(data);
+    }
+    
+    // 请求缺失的瓦片；选出每个覆盖瓦片要绘制的数据（自身或最近的已上传祖先）
+    drawTiles.clear();
+    drawnKeys.clear();
+    bool queueFull = false;
+    for (const TileID& tile : frame.tiles)
+    {
+        TileID target = requestTarget(tile);
+        uint64_t key = target.key();
+        if (!tiles.count(key) && !unavailableTiles.count(key) && !pendingTiles.count(key) && !queueFull)
+        {
+            // 队列已满时放弃，下一帧再请求
+            if (loader.request(target))
+            {
+                pendingTiles.insert(key);
+            }
+            else
+            {
+                queueFull = true;
+            }
+        }
+        
+        TileID source = target;
+        auto found = tiles.find(key);
+        while (found == tiles.end() && source.z > 0)
+        {
+            source.x >>= 1;
+            source.y >>= 1;
+            source.z--;
+            found = tiles.find(source.key());
+        }
+        if (found == tiles.end())
+        {
+            continue;
+        }
+        found->second.lastUsedFrame = frameIndex;
+        source.wrap = tile.wrap;
+        if (drawnKeys.insert(drawKey(source)).second)
+        {
+            drawTiles.push_back({ &found->second, source });
+        }
+    }
+    evict();
+}
+
+void VectorTileLayer::upload(VectorTileData& data)
+{
+    PROFILE_ZONE("VectorTileLayer::upload");
+    GpuTile& gpuTile = tiles[data.tile.key()];
+    glDeleteBuffers(1, &gpuTile.vertexBuffer);
+    glDeleteBuffers(1, &gpuTile.indexBuffer);
+    stats.residentBytes -= gpuTile.bytes;
+    gpuTile = GpuTile();
+    gpuTile.layers = std::move(data.mesh.layers);
+    gpuTile.lastUsedFrame = frameIndex;
+    if (data.mesh.empty())
+    {
+        return;
+    }
+    
+    glGenBuffers(1, &gpuTile.vertexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, gpuTile.vertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, data.mesh.vertices.size() * sizeof(VectorVertex), data.mesh.vertices.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &gpuTile.indexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, gpuTile.indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, data.mesh.indices.size() * sizeof(uint32_t), data.mesh.indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    
+    gpuTile.bytes = data.sizeInBytes();
+    stats.residentBytes += gpuTile.bytes;
+    stats.uploads++;
+    stats.uploadedBytes += gpuTile.bytes;
+}
+
+void VectorTileLayer::evict()
+{
+    while (stats.residentBytes > memoryBudget)
+    {
+        auto oldest = tiles.end();
+        for (auto it = tiles.begin(); it != tiles.end(); ++it)
+        {
+            if (it->second.lastUsedFrame < frameIndex && (oldest == tiles.end() || it->second.lastUsedFrame < oldest->second.lastUsedFrame))
+            {
+                oldest = it;
+            }
+        }
+        if (oldest == tiles.end())
+        {
+            return;     // 全部是本帧用到的瓦片
+        }
+        glDeleteBuffers(1, &oldest->second.vertexBuffer);
+        glDeleteBuffers(1, &oldest->second.indexBuffer);
+        stats.residentBytes -= oldest->second.bytes;
+        stats.evictions++;
+        tiles.erase(oldest);
+    }
+}
+
+size_t VectorTileLayer::draw(StreamBuffer& streamBuffer, const ProjectionState& state)
+{
+    PROFILE_ZONE("VectorTileLayer::draw");
+    stats.drawnTiles = 0;
+    stats.drawnTriangles = 0;
+    size_t instanceCount = 0;
+    for (const DrawTile& drawTile : drawTiles)
+    {
+        for (const VectorTileMesh::Range& range : drawTile.gpuTile->layers)
+        {
+            instanceCount += range.indexCount > 0 ? 1 : 0;
+        }
+    }
+    if (instanceCount == 0)
+    {
+        return 0;
+    }
+    
+    // 每个（瓦片, 样式图层）一个实例，直接写入流式缓冲区
+    StreamBuffer::Allocation allocation = streamBuffer.allocate(instanceCount * sizeof(TileInstance));
+    TileInstance* out = static_cast<TileInstance*>(allocation.pointer);
+    size_t written = 0;
+    for (const DrawTile& drawTile : drawTiles)
+    {
+        const glm::mat4 mercatorMatrix = state.mercatorMatrix(drawTile.tile);
+        const glm::vec4 tileMercatorCoords = state.tileMercatorCoords(drawTile.tile);
+        for (size_t layer = 0; layer < drawTile.gpuTile->layers.size(); layer++)
+        {
+            if (drawTile.gpuTile->layers[layer].indexCount == 0)
+            {
+                continue;
+            }
+            TileInstance instance;
+            instance.mercatorMatrix = mercatorMatrix;
+            instance.tileMercatorCoords = tileMercatorCoords;
+            instance.color = style.layers[layer].color;
+            instance.tileID = glm::ivec4(drawTile.tile.x, drawTile.tile.y, drawTile.tile.z, drawTile.tile.wrap);
+            instance.resources = glm::ivec4(-1, -1, 0, 0);
+            instance.textureRect = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+            // 整个实例一次写出（out 是映射的内存，只写不读）
+            out[written++] = instance;
+        }
+    }
+    
+    glBindVertexArray(vertexArray);
+    glBindVertexBuffer(kInstanceBinding, allocation.buffer, static_cast<GLintptr>(allocation.offset), sizeof(TileInstance));
+    size_t drawCalls = 0;
+    GLuint baseInstance = 0;
+    for (const DrawTile& drawTile : drawTiles)
+    {
+        const GpuTile& gpuTile = *drawTile.gpuTile;
+        if (gpuTile.vertexBuffer == 0)
+        {
+            continue;
+        }
+        glBindVertexBuffer(0, gpuTile.vertexBuffer, 0, sizeof(VectorVertex));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuTile.indexBuffer);
+        for (const VectorTileMesh::Range& range : gpuTile.layers)
+        {
+            if (range.indexCount == 0)
+            {
+                continue;
+            }
+            glDrawElementsInstancedBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_INT,
+                                                (void*)(range.firstIndex * sizeof(uint32_t)), 1, baseInstance++);
+            stats.drawnTriangles += range.indexCount / 3;
+            drawCalls++;
+        }
+        stats.drawnTiles++;
+    }
+    glBindVertexArray(0);
+    return drawCalls;
+}
+
+VectorTileLayer::Stats VectorTileLayer::getStats() const
+{
+    Stats result = stats;
+    result.residentTiles = tiles.size();
+    return result;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "FrameBuilder.h"
+#include "ProjectionState.h"
+#include "StreamBuffer.h"
+#include "TileID.h"
+#include "TileSource.h"
+#include "VectorTessellator.h"
+#include "VectorTileLoader.h"
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * 矢量瓦片的 GPU 端：请求覆盖瓦片的矢量数据，上传三角化结果，用 tile shader 绘制
+ *
+ * - 解码和三角化在 VectorTileLoader 的工作线程上完成，这里每帧只按预算创建缓冲区
+ * - 每个瓦片一对静态 VBO / EBO（int16 TILE_EXTENT 坐标 + uint32 索引），
+ *   所有瓦片共用一个 VAO，实例属性的格式与 TileRenderer 相同
+ * - 每个（瓦片, 样式图层）一个实例：瓦片的墨卡托矩阵 + 图层颜色，纹理层为 -1，
+ *   因此顶点经过与填充面相同的 Mercator / Globe 混合投影
+ * - 缺失的瓦片用已上传的最近祖先代替（与兄弟瓦片可能短暂重叠）
+ * - 显存超过预算时按最久未使用淘汰，本帧用到的瓦片不淘汰
+ *
+ * 只能在创建它的 GL 上下文所在线程上使用。
+ */
+class VectorTileLayer
+{
+public:
+    struct Stats
+    {
+        size_t residentTiles = 0;
+        size_t residentBytes = 0;
+        uint64_t uploads = 0;
+        uint64_t uploadedBytes = 0;
+        uint64_t evictions = 0;
+        size_t drawnTiles = 0;      // 最近一帧
+        size_t drawnTriangles = 0;
+    };
+    
+    VectorTileLayer(std::shared_ptr<const TileSource> source, const VectorStyle& style, size_t memoryBudget = 128 * 1024 * 1024);
+    ~VectorTileLayer();
+    
+    VectorTileLayer(const VectorTileLayer&) = delete;
+    VectorTileLayer& operator=(const VectorTileLayer&) = delete;
+    
+    /**
+     * 请求本帧缺失的瓦片，在预算内上传已完成的结果，并选出要绘制的瓦片（自身或最近的已上传祖先）
+     */
+    void update(const FramePacket& frame, size_t maxUploadBytes, double maxUploadMilliseconds);
+    
+    /**
+     * 写入实例数据并绘制 update 选出的瓦片；调用方已设置好 tile shader 的程序和 uniform。
+     * 结束时 VAO 绑定被清除，返回 draw call 数
+     */
+    size_t draw(StreamBuffer& streamBuffer, const ProjectionState& state);
+    
+    bool hasPendingTiles() const { return !pendingTiles.empty(); }
+    bool hasResults() const { return loader.hasResults(); }
+    const VectorTileLoader& getLoader() const { return loader; }
+    Stats getStats() const;
+    
+private:
+    // 实例属性使用的顶点缓冲区绑定点（与 TileRenderer 相同，0 为矢量顶点）
+    static constexpr GLuint kInstanceBinding = 1;
+    
+    struct GpuTile
+    {
+        GLuint vertexBuffer = 0;    // 没有可绘制内容的瓦片为 0（仍然记为已加载）
+        GLuint indexBuffer = 0;
+        std::vector<VectorTileMesh::Range> layers;
+        size_t bytes = 0;
+        uint64_t lastUsedFrame = 0;
+    };
+    
+    struct DrawTile
+    {
+        const GpuTile* gpuTile;
+        TileID tile;                // 数据所属的瓦片（可能是祖先），wrap 取自覆盖瓦片
+    };
+    
+    TileID requestTarget(const TileID& tile) const;
+    void upload(VectorTileData& data);
+    void evict();
+    
+    VectorTileLoader loader;
+    const VectorStyle style;
+    size_t memoryBudget;
+    GLuint vertexArray;
+    
+    std::unordered_map<uint64_t, GpuTile> tiles;
+    std::unordered_set<uint64_t> pendingTiles;
+    std::unordered_set<uint64_t> unavailableTiles;  // 数据源中不存在或数据损坏
+    std::vector<DrawTile> drawTiles;
+    std::unordered_set<uint64_t> drawnKeys;         // 本帧已选出的（瓦片, wrap），祖先只画一次
+    uint64_t frameIndex;
+    Stats stats;
+};
@@ -0,0 +1,252 @@
+#include "VectorTileLoader.h"
+
+#include "Profiler.h"
+#include "stb_image.h"
+#include <thread>
+
+namespace
+{
+// 解压后的大小上限，防止损坏的长度字段触发巨大的分配
+constexpr uint32_t kMaxInflatedSize = 64u * 1024u * 1024u;
+
+double secondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
+bool isGzip(const uint8_t* bytes, size_t size)
+{
+    return size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b;
+}
+} // namespace
+
+VectorTileLoader::VectorTileLoader(std::shared_ptr<const TileSource> source, const VectorStyle& style)
+    : VectorTileLoader(std::move(source), style, Options())
+{
+}
+
+VectorTileLoader::VectorTileLoader(std::shared_ptr<const TileSource> source, const VectorStyle& style, const Options& options)
+    : source(std::move(source)),
+      style(style),
+      jobs(options.jobSystem ? *options.jobSystem : JobSystem::shared()),
+      results(options.queueCapacity),
+      stopping(false),
+      inFlight(0),
+      pendingJobs(0),
+      startTime(std::chrono::steady_clock::now()),
+      requested(0), rejected(0), decoded(0), failed(0), delivered(0), cancelled(0),
+      encodedBytes(0), meshBytes(0), vertices(0), triangles(0), subdividedVertices(0),
+      decodeSeconds(0.0)
+{
+}
+
+VectorTileLoader::~VectorTileLoader()
+{
+    // 尚未开始的任务看到 stopping 后直接结束；等待期间帮调度器执行任务
+    stopping.store(true);
+    while (pendingJobs.load(std::memory_order_acquire) > 0)
+    {
+        if (!jobs.runOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool VectorTileLoader::request(const TileID& tile, TilePriority priority, std::shared_ptr<const CancellationToken> token)
+{
+    requested.fetch_add(1, std::memory_order_relaxed);
+    // 在途数量不超过结果队列容量，任务写结果时就不会遇到队列已满
+    if (inFlight.fetch_add(1, std::memory_order_relaxed) >= results.capacity())
+    {
+        inFlight.fetch_sub(1, std::memory_order_relaxed);
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    Request request{ tile, priority, std::move(token), std::chrono::steady_clock::now() };
+    pendingJobs.fetch_add(1, std::memory_order_relaxed);
+    jobs.schedule([this, request]() {
+        if (!stopping.load(std::memory_order_relaxed))
+        {
+            process(request);
+        }
+        pendingJobs.fetch_sub(1, std::memory_order_release);
+    }, priority == TilePriority::Visible ? JobSystem::Priority::Normal : JobSystem::Priority::Low);
+    return true;
+}
+
+bool VectorTileLoader::poll(VectorTileData& out)
+{
+    if (!results.pop(out))
+    {
+        return false;
+    }
+    inFlight.fetch_sub(1, std::memory_order_relaxed);
+    delivered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+VectorTileLoader::Stats VectorTileLoader::getStats() const
+{
+    Stats stats;
+    stats.requested = requested.load(std::memory_order_relaxed);
+    stats.rejected = rejected.load(std::memory_order_relaxed);
+    stats.decoded = decoded.load(std::memory_order_relaxed);
+    stats.failed = failed.load(std::memory_order_relaxed);
+    stats.delivered = delivered.load(std::memory_order_relaxed);
+    stats.cancelled = cancelled.load(std::memory_order_relaxed);
+    stats.encodedBytes = encodedBytes.load(std::memory_order_relaxed);
+    stats.meshBytes = meshBytes.load(std::memory_order_relaxed);
+    stats.vertices = vertices.load(std::memory_order_relaxed);
+    stats.triangles = triangles.load(std::memory_order_relaxed);
+    stats.subdividedVertices = subdividedVertices.load(std::memory_order_relaxed);
+    stats.decodeSeconds = decodeSeconds.load(std::memory_order_relaxed);
+    stats.elapsedSeconds = secondsBetween(startTime, std::chrono::steady_clock::now());
+    return stats;
+}
+
+bool VectorTileLoader::decode(const uint8_t* bytes, size_t size, const VectorStyle& style, int zoom, VectorTileMesh& out,
+                              uint64_t* subdividedVertices)
+{
+    // 解压缓冲区、三角化的中间状态和网格都按线程复用，稳定后只有结果的三次分配
+    thread_local std::vector<uint8_t> inflated;
+    thread_local VectorTessellator tessellator;
+    thread_local VectorTileMesh scratch;
+    if (isGzip(bytes, size))
+    {
+        if (!gunzip(bytes, size, inflated))
+        {
+            return false;
+        }
+        bytes = inflated.data();
+        size = inflated.size();
+    }
+    const uint64_t subdividedBefore = tessellator.getStats().subdividedVertices;
+    if (!tessellator.build(bytes, size, style, zoom, scratch))
+    {
+        return false;
+    }
+    if (subdividedVertices)
+    {
+        *subdividedVertices = tessellator.getStats().subdividedVertices - subdividedBefore;
+    }
+    out.vertices.assign(scratch.vertices.begin(), scratch.vertices.end());
+    out.indices.assign(scratch.indices.begin(), scratch.indices.end());
+    out.layers.assign(scratch.layers.begin(), scratch.layers.end());
+    return true;
+}
+
+bool VectorTileLoader::gunzip(const uint8_t* bytes, size_t size, std::vector<uint8_t>& out)
+{
+    // 固定的 10 字节头（魔数、压缩方法、标志）之后是可选字段，尾部 8 字节为 CRC32 和原始长度
+    if (size < 18 || !isGzip(bytes, size) || bytes[2] != 8)
+    {
+        return false;
+    }
+    const uint8_t flags = bytes[3];
+    size_t offset = 10;
+    if (flags & 0x04)
+    {
+        // FEXTRA
+        offset += 2 + (bytes[offset] | (bytes[offset + 1] << 8));
+    }
+    for (uint8_t flag : { uint8_t(0x08), uint8_t(0x10) })
+    {
+        // FNAME / FCOMMENT：以 0 结尾的字符串
+        if (flags & flag)
+        {
+            while (offset < size && bytes[offset] != 0)
+            {
+                offset++;
+            }
+            offset++;
+        }
+    }
+    if (flags & 0x02)
+    {
+        offset += 2;    // FHCRC
+    }
+    if (offset + 8 > size)
+    {
+        return false;
+    }
+    
+    const uint8_t* trailer = bytes + size - 4;
+    const uint32_t inflatedSize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<uint32_t>(trailer[3]) << 24);
+    if (inflatedSize > kMaxInflatedSize)
+    {
+        return false;
+    }
+    out.resize(inflatedSize);
+    if (inflatedSize == 0)
+    {
+        return true;
+    }
+    // 直接解压到按原始长度分配好的缓冲区，stb 不再分配内存
+    int written = stbi_zlib_decode_noheader_buffer(reinterpret_cast<char*>(out.data()), static_cast<int>(inflatedSize),
+                                                   reinterpret_cast<const char*>(bytes + offset), static_cast<int>(size - 8 - offset));
+    return written == static_cast<int>(inflatedSize);
+}
+
+void VectorTileLoader::process(const Request& request)
+{
+    PROFILE_ZONE("VectorTileLoader::process");
+    auto start = std::chrono::steady_clock::now();
+    VectorTileData result;
+    result.tile = request.tile;
+    result.priority = request.priority;
+    result.requestTime = request.requestTime;
+    if (request.token && request.token->isCancelled())
+    {
+        result.cancelled = true;
+        result.decodedTime = start;
+        cancelled.fetch_add(1, std::memory_order_relaxed);
+        while (!results.push(std::move(result)))
+        {
+            std::this_thread::yield();
+        }
+        return;
+    }
+    
+    // 优先零拷贝读取，否则读入每个线程复用的缓冲
+    thread_local std::vector<uint8_t> buffer;
+    const uint8_t* encoded = nullptr;
+    size_t encodedSize = 0;
+    if (!source->view(request.tile, encoded, encodedSize) && source->read(request.tile, buffer))
+    {
+        encoded = buffer.data();
+        encodedSize = buffer.size();
+    }
+    uint64_t added = 0;
+    result.failed = !encoded || !decode(encoded, encodedSize, style, request.tile.z, result.mesh, &added);
+    
+    result.decodedTime = std::chrono::steady_clock::now();
+    atomicAdd(decodeSeconds, secondsBetween(start, result.decodedTime));
+    if (result.failed)
+    {
+        failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        decoded.fetch_add(1, std::memory_order_relaxed);
+        encodedBytes.fetch_add(encodedSize, std::memory_order_relaxed);
+        meshBytes.fetch_add(result.sizeInBytes(), std::memory_order_relaxed);
+        vertices.fetch_add(result.mesh.vertices.size(), std::memory_order_relaxed);
+        triangles.fetch_add(result.mesh.indices.size() / 3, std::memory_order_relaxed);
+        subdividedVertices.fetch_add(added, std::memory_order_relaxed);
+    }
+    // 在途数量不超过队列容量，这里只会在消费者尚未释放槽位时短暂重试
+    while (!results.push(std::move(result)))
+    {
+        std::this_thread::yield();
+    }
+}
+
+void VectorTileLoader::atomicAdd(std::atomic<double>& target, double value)
+{
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+    {
+    }
+}
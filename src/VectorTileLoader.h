@@ -0,0 +1,136 @@
+#pragma once
+#include "CancellationToken.h"
+#include "JobSystem.h"
+#include "LockFreeQueue.h"
+#include "RasterTileLoader.h"
+#include "TileID.h"
+#include "TileSource.h"
+#include "VectorTessellator.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * 三角化完成的矢量瓦片
+ */
+struct VectorTileData
+{
+    TileID tile;
+    TilePriority priority = TilePriority::Visible;
+    VectorTileMesh mesh;
+    bool failed = false;            // 数据源没有该瓦片或数据损坏
+    bool cancelled = false;         // 开始解码前已被取消，没有网格
+    
+    std::chrono::steady_clock::time_point requestTime;
+    std::chrono::steady_clock::time_point decodedTime;
+    
+    size_t sizeInBytes() const { return mesh.sizeInBytes(); }
+};
+
+/**
+ * 异步矢量瓦片加载器（不依赖 GL），与 RasterTileLoader 的流程相同：
+ *
+ * - request 把每个请求作为一个 JobSystem 任务提交（可见瓦片为 Normal 优先级，预取为 Low）
+ * - 任务中 TileSource 读字节，gzip 压缩的先解压，再由 VectorTessellator 解码、三角化（包括球面细分）
+ * - 中间缓冲区按线程复用，结果网格按实际大小复制一份交给渲染线程
+ * - 结果进入无锁队列，渲染线程每帧用 poll 取出并在自己的预算内上传
+ */
+class VectorTileLoader
+{
+public:
+    struct Options
+    {
+        JobSystem* jobSystem = nullptr; // nullptr 表示使用 JobSystem::shared()
+        size_t queueCapacity = 1024;    // 在途请求上限，也是结果队列的容量
+    };
+    
+    /**
+     * 累计统计（线程安全地读取一份快照）
+     */
+    struct Stats
+    {
+        uint64_t requested = 0;
+        uint64_t rejected = 0;          // 在途请求已达上限
+        uint64_t decoded = 0;
+        uint64_t failed = 0;
+        uint64_t delivered = 0;         // 已被 poll 取走
+        uint64_t cancelled = 0;         // 解码前被取消
+        uint64_t encodedBytes = 0;
+        uint64_t meshBytes = 0;
+        uint64_t vertices = 0;
+        uint64_t triangles = 0;
+        uint64_t subdividedVertices = 0; // 球面细分新增的顶点（包含在 vertices 中）
+        double decodeSeconds = 0.0;     // 所有解码线程的读取 + 解压 + 三角化耗时之和
+        double elapsedSeconds = 0.0;    // 加载器创建至今
+        
+        double tilesPerSecond() const { return elapsedSeconds > 0.0 ? decoded / elapsedSeconds : 0.0; }
+        // 细分后与细分前的顶点数之比
+        double vertexInflation() const { return vertices > subdividedVertices ? static_cast<double>(vertices) / (vertices - subdividedVertices) : 1.0; }
+    };
+    
+    VectorTileLoader(std::shared_ptr<const TileSource> source, const VectorStyle& style, const Options& options);
+    VectorTileLoader(std::shared_ptr<const TileSource> source, const VectorStyle& style);
+    ~VectorTileLoader();
+    
+    VectorTileLoader(const VectorTileLoader&) = delete;
+    VectorTileLoader& operator=(const VectorTileLoader&) = delete;
+    
+    /**
+     * 请求三角化一个瓦片；在途请求已达上限时返回 false（调用方下一帧重试）
+     */
+    bool request(const TileID& tile, TilePriority priority = TilePriority::Visible,
+                 std::shared_ptr<const CancellationToken> token = nullptr);
+    
+    /**
+     * 取出一个结果（包括失败的）；没有结果时返回 false
+     */
+    bool poll(VectorTileData& out);
+    
+    size_t getInFlightCount() const { return inFlight.load(std::memory_order_relaxed); }
+    bool hasResults() const { return !results.emptyApprox(); }
+    const TileSource& getSource() const { return *source; }
+    const VectorStyle& getStyle() const { return style; }
+    
+    Stats getStats() const;
+    
+    /**
+     * 同步解码一段 MVT 字节（可以是 gzip 压缩的）并三角化，结果按实际大小写入 out；
+     * zoom 为瓦片层级（决定球面细分），subdividedVertices 非空时写入细分新增的顶点数。
+     * 使用调用线程的复用缓冲区（解码线程和基准共用）
+     */
+    static bool decode(const uint8_t* bytes, size_t size, const VectorStyle& style, int zoom, VectorTileMesh& out,
+                       uint64_t* subdividedVertices = nullptr);
+    
+    /**
+     * 解压 gzip 数据（RFC 1952，只支持 deflate），不是 gzip 或数据损坏时返回 false
+     */
+    static bool gunzip(const uint8_t* bytes, size_t size, std::vector<uint8_t>& out);
+    
+private:
+    struct Request
+    {
+        TileID tile;
+        TilePriority priority = TilePriority::Visible;
+        std::shared_ptr<const CancellationToken> token;
+        std::chrono::steady_clock::time_point requestTime;
+    };
+    
+    void process(const Request& request);
+    static void atomicAdd(std::atomic<double>& target, double value);
+    
+    std::shared_ptr<const TileSource> source;
+    const VectorStyle style;
+    JobSystem& jobs;
+    LockFreeQueue<VectorTileData> results;
+    std::atomic<bool> stopping;
+    std::atomic<size_t> inFlight;
+    std::atomic<size_t> pendingJobs;     // 已提交、尚未结束的任务（析构时等待归零）
+    
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<uint64_t> requested, rejected, decoded, failed, delivered, cancelled;
+    std::atomic<uint64_t> encodedBytes, meshBytes, vertices, triangles, subdividedVertices;
+    std::atomic<double> decodeSeconds;
+};
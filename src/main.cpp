@@ -11,9 +11,15 @@
  */
 
 #include "Application.h"
-int main()
+/**
+ * 用法：GlobeMercatorBlendDemo [栅格瓦片目录或归档文件] [矢量瓦片目录、归档文件或 .geojson 文件]
+ * 目录按 z/x/y.png 或 z/x/y.jpg（矢量瓦片为 z/x/y.pbf / .mvt）组织，归档由 TileArchiveTool pack 生成，
+ * GeoJSON 在运行时按需切片；
+ * 不指定栅格瓦片时 tile 使用棋盘格填充色（第一个参数为空字符串时只显示矢量瓦片）
+ */
+int main(int argc, char** argv)
 {
-    Application app;
+    Application app(argc > 1 ? argv[1] : "", argc > 2 ? argv[2] : "");
     app.run();
     return 0;
 }
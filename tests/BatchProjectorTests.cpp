@@ -0,0 +1,195 @@
+#include "TestHarness.h"
+
+#include "BatchProjector.h"
+#include "GlobeProjection.h"
+#include "ProjectionState.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr int kViewportWidth = 1920;
+constexpr int kViewportHeight = 1080;
+// 相对 max(1, |w|) 的误差：批量路径由经纬度直接计算单位球坐标，shader 经由墨卡托 atan(exp) 往返
+constexpr double kRelativeTolerance = 1e-5;
+
+struct Points
+{
+    std::vector<float> lon;
+    std::vector<float> lat;
+};
+
+// 固定种子的随机点，加上日界线两侧和高纬的点
+Points testPoints()
+{
+    Points points;
+    std::mt19937 random(20240611u);
+    std::uniform_real_distribution<float> anyLon(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> anyLat(-85.0f, 85.0f);
+    for (int i = 0; i < 20000; i++)
+    {
+        points.lon.push_back(anyLon(random));
+        points.lat.push_back(anyLat(random));
+    }
+    for (int i = 0; i <= 400; i++)
+    {
+        float offset = i * 0.05f;
+        for (float lat : { -60.0f, -5.0f, 0.0f, 30.0f, 84.9f })
+        {
+            points.lon.push_back(180.0f - offset);
+            points.lat.push_back(lat);
+            points.lon.push_back(-180.0f + offset);
+            points.lat.push_back(lat);
+        }
+    }
+    // 数量不是向量宽度的整数倍，覆盖标量尾部
+    points.lon.push_back(179.99f);
+    points.lat.push_back(1.0f);
+    return points;
+}
+
+struct Camera
+{
+    float transition;
+    float centerLon;
+    float centerLat;
+    float zoom;
+};
+
+// 平面、过渡（Z 延迟混合前后）和 Globe；中心靠近日界线，离 center 最近的 wrap 在日界线两侧不同
+const Camera kCameras[] = { { 0.0f, 170.0f, 10.0f, 2.0f }, { 0.0f, -178.0f, -20.0f, 0.5f }, { 0.5f, -175.0f, 15.0f, 1.5f },
+                            { 0.9f, 178.0f, 40.0f, 1.0f }, { 1.0f, 179.0f, 0.0f, 1.0f }, { 1.0f, -150.0f, 60.0f, 2.5f } };
+
+std::vector<BatchProjector::SimdPath> supportedPaths()
+{
+    std::vector<BatchProjector::SimdPath> paths;
+    for (BatchProjector::SimdPath path : { BatchProjector::SimdPath::Scalar, BatchProjector::SimdPath::Sse2, BatchProjector::SimdPath::Avx2 })
+    {
+        if (path <= BatchProjector::detectSimdPath())
+        {
+            paths.push_back(path);
+        }
+    }
+    return paths;
+}
+} // namespace
+
+TEST_CASE(batchMatchesShaderReference, "BatchProjector/every SIMD path matches projectToClip masks and positions")
+{
+    const Points points = testPoints();
+    const size_t count = points.lon.size();
+    std::vector<float> x(count), y(count), z(count), w(count);
+    std::vector<uint8_t> visible(count);
+    BatchProjector::ClipOutput out;
+    out.x = x.data();
+    out.y = y.data();
+    out.z = z.data();
+    out.w = w.data();
+    out.visible = visible.data();
+    
+    for (const Camera& camera : kCameras)
+    {
+        auto state = Test::makeState(camera.transition, camera.centerLon, camera.centerLat, camera.zoom,
+                                     static_cast<float>(kViewportWidth) / kViewportHeight);
+        BatchProjector projector(state, kViewportWidth, kViewportHeight);
+        for (BatchProjector::SimdPath path : supportedPaths())
+        {
+            projector.setSimdPath(path);
+            REQUIRE(projector.getSimdPath() == path);
+            projector.projectToClip(points.lon.data(), points.lat.data(), count, out);
+            
+            size_t visibleCount = 0, maskMismatches = 0;
+            double maxError = 0.0;
+            for (size_t i = 0; i < count; i++)
+            {
+                glm::vec2 mercator(state->nearestWrapMercX(points.lon[i] / 360.0f + 0.5f), GlobeProjection::mercatorYFromLat(points.lat[i]));
+                glm::vec4 reference = state->projectToClip(mercator);
+                double scale = std::max(1.0f, std::abs(reference.w));
+                maxError = std::max({ maxError, std::abs(x[i] - reference.x) / scale, std::abs(y[i] - reference.y) / scale,
+                                      std::abs(z[i] - reference.z) / scale, std::abs(w[i] - reference.w) / scale });
+                bool expected = ProjectionState::isInsideClipVolume(reference);
+                maskMismatches += expected != (visible[i] != 0) ? 1 : 0;
+                visibleCount += expected ? 1 : 0;
+            }
+            CHECK(visibleCount > 0);
+            CHECK(maskMismatches == 0);
+            CHECK_NEAR(maxError, 0.0, kRelativeTolerance);
+        }
+    }
+}
+
+TEST_CASE(batchPathsAgree, "BatchProjector/SIMD paths agree with the scalar path and with projectToScreen")
+{
+    const Points points = testPoints();
+    const size_t count = points.lon.size();
+    for (const Camera& camera : kCameras)
+    {
+        auto state = Test::makeState(camera.transition, camera.centerLon, camera.centerLat, camera.zoom,
+                                     static_cast<float>(kViewportWidth) / kViewportHeight);
+        BatchProjector projector(state, kViewportWidth, kViewportHeight);
+        
+        projector.setSimdPath(BatchProjector::SimdPath::Scalar);
+        std::vector<float> x(count), y(count), z(count), w(count);
+        std::vector<uint8_t> visible(count);
+        BatchProjector::ClipOutput scalar;
+        scalar.x = x.data();
+        scalar.y = y.data();
+        scalar.z = z.data();
+        scalar.w = w.data();
+        scalar.visible = visible.data();
+        projector.projectToClip(points.lon.data(), points.lat.data(), count, scalar);
+        
+        for (BatchProjector::SimdPath path : supportedPaths())
+        {
+            projector.setSimdPath(path);
+            
+            // 多线程分段与单线程结果相同
+            std::vector<float> sx(count), sy(count), depth(count);
+            std::vector<uint8_t> screenVisible(count);
+            BatchProjector::ScreenOutput screen;
+            screen.x = sx.data();
+            screen.y = sy.data();
+            screen.depth = depth.data();
+            screen.visible = screenVisible.data();
+            projector.projectToScreen(points.lon.data(), points.lat.data(), count, screen, 4);
+            
+            CHECK(screenVisible == visible);
+            double maxError = 0.0;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!visible[i])
+                {
+                    continue;
+                }
+                float expectedX = (x[i] / w[i] * 0.5f + 0.5f) * kViewportWidth;
+                float expectedY = (0.5f - y[i] / w[i] * 0.5f) * kViewportHeight;
+                maxError = std::max({ maxError, static_cast<double>(std::abs(sx[i] - expectedX)),
+                                      static_cast<double>(std::abs(sy[i] - expectedY)),
+                                      static_cast<double>(std::abs(depth[i] - z[i] / w[i])) * kViewportHeight });
+            }
+            // 像素
+            CHECK_NEAR(maxError, 0.0, 1e-2);
+        }
+    }
+}
+
+TEST_CASE(batchPathSelection, "BatchProjector/setSimdPath clamps to the detected path")
+{
+    auto state = Test::makeState(0.5f, 0.0f, 0.0f, 2.0f);
+    BatchProjector projector(state, kViewportWidth, kViewportHeight);
+    CHECK(projector.getSimdPath() == BatchProjector::detectSimdPath());
+    projector.setSimdPath(BatchProjector::SimdPath::Avx2);
+    CHECK(projector.getSimdPath() == std::min(BatchProjector::SimdPath::Avx2, BatchProjector::detectSimdPath()));
+    projector.setSimdPath(BatchProjector::SimdPath::Scalar);
+    CHECK(projector.getSimdPath() == BatchProjector::SimdPath::Scalar);
+    for (BatchProjector::SimdPath path : supportedPaths())
+    {
+        CHECK(BatchProjector::simdPathName(path) != nullptr);
+    }
+}
@@ -0,0 +1,103 @@
+#include "TestHarness.h"
+
+#include "CameraPath.h"
+#include "FrameBuilder.h"
+#include "GlobeProjection.h"
+#include "JobSystem.h"
+#include "TileMesh.h"
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr float kAspect = 16.0f / 9.0f;
+constexpr double kFrameStep = 1.0 / 10.0;   // 按 10Hz 采样内置路径，覆盖几何缓存的命中与淘汰
+
+bool sameInstances(const TileInstanceBuffer& a, const TileInstanceBuffer& b)
+{
+    if (a.size() != b.size() || std::memcmp(a.data(), b.data(), a.sizeInBytes()) != 0)
+    {
+        return false;
+    }
+    for (int lod = 0; lod < TileMesh::kLodCount; lod++)
+    {
+        if (a.getLodRange(lod).first != b.getLodRange(lod).first || a.getLodRange(lod).count != b.getLodRange(lod).count)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void checkSamePacket(const FramePacket& serial, const FramePacket& pipelined)
+{
+    CHECK(serial.frameIndex == pipelined.frameIndex);
+    CHECK(serial.projection.transition == pipelined.projection.transition);
+    CHECK(serial.projection.centerLon == pipelined.projection.centerLon);
+    CHECK(serial.projection.centerLat == pipelined.projection.centerLat);
+    CHECK(serial.projection.zoom == pipelined.projection.zoom);
+    CHECK(serial.aspect == pipelined.aspect);
+    REQUIRE(serial.state && pipelined.state);
+    CHECK(serial.state->getProjectionMatrix() == pipelined.state->getProjectionMatrix());
+    CHECK(serial.state->getGlobeMatrix() == pipelined.state->getGlobeMatrix());
+    CHECK(serial.state->getClippingPlane() == pipelined.state->getClippingPlane());
+    CHECK(serial.tiles == pipelined.tiles);
+    CHECK(sameInstances(serial.instances, pipelined.instances));
+    CHECK(serial.cullStats.tested == pipelined.cullStats.tested);
+    CHECK(serial.cullStats.kept == pipelined.cullStats.kept);
+    CHECK(serial.cullStats.culledFrustum == pipelined.cullStats.culledFrustum);
+    CHECK(serial.cullStats.culledHorizon == pipelined.cullStats.culledHorizon);
+    CHECK(serial.geometrySlots == pipelined.geometrySlots);
+    CHECK(serial.geometryPositions == pipelined.geometryPositions);
+}
+} // namespace
+
+TEST_CASE(pipelinedPacketsMatchSerial, "FrameBuilder/pipelined build produces the same packets as serial build")
+{
+    TileMesh mesh;
+    for (const std::string& name : CameraPath::builtinNames())
+    {
+        CameraPath path;
+        REQUIRE(CameraPath::builtin(name, path));
+        const size_t frameCount = static_cast<size_t>(path.getDuration() / kFrameStep) + 1;
+        
+        // 串行：在当前线程逐帧构建
+        FrameBuilder serialBuilder(mesh);
+        std::vector<std::shared_ptr<const FramePacket>> serial;
+        GlobeProjection camera;
+        for (size_t frame = 0; frame < frameCount; frame++)
+        {
+            path.sample(frame * kFrameStep, camera);
+            serial.push_back(serialBuilder.build(camera, kAspect));
+        }
+        
+        // 流水线：与 TileRenderer::renderPipelined 相同，第一帧同步构建，之后每帧在工作线程上构建下一帧，
+        // 当前线程在构建期间检查上一帧并修改自己的相机
+        FrameBuilder pipelinedBuilder(mesh);
+        std::shared_ptr<const FramePacket> next;
+        JobSystem::JobHandle job;
+        path.sample(0.0, camera);
+        std::shared_ptr<const FramePacket> current = pipelinedBuilder.build(camera, kAspect);
+        for (size_t frame = 0; frame < frameCount; frame++)
+        {
+            if (frame + 1 < frameCount)
+            {
+                path.sample((frame + 1) * kFrameStep, camera);
+                job = JobSystem::shared().schedule([&pipelinedBuilder, &next, camera]() {
+                    next = pipelinedBuilder.build(camera, kAspect);
+                }, JobSystem::Priority::High);
+                camera.zoom += 1.0f;
+            }
+            REQUIRE(current);
+            checkSamePacket(*serial[frame], *current);
+            if (job)
+            {
+                JobSystem::shared().wait(job);
+                job.reset();
+                current = std::move(next);
+            }
+        }
+    }
+}
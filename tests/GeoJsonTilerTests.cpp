@@ -0,0 +1,357 @@
+#include "TestHarness.h"
+
+#include "Constants.h"
+#include "GeoJsonReader.h"
+#include "GeoJsonTiler.h"
+#include <sstream>
+
+namespace
+{
+constexpr double kPi = 3.14159265358979323846;
+
+double mercatorY(double lat)
+{
+    return 0.5 - std::log(std::tan(kPi / 4.0 + lat * kPi / 360.0)) / (2.0 * kPi);
+}
+
+double latFromMercatorY(double y)
+{
+    return std::atan(std::sinh(kPi * (1.0 - 2.0 * y))) * 180.0 / kPi;
+}
+
+/**
+ * 文档由 before + 空白填充 + token + after 组成，token 从 offset 开始（用来让 token 跨越读取块的边界）
+ */
+std::string padTo(const std::string& before, size_t offset, const std::string& rest)
+{
+    std::string text = before;
+    text.append(offset - before.size(), ' ');
+    return text + rest;
+}
+
+struct ReadResult
+{
+    bool ok = false;
+    std::string error;
+    std::vector<GeoJsonGeometry> geometries;
+    uint64_t invalid = 0;
+    uint64_t bytesRead = 0;
+};
+
+ReadResult readAll(const std::string& text)
+{
+    std::istringstream stream(text);
+    GeoJsonReader reader(stream);
+    ReadResult result;
+    result.ok = reader.read([&result](const GeoJsonGeometry& geometry) { result.geometries.push_back(geometry); }, &result.error);
+    result.invalid = reader.getInvalidCount();
+    result.bytesRead = reader.getBytesRead();
+    return result;
+}
+
+double ringArea(const std::vector<glm::ivec2>& points, size_t begin, size_t end)
+{
+    double sum = 0.0;
+    for (size_t i = begin, j = end - 1; i < end; j = i++)
+    {
+        sum += static_cast<double>(points[j].x) * points[i].y - static_cast<double>(points[i].x) * points[j].y;
+    }
+    return sum * 0.5;
+}
+
+/**
+ * 瓦片中所有多边形的带符号面积之和（外环为正、洞为负），单位为 TILE_EXTENT 的平方
+ */
+double polygonArea(const GeoJsonTile& tile)
+{
+    double area = 0.0;
+    for (const GeoJsonTile::Feature& feature : tile.features)
+    {
+        uint32_t begin = 0;
+        for (uint32_t end : feature.partEnds)
+        {
+            area += ringArea(feature.points, begin, end);
+            begin = end;
+        }
+    }
+    return area;
+}
+
+/**
+ * 经纬度矩形在 z 层级 TILE_EXTENT 坐标下的面积
+ */
+double rectangleArea(double west, double south, double east, double north, int z)
+{
+    const double scale = std::exp2(z) * Constants::TILE_EXTENT;
+    return (east - west) / 360.0 * scale * (mercatorY(south) - mercatorY(north)) * scale;
+}
+
+// 外环 ±30°，洞 ±5°
+const char* kSquareWithHole = R"({"type":"Polygon","coordinates":[
+    [[-30,-30],[30,-30],[30,30],[-30,30],[-30,-30]],
+    [[-5,-5],[-5,5],[5,5],[5,-5],[-5,-5]]]})";
+
+GeoJsonTiler::Options clipOptions(double buffer)
+{
+    GeoJsonTiler::Options options;
+    options.maxZoom = 8;
+    options.indexMaxZoom = 0;     // 全部在 getTile 时裁剪
+    options.buffer = buffer;
+    return options;
+}
+
+std::shared_ptr<const GeoJsonTile> loadAndGet(GeoJsonTiler& tiler, const std::string& text, const TileID& tile)
+{
+    std::istringstream stream(text);
+    std::string error;
+    if (!tiler.load(stream, &error))
+    {
+        return nullptr;
+    }
+    return tiler.getTile(tile);
+}
+} // namespace
+
+TEST_CASE(geoJsonChunkBoundary, "GeoJsonTiler/reader tokens split across the chunk boundary")
+{
+    const size_t boundary = GeoJsonReader::kChunkSize;
+    const std::string head = R"({"type":"Feature","properties":{"name":)";
+    
+    // 数字跨越边界：读取块的最后 3 个字节是 "12."
+    std::string number = padTo(R"({"type":"Point","coordinates":[)", boundary - 3, "12.345678,-45.5e0]}");
+    ReadResult result = readAll(number);
+    REQUIRE(result.ok);
+    REQUIRE(result.geometries.size() == 1);
+    CHECK(result.geometries[0].type == VectorTile::GeometryType::Point);
+    CHECK(result.geometries[0].points[0] == glm::dvec2(12.345678, -45.5));
+    CHECK(result.bytesRead == number.size());
+    
+    // 键、类型名、被跳过的属性字符串（含转义）跨越边界
+    for (size_t split : { size_t(1), size_t(4), size_t(7) })
+    {
+        std::string key = padTo(R"({"type":"Point",)", boundary - split, R"("coordinates":[1,2]})");
+        result = readAll(key);
+        CHECK(result.ok && result.geometries.size() == 1);
+        
+        std::string typeName = padTo(R"({"coordinates":[[0,0],[1,1]],"type":)", boundary - split, R"("LineString"})");
+        result = readAll(typeName);
+        CHECK(result.ok && result.geometries.size() == 1 && result.geometries[0].type == VectorTile::GeometryType::LineString);
+        
+        std::string property = padTo(head, boundary - split, R"("a\"béc]}"},"geometry":{"type":"Point","coordinates":[3,4]}})");
+        result = readAll(property);
+        CHECK(result.ok && result.geometries.size() == 1 && result.geometries[0].points[0] == glm::dvec2(3.0, 4.0));
+    }
+    
+    // 截断在边界处的文档仍然报告错误
+    std::string truncated = padTo(R"({"type":"Point","coordinates":[)", boundary - 3, "12.3");
+    result = readAll(truncated);
+    CHECK(!result.ok);
+    CHECK(!result.error.empty());
+}
+
+TEST_CASE(geoJsonKeyOrder, "GeoJsonTiler/reader accepts keys in any order and expands multi geometries")
+{
+    // coordinates 在 type 之前、geometry 在 type 之前、properties 在最后
+    ReadResult result = readAll(R"({"features":[
+        {"geometry":{"coordinates":[[[0,0],[1,0],[1,1],[0,0]]],"bbox":[0,0,1,1],"type":"Polygon"},"type":"Feature","id":7},
+        {"properties":{"nested":{"a":[1,{"b":"}"}]}},"type":"Feature","geometry":{"type":"MultiPoint","coordinates":[[5,6,100],[7,8]]}},
+        {"type":"Feature","geometry":{"type":"GeometryCollection","geometries":[
+            {"coordinates":[[[[0,0],[2,0],[2,2],[0,0]],[[0.5,0.5],[1,0.5],[1,1],[0.5,0.5]]],[[[5,5],[6,5],[6,6],[5,5]]]],"type":"MultiPolygon"},
+            {"type":"LineString","coordinates":[[0,0],[1,1]]}]}},
+        {"type":"Feature","geometry":{"type":"Point","coordinates":[[1,2],[3,4]]}}
+    ],"type":"FeatureCollection"})");
+    REQUIRE(result.ok);
+    REQUIRE(result.geometries.size() == 4);
+    
+    const GeoJsonGeometry& polygon = result.geometries[0];
+    CHECK(polygon.type == VectorTile::GeometryType::Polygon);
+    CHECK(polygon.parts.size() == 1 && polygon.parts[0].outer && polygon.parts[0].end == 4);
+    
+    // 多点的每个点一部分，第三维忽略
+    const GeoJsonGeometry& points = result.geometries[1];
+    CHECK(points.type == VectorTile::GeometryType::Point);
+    CHECK(points.parts.size() == 2);
+    CHECK(points.points[0] == glm::dvec2(5.0, 6.0));
+    
+    // 多多边形：每个多边形的第一个环为外环
+    const GeoJsonGeometry& multiPolygon = result.geometries[2];
+    CHECK(multiPolygon.type == VectorTile::GeometryType::Polygon);
+    REQUIRE(multiPolygon.parts.size() == 3);
+    CHECK(multiPolygon.parts[0].outer);
+    CHECK(!multiPolygon.parts[1].outer);
+    CHECK(multiPolygon.parts[2].outer);
+    CHECK(result.geometries[3].type == VectorTile::GeometryType::LineString);
+    
+    // 类型与嵌套深度不符的几何跳过并计数
+    CHECK(result.invalid == 1);
+    
+    // 语法错误
+    CHECK(!readAll(R"({"type":"Point","coordinates":[1,2]} x)").ok);
+    CHECK(!readAll(R"({"type":"Point","coordinates":[1,2)").ok);
+    CHECK(!readAll(R"([1,2])").ok);
+}
+
+TEST_CASE(geoJsonClipArea, "GeoJsonTiler/clipped polygons keep the area of the source inside each tile")
+{
+    GeoJsonTiler tiler(clipOptions(0.0));
+    std::shared_ptr<const GeoJsonTile> world = loadAndGet(tiler, kSquareWithHole, Test::makeTile(0, 0, 0));
+    REQUIRE(world);
+    const double expected = rectangleArea(-30, -30, 30, 30, 0) - rectangleArea(-5, -5, 5, 5, 0);
+    // 取整到整数坐标的误差不超过周长的量级
+    CHECK_NEAR(polygonArea(*world), expected, expected * 2e-3);
+    
+    // z1 的四个瓦片各分到四分之一（层级加一，面积单位缩小为四分之一）
+    double total = 0.0;
+    for (int x = 0; x < 2; x++)
+    {
+        for (int y = 0; y < 2; y++)
+        {
+            std::shared_ptr<const GeoJsonTile> quarter = tiler.getTile(Test::makeTile(1, x, y));
+            REQUIRE(quarter);
+            double area = polygonArea(*quarter);
+            CHECK_NEAR(area, expected, expected * 2e-3);
+            total += area;
+            // 外环为正（MVT 约定），洞为负
+            for (const GeoJsonTile::Feature& feature : quarter->features)
+            {
+                CHECK(feature.type == VectorTile::GeometryType::Polygon);
+                CHECK(ringArea(feature.points, 0, feature.partEnds[0]) > 0.0);
+                if (feature.partEnds.size() > 1)
+                {
+                    CHECK(ringArea(feature.points, feature.partEnds[0], feature.partEnds[1]) < 0.0);
+                }
+            }
+            // 裁剪后的坐标不超出瓦片（缓冲区为 0）
+            for (const GeoJsonTile::Feature& feature : quarter->features)
+            {
+                for (const glm::ivec2& point : feature.points)
+                {
+                    CHECK(point.x >= 0 && point.x <= Constants::TILE_EXTENT && point.y >= 0 && point.y <= Constants::TILE_EXTENT);
+                }
+            }
+        }
+    }
+    CHECK_NEAR(total, 4.0 * expected, expected * 8e-3);
+    
+    std::shared_ptr<const GeoJsonTile> inside = tiler.getTile(Test::makeTile(4, 7, 7));
+    REQUIRE(inside);
+    CHECK(inside->features.size() == 1);
+    const double full = static_cast<double>(Constants::TILE_EXTENT) * Constants::TILE_EXTENT;
+    // z4 (7, 7) 是经度 -22.5..0、纬度 0..21.9 的瓦片：整个在外环内，只与洞（±5°）的一角相交
+    CHECK_NEAR(polygonArea(*inside), full - rectangleArea(-5, 0, 0, 5, 4), full * 1e-3);
+    
+    // 多边形外的瓦片没有要素
+    std::shared_ptr<const GeoJsonTile> outside = tiler.getTile(Test::makeTile(4, 0, 0));
+    REQUIRE(outside);
+    CHECK(outside->features.empty());
+    CHECK(!tiler.getTile(Test::makeTile(9, 0, 0)));
+    CHECK(!tiler.getTile(Test::makeTile(2, 4, 0)));
+    
+    // 缓冲区让要素伸出瓦片四周各 buffer：z5 (14, 14) 完全在外环内、洞外
+    GeoJsonTiler buffered(clipOptions(64.0));
+    std::shared_ptr<const GeoJsonTile> interior = loadAndGet(buffered, kSquareWithHole, Test::makeTile(5, 14, 14));
+    REQUIRE(interior);
+    const double side = Constants::TILE_EXTENT + 128.0;
+    CHECK_NEAR(polygonArea(*interior), side * side, 1.0);
+}
+
+TEST_CASE(geoJsonSimplification, "GeoJsonTiler/simplification tolerance shrinks with the zoom level")
+{
+    // 经度 1..10、纬度 10 附近的折线，相邻点交替上下偏移 amplitude：每个内部点到两侧点连线的距离为
+    // 2 * amplitude，在 z2 上为 3 个 tile 单位（低于容差 6），z4 上为 12；z0..z5 整条线都在同一个瓦片内
+    const int kPoints = 41;
+    const double centerY = mercatorY(10.0);
+    const double amplitude = 1.5 / (Constants::TILE_EXTENT * 4.0);
+    std::ostringstream text;
+    text.precision(17);
+    text << R"({"type":"LineString","coordinates":[)";
+    for (int i = 0; i < kPoints; i++)
+    {
+        double lon = 1.0 + 9.0 * i / (kPoints - 1);
+        double y = centerY + (i % 2 == 0 ? amplitude : -amplitude);
+        text << (i > 0 ? "," : "") << "[" << lon << "," << latFromMercatorY(y) << "]";
+    }
+    text << "]}";
+    
+    GeoJsonTiler::Options options;
+    options.maxZoom = 8;
+    options.indexMaxZoom = 0;
+    GeoJsonTiler tiler(options);
+    std::istringstream stream(text.str());
+    REQUIRE(tiler.load(stream));
+    
+    // 每层取包含整条线的瓦片
+    auto pointsAt = [&tiler, centerY](int z) -> size_t {
+        const double scale = std::exp2(z);
+        TileID tile = Test::makeTile(z, static_cast<int>(0.5 * scale), static_cast<int>(centerY * scale));
+        std::shared_ptr<const GeoJsonTile> result = tiler.getTile(tile);
+        if (!result || result->features.size() != 1)
+        {
+            return 0;
+        }
+        return result->features[0].points.size();
+    };
+    // z2 及以下起伏低于容差，只剩端点；z4 起全部保留
+    CHECK(pointsAt(0) == 2);
+    CHECK(pointsAt(2) == 2);
+    CHECK(pointsAt(4) == kPoints);
+    CHECK(pointsAt(5) == kPoints);
+    
+    // 容差加倍后 z4 也只剩端点
+    options.tolerance = 12.5;
+    GeoJsonTiler coarse(options);
+    std::istringstream again(text.str());
+    REQUIRE(coarse.load(again));
+    std::shared_ptr<const GeoJsonTile> tile = coarse.getTile(Test::makeTile(4, 8, static_cast<int>(centerY * 16.0)));
+    REQUIRE(tile);
+    REQUIRE(tile->features.size() == 1);
+    CHECK(tile->features[0].points.size() == 2);
+}
+
+TEST_CASE(geoJsonLruBounds, "GeoJsonTiler/LRU keeps on-demand tiles within the byte budget")
+{
+    GeoJsonTiler::Options options = clipOptions(16.0);
+    options.cacheBytes = 16 * 1024;
+    GeoJsonTiler tiler(options);
+    std::istringstream stream(kSquareWithHole);
+    REQUIRE(tiler.load(stream));
+    
+    // z6 覆盖 ±30° 的 64 个瓦片
+    std::shared_ptr<const GeoJsonTile> last;
+    size_t tiles = 0;
+    for (int x = 26; x < 38; x++)
+    {
+        for (int y = 26; y < 38; y++)
+        {
+            last = tiler.getTile(Test::makeTile(6, x, y));
+            REQUIRE(last);
+            tiles++;
+            GeoJsonTiler::Stats stats = tiler.getStats();
+            // 只剩刚插入的一个时允许超出
+            CHECK(stats.cachedBytes <= options.cacheBytes || stats.cachedTiles == 1);
+        }
+    }
+    GeoJsonTiler::Stats stats = tiler.getStats();
+    CHECK(stats.requests == tiles);
+    CHECK(stats.evictions > 0);
+    CHECK(stats.cachedTiles < tiles);
+    
+    // 最近的瓦片仍然命中，返回同一份数据
+    CHECK(tiler.getTile(Test::makeTile(6, 37, 37)) == last);
+    CHECK(tiler.getStats().cacheHits == stats.cacheHits + 1);
+    
+    // 预算足够时不淘汰，第二轮全部命中
+    GeoJsonTiler::Options large = clipOptions(16.0);
+    GeoJsonTiler roomy(large);
+    std::istringstream again(kSquareWithHole);
+    REQUIRE(roomy.load(again));
+    for (int round = 0; round < 2; round++)
+    {
+        for (int x = 26; x < 38; x++)
+        {
+            roomy.getTile(Test::makeTile(6, x, 30));
+        }
+    }
+    CHECK(roomy.getStats().evictions == 0);
+    CHECK(roomy.getStats().cacheHits >= 12);
+}
@@ -0,0 +1,215 @@
+#include "TestHarness.h"
+
+#include "Constants.h"
+#include "GeodesicSubdivider.h"
+#include "VectorTessellator.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+// 网格线上的交点是 float 计算的，判断是否落在格子内时允许的误差（tile 坐标）
+constexpr float kCellTolerance = 1e-2f;
+
+float signedArea(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+{
+    return 0.5f * ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+}
+
+/**
+ * 三角形到解析球面的最大距离（像素），误差定义与 GeodesicSubdivider::gridDivisions 相同：
+ * 瓦片 (zoom, 0, tileY) 的顶点按 shader 的公式（这里用 double）投影到单位球，
+ * 在三角形内按重心坐标密集取点，按放大到下一层级时的球面半径换算
+ */
+double maxChordError(const std::vector<glm::vec2>& points, const std::vector<uint32_t>& indices, uint32_t baseIndex, int zoom, int tileY)
+{
+    const double pi = 3.14159265358979323846;
+    const double scale = std::exp2(static_cast<double>(zoom));
+    const double radius = 2.0 * VectorTessellator::kTilePixels * scale / (2.0 * pi);
+    auto toSphere = [&](const glm::vec2& point) {
+        double lon = point.x / static_cast<double>(Constants::TILE_EXTENT) / scale * pi * 2.0 + pi;
+        double lat = 2.0 * std::atan(std::exp(pi - (tileY + point.y / static_cast<double>(Constants::TILE_EXTENT)) / scale * pi * 2.0)) - pi * 0.5;
+        return glm::dvec3(std::sin(lon) * std::cos(lat), std::sin(lat), std::cos(lon) * std::cos(lat));
+    };
+    const int samples = 8;
+    double maxError = 0.0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const glm::dvec3 a = toSphere(points[indices[i] - baseIndex]);
+        const glm::dvec3 b = toSphere(points[indices[i + 1] - baseIndex]);
+        const glm::dvec3 c = toSphere(points[indices[i + 2] - baseIndex]);
+        for (int u = 0; u <= samples; u++)
+        {
+            for (int v = 0; u + v <= samples; v++)
+            {
+                glm::dvec3 point = (a * static_cast<double>(u) + b * static_cast<double>(v) + c * static_cast<double>(samples - u - v)) / static_cast<double>(samples);
+                maxError = std::max(maxError, 1.0 - glm::length(point));
+            }
+        }
+    }
+    return maxError * radius;
+}
+
+// 整个瓦片的正方形（两个三角形）和一个不规则多边形的扇形
+void testTriangles(std::vector<glm::vec2>& points, std::vector<uint32_t>& indices)
+{
+    const float extent = static_cast<float>(Constants::TILE_EXTENT);
+    points = { { 0.0f, 0.0f }, { extent, 0.0f }, { extent, extent }, { 0.0f, extent },
+               { 1000.5f, 700.25f }, { 7900.0f, 2100.0f }, { 6100.75f, 7300.0f }, { 1500.0f, 5000.5f } };
+    indices = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7 };
+}
+
+void checkTrianglesInCells(const std::vector<glm::vec2>& points, const std::vector<uint32_t>& indices, uint32_t baseIndex, int divisions)
+{
+    const float cellSize = static_cast<float>(Constants::TILE_EXTENT) / divisions;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        REQUIRE(indices[i] >= baseIndex && indices[i + 1] >= baseIndex && indices[i + 2] >= baseIndex);
+        const glm::vec2& a = points[indices[i] - baseIndex];
+        const glm::vec2& b = points[indices[i + 1] - baseIndex];
+        const glm::vec2& c = points[indices[i + 2] - baseIndex];
+        const glm::vec2 cell = glm::floor((a + b + c) / 3.0f / cellSize) * cellSize;
+        for (const glm::vec2& point : { a, b, c })
+        {
+            CHECK(point.x >= cell.x - kCellTolerance && point.x <= cell.x + cellSize + kCellTolerance);
+            CHECK(point.y >= cell.y - kCellTolerance && point.y <= cell.y + cellSize + kCellTolerance);
+        }
+    }
+}
+} // namespace
+
+TEST_CASE(subdividedChordErrorWithinTarget, "GeodesicSubdivider/chord error against the analytic sphere stays within the target")
+{
+    std::vector<glm::vec2> points, outPoints;
+    std::vector<uint32_t> indices, outIndices;
+    testTriangles(points, indices);
+    GeodesicSubdivider subdivider;
+    for (int zoom = 0; zoom <= 14; zoom++)
+    {
+        const int divisions = GeodesicSubdivider::gridDivisions(zoom, VectorTessellator::kTilePixels);
+        CHECK(divisions >= 1 && divisions <= GeodesicSubdivider::kMaxDivisions);
+        CHECK((divisions & (divisions - 1)) == 0);
+        
+        outIndices.clear();
+        subdivider.subdivideTriangles(points.data(), indices.data(), indices.size(), divisions, outPoints, outIndices, 0);
+        // 赤道以南的第一行张角最大，最北一行在高纬
+        const int scale = 1 << zoom;
+        for (int tileY : { scale / 2, 0 })
+        {
+            double original = maxChordError(points, indices, 0, zoom, tileY);
+            double subdivided = maxChordError(outPoints, outIndices, 0, zoom, tileY);
+            CHECK(subdivided <= GeodesicSubdivider::kMaxChordErrorPixels);
+            CHECK(subdivided <= original);
+            if (divisions > 1 && tileY == scale / 2)
+            {
+                // 需要细分的层级上原始网格确实超出目标
+                CHECK(original > GeodesicSubdivider::kMaxChordErrorPixels);
+            }
+        }
+    }
+}
+
+TEST_CASE(subdividedTrianglesPreserveCoverage, "GeodesicSubdivider/triangles are clipped to cells without changing coverage")
+{
+    std::vector<glm::vec2> points, outPoints;
+    std::vector<uint32_t> indices, outIndices;
+    testTriangles(points, indices);
+    GeodesicSubdivider subdivider;
+    for (int divisions : { 1, 2, 8, 64 })
+    {
+        // 追加到已有下标之后，下标从 baseIndex 开始
+        const uint32_t baseIndex = 100;
+        outIndices.assign({ 1, 2, 3 });
+        subdivider.subdivideTriangles(points.data(), indices.data(), indices.size(), divisions, outPoints, outIndices, baseIndex);
+        REQUIRE(outIndices.size() >= 3 && outIndices.size() % 3 == 0);
+        CHECK(outIndices[0] == 1 && outIndices[1] == 2 && outIndices[2] == 3);
+        outIndices.erase(outIndices.begin(), outIndices.begin() + 3);
+        for (uint32_t index : outIndices)
+        {
+            REQUIRE(index >= baseIndex && index - baseIndex < outPoints.size());
+        }
+        checkTrianglesInCells(outPoints, outIndices, baseIndex, divisions);
+        
+        // 面积守恒，所有三角形保持原来的绕序（输入都是同一绕序）
+        double inputArea = 0.0, outputArea = 0.0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            inputArea += signedArea(points[indices[i]], points[indices[i + 1]], points[indices[i + 2]]);
+        }
+        for (size_t i = 0; i < outIndices.size(); i += 3)
+        {
+            float area = signedArea(outPoints[outIndices[i] - baseIndex], outPoints[outIndices[i + 1] - baseIndex], outPoints[outIndices[i + 2] - baseIndex]);
+            CHECK(area * inputArea >= 0.0);
+            outputArea += area;
+        }
+        CHECK_NEAR(outputArea, inputArea, std::abs(inputArea) * 1e-5);
+        
+        // 共享边上的交点去重：输出中没有重复坐标
+        std::set<std::pair<float, float>> unique;
+        for (const glm::vec2& point : outPoints)
+        {
+            unique.insert({ point.x, point.y });
+        }
+        CHECK(unique.size() == outPoints.size());
+        if (divisions == 1)
+        {
+            CHECK(outPoints.size() == points.size());
+            CHECK(outIndices.size() == indices.size());
+        }
+    }
+}
+
+TEST_CASE(subdividedLinesSplitAtGridLines, "GeodesicSubdivider/lines gain a vertex at every grid crossing")
+{
+    const std::vector<glm::vec2> line = { { 100.0f, 100.0f }, { 8000.0f, 3000.5f }, { 4096.0f, 4096.0f }, { 4096.0f, 8100.0f }, { 300.0f, 7000.0f } };
+    GeodesicSubdivider subdivider;
+    std::vector<glm::vec2> out;
+    for (bool closed : { false, true })
+    {
+        for (int divisions : { 1, 4, 64 })
+        {
+            subdivider.subdivideLine(line.data(), line.size(), closed, divisions, out);
+            const float cellSize = static_cast<float>(Constants::TILE_EXTENT) / divisions;
+            
+            // 原有顶点按顺序保留，新顶点在对应线段上，首尾不重复
+            size_t next = 0;
+            for (size_t i = 0; i < out.size(); i++)
+            {
+                if (next < line.size() && out[i] == line[next])
+                {
+                    next++;
+                    continue;
+                }
+                REQUIRE(next > 0);
+                const glm::vec2& a = line[next - 1];
+                const glm::vec2& b = line[next % line.size()];
+                CHECK_NEAR(signedArea(a, b, out[i]) / glm::length(b - a), 0.0f, kCellTolerance);
+            }
+            CHECK(next == line.size());
+            CHECK(closed || out.back() == line.back());
+            
+            // 每一段都在一个格子内
+            const size_t segments = closed ? out.size() : out.size() - 1;
+            for (size_t i = 0; i < segments; i++)
+            {
+                const glm::vec2& a = out[i];
+                const glm::vec2& b = out[(i + 1) % out.size()];
+                const glm::vec2 cell = glm::floor((a + b) * 0.5f / cellSize) * cellSize;
+                for (const glm::vec2& point : { a, b })
+                {
+                    CHECK(point.x >= cell.x - kCellTolerance && point.x <= cell.x + cellSize + kCellTolerance);
+                    CHECK(point.y >= cell.y - kCellTolerance && point.y <= cell.y + cellSize + kCellTolerance);
+                }
+            }
+            if (divisions == 1)
+            {
+                CHECK(out.size() == line.size());
+            }
+        }
+    }
+}
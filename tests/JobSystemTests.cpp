@@ -0,0 +1,215 @@
+#include "TestHarness.h"
+
+#include "JobSystem.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace
+{
+// 等待条件成立（用于确认工作线程已经进入某个任务），超时返回 false 而不是卡住测试
+template <typename Predicate>
+bool spinUntil(Predicate predicate)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!predicate())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE(jobSystemThreadCount, "JobSystem/default thread count survives hardware_concurrency() == 0")
+{
+    CHECK(JobSystem::defaultThreadCount(0) == 1);
+    CHECK(JobSystem::defaultThreadCount(1) == 1);
+    CHECK(JobSystem::defaultThreadCount(2) == 1);
+    CHECK(JobSystem::defaultThreadCount(8) == 7);
+    
+    JobSystem jobs;
+    CHECK(jobs.getThreadCount() == JobSystem::defaultThreadCount(std::thread::hardware_concurrency()));
+    std::atomic<int> ran(0);
+    jobs.wait(jobs.schedule([&ran]() { ran++; }));
+    CHECK(ran == 1);
+}
+
+TEST_CASE(jobSystemDependencies, "JobSystem/random dependency graphs run every job after its dependencies")
+{
+    constexpr int kJobs = 400;
+    std::mt19937 random(20240613);
+    for (unsigned threads : { 1u, 3u })
+    {
+        JobSystem jobs(threads);
+        auto token = std::make_shared<CancellationToken>();
+        token->cancel();
+        
+        std::vector<std::vector<int>> dependencies(kJobs);
+        std::vector<bool> cancelled(kJobs, false);
+        std::vector<JobSystem::JobHandle> handles(kJobs);
+        // 完成顺序：每个任务结束时取一个递增的序号；被取消的任务保持 -1
+        std::vector<std::atomic<int>> order(kJobs);
+        std::atomic<int> sequence(0);
+        for (int i = 0; i < kJobs; i++)
+        {
+            order[i] = -1;
+            int dependencyCount = i > 0 ? static_cast<int>(random() % 4) : 0;
+            for (int d = 0; d < dependencyCount; d++)
+            {
+                dependencies[i].push_back(static_cast<int>(random() % i));
+            }
+            cancelled[i] = random() % 10 == 0;
+            auto priority = static_cast<JobSystem::Priority>(random() % JobSystem::kPriorityCount);
+            handles[i] = jobs.create([&order, &sequence, i]() { order[i] = sequence++; }, priority, cancelled[i] ? token : nullptr);
+        }
+        // 倒序提交，让依赖尚未完成的任务先进入等待
+        for (int i = kJobs - 1; i >= 0; i--)
+        {
+            for (int dependency : dependencies[i])
+            {
+                jobs.addDependency(handles[i], handles[dependency]);
+            }
+            jobs.submit(handles[i]);
+        }
+        for (const JobSystem::JobHandle& handle : handles)
+        {
+            jobs.wait(handle);
+        }
+        
+        int cancelledCount = 0;
+        for (int i = 0; i < kJobs; i++)
+        {
+            CHECK(JobSystem::isDone(handles[i]));
+            cancelledCount += cancelled[i] ? 1 : 0;
+            CHECK((order[i] < 0) == cancelled[i]);
+            if (cancelled[i])
+            {
+                continue;
+            }
+            for (int dependency : dependencies[i])
+            {
+                // 被取消的依赖也算完成，但没有序号
+                CHECK(cancelled[dependency] || order[dependency] < order[i]);
+            }
+        }
+        JobSystem::Stats stats = jobs.getStats();
+        CHECK(stats.executed == static_cast<uint64_t>(kJobs - cancelledCount));
+        CHECK(stats.cancelled == static_cast<uint64_t>(cancelledCount));
+        CHECK(cancelledCount > 0);
+    }
+}
+
+TEST_CASE(jobSystemCancellation, "JobSystem/cancelled jobs skip their body but release dependents")
+{
+    JobSystem jobs(2);
+    auto token = std::make_shared<CancellationToken>();
+    std::atomic<int> ran(0);
+    
+    // 提交前取消
+    token->cancel();
+    JobSystem::JobHandle skipped = jobs.create([&ran]() { ran += 100; }, JobSystem::Priority::Normal, token);
+    JobSystem::JobHandle after = jobs.create([&ran]() { ran += 1; });
+    jobs.addDependency(after, skipped);
+    jobs.submit(after);
+    jobs.submit(skipped);
+    jobs.wait(after);
+    CHECK(JobSystem::isDone(skipped));
+    CHECK(ran == 1);
+    CHECK(jobs.getStats().cancelled == 1);
+    
+    // 在依赖执行期间取消：依赖照常完成，后续任务开始前才检查标记
+    auto lateToken = std::make_shared<CancellationToken>();
+    std::atomic<bool> started(false), release(false);
+    JobSystem::JobHandle running = jobs.schedule([&]() {
+        started = true;
+        while (!release)
+        {
+            std::this_thread::yield();
+        }
+        ran += 10;
+    });
+    JobSystem::JobHandle dependent = jobs.create([&ran]() { ran += 100; }, JobSystem::Priority::High, lateToken);
+    jobs.addDependency(dependent, running);
+    jobs.submit(dependent);
+    REQUIRE(spinUntil([&]() { return started.load(); }));
+    lateToken->cancel();
+    release = true;
+    jobs.wait(dependent);
+    CHECK(JobSystem::isDone(running));
+    CHECK(ran == 11);
+    CHECK(jobs.getStats().cancelled == 2);
+    CHECK(jobs.getStats().executed == 2);
+}
+
+TEST_CASE(jobSystemHelperPriority, "JobSystem/non-worker threads only help with High jobs while waiting")
+{
+    // 唯一的工作线程被占住，排队的任务只能由等待的线程执行
+    JobSystem jobs(1);
+    const std::thread::id self = std::this_thread::get_id();
+    std::atomic<bool> started(false), release(false);
+    JobSystem::JobHandle blocker = jobs.schedule([&]() {
+        started = true;
+        while (!release)
+        {
+            std::this_thread::yield();
+        }
+    }, JobSystem::Priority::Low);
+    REQUIRE(spinUntil([&]() { return started.load(); }));
+    
+    std::thread::id normalThread, lowThread, highThread;
+    JobSystem::JobHandle normal = jobs.schedule([&]() { normalThread = std::this_thread::get_id(); }, JobSystem::Priority::Normal);
+    JobSystem::JobHandle low = jobs.schedule([&]() { lowThread = std::this_thread::get_id(); }, JobSystem::Priority::Low);
+    CHECK(!jobs.runOne());
+    
+    // 等待 High 任务：调用线程自己执行它，而不会接下排在前面的 Normal / Low
+    JobSystem::JobHandle high = jobs.schedule([&]() { highThread = std::this_thread::get_id(); }, JobSystem::Priority::High);
+    jobs.wait(high);
+    CHECK(highThread == self);
+    CHECK(!JobSystem::isDone(normal));
+    CHECK(!JobSystem::isDone(low));
+    
+    // High 依赖 Normal：调用线程阻塞到工作线程执行完 Normal，再执行随之入队的 High
+    std::thread::id joinThread;
+    JobSystem::JobHandle join = jobs.create([&]() { joinThread = std::this_thread::get_id(); }, JobSystem::Priority::High);
+    jobs.addDependency(join, normal);
+    jobs.submit(join);
+    release = true;
+    jobs.wait(join);
+    jobs.wait(low);
+    CHECK(JobSystem::isDone(normal));
+    CHECK(normalThread != self);
+    CHECK(lowThread != self);
+    CHECK(joinThread != std::thread::id());
+    jobs.wait(blocker);
+    CHECK(jobs.getStats().executed == 5);
+}
+
+TEST_CASE(jobSystemParallelFor, "JobSystem/parallelFor visits every index exactly once")
+{
+    JobSystem jobs(3);
+    for (size_t count : { size_t(0), size_t(1), size_t(7), size_t(1000), size_t(4097) })
+    {
+        std::vector<std::atomic<int>> visits(count);
+        for (std::atomic<int>& visit : visits)
+        {
+            visit = 0;
+        }
+        jobs.parallelFor(count, 16, [&visits](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                visits[i]++;
+            }
+        });
+        size_t wrong = 0;
+        for (const std::atomic<int>& visit : visits)
+        {
+            wrong += visit == 1 ? 0 : 1;
+        }
+        CHECK(wrong == 0);
+    }
+}
@@ -0,0 +1,414 @@
+#include "TestHarness.h"
+
+#include "CollisionGrid.h"
+#include "LabelPlacer.h"
+#include <cmath>
+#include <random>
+
+namespace
+{
+constexpr int kWidth = 1600;
+constexpr int kHeight = 900;
+
+/**
+ * 暴力判定用的形状：圆的 box 为外接框
+ */
+struct Shape
+{
+    bool circle;
+    glm::vec2 center;
+    float radius;
+    glm::vec4 box;
+};
+
+Shape makeBox(const glm::vec4& box)
+{
+    return { false, glm::vec2(box.x + box.z, box.y + box.w) * 0.5f, 0.0f, box };
+}
+
+Shape makeCircle(const glm::vec2& center, float radius)
+{
+    return { true, center, radius, glm::vec4(center - radius, center + radius) };
+}
+
+/**
+ * 两个形状是否重叠（边界相接不算），判定与 CollisionGrid 相同
+ */
+bool shapesOverlap(const Shape& a, const Shape& b)
+{
+    if (a.circle && b.circle)
+    {
+        glm::vec2 d = a.center - b.center;
+        return glm::dot(d, d) < (a.radius + b.radius) * (a.radius + b.radius);
+    }
+    if (a.circle || b.circle)
+    {
+        const Shape& circle = a.circle ? a : b;
+        const glm::vec4& box = a.circle ? b.box : a.box;
+        float dx = circle.center.x - std::clamp(circle.center.x, box.x, box.z);
+        float dy = circle.center.y - std::clamp(circle.center.y, box.y, box.w);
+        return dx * dx + dy * dy < circle.radius * circle.radius;
+    }
+    return a.box.x < b.box.z && b.box.x < a.box.z && a.box.y < b.box.w && b.box.y < a.box.w;
+}
+
+/**
+ * 已放置候选在屏幕上占用的形状（含 padding）
+ */
+Shape placedShape(const LabelPlacer& placer, uint32_t handle)
+{
+    const float padding = placer.getOptions().padding;
+    const LabelPlacer::Candidate& candidate = placer.getCandidate(handle);
+    glm::vec2 center = placer.getScreenPosition(handle) + candidate.offset;
+    if (candidate.shape == LabelPlacer::Shape::Circle)
+    {
+        return makeCircle(center, candidate.size.x + padding);
+    }
+    glm::vec2 half = candidate.size * 0.5f + padding;
+    return makeBox(glm::vec4(center - half, center + half));
+}
+
+std::vector<uint32_t> placedHandles(const LabelPlacer& placer)
+{
+    std::vector<uint32_t> placed;
+    for (uint32_t handle = 0; handle < placer.getHandleCount(); handle++)
+    {
+        if (placer.isPlaced(handle))
+        {
+            placed.push_back(handle);
+        }
+    }
+    return placed;
+}
+
+/**
+ * 两两检查已放置的形状，返回重叠的对数
+ */
+size_t countOverlaps(const LabelPlacer& placer)
+{
+    std::vector<uint32_t> placed;
+    for (uint32_t handle : placedHandles(placer))
+    {
+        if (!placer.getCandidate(handle).allowOverlap)
+        {
+            placed.push_back(handle);
+        }
+    }
+    size_t overlaps = 0;
+    for (size_t i = 0; i < placed.size(); i++)
+    {
+        for (size_t j = i + 1; j < placed.size(); j++)
+        {
+            overlaps += shapesOverlap(placedShape(placer, placed[i]), placedShape(placer, placed[j])) ? 1 : 0;
+        }
+    }
+    return overlaps;
+}
+
+/**
+ * 与 LabelPlacementBench 相同的分布（规模小得多）：一部分围绕几个中心聚集，其中一个贴着经度 ±180
+ */
+std::vector<LabelPlacer::Candidate> generateCandidates(size_t count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> anyLon(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> anyLat(-80.0f, 80.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    const glm::vec2 centers[] = { glm::vec2(179.5f, 10.0f), glm::vec2(0.0f, 30.0f), glm::vec2(-70.0f, -20.0f) };
+    
+    std::vector<LabelPlacer::Candidate> candidates(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        LabelPlacer::Candidate& candidate = candidates[i];
+        if (unit(random) < 0.3f)
+        {
+            candidate.lon = anyLon(random);
+            candidate.lat = anyLat(random);
+        }
+        else
+        {
+            const glm::vec2& center = centers[random() % 3];
+            float x = center.x + normal(random) * 4.0f;
+            candidate.lon = x > 180.0f ? x - 360.0f : x;
+            candidate.lat = center.y + normal(random) * 4.0f;
+        }
+        if (unit(random) < 0.8f)
+        {
+            candidate.shape = LabelPlacer::Shape::Box;
+            candidate.size = glm::vec2(40.0f + 120.0f * unit(random), 14.0f + 6.0f * unit(random));
+            candidate.offset = glm::vec2(0.0f, -candidate.size.y);
+        }
+        else
+        {
+            candidate.shape = LabelPlacer::Shape::Circle;
+            candidate.size = glm::vec2(8.0f + 6.0f * unit(random), 0.0f);
+        }
+        candidate.priority = static_cast<float>(random() % 10);
+        candidate.id = static_cast<uint32_t>(i);
+    }
+    return candidates;
+}
+
+LabelPlacer::Candidate makeCandidate(float lon, float lat, float priority, uint32_t id)
+{
+    LabelPlacer::Candidate candidate;
+    candidate.lon = lon;
+    candidate.lat = lat;
+    candidate.size = glm::vec2(80.0f, 20.0f);
+    candidate.priority = priority;
+    candidate.id = id;
+    return candidate;
+}
+} // namespace
+
+TEST_CASE(collisionGridCells, "Label/grid box and circle hit tests match brute force across cell boundaries")
+{
+    CollisionGrid grid(64.0f);
+    grid.reset(640.0f, 384.0f);
+    
+    // 跨 4 个格子的矩形：从任何一个格子查询都能命中，queryBox 只返回一次
+    grid.insertBox(glm::vec4(60.0f, 60.0f, 70.0f, 70.0f), 1);
+    CHECK(grid.hitTestBox(glm::vec4(69.0f, 69.0f, 200.0f, 200.0f)));
+    CHECK(grid.hitTestBox(glm::vec4(0.0f, 0.0f, 61.0f, 61.0f)));
+    CHECK(grid.hitTestCircle(glm::vec2(75.0f, 65.0f), 5.5f));
+    // 边界相接、外接框相交但圆没有碰到角
+    CHECK(!grid.hitTestBox(glm::vec4(70.0f, 60.0f, 80.0f, 70.0f)));
+    CHECK(!grid.hitTestCircle(glm::vec2(75.0f, 75.0f), 7.0f));
+    std::vector<uint32_t> keys;
+    grid.queryBox(glm::vec4(0.0f, 0.0f, 640.0f, 384.0f), keys);
+    CHECK(keys == std::vector<uint32_t>{ 1 });
+    
+    // 圆跨过格子边界；矩形靠近外接框的角
+    grid.insertCircle(glm::vec2(128.0f, 192.0f), 20.0f, 2);
+    CHECK(grid.hitTestBox(glm::vec4(140.0f, 180.0f, 150.0f, 190.0f)));
+    CHECK(!grid.hitTestBox(glm::vec4(145.0f, 207.0f, 160.0f, 220.0f)));
+    CHECK(grid.hitTestCircle(glm::vec2(100.0f, 192.0f), 8.5f));
+    CHECK(!grid.hitTestCircle(glm::vec2(100.0f, 192.0f), 8.0f));
+    
+    // 超出视口的条目夹到边缘的格子，仍然可以查到
+    uint32_t outside = grid.insertBox(glm::vec4(-100.0f, -100.0f, -50.0f, -50.0f), 3);
+    CHECK(grid.hitTestBox(glm::vec4(-80.0f, -80.0f, -70.0f, -70.0f)));
+    CHECK(!grid.hitTestBox(glm::vec4(-40.0f, -40.0f, -30.0f, -30.0f)));
+    CHECK(grid.getEntryCount() == 3);
+    grid.remove(outside);
+    grid.remove(outside);
+    CHECK(!grid.hitTestBox(glm::vec4(-80.0f, -80.0f, -70.0f, -70.0f)));
+    CHECK(grid.getEntryCount() == 2);
+    
+    // 随机形状：网格的查询与逐个比较的结果一致
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> position(-40.0f, 680.0f);
+    std::uniform_real_distribution<float> extent(1.0f, 150.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto randomShape = [&]() {
+        glm::vec2 corner(position(random), position(random) * 0.6f);
+        if (unit(random) < 0.5f)
+        {
+            return makeCircle(corner, extent(random) * 0.5f);
+        }
+        return makeBox(glm::vec4(corner, corner + glm::vec2(extent(random), extent(random) * 0.3f)));
+    };
+    
+    grid.reset(640.0f, 384.0f);
+    std::vector<Shape> shapes;
+    for (uint32_t i = 0; i < 60; i++)
+    {
+        shapes.push_back(randomShape());
+        const Shape& shape = shapes.back();
+        if (shape.circle)
+        {
+            grid.insertCircle(shape.center, shape.radius, i);
+        }
+        else
+        {
+            grid.insertBox(shape.box, i);
+        }
+    }
+    size_t hits = 0;
+    for (int query = 0; query < 2000; query++)
+    {
+        Shape shape = randomShape();
+        std::vector<uint32_t> expectedKeys;
+        for (uint32_t i = 0; i < shapes.size(); i++)
+        {
+            if (shapesOverlap(shape, shapes[i]))
+            {
+                expectedKeys.push_back(i);
+            }
+        }
+        const bool expected = !expectedKeys.empty();
+        hits += expected ? 1 : 0;
+        CHECK((shape.circle ? grid.hitTestCircle(shape.center, shape.radius) : grid.hitTestBox(shape.box)) == expected);
+        if (!shape.circle)
+        {
+            keys.clear();
+            grid.queryBox(shape.box, keys);
+            std::sort(keys.begin(), keys.end());
+            CHECK(keys == expectedKeys);
+        }
+    }
+    // 命中和未命中都有足够的样本
+    CHECK(hits > 200 && hits < 1800);
+}
+
+TEST_CASE(labelNoOverlap, "Label/placed labels never overlap across globe and Mercator cameras")
+{
+    const std::vector<LabelPlacer::Candidate> candidates = generateCandidates(3000, 1);
+    LabelPlacer placer;
+    for (const LabelPlacer::Candidate& candidate : candidates)
+    {
+        placer.add(candidate);
+    }
+    
+    size_t frames = 0;
+    for (float transition : { 0.0f, 0.5f, 1.0f })
+    {
+        for (float centerLon : { 0.0f, 170.0f, -175.0f })
+        {
+            for (float zoom : { 1.5f, 3.0f })
+            {
+                placer.update(Test::makeState(transition, centerLon, 15.0f, zoom), kWidth, kHeight);
+                placer.advance(1.0f / 60.0f);
+                CHECK(placer.getStats().placed > 0);
+                CHECK(placer.getStats().collided > 0);
+                CHECK(countOverlaps(placer) == 0);
+                frames++;
+            }
+        }
+    }
+    CHECK(frames == 18);
+}
+
+TEST_CASE(labelBackOfGlobe, "Label/anchors on the back of the globe are rejected before collision")
+{
+    LabelPlacer placer;
+    uint32_t front = placer.add(makeCandidate(10.0f, 0.0f, 0.0f, 1));
+    uint32_t back = placer.add(makeCandidate(180.0f, 0.0f, 9.0f, 2));
+    uint32_t nearHorizon = placer.add(makeCandidate(-110.0f, 0.0f, 9.0f, 3));
+    
+    // Globe：背面的锚点即使优先级更高也不放置，不占用网格
+    placer.update(Test::makeState(1.0f, 0.0f, 0.0f, 1.0f), kWidth, kHeight);
+    placer.advance(1.0f);
+    CHECK(placer.isPlaced(front));
+    CHECK(!placer.isPlaced(back));
+    CHECK(!placer.isPlaced(nearHorizon));
+    CHECK(placer.getStats().beyondHorizon == 2);
+    CHECK(placer.getStats().collided == 0);
+    CHECK(placer.getGrid().getEntryCount() == 1);
+    REQUIRE(placer.getVisible().size() == 1);
+    CHECK(placer.getVisible()[0].handle == front);
+    
+    // 转到另一侧：原来的背面锚点可见，原来正面的锚点被排除
+    placer.update(Test::makeState(1.0f, 180.0f, 0.0f, 1.0f), kWidth, kHeight);
+    CHECK(placer.isPlaced(back));
+    CHECK(!placer.isPlaced(front));
+    CHECK(placer.getStats().beyondHorizon == 1);
+    
+    // 墨卡托没有背面：视口外的锚点计入 outsideView
+    placer.update(Test::makeState(0.0f, 0.0f, 0.0f, 3.0f), kWidth, kHeight);
+    CHECK(placer.getStats().beyondHorizon == 0);
+    CHECK(placer.isPlaced(front));
+    CHECK(placer.getStats().outsideView == 2);
+}
+
+TEST_CASE(labelStability, "Label/placement is stable for an unchanged state and prefers labels already shown")
+{
+    const std::vector<LabelPlacer::Candidate> candidates = generateCandidates(1500, 2);
+    LabelPlacer placer;
+    for (const LabelPlacer::Candidate& candidate : candidates)
+    {
+        placer.add(candidate);
+    }
+    auto state = Test::makeState(0.3f, 5.0f, 25.0f, 2.5f);
+    placer.update(state, kWidth, kHeight);
+    CHECK(!placer.getStats().incremental);
+    const std::vector<uint32_t> placed = placedHandles(placer);
+    CHECK(!placed.empty());
+    
+    // 同一个状态：只处理增量，没有候选需要处理
+    placer.update(state, kWidth, kHeight);
+    CHECK(placer.getStats().incremental);
+    CHECK(placer.getStats().tested == 0);
+    CHECK(placedHandles(placer) == placed);
+    
+    // 参数相同的新状态：整体重新放置，结果不变
+    placer.update(Test::makeState(0.3f, 5.0f, 25.0f, 2.5f), kWidth, kHeight);
+    CHECK(!placer.getStats().incremental);
+    CHECK(placedHandles(placer) == placed);
+    
+    // 同一优先级的两个重叠标注：已显示的保持显示，不会因为新来的 id 更小而切换
+    LabelPlacer pair;
+    uint32_t shown = pair.add(makeCandidate(0.0f, 0.0f, 1.0f, 5));
+    pair.update(Test::makeState(0.0f, 0.0f, 0.0f, 3.0f), kWidth, kHeight);
+    uint32_t late = pair.add(makeCandidate(0.5f, 0.0f, 1.0f, 1));
+    pair.update(Test::makeState(0.0f, 0.2f, 0.0f, 3.0f), kWidth, kHeight);
+    CHECK(pair.isPlaced(shown));
+    CHECK(!pair.isPlaced(late));
+    
+    // 淡入淡出：目标不透明度切换后按 fadeDuration 线性过渡
+    pair.advance(0.15f);
+    CHECK_NEAR(pair.getOpacity(shown), 0.5f, 1e-5f);
+    CHECK(pair.getOpacity(late) == 0.0f);
+    CHECK(pair.getStats().fading == 1);
+    pair.advance(0.3f);
+    CHECK(pair.getOpacity(shown) == 1.0f);
+}
+
+TEST_CASE(labelIncremental, "Label/incremental add and remove matches a full re-placement for a static camera")
+{
+    const std::vector<LabelPlacer::Candidate> candidates = generateCandidates(2500, 3);
+    LabelPlacer placer;
+    std::vector<uint32_t> handles;
+    for (size_t i = 0; i < 2000; i++)
+    {
+        handles.push_back(placer.add(candidates[i]));
+    }
+    auto state = Test::makeState(0.7f, 10.0f, 20.0f, 2.5f);
+    placer.update(state, kWidth, kHeight);
+    
+    std::mt19937 random(11);
+    size_t next = handles.size();
+    size_t incremental = 0;
+    for (int round = 0; round < 10; round++)
+    {
+        // 偶数轮删除 2%、新增 2%（优先级随机，可能高于挡住它的已放置标注）；
+        // 奇数轮只新增优先级最低的候选，挡住它们的都不低于它们，一定只处理增量
+        const bool lowest = round % 2 == 1;
+        for (int i = 0; i < 40; i++)
+        {
+            LabelPlacer::Candidate candidate = candidates[next++ % candidates.size()];
+            if (lowest)
+            {
+                candidate.priority = -1.0f;
+                handles.push_back(placer.add(candidate));
+                continue;
+            }
+            size_t slot = random() % handles.size();
+            placer.remove(handles[slot]);
+            handles[slot] = placer.add(candidate);
+        }
+        placer.update(state, kWidth, kHeight);
+        CHECK(placer.getStats().incremental || !lowest);
+        incremental += placer.getStats().incremental ? 1 : 0;
+        const std::vector<uint32_t> placed = placedHandles(placer);
+        CHECK(countOverlaps(placer) == 0);
+        
+        // 参数相同的新状态强制整体重新放置
+        state = Test::makeState(0.7f, 10.0f, 20.0f, 2.5f);
+        placer.update(state, kWidth, kHeight);
+        CHECK(!placer.getStats().incremental);
+        CHECK(placedHandles(placer) == placed);
+    }
+    CHECK(incremental >= 5);
+    
+    // 只删除：之前被挡住的候选补上，结果同样与整体放置一致
+    for (int i = 0; i < 100; i++)
+    {
+        placer.remove(handles[random() % handles.size()]);
+    }
+    placer.update(state, kWidth, kHeight);
+    const std::vector<uint32_t> placed = placedHandles(placer);
+    placer.update(Test::makeState(0.7f, 10.0f, 20.0f, 2.5f), kWidth, kHeight);
+    CHECK(placedHandles(placer) == placed);
+}
@@ -0,0 +1,126 @@
+#include "TestHarness.h"
+
+#include "LockFreeQueue.h"
+#include <atomic>
+#include <thread>
+
+TEST_CASE(lockFreeQueueBounds, "LockFreeQueue/capacity rounds up and full or empty queues fail immediately")
+{
+    CHECK(LockFreeQueue<int>(0).capacity() == 2);
+    CHECK(LockFreeQueue<int>(5).capacity() == 8);
+    CHECK(LockFreeQueue<int>(8).capacity() == 8);
+    
+    LockFreeQueue<int> queue(4);
+    int value = -1;
+    CHECK(!queue.pop(value));
+    CHECK(queue.emptyApprox());
+    // 多次绕过环的末尾，确认序号交接
+    for (int round = 0; round < 5; round++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            CHECK(queue.push(round * 10 + i));
+        }
+        CHECK(!queue.push(99));
+        CHECK(queue.sizeApprox() == 4);
+        for (int i = 0; i < 4; i++)
+        {
+            CHECK(queue.pop(value));
+            CHECK(value == round * 10 + i);
+        }
+        CHECK(!queue.pop(value));
+    }
+}
+
+TEST_CASE(lockFreeQueueMoveOnly, "LockFreeQueue/moves values in and releases them on pop")
+{
+    LockFreeQueue<std::unique_ptr<int>> queue(2);
+    std::unique_ptr<int> value(new int(7));
+    CHECK(queue.push(std::move(value)));
+    CHECK(!value);
+    CHECK(queue.push(std::unique_ptr<int>(new int(8))));
+    
+    // 队列已满时 value 保持不变
+    std::unique_ptr<int> rejected(new int(9));
+    CHECK(!queue.push(std::move(rejected)));
+    REQUIRE(rejected);
+    CHECK(*rejected == 9);
+    
+    std::unique_ptr<int> out;
+    REQUIRE(queue.pop(out));
+    REQUIRE(out);
+    CHECK(*out == 7);
+    REQUIRE(queue.pop(out));
+    REQUIRE(out);
+    CHECK(*out == 8);
+}
+
+TEST_CASE(lockFreeQueueContention, "LockFreeQueue/MPMC under contention delivers every item once and in producer order")
+{
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kItems = 20000;
+    // 容量远小于总数，生产者和消费者都会频繁遇到满和空
+    LockFreeQueue<int> queue(16);
+    std::atomic<int> consumed(0);
+    std::vector<std::vector<int>> received(kConsumers);
+    
+    std::vector<std::thread> threads;
+    for (int producer = 0; producer < kProducers; producer++)
+    {
+        threads.emplace_back([&queue, producer]() {
+            for (int i = 0; i < kItems; i++)
+            {
+                while (!queue.push(producer * kItems + i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int consumer = 0; consumer < kConsumers; consumer++)
+    {
+        threads.emplace_back([&queue, &consumed, &received, consumer]() {
+            int value = 0;
+            while (consumed.load() < kProducers * kItems)
+            {
+                if (queue.pop(value))
+                {
+                    received[consumer].push_back(value);
+                    consumed++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    
+    std::vector<int> counts(kProducers * kItems, 0);
+    size_t outOfOrder = 0;
+    for (const std::vector<int>& values : received)
+    {
+        // 同一个消费者看到的同一生产者的元素保持入队顺序
+        std::vector<int> last(kProducers, -1);
+        for (int value : values)
+        {
+            counts[value]++;
+            int producer = value / kItems;
+            outOfOrder += value % kItems > last[producer] ? 0 : 1;
+            last[producer] = value % kItems;
+        }
+    }
+    size_t wrong = 0;
+    for (int count : counts)
+    {
+        wrong += count == 1 ? 0 : 1;
+    }
+    CHECK(wrong == 0);
+    CHECK(outOfOrder == 0);
+    CHECK(queue.emptyApprox());
+}
@@ -0,0 +1,343 @@
+#include "TestHarness.h"
+
+#include "Constants.h"
+#include "PointClusterIndex.h"
+#include <cmath>
+
+namespace
+{
+constexpr double kPi = 3.14159265358979323846;
+
+/**
+ * 固定的小点集：组内相距不超过 0.07°，组与组的距离要么远大于 z0 的聚类半径（约 28°），
+ * 要么（A 与 B 相距 3°）只在 z3 及以下合并，因此每一级的聚类结果与种子顺序无关
+ */
+const float kLon[] = { 10.0f, 10.05f, 10.0f, 10.05f,     // A：4 个点，z5 合并
+                       13.0f, 13.05f, 13.02f,             // B：3 个点，z5 合并，z3 与 A 合并
+                       -60.0f, -60.1f,                    // C
+                       100.0f,                            // D：单独的点
+                       179.95f, 179.97f,                  // E：贴着经度 180
+                       -179.9f };                         // F：经度 -180 的另一侧
+const float kLat[] = { 10.0f, 10.0f, 10.05f, 10.05f,
+                       10.0f, 10.02f, 10.05f,
+                       -30.0f, -30.0f,
+                       40.0f,
+                       0.0f, 0.02f,
+                       5.0f };
+constexpr size_t kCount = sizeof(kLon) / sizeof(kLon[0]);
+constexpr size_t kF = kCount - 1;
+
+PointClusterIndex::Options testOptions()
+{
+    PointClusterIndex::Options options;
+    options.maxZoom = 5;
+    return options;
+}
+
+struct Entity
+{
+    double x;
+    double y;
+    uint32_t count;
+};
+
+Entity project(float lon, float lat)
+{
+    double x = lon / 360.0 + 0.5;
+    double phi = std::clamp(static_cast<double>(lat), -85.051128779806604, 85.051128779806604) * kPi / 180.0;
+    return { x - std::floor(x), 0.5 - std::log(std::tan(kPi / 4.0 + phi / 2.0)) / (2.0 * kPi), 1 };
+}
+
+/**
+ * 暴力聚类：从 maxZoom 逐级向下，每个未合并的实体把半径内未合并的实体并成按点数加权的聚类
+ */
+std::vector<Entity> bruteForce(const PointClusterIndex::Options& options, int zoom)
+{
+    std::vector<Entity> entities;
+    for (size_t i = 0; i < kCount; i++)
+    {
+        entities.push_back(project(kLon[i], kLat[i]));
+    }
+    for (int level = options.maxZoom; level >= std::max(zoom, options.minZoom); level--)
+    {
+        const double radius = options.radius / (options.extent * std::exp2(level));
+        std::vector<bool> merged(entities.size(), false);
+        std::vector<Entity> next;
+        for (size_t i = 0; i < entities.size(); i++)
+        {
+            if (merged[i])
+            {
+                continue;
+            }
+            std::vector<size_t> members = { i };
+            uint32_t total = entities[i].count;
+            for (size_t j = 0; j < entities.size(); j++)
+            {
+                double dx = entities[j].x - entities[i].x;
+                double dy = entities[j].y - entities[i].y;
+                if (j != i && !merged[j] && dx * dx + dy * dy <= radius * radius)
+                {
+                    members.push_back(j);
+                    total += entities[j].count;
+                }
+            }
+            if (members.size() == 1 || total < options.minPoints)
+            {
+                next.push_back(entities[i]);
+                continue;
+            }
+            Entity cluster = { 0.0, 0.0, total };
+            for (size_t member : members)
+            {
+                merged[member] = true;
+                cluster.x += entities[member].x * entities[member].count;
+                cluster.y += entities[member].y * entities[member].count;
+            }
+            cluster.x /= total;
+            cluster.y /= total;
+            next.push_back(cluster);
+        }
+        entities.swap(next);
+    }
+    return entities;
+}
+
+bool lessFeature(const PointClusterIndex::Feature& a, const PointClusterIndex::Feature& b)
+{
+    if (a.count != b.count)
+    {
+        return a.count < b.count;
+    }
+    return a.position.x != b.position.x ? a.position.x < b.position.x : a.position.y < b.position.y;
+}
+
+/**
+ * 暴力结果中落在瓦片（含缓冲区，经度方向三个世界副本）内的实体
+ */
+std::vector<PointClusterIndex::Feature> expectedTile(const PointClusterIndex::Options& options, const TileID& tile)
+{
+    const double scale = std::exp2(tile.z);
+    const double padding = options.buffer / options.extent;
+    std::vector<PointClusterIndex::Feature> features;
+    for (const Entity& entity : bruteForce(options, tile.z))
+    {
+        for (int shift = -1; shift <= 1; shift++)
+        {
+            double x = (entity.x + shift) * scale - tile.x;
+            double y = entity.y * scale - tile.y;
+            if (x >= -padding && x <= 1.0 + padding && y >= -padding && y <= 1.0 + padding)
+            {
+                PointClusterIndex::Feature feature;
+                feature.count = entity.count;
+                feature.mercator = glm::dvec2(entity.x + shift + tile.wrap, entity.y);
+                feature.position = glm::ivec2(static_cast<int>(std::lround(x * Constants::TILE_EXTENT)),
+                                              static_cast<int>(std::lround(y * Constants::TILE_EXTENT)));
+                features.push_back(feature);
+            }
+        }
+    }
+    std::sort(features.begin(), features.end(), lessFeature);
+    return features;
+}
+
+/**
+ * 某一层级所有瓦片里的聚类，每个只取一次（不含缓冲区内的副本）
+ */
+std::vector<PointClusterIndex::Feature> clustersAt(const PointClusterIndex& index, int zoom)
+{
+    std::vector<PointClusterIndex::Feature> features, clusters;
+    const int tiles = 1 << zoom;
+    for (int tx = 0; tx < tiles; tx++)
+    {
+        for (int ty = 0; ty < tiles; ty++)
+        {
+            index.getTile(Test::makeTile(zoom, tx, ty), features);
+            for (const PointClusterIndex::Feature& feature : features)
+            {
+                bool inside = feature.position.x >= 0 && feature.position.x < Constants::TILE_EXTENT &&
+                              feature.position.y >= 0 && feature.position.y < Constants::TILE_EXTENT;
+                if (inside && feature.count > 1)
+                {
+                    clusters.push_back(feature);
+                }
+            }
+        }
+    }
+    return clusters;
+}
+} // namespace
+
+TEST_CASE(pointClusterBruteForce, "PointClusterIndex/getTile matches brute-force clustering at every zoom")
+{
+    PointClusterIndex::Options options = testOptions();
+    PointClusterIndex index(options);
+    index.build(kLon, kLat, kCount);
+    CHECK(index.getStats().points == kCount);
+    
+    std::vector<PointClusterIndex::Feature> features;
+    size_t compared = 0;
+    for (int z = 0; z <= options.maxZoom + 2; z++)
+    {
+        for (int tx = 0; tx < (1 << z); tx++)
+        {
+            for (int ty = 0; ty < (1 << z); ty++)
+            {
+                TileID tile = Test::makeTile(z, tx, ty);
+                std::vector<PointClusterIndex::Feature> expected = expectedTile(options, tile);
+                index.getTile(tile, features);
+                std::sort(features.begin(), features.end(), lessFeature);
+                REQUIRE(features.size() == expected.size());
+                for (size_t i = 0; i < features.size(); i++)
+                {
+                    // 定点坐标和整数加权中心的取整最多差 1 个瓦片单位
+                    CHECK(features[i].count == expected[i].count);
+                    CHECK(std::abs(features[i].position.x - expected[i].position.x) <= 1);
+                    CHECK(std::abs(features[i].position.y - expected[i].position.y) <= 1);
+                    CHECK_NEAR(features[i].mercator.x, expected[i].mercator.x, 1e-9);
+                    CHECK_NEAR(features[i].mercator.y, expected[i].mercator.y, 1e-9);
+                }
+                compared += features.size();
+            }
+        }
+    }
+    CHECK(compared > 0);
+    
+    // z0 时 A、B 合成一个 7 点的聚类，各组互不合并
+    std::vector<Entity> top = bruteForce(options, 0);
+    CHECK(top.size() == 5);
+}
+
+TEST_CASE(pointClusterLeaves, "PointClusterIndex/getLeaves returns exactly the points counted by each cluster")
+{
+    PointClusterIndex index(testOptions());
+    index.build(kLon, kLat, kCount);
+    
+    size_t clusters = 0;
+    for (int z = 0; z <= index.getOptions().maxZoom; z++)
+    {
+        for (const PointClusterIndex::Feature& cluster : clustersAt(index, z))
+        {
+            clusters++;
+            CHECK(cluster.id >= kCount);
+            std::vector<uint32_t> leaves;
+            CHECK(index.getLeaves(cluster.id, SIZE_MAX, 0, leaves) == cluster.count);
+            REQUIRE(leaves.size() == cluster.count);
+            
+            // 叶子互不重复，且都在聚类中心的半径内（原始点到中心的距离不超过逐级半径之和）
+            std::vector<uint32_t> sorted = leaves;
+            std::sort(sorted.begin(), sorted.end());
+            CHECK(std::unique(sorted.begin(), sorted.end()) == sorted.end());
+            for (uint32_t leaf : leaves)
+            {
+                REQUIRE(leaf < kCount);
+                Entity point = project(kLon[leaf], kLat[leaf]);
+                CHECK(std::hypot(point.x - cluster.mercator.x, point.y - cluster.mercator.y) < 0.2 / std::exp2(z));
+            }
+            
+            // 分页：offset / limit 取出的是完整结果中的一段
+            std::vector<uint32_t> page;
+            size_t appended = index.getLeaves(cluster.id, 2, 1, page);
+            CHECK(appended == std::min<size_t>(2, cluster.count - 1));
+            for (size_t i = 0; i < page.size(); i++)
+            {
+                CHECK(page[i] == leaves[i + 1]);
+            }
+            
+            // 子实体的点数之和等于聚类的点数
+            std::vector<PointClusterIndex::Feature> children;
+            REQUIRE(index.getChildren(cluster.id, children));
+            CHECK(children.size() >= 2);
+            uint32_t total = 0;
+            for (const PointClusterIndex::Feature& child : children)
+            {
+                total += child.count;
+            }
+            CHECK(total == cluster.count);
+        }
+    }
+    // z0..z3 每级 3 个（A+B，C，E），z4、z5 每级 4 个（A，B，C，E）
+    CHECK(clusters == 3 * 4 + 4 * 2);
+    
+    // 原始点和不存在的 id 没有叶子
+    std::vector<uint32_t> none;
+    CHECK(index.getLeaves(0, SIZE_MAX, 0, none) == 0);
+    CHECK(index.getLeaves(UINT32_MAX, SIZE_MAX, 0, none) == 0);
+    std::vector<PointClusterIndex::Feature> children;
+    CHECK(!index.getChildren(0, children));
+}
+
+TEST_CASE(pointClusterExpansionZoom, "PointClusterIndex/getExpansionZoom is the first zoom where the cluster splits")
+{
+    PointClusterIndex index(testOptions());
+    index.build(kLon, kLat, kCount);
+    const int maxZoom = index.getOptions().maxZoom;
+    
+    size_t checked = 0;
+    for (int z = 0; z <= maxZoom; z++)
+    {
+        for (const PointClusterIndex::Feature& cluster : clustersAt(index, z))
+        {
+            // A+B 在 z3 合并，z4 分开；其余聚类在 maxZoom 产生，超过 maxZoom 才分开
+            int expected = cluster.count == 7 ? 4 : maxZoom + 1;
+            CHECK(index.getExpansionZoom(cluster.id) == expected);
+            CHECK(index.getExpansionZoom(cluster.id) > z);
+            
+            // 在展开层级上，聚类不再出现，它的子实体各自可见
+            std::vector<PointClusterIndex::Feature> expanded = clustersAt(index, std::min(expected, maxZoom));
+            bool stillVisible = false;
+            for (const PointClusterIndex::Feature& feature : expanded)
+            {
+                stillVisible = stillVisible || feature.id == cluster.id;
+            }
+            CHECK(!stillVisible || expected > maxZoom);
+            checked++;
+        }
+    }
+    CHECK(checked > 0);
+}
+
+TEST_CASE(pointClusterAntimeridian, "PointClusterIndex/buffer pulls points across the antimeridian for every wrap")
+{
+    PointClusterIndex index(testOptions());
+    index.build(kLon, kLat, kCount);
+    const double fx = project(kLon[kF], kLat[kF]).x;
+    
+    std::vector<PointClusterIndex::Feature> base, features;
+    index.getTile(Test::makeTile(3, 7, 3), base);
+    for (int wrap = -1; wrap <= 1; wrap++)
+    {
+        // 东边界的瓦片：F 从世界的另一侧进入缓冲区，位置超出 TILE_EXTENT
+        index.getTile(Test::makeTile(3, 7, 3, wrap), features);
+        REQUIRE(features.size() == 2);
+        REQUIRE(features.size() == base.size());
+        std::sort(features.begin(), features.end(), lessFeature);
+        const PointClusterIndex::Feature& f = features[0];
+        CHECK(f.count == 1);
+        CHECK(f.id == kF);
+        CHECK(f.position.x > Constants::TILE_EXTENT);
+        CHECK(f.position.x < Constants::TILE_EXTENT * 9 / 8);
+        CHECK_NEAR(f.mercator.x, fx + 1.0 + wrap, 1e-9);
+        CHECK(features[1].count == 2);
+        CHECK(features[1].position.x < Constants::TILE_EXTENT);
+        CHECK_NEAR(features[1].mercator.x, features[1].position.x / (8.0 * Constants::TILE_EXTENT) + 7.0 / 8.0 + wrap, 1e-3);
+        
+        // 西边界的瓦片：E 从另一侧进入，位置为负
+        index.getTile(Test::makeTile(3, 0, 3, wrap), features);
+        std::sort(features.begin(), features.end(), lessFeature);
+        REQUIRE(features.size() == 2);
+        CHECK(features[0].id == kF);
+        CHECK(features[0].position.x > 0);
+        CHECK_NEAR(features[0].mercator.x, fx + wrap, 1e-9);
+        CHECK(features[1].count == 2);
+        CHECK(features[1].position.x < 0);
+        CHECK(features[1].position.x > -Constants::TILE_EXTENT / 8);
+        CHECK(features[1].mercator.x < wrap);
+    }
+    
+    // 远离经度 ±180 的瓦片不会复制
+    index.getTile(Test::makeTile(3, 4, 3), features);
+    for (const PointClusterIndex::Feature& feature : features)
+    {
+        CHECK(feature.mercator.x >= 0.5 - 1.0 / 64.0 && feature.mercator.x <= 0.625 + 1.0 / 64.0);
+    }
+}
@@ -0,0 +1,154 @@
+#include "TestHarness.h"
+
+#include "ProjectionState.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+
+namespace
+{
+// 1080 像素高的视口上半个像素（NDC 每像素 2 / 1080）
+constexpr float kNdcTolerance = 1.0f / 1080.0f;
+// 反投影回到的地图点与原来的点在单位球上的距离（按 2^zoom 缩小）；曲面折叠时重叠的另一点远远超出
+constexpr float kSphereTolerance = 1e-2f;
+// clipping Z / w 超过该值的点视为在球的轮廓附近
+constexpr float kLimbClipZ = 0.9f;
+
+glm::vec2 toNdc(const glm::vec4& clip)
+{
+    return glm::vec2(clip.x, clip.y) / clip.w;
+}
+
+// 解在哪个世界副本上由调用方决定：取 wrap -1..1 中重新投影离目标像素最近的一个
+float reprojectionError(const ProjectionState& state, const glm::vec2& mercator, const glm::vec2& ndc)
+{
+    float best = std::numeric_limits<float>::max();
+    for (int wrap = -1; wrap <= 1; wrap++)
+    {
+        glm::vec4 clip = state.projectToClip(glm::vec2(mercator.x + wrap, mercator.y));
+        if (clip.w > 0.0f)
+        {
+            best = std::min(best, glm::length(toNdc(clip) - ndc));
+        }
+    }
+    return best;
+}
+
+struct RoundTrip
+{
+    size_t visible = 0;     // 在视锥内、应当命中的采样点
+    size_t hits = 0;
+    size_t interior = 0;    // 命中且远离球的轮廓的采样点：轮廓附近视线与球面相切，像素内的误差对应球面上很大的距离
+    size_t sameSource = 0;  // 其中解回到原来地图点的个数（按球面距离比较，高纬处墨卡托 X 的差别在球面上很小）
+    float maxError = 0.0f;  // 重新投影的误差（NDC）
+};
+
+/**
+ * 在以 center 为中心、边长 size 的墨卡托范围（限制在 y ∈ (0, 1) 内）上取网格点，
+ * 投影到屏幕、再反投影并重新投影；xOffset 为整数时测试对应的世界副本
+ */
+RoundTrip roundTrip(const ProjectionState& state, float size, float xOffset = 0.0f)
+{
+    RoundTrip result;
+    const int samples = 64;
+    for (int j = 0; j < samples; j++)
+    {
+        for (int i = 0; i < samples; i++)
+        {
+            glm::vec2 source(state.getCenterMercX() + xOffset + ((i + 0.5f) / samples - 0.5f) * size,
+                             state.getCenterMercY() + ((j + 0.5f) / samples - 0.5f) * size);
+            if (source.y <= 0.0f || source.y >= 1.0f)
+            {
+                continue;
+            }
+            glm::vec4 clip = state.projectToClip(source);
+            if (!ProjectionState::isInsideClipVolume(clip))
+            {
+                continue;
+            }
+            glm::vec2 ndc = toNdc(clip);
+            result.visible++;
+            glm::vec2 mercator;
+            if (!state.unprojectNdc(ndc, mercator))
+            {
+                continue;
+            }
+            result.hits++;
+            CHECK(mercator.x == state.nearestWrapMercX(mercator.x));
+            result.maxError = std::max(result.maxError, reprojectionError(state, mercator, ndc));
+            
+            // clipping Z 接近 w 的点在球的轮廓附近
+            if (clip.z > kLimbClipZ * clip.w)
+            {
+                continue;
+            }
+            result.interior++;
+            glm::vec2 unwrapped(mercator.x + std::round(source.x - mercator.x), mercator.y);
+            float distance = glm::length(ProjectionState::sphereFromMercator(unwrapped) - ProjectionState::sphereFromMercator(source));
+            if (distance < kSphereTolerance * std::exp2(-state.getZoom()))
+            {
+                result.sameSource++;
+            }
+        }
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE(unprojectRoundTrip, "ProjectionState/unprojectNdc inverts projectToClip at transitions 0, 0.5 and 1")
+{
+    // 更高的层级上 Globe 相机已进入球内（w < 0），不在 unprojectNdc 的适用范围
+    for (float zoom : { 1.0f, 2.0f, 3.0f })
+    {
+        for (float transition : { 0.0f, 0.5f, 1.0f })
+        {
+            auto state = Test::makeState(transition, 30.0f, 25.0f, zoom);
+            // 覆盖整个视口并略超出（视口外的点不在视锥内，跳过）
+            RoundTrip result = roundTrip(*state, std::min(1.0f, 1.5f / std::exp2(zoom)));
+            REQUIRE(result.visible > 0);
+            CHECK(result.hits == result.visible);
+            CHECK_NEAR(result.maxError, 0.0f, kNdcTolerance);
+            CHECK(result.sameSource == result.interior);
+        }
+    }
+}
+
+TEST_CASE(unprojectSideWorldCopies, "ProjectionState/unprojectNdc hits the side world copies")
+{
+    // 低缩放时整个世界比视口窄，两侧的副本（wrap = ±1）也在屏幕上
+    for (float transition : { 0.0f, 0.0005f, 0.25f })
+    {
+        auto state = Test::makeState(transition, 0.0f, 0.0f, 0.3f);
+        size_t sideHits = 0;
+        for (int wrap : { -1, 1 })
+        {
+            RoundTrip result = roundTrip(*state, 1.0f, static_cast<float>(wrap));
+            CHECK(result.hits == result.visible);
+            CHECK_NEAR(result.maxError, 0.0f, kNdcTolerance);
+            if (state->isFlat())
+            {
+                CHECK(result.sameSource == result.interior);
+            }
+            sideHits += result.hits;
+        }
+        CHECK(sideHits > 0);
+    }
+}
+
+TEST_CASE(unprojectMisses, "ProjectionState/unprojectNdc rejects sky and off-map pixels")
+{
+    // 低缩放的 Globe：视口角落是天空
+    auto globe = Test::makeState(1.0f, 0.0f, 0.0f, 0.3f);
+    glm::vec2 mercator;
+    CHECK(!globe->unprojectNdc(glm::vec2(0.98f, 0.98f), mercator));
+    CHECK(globe->unprojectNdc(glm::vec2(0.0f, 0.0f), mercator));
+    CHECK_NEAR(mercator.x, globe->getCenterMercX(), 1e-4);
+    CHECK_NEAR(mercator.y, globe->getCenterMercY(), 1e-4);
+    
+    // 平面：中心纬度接近极限时视口顶部超出墨卡托范围
+    auto flat = Test::makeState(0.0f, 0.0f, 84.0f, 2.0f);
+    CHECK(!flat->unprojectNdc(glm::vec2(0.0f, 0.99f), mercator));
+    CHECK(flat->unprojectNdc(glm::vec2(0.0f, -0.5f), mercator));
+}
@@ -0,0 +1,311 @@
+#include "TestHarness.h"
+
+#include "RasterTileLoader.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+void appendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void appendChunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data)
+{
+    appendBigEndian(png, static_cast<uint32_t>(data.size()));
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    appendBigEndian(png, Test::crc32(png.data() + start, png.size() - start));
+}
+
+/**
+ * 编码 RGBA8 的 PNG（每行过滤方式 0，zlib 流只用不压缩的块）
+ */
+std::vector<uint8_t> encodePng(int width, int height, const std::vector<uint8_t>& rgba)
+{
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(width));
+    appendBigEndian(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });
+    
+    std::vector<uint8_t> scanlines;
+    for (int row = 0; row < height; row++)
+    {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgba.begin() + row * width * 4, rgba.begin() + (row + 1) * width * 4);
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : scanlines)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    Test::appendStoredDeflate(zlib, scanlines.data(), scanlines.size());
+    appendBigEndian(zlib, (b << 16) | a);
+    
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlib);
+    appendChunk(png, "IEND", {});
+    return png;
+}
+
+/**
+ * 每个瓦片的像素由坐标决定，解码结果可以逐字节核对
+ */
+std::vector<uint8_t> tilePixels(const TileID& tile, int size)
+{
+    std::vector<uint8_t> rgba;
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            rgba.insert(rgba.end(), { static_cast<uint8_t>(tile.x * 16 + x), static_cast<uint8_t>(tile.y * 16 + y),
+                                      static_cast<uint8_t>(tile.z * 40), static_cast<uint8_t>(255 - x - y) });
+        }
+    }
+    return rgba;
+}
+
+constexpr int kTileSize = 8;
+
+/**
+ * 临时目录下的 z/x/y.png 瓦片，析构时删除
+ */
+struct TileDirectory
+{
+    fs::path root;
+    std::vector<TileID> tiles;
+    
+    TileDirectory()
+    {
+        root = fs::temp_directory_path() /
+               ("GlobeCoreTests-raster-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        for (int z = 0; z <= 2; z++)
+        {
+            for (int x = 0; x < (1 << z); x++)
+            {
+                for (int y = 0; y < (1 << z); y++)
+                {
+                    tiles.push_back(Test::makeTile(z, x, y));
+                    fs::path directory = root / std::to_string(z) / std::to_string(x);
+                    fs::create_directories(directory);
+                    std::vector<uint8_t> png = encodePng(kTileSize, kTileSize, tilePixels(tiles.back(), kTileSize));
+                    std::ofstream file(directory / (std::to_string(y) + ".png"), std::ios::binary);
+                    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+                }
+            }
+        }
+        // 损坏的文件：解码失败而不是数据源读取失败
+        std::ofstream broken(root / "2" / "0" / "0.png", std::ios::binary | std::ios::trunc);
+        broken << "not a png";
+    }
+    
+    ~TileDirectory()
+    {
+        std::error_code error;
+        fs::remove_all(root, error);
+    }
+};
+
+/**
+ * 取出 count 个结果，超时返回已取到的
+ */
+std::vector<DecodedTile> pollAll(RasterTileLoader& loader, size_t count)
+{
+    std::vector<DecodedTile> results;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (results.size() < count && std::chrono::steady_clock::now() < deadline)
+    {
+        DecodedTile tile;
+        if (loader.poll(tile))
+        {
+            results.push_back(std::move(tile));
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    return results;
+}
+
+/**
+ * 占住调度器的全部工作线程，让之后提交的请求停在队列里
+ */
+struct WorkerBlocker
+{
+    std::atomic<bool> release{ false };
+    std::atomic<unsigned> started{ 0 };
+    std::vector<JobSystem::JobHandle> jobs;
+    
+    explicit WorkerBlocker(JobSystem& system)
+    {
+        for (unsigned i = 0; i < system.getThreadCount(); i++)
+        {
+            jobs.push_back(system.schedule([this]() {
+                started++;
+                while (!release)
+                {
+                    std::this_thread::yield();
+                }
+            }, JobSystem::Priority::High));
+        }
+        while (started < system.getThreadCount())
+        {
+            std::this_thread::yield();
+        }
+    }
+};
+} // namespace
+
+TEST_CASE(rasterDecode, "RasterTileLoader/decode round-trips RGBA PNGs and rejects garbage")
+{
+    TileID tile = Test::makeTile(3, 2, 5);
+    std::vector<uint8_t> pixels = tilePixels(tile, kTileSize);
+    std::vector<uint8_t> png = encodePng(kTileSize, kTileSize, pixels);
+    
+    DecodedTile decoded;
+    REQUIRE(RasterTileLoader::decode(png.data(), png.size(), decoded));
+    CHECK(decoded.width == kTileSize);
+    CHECK(decoded.height == kTileSize);
+    CHECK(decoded.pixels == pixels);
+    
+    DecodedTile truncated;
+    CHECK(!RasterTileLoader::decode(png.data(), png.size() / 2, truncated));
+    const uint8_t garbage[] = { 1, 2, 3, 4 };
+    CHECK(!RasterTileLoader::decode(garbage, sizeof(garbage), truncated));
+}
+
+TEST_CASE(rasterLoad, "RasterTileLoader/loads tiles from a directory source on the job system")
+{
+    TileDirectory directory;
+    JobSystem jobs(2);
+    RasterTileLoader::Options options;
+    options.jobSystem = &jobs;
+    RasterTileLoader loader(std::make_shared<DirectoryTileSource>(directory.root.string(), 2), options);
+    
+    for (const TileID& tile : directory.tiles)
+    {
+        CHECK(loader.request(tile, tile.z == 2 ? TilePriority::Prefetch : TilePriority::Visible));
+    }
+    // 数据源中没有的瓦片
+    CHECK(loader.request(Test::makeTile(5, 1, 1)));
+    const size_t expected = directory.tiles.size() + 1;
+    
+    std::vector<DecodedTile> results = pollAll(loader, expected);
+    REQUIRE(results.size() == expected);
+    CHECK(loader.getInFlightCount() == 0);
+    
+    auto find = [&results](const TileID& tile) -> const DecodedTile* {
+        const DecodedTile* found = nullptr;
+        for (const DecodedTile& result : results)
+        {
+            // 每个瓦片只有一个结果
+            CHECK(!(found && result.tile == tile));
+            found = result.tile == tile ? &result : found;
+        }
+        return found;
+    };
+    for (const TileID& tile : directory.tiles)
+    {
+        const DecodedTile* result = find(tile);
+        REQUIRE(result);
+        CHECK(!result->cancelled);
+        CHECK(result->priority == (tile.z == 2 ? TilePriority::Prefetch : TilePriority::Visible));
+        if (tile == Test::makeTile(2, 0, 0))
+        {
+            CHECK(result->failed);
+            continue;
+        }
+        CHECK(!result->failed);
+        CHECK(result->width == kTileSize);
+        CHECK(result->pixels == tilePixels(tile, kTileSize));
+    }
+    const DecodedTile* missing = find(Test::makeTile(5, 1, 1));
+    REQUIRE(missing);
+    CHECK(missing->failed);
+    
+    RasterTileLoader::Stats stats = loader.getStats();
+    CHECK(stats.requested == expected);
+    CHECK(stats.decoded == expected - 2);
+    CHECK(stats.failed == 2);
+    CHECK(stats.delivered == expected);
+    CHECK(stats.decodedBytes == (expected - 2) * kTileSize * kTileSize * 4);
+}
+
+TEST_CASE(rasterCancel, "RasterTileLoader/cancelled requests return without reading or decoding")
+{
+    TileDirectory directory;
+    JobSystem jobs(1);
+    RasterTileLoader::Options options;
+    options.jobSystem = &jobs;
+    RasterTileLoader loader(std::make_shared<DirectoryTileSource>(directory.root.string(), 2), options);
+    
+    // 请求排在被占住的工作线程后面，取消发生在任何解码开始之前
+    auto token = std::make_shared<CancellationToken>();
+    WorkerBlocker blocker(jobs);
+    for (const TileID& tile : directory.tiles)
+    {
+        CHECK(loader.request(tile, TilePriority::Visible, tile.z == 1 ? token : nullptr));
+    }
+    token->cancel();
+    DecodedTile early;
+    CHECK(!loader.poll(early));
+    blocker.release = true;
+    
+    std::vector<DecodedTile> results = pollAll(loader, directory.tiles.size());
+    REQUIRE(results.size() == directory.tiles.size());
+    size_t cancelled = 0;
+    for (const DecodedTile& result : results)
+    {
+        CHECK(result.cancelled == (result.tile.z == 1));
+        if (result.cancelled)
+        {
+            cancelled++;
+            CHECK(result.pixels.empty());
+            CHECK(!result.failed);
+        }
+    }
+    CHECK(cancelled == 4);
+    RasterTileLoader::Stats stats = loader.getStats();
+    CHECK(stats.cancelled == 4);
+    CHECK(stats.decoded + stats.failed == directory.tiles.size() - 4);
+}
+
+TEST_CASE(rasterBackpressure, "RasterTileLoader/rejects requests beyond the queue capacity until results are polled")
+{
+    TileDirectory directory;
+    JobSystem jobs(1);
+    RasterTileLoader::Options options;
+    options.jobSystem = &jobs;
+    options.queueCapacity = 2;
+    RasterTileLoader loader(std::make_shared<DirectoryTileSource>(directory.root.string(), 2), options);
+    
+    WorkerBlocker blocker(jobs);
+    CHECK(loader.request(Test::makeTile(0, 0, 0)));
+    CHECK(loader.request(Test::makeTile(1, 0, 0)));
+    CHECK(!loader.request(Test::makeTile(1, 1, 0)));
+    CHECK(loader.getInFlightCount() == 2);
+    CHECK(loader.getStats().rejected == 1);
+    blocker.release = true;
+    
+    std::vector<DecodedTile> results = pollAll(loader, 2);
+    CHECK(results.size() == 2);
+    CHECK(loader.request(Test::makeTile(1, 1, 0)));
+    results = pollAll(loader, 1);
+    REQUIRE(results.size() == 1);
+    CHECK(results[0].tile == Test::makeTile(1, 1, 0));
+    CHECK(!results[0].failed);
+}
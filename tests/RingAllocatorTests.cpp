@@ -0,0 +1,163 @@
+#include "TestHarness.h"
+
+#include "RingAllocator.h"
+
+TEST_CASE(ringAllocatorRejects, "RingAllocator/rejects empty rings and oversized allocations")
+{
+    RingAllocator empty;
+    CHECK(empty.getCapacity() == 0);
+    CHECK(empty.allocate(16, 16) == RingAllocator::kInvalidOffset);
+    CHECK(empty.getStats().failures == 1);
+    
+    // 容量向上取整为 kMaxAlignment 的倍数
+    RingAllocator ring(1000);
+    CHECK(ring.getCapacity() == 1024);
+    CHECK(ring.allocate(1025, 16) == RingAllocator::kInvalidOffset);
+    CHECK(ring.allocate(1024, 16) == 0);
+    CHECK(ring.getStats().failures == 1);
+    CHECK(ring.getStats().allocations == 1);
+}
+
+TEST_CASE(ringAllocatorWrap, "RingAllocator/wraps to the start and counts the skipped tail as demand")
+{
+    RingAllocator ring(1024);
+    CHECK(ring.allocate(700, 16) == 0);
+    CHECK(ring.endFrame() == 0);
+    ring.retire(0);
+    CHECK(ring.getFramesInFlight() == 0);
+    CHECK(ring.getUsedBytes() == 0);
+    
+    // 对齐到 704 后尾部只剩 320 字节：跳到开头
+    CHECK(ring.allocate(400, 16) == 0);
+    CHECK(ring.getStats().wraps == 1);
+    // 本帧用量 = 4（对齐）+ 320（跳过的尾部）+ 400
+    CHECK(ring.getPeakFrameBytes() == 724);
+    CHECK(ring.getUsedBytes() == 724);
+    CHECK(ring.endFrame() == 1);
+    CHECK(ring.getPeakFrameBytes() == 724);
+    
+    // 跳过的尾部属于帧 1：帧 1 retire 之前 768 放不下
+    CHECK(ring.allocate(1, 256) == 512);
+    CHECK(ring.allocate(1, 256) == RingAllocator::kInvalidOffset);
+    CHECK(ring.endFrame() == 2);
+    ring.retire(2);
+    
+    // 对齐同样计入用量
+    CHECK(ring.allocate(1, 256) == 768);
+    CHECK(ring.getPeakFrameBytes() == 724);
+    CHECK(ring.allocate(1, 4) == 772);
+    CHECK(ring.endFrame() == 3);
+    CHECK(ring.getStats().wraps == 1);
+    CHECK(ring.getStats().allocations == 5);
+}
+
+TEST_CASE(ringAllocatorOverlap, "RingAllocator/fails on overlap with frames in flight until they retire")
+{
+    RingAllocator ring(1024);
+    CHECK(ring.allocate(700, 16) == 0);
+    CHECK(ring.endFrame() == 0);
+    CHECK(ring.getOldestFrameInFlight() == 0);
+    
+    // 跳到开头会覆盖帧 0 的数据
+    CHECK(ring.allocate(400, 16) == RingAllocator::kInvalidOffset);
+    CHECK(ring.getStats().failures == 1);
+    CHECK(ring.getStats().wraps == 0);
+    // 尾部放得下的分配不受影响
+    CHECK(ring.allocate(300, 16) == 704);
+    CHECK(ring.endFrame() == 1);
+    CHECK(ring.getFramesInFlight() == 2);
+    CHECK(ring.getUsedBytes() == 1004);
+    
+    // 还没有 retire 任何帧：尾部放不下时也不能跳到开头
+    CHECK(ring.allocate(32, 16) == RingAllocator::kInvalidOffset);
+    
+    // retire 帧 0 后开头的 700 字节可以复用（帧 1 仍然在途）
+    ring.retire(0);
+    CHECK(ring.getFramesInFlight() == 1);
+    CHECK(ring.getOldestFrameInFlight() == 1);
+    CHECK(ring.getUsedBytes() == 304);
+    CHECK(ring.allocate(720, 16) == RingAllocator::kInvalidOffset);
+    CHECK(ring.allocate(400, 16) == 0);
+    CHECK(ring.getStats().wraps == 1);
+    CHECK(ring.endFrame() == 2);
+    
+    // retire 会一次回收所有不大于帧号的帧
+    ring.retire(5);
+    CHECK(ring.getFramesInFlight() == 0);
+    CHECK(ring.getUsedBytes() == 0);
+    CHECK(ring.getOldestFrameInFlight() == 3);
+    // 从 400 开始填满尾部，再跳到开头
+    CHECK(ring.allocate(624, 16) == 400);
+    CHECK(ring.allocate(400, 16) == 0);
+    CHECK(ring.getUsedBytes() == 1024);
+}
+
+TEST_CASE(ringAllocatorReset, "RingAllocator/reset keeps the bytes already allocated in the current frame")
+{
+    RingAllocator ring(1024);
+    CHECK(ring.allocate(512, 256) == 0);
+    CHECK(ring.endFrame() == 0);
+    CHECK(ring.allocate(500, 4) == 512);
+    
+    // 扩容丢弃在途的帧，但帧号继续递增
+    ring.reset(2000);
+    CHECK(ring.getCapacity() == 2048);
+    CHECK(ring.getFramesInFlight() == 0);
+    CHECK(ring.getUsedBytes() == 0);
+    CHECK(ring.getPeakFrameBytes() == 512);
+    
+    CHECK(ring.allocate(100, 4) == 0);
+    CHECK(ring.getPeakFrameBytes() == 600);
+    CHECK(ring.endFrame() == 1);
+    CHECK(ring.getPeakFrameBytes() == 600);
+    
+    // 下一帧不再带上 reset 之前的用量
+    CHECK(ring.allocate(64, 4) == 100);
+    CHECK(ring.endFrame() == 2);
+    CHECK(ring.getPeakFrameBytes() == 600);
+    CHECK(ring.requiredCapacity(2) == 1792);    // 2 * 600 + 500 向上取整到 256 的倍数
+}
+
+TEST_CASE(ringAllocatorDemandWindow, "RingAllocator/peak and required capacity cover the last kDemandWindow frames")
+{
+    // 大小都是 kMaxAlignment 的倍数，容量也是它们的倍数：既没有对齐也没有跳转浪费
+    constexpr size_t kLarge = 10 * 1024;
+    constexpr size_t kSmall = 1024;
+    RingAllocator ring(1 << 20);
+    
+    uint64_t frame = 0;
+    auto runFrame = [&](size_t bytes) {
+        CHECK(ring.allocate(bytes) != RingAllocator::kInvalidOffset);
+        frame = ring.endFrame();
+        ring.retire(frame);
+    };
+    
+    runFrame(kLarge);
+    for (size_t i = 1; i < RingAllocator::kDemandWindow; i++)
+    {
+        runFrame(kSmall);
+    }
+    CHECK(frame == RingAllocator::kDemandWindow - 1);
+    CHECK(ring.getPeakFrameBytes() == kLarge);
+    CHECK(ring.requiredCapacity(3) == 3 * kLarge + kLarge);
+    CHECK(ring.requiredCapacity(0) == kLarge);
+    
+    // 大帧移出统计窗口
+    runFrame(kSmall);
+    CHECK(ring.getPeakFrameBytes() == kSmall);
+    CHECK(ring.requiredCapacity(3) == 3 * kSmall + kSmall);
+    
+    // 进行中的一帧也计入
+    CHECK(ring.allocate(2 * kSmall) != RingAllocator::kInvalidOffset);
+    CHECK(ring.getPeakFrameBytes() == 2 * kSmall);
+    CHECK(ring.requiredCapacity(2) == 2 * 2 * kSmall + 2 * kSmall);
+    
+    // 跑满整个环以上仍然没有失败或浪费
+    for (size_t i = 0; i < 8 * RingAllocator::kDemandWindow; i++)
+    {
+        runFrame(kSmall);
+    }
+    CHECK(ring.getStats().failures == 0);
+    CHECK(ring.getStats().wraps == 0);
+    CHECK(ring.getPeakFrameBytes() == kSmall);
+}
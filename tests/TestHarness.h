@@ -0,0 +1,143 @@
+#pragma once
+#include "GlobeProjection.h"
+#include "ProjectionState.h"
+#include "TileID.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * 单元测试的最小框架（不依赖第三方库，也不依赖 GL）
+ *
+ * - TEST_CASE(函数名, "分组/描述") 定义并注册一个用例
+ * - CHECK 失败时记录位置和表达式后继续执行；REQUIRE 失败时结束当前用例
+ * - CHECK_NEAR 比较浮点数，失败时输出两边的值
+ *
+ * - makeTile、makeState 等各分组共用的构造辅助也放在这里，crc32 / appendStoredDeflate 用来
+ *   在测试里直接写出 PNG、gzip 等压缩格式（只用不压缩的块，不需要 zlib）
+ *
+ * 运行：GlobeCoreTests [名字子串]，只运行名字包含该子串的用例；有失败时返回 1
+ */
+namespace Test
+{
+struct Case
+{
+    const char* name;
+    void (*run)();
+};
+
+std::vector<Case>& registry();
+
+struct Registrar
+{
+    Registrar(const char* name, void (*run)()) { registry().push_back({ name, run }); }
+};
+
+// REQUIRE 失败时抛出，由 main 捕获并结束当前用例
+struct Abort
+{
+};
+
+void fail(const char* file, int line, const std::string& message);
+
+inline TileID makeTile(int z, int x, int y, int wrap = 0)
+{
+    TileID tile;
+    tile.z = z;
+    tile.x = x;
+    tile.y = y;
+    tile.wrap = wrap;
+    return tile;
+}
+
+inline std::shared_ptr<const ProjectionState> makeState(float transition, float centerLon, float centerLat, float zoom,
+                                                        float aspect = 16.0f / 9.0f)
+{
+    GlobeProjection projection;
+    projection.transition = transition;
+    projection.centerLon = centerLon;
+    projection.centerLat = centerLat;
+    projection.zoom = zoom;
+    return projection.getState(aspect);
+}
+
+inline uint32_t crc32(const uint8_t* bytes, size_t size, uint32_t crc = 0)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * 追加 bytes 的 raw deflate 流（全部为不压缩的块，最后一块带结束标记）
+ */
+inline void appendStoredDeflate(std::vector<uint8_t>& out, const uint8_t* bytes, size_t size)
+{
+    size_t offset = 0;
+    do
+    {
+        size_t length = std::min<size_t>(size - offset, 65535);
+        bool last = offset + length == size;
+        out.push_back(last ? 1 : 0);
+        out.push_back(static_cast<uint8_t>(length));
+        out.push_back(static_cast<uint8_t>(length >> 8));
+        out.push_back(static_cast<uint8_t>(~length));
+        out.push_back(static_cast<uint8_t>(~length >> 8));
+        out.insert(out.end(), bytes + offset, bytes + offset + length);
+        offset += length;
+    } while (offset < size);
+}
+
+template <typename A, typename B>
+std::string describeNear(const char* expression, const A& a, const B& b, double tolerance)
+{
+    std::ostringstream stream;
+    stream << expression << " (" << a << " vs " << b << ", tolerance " << tolerance << ")";
+    return stream.str();
+}
+} // namespace Test
+
+#define TEST_CASE(function, name)                                     \
+    static void function();                                           \
+    static const Test::Registrar function##Registrar(name, function); \
+    static void function()
+
+#define CHECK(condition)                                   \
+    do                                                     \
+    {                                                      \
+        if (!(condition))                                  \
+        {                                                  \
+            Test::fail(__FILE__, __LINE__, #condition);    \
+        }                                                  \
+    } while (0)
+
+#define REQUIRE(condition)                                 \
+    do                                                     \
+    {                                                      \
+        if (!(condition))                                  \
+        {                                                  \
+            Test::fail(__FILE__, __LINE__, #condition);    \
+            throw Test::Abort();                           \
+        }                                                  \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance)                                                                      \
+    do                                                                                                   \
+    {                                                                                                    \
+        if (!(std::abs(static_cast<double>(a) - static_cast<double>(b)) <= (tolerance)))                 \
+        {                                                                                                \
+            Test::fail(__FILE__, __LINE__, Test::describeNear(#a " == " #b, (a), (b), (tolerance)));     \
+        }                                                                                                \
+    } while (0)
@@ -0,0 +1,59 @@
+#include "TestHarness.h"
+
+#include <exception>
+#include <iostream>
+
+namespace
+{
+// 当前用例的失败数，以及只报告前几条失败（循环中的 CHECK 可能失败很多次）
+size_t caseFailures = 0;
+constexpr size_t kReportedFailures = 10;
+} // namespace
+
+std::vector<Test::Case>& Test::registry()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void Test::fail(const char* file, int line, const std::string& message)
+{
+    if (caseFailures++ < kReportedFailures)
+    {
+        std::cout << "  " << file << ":" << line << ": " << message << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+    size_t run = 0, failed = 0;
+    for (const Test::Case& testCase : Test::registry())
+    {
+        if (std::string(testCase.name).find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        std::cout << testCase.name << "\n";
+        caseFailures = 0;
+        try
+        {
+            testCase.run();
+        }
+        catch (const Test::Abort&)
+        {
+        }
+        catch (const std::exception& exception)
+        {
+            Test::fail(__FILE__, __LINE__, std::string("unexpected exception: ") + exception.what());
+        }
+        if (caseFailures > kReportedFailures)
+        {
+            std::cout << "  ... " << caseFailures - kReportedFailures << " more\n";
+        }
+        run++;
+        failed += caseFailures > 0 ? 1 : 0;
+    }
+    std::cout << run - failed << "/" << run << " test cases passed\n";
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+#include "TestHarness.h"
+
+#include "CoveringTiles.h"
+#include "GlobeProjection.h"
+#include "TileGeometryCache.h"
+#include "TileInstanceBuffer.h"
+#include "TileMesh.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// 查表计算与 shader 逐顶点计算的 float 误差（单位球坐标）
+constexpr float kSphereTolerance = 2e-6f;
+
+size_t slotBytes(const TileMesh& mesh)
+{
+    return mesh.getLod(TileMesh::kLodCount - 1).vertexCount * 3 * sizeof(float);
+}
+} // namespace
+
+TEST_CASE(computeTileMatchesShader, "TileGeometryCache/computeTile matches projectToSphereReference")
+{
+    TileMesh mesh;
+    const TileID tiles[] = { Test::makeTile(0, 0, 0), Test::makeTile(3, 5, 2), Test::makeTile(6, 10, 1),
+                             Test::makeTile(6, 63, 62), Test::makeTile(12, 2047, 2048) };
+    std::vector<float> positions(mesh.getLod(TileMesh::kLodCount - 1).vertexCount * 3);
+    for (const TileID& tile : tiles)
+    {
+        for (int lod = 0; lod < TileMesh::kLodCount; lod++)
+        {
+            const TileMesh::Lod& meshLod = mesh.getLod(lod);
+            TileGeometryCache::computeTile(mesh, tile, lod, positions.data());
+            
+            // shader 使用带 wrap 的墨卡托坐标，球面坐标与 wrap 无关
+            float numTiles = ProjectionState::tileCount(tile.z);
+            for (int wrap = -1; wrap <= 1; wrap++)
+            {
+                glm::vec4 coords((tile.x + wrap * numTiles) / numTiles, tile.y / numTiles,
+                                 1.0f / numTiles / Constants::TILE_EXTENT, 1.0f / numTiles / Constants::TILE_EXTENT);
+                float maxError = 0.0f;
+                for (uint32_t v = 0; v < meshLod.vertexCount; v++)
+                {
+                    const uint16_t* vertex = &mesh.getVertices()[(meshLod.baseVertex + v) * 2];
+                    glm::vec3 expected = TileGeometryCache::projectToSphereReference(coords, glm::vec2(vertex[0], vertex[1]));
+                    glm::vec3 actual(positions[v * 3 + 0], positions[v * 3 + 1], positions[v * 3 + 2]);
+                    maxError = std::max(maxError, glm::length(actual - expected));
+                }
+                // wrap != 0 时参考实现的经度多了 ±2π，float 的舍入误差随之增大
+                CHECK_NEAR(maxError, 0.0f, wrap == 0 ? kSphereTolerance : 4.0f * kSphereTolerance);
+            }
+        }
+    }
+}
+
+TEST_CASE(slotsPackedAtFixedStride, "TileGeometryCache/slots are packed at a fixed stride")
+{
+    TileMesh mesh;
+    TileGeometryCache cache(mesh, 10 * slotBytes(mesh) + 1);
+    CHECK(cache.getSlotVertexCount() == mesh.getLod(TileMesh::kLodCount - 1).vertexCount);
+    REQUIRE(cache.getSlotCount() == 10);
+    CHECK(cache.getPositionsSizeInBytes() == 10 * slotBytes(mesh));
+    for (int slot = 0; slot < cache.getSlotCount(); slot++)
+    {
+        CHECK(cache.slotFirstVertex(slot) == static_cast<uint32_t>(slot) * cache.getSlotVertexCount());
+    }
+    
+    // 预算小于一个 slot 时仍然保留一个
+    TileGeometryCache tiny(mesh, 1);
+    CHECK(tiny.getSlotCount() == 1);
+}
+
+TEST_CASE(instanceOffsetsAddressSlots, "TileGeometryCache/instance offsets address the computed slot positions")
+{
+    TileMesh mesh;
+    TileGeometryCache cache(mesh);
+    CoveringTiles coveringTiles;
+    GlobeProjection projection;
+    projection.transition = 0.6f;
+    projection.centerLon = 150.0f;
+    projection.centerLat = 55.0f;
+    projection.zoom = 3.0f;
+    auto state = projection.getState(16.0f / 9.0f);
+    std::vector<TileID> tiles = coveringTiles.select(*state);
+    REQUIRE(!tiles.empty());
+    
+    cache.beginFrame();
+    TileInstanceBuffer buffer;
+    buffer.build(*state, tiles, &cache);
+    const std::vector<int>& computed = cache.computePending();
+    CHECK(computed.size() == cache.getStats().misses);
+    
+    REQUIRE(cache.getStats().failures == 0);
+    
+    std::vector<float> expected(cache.getSlotVertexCount() * 3);
+    size_t negativeOffsets = 0;
+    for (int lod = 0; lod < TileMesh::kLodCount; lod++)
+    {
+        const TileInstanceBuffer::Range& range = buffer.getLodRange(lod);
+        const TileMesh::Lod& meshLod = mesh.getLod(lod);
+        for (uint32_t i = range.first; i < range.first + range.count; i++)
+        {
+            // 每个实例都分配到了 slot，shader 必须走缓存路径（由 z 标记，与偏移的符号无关），
+            // 按 gl_VertexID（含 baseVertex）+ resources.x 读取球面坐标
+            const TileInstance& instance = buffer[i];
+            CHECK(instance.resources.z == 1);
+            negativeOffsets += instance.resources.x < 0 ? 1 : 0;
+            int vertex = instance.resources.x + static_cast<int>(meshLod.baseVertex);
+            REQUIRE(vertex >= 0);
+            uint32_t firstVertex = static_cast<uint32_t>(vertex);
+            CHECK(firstVertex % cache.getSlotVertexCount() == 0);
+            REQUIRE(firstVertex / cache.getSlotVertexCount() < static_cast<uint32_t>(cache.getSlotCount()));
+            
+            TileID tile = { instance.tileID.x, instance.tileID.y, instance.tileID.z, instance.tileID.w };
+            TileGeometryCache::computeTile(mesh, tile, lod, expected.data());
+            const float* actual = cache.getPositions() + firstVertex * 3;
+            CHECK(std::equal(expected.begin(), expected.begin() + meshLod.vertexCount * 3, actual));
+        }
+    }
+    // 靠前的 slot 用于 baseVertex 较大的 LOD 时偏移为负，同样使用缓存
+    CHECK(negativeOffsets > 0);
+}
+
+TEST_CASE(uncachedInstancesFallBackToShader, "TileGeometryCache/instances without a slot are marked for shader projection")
+{
+    TileMesh mesh;
+    TileGeometryCache cache(mesh, 2 * slotBytes(mesh));
+    GlobeProjection projection;
+    projection.transition = 1.0f;
+    projection.zoom = 2.0f;
+    auto state = projection.getState(16.0f / 9.0f);
+    std::vector<TileID> tiles = CoveringTiles().select(*state);
+    REQUIRE(tiles.size() > 2);
+    
+    cache.beginFrame();
+    TileInstanceBuffer buffer;
+    buffer.build(*state, tiles, &cache);
+    size_t cached = 0;
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        const glm::ivec4& resources = buffer[i].resources;
+        CHECK(resources.z == 0 || resources.z == 1);
+        if (resources.z == 1)
+        {
+            cached++;
+        }
+        else
+        {
+            CHECK(resources.x == -1);
+        }
+    }
+    CHECK(cached == 2);
+    CHECK(cache.getStats().failures == tiles.size() - 2);
+    
+    // 不传几何缓存时全部由 shader 现算
+    buffer.build(*state, tiles);
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        CHECK(buffer[i].resources.z == 0);
+    }
+}
+
+TEST_CASE(geometryCacheHitsAndEviction, "TileGeometryCache/hits, wrap sharing, LRU eviction and frame pinning")
+{
+    TileMesh mesh;
+    TileGeometryCache cache(mesh, 2 * slotBytes(mesh));
+    REQUIRE(cache.getSlotCount() == 2);
+    const TileID a = Test::makeTile(2, 1, 1), b = Test::makeTile(2, 2, 1), c = Test::makeTile(2, 3, 1);
+    
+    cache.beginFrame();
+    int slotA = cache.acquire(a, 0);
+    int slotB = cache.acquire(b, 0);
+    CHECK(slotA >= 0);
+    CHECK(slotB >= 0);
+    CHECK(slotA != slotB);
+    CHECK(cache.computePending().size() == 2);
+    
+    // 同一帧内再次获取和其他世界副本都命中同一个 slot，不再计算
+    CHECK(cache.acquire(Test::makeTile(2, 1, 1, -1), 0) == slotA);
+    CHECK(cache.acquire(Test::makeTile(2, 1, 1, 2), 0) == slotA);
+    CHECK(cache.computePending().empty());
+    CHECK(cache.getStats().hits == 2);
+    CHECK(cache.getStats().misses == 2);
+    
+    // 不同 LOD 是不同的 key；两个 slot 都在本帧使用过，无法分配
+    CHECK(cache.acquire(a, 1) == -1);
+    CHECK(cache.getStats().failures == 1);
+    
+    // 下一帧只使用 b：c 淘汰最久未使用的 a
+    cache.beginFrame();
+    CHECK(cache.acquire(b, 0) == slotB);
+    CHECK(cache.acquire(c, 0) == slotA);
+    CHECK(cache.getStats().evictions == 1);
+    const std::vector<int>& computed = cache.computePending();
+    REQUIRE(computed.size() == 1);
+    CHECK(computed[0] == slotA);
+    
+    std::vector<float> expected(cache.getSlotVertexCount() * 3);
+    TileGeometryCache::computeTile(mesh, c, 0, expected.data());
+    const float* actual = cache.getPositions() + cache.slotFirstVertex(slotA) * 3;
+    CHECK(std::equal(expected.begin(), expected.begin() + mesh.getLod(0).vertexCount * 3, actual));
+    
+    // a 已被淘汰，重新获取是一次未命中
+    cache.beginFrame();
+    size_t misses = cache.getStats().misses;
+    CHECK(cache.acquire(a, 0) >= 0);
+    CHECK(cache.getStats().misses == misses + 1);
+}
@@ -0,0 +1,109 @@
+#include "TestHarness.h"
+
+#include "CoveringTiles.h"
+#include "GlobeProjection.h"
+#include "TileInstanceBuffer.h"
+#include "TileMesh.h"
+#include <cstddef>
+#include <memory>
+
+namespace
+{
+// 平面、过渡和 Globe 状态各取一个，Globe 状态朝向高纬以覆盖多个 LOD
+std::vector<std::shared_ptr<const ProjectionState>> testStates()
+{
+    return { Test::makeState(0.0f, 10.0f, 20.0f, 2.5f), Test::makeState(0.5f, -40.0f, 30.0f, 3.0f),
+             Test::makeState(1.0f, 120.0f, 70.0f, 3.5f) };
+}
+} // namespace
+
+TEST_CASE(instanceLayoutMatchesAttributes, "TileInstanceBuffer/layout matches the instanced vertex attributes")
+{
+    // TileRenderer 按这些偏移设置 instanced 属性，改动结构体时必须同步修改
+    CHECK(sizeof(TileInstance) == 144);
+    CHECK(offsetof(TileInstance, mercatorMatrix) == 0);
+    CHECK(offsetof(TileInstance, tileMercatorCoords) == 64);
+    CHECK(offsetof(TileInstance, color) == 80);
+    CHECK(offsetof(TileInstance, tileID) == 96);
+    CHECK(offsetof(TileInstance, resources) == 112);
+    CHECK(offsetof(TileInstance, textureRect) == 128);
+}
+
+TEST_CASE(instancesMatchProjectionState, "TileInstanceBuffer/instances match ProjectionState for every tile")
+{
+    CoveringTiles coveringTiles;
+    for (const auto& state : testStates())
+    {
+        std::vector<TileID> tiles = coveringTiles.select(*state);
+        REQUIRE(!tiles.empty());
+        TileInstanceBuffer buffer;
+        buffer.build(*state, tiles);
+        REQUIRE(buffer.size() == tiles.size());
+        CHECK(buffer.sizeInBytes() == tiles.size() * sizeof(TileInstance));
+        CHECK(static_cast<const void*>(buffer.data()) == static_cast<const void*>(&buffer[0]));
+        
+        // 每个 LOD 的范围首尾相接覆盖全部实例，范围内保持 tile 的原有顺序
+        uint32_t next = 0;
+        for (int lod = 0; lod < TileMesh::kLodCount; lod++)
+        {
+            const TileInstanceBuffer::Range& range = buffer.getLodRange(lod);
+            CHECK(range.first == next);
+            next = range.first + range.count;
+            
+            uint32_t position = range.first;
+            for (const TileID& tile : tiles)
+            {
+                if (TileMesh::selectLod(*state, tile) != lod)
+                {
+                    continue;
+                }
+                REQUIRE(position < range.first + range.count);
+                const TileInstance& instance = buffer[position++];
+                CHECK(instance.tileID == glm::ivec4(tile.x, tile.y, tile.z, tile.wrap));
+                CHECK(instance.mercatorMatrix == state->mercatorMatrix(tile));
+                CHECK(instance.tileMercatorCoords == state->tileMercatorCoords(tile));
+                CHECK(instance.color == TileInstanceBuffer::tileColor(tile));
+                CHECK(instance.resources == glm::ivec4(-1, -1, 0, 0));
+                CHECK(instance.textureRect == glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+            }
+            CHECK(position == range.first + range.count);
+        }
+        CHECK(next == tiles.size());
+        
+        if (state->isFlat())
+        {
+            CHECK(buffer.getLodRange(0).count == tiles.size());
+        }
+    }
+}
+
+TEST_CASE(instanceBufferRebuildAndClear, "TileInstanceBuffer/rebuild and clear reset the LOD ranges")
+{
+    CoveringTiles coveringTiles;
+    std::vector<std::shared_ptr<const ProjectionState>> states = testStates();
+    TileInstanceBuffer buffer;
+    buffer.build(*states[2], coveringTiles.select(*states[2]));
+    
+    // 复用同一个缓冲区构建平面状态：全部落在 LOD 0，之前的范围不残留
+    std::vector<TileID> flatTiles = coveringTiles.select(*states[0]);
+    buffer.build(*states[0], flatTiles);
+    CHECK(buffer.size() == flatTiles.size());
+    CHECK(buffer.getLodRange(0).first == 0);
+    CHECK(buffer.getLodRange(0).count == flatTiles.size());
+    for (int lod = 1; lod < TileMesh::kLodCount; lod++)
+    {
+        CHECK(buffer.getLodRange(lod).count == 0);
+        CHECK(buffer.getLodRange(lod).first == flatTiles.size());
+    }
+    
+    buffer.clear();
+    CHECK(buffer.size() == 0);
+    CHECK(buffer.sizeInBytes() == 0);
+    for (int lod = 0; lod < TileMesh::kLodCount; lod++)
+    {
+        CHECK(buffer.getLodRange(lod).count == 0);
+    }
+    
+    buffer.build(*states[0], {});
+    CHECK(buffer.size() == 0);
+}
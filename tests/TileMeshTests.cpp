@@ -0,0 +1,132 @@
+#include "TestHarness.h"
+
+#include "Constants.h"
+#include "TileMesh.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using Triangle = std::array<float, 6>;
+
+/**
+ * 原 TileRenderer::createTileMesh 的输出（未索引的三角形列表，每个顶点 x, y）
+ */
+std::vector<float> createTileMesh(int divisions)
+{
+    std::vector<float> verts;
+    float step = Constants::TILE_EXTENT / (float)divisions;
+    
+    for (int y = 0; y < divisions; y++)
+    {
+        for (int x = 0; x < divisions; x++)
+        {
+            float x0 = x * step;
+            float y0 = y * step;
+            float x1 = (x + 1) * step;
+            float y1 = (y + 1) * step;
+            
+            // 两个三角形
+            verts.insert(verts.end(), {x0, y0, x1, y0, x0, y1});
+            verts.insert(verts.end(), {x1, y0, x1, y1, x0, y1});
+        }
+    }
+    return verts;
+}
+
+// 三角形按原顶点顺序比较（绕序和起始顶点都必须相同），与三角形的先后顺序无关
+std::vector<Triangle> sortedTriangles(const std::vector<float>& soup)
+{
+    std::vector<Triangle> triangles(soup.size() / 6);
+    for (size_t i = 0; i < triangles.size(); i++)
+    {
+        std::copy(soup.begin() + i * 6, soup.begin() + i * 6 + 6, triangles[i].begin());
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+std::vector<float> expandIndexed(const uint16_t* vertices, const uint16_t* indices, size_t indexCount)
+{
+    std::vector<float> soup;
+    soup.reserve(indexCount * 2);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        soup.push_back(vertices[indices[i] * 2 + 0]);
+        soup.push_back(vertices[indices[i] * 2 + 1]);
+    }
+    return soup;
+}
+
+void checkGrid(int divisions, const uint16_t* vertices, uint32_t vertexCount, const uint16_t* indices, uint32_t indexCount)
+{
+    CHECK(vertexCount == static_cast<uint32_t>((divisions + 1) * (divisions + 1)));
+    CHECK(indexCount == static_cast<uint32_t>(divisions * divisions * 6));
+    
+    // 顶点按首次使用顺序编号：第 i 个新出现的下标必须是 i，因此也不会有未使用的顶点
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < indexCount; i++)
+    {
+        REQUIRE(indices[i] < vertexCount);
+        CHECK(indices[i] <= next);
+        if (indices[i] == next)
+        {
+            next++;
+        }
+    }
+    CHECK(next == vertexCount);
+    
+    CHECK(sortedTriangles(expandIndexed(vertices, indices, indexCount)) == sortedTriangles(createTileMesh(divisions)));
+}
+} // namespace
+
+TEST_CASE(meshLodsMatchCreateTileMesh, "TileMesh/every LOD matches createTileMesh triangle for triangle")
+{
+    TileMesh mesh;
+    int divisions = TileMesh::kMinDivisions;
+    for (int level = 0; level < TileMesh::kLodCount; level++, divisions *= 2)
+    {
+        const TileMesh::Lod& lod = mesh.getLod(level);
+        CHECK(lod.divisions == divisions);
+        REQUIRE((lod.baseVertex + lod.vertexCount) * 2 <= mesh.getVertices().size());
+        REQUIRE(lod.firstIndex + lod.indexCount <= mesh.getIndices().size());
+        checkGrid(divisions, mesh.getVertices().data() + lod.baseVertex * 2, lod.vertexCount,
+                  mesh.getIndices().data() + lod.firstIndex, lod.indexCount);
+    }
+    
+    // 各 LOD 首尾相接打包
+    const TileMesh::Lod& last = mesh.getLod(TileMesh::kLodCount - 1);
+    CHECK((last.baseVertex + last.vertexCount) * 2 == mesh.getVertices().size());
+    CHECK(last.firstIndex + last.indexCount == mesh.getIndices().size());
+}
+
+TEST_CASE(optimizedGridMatchesForAnyDivisions, "TileMesh/optimizeGrid keeps the triangles and lowers ACMR")
+{
+    // 包括不是 2 的幂、不能被带宽整除的细分数；这些细分数的顶点坐标被截断为整数，
+    // 与重排前的网格比较，2 的幂再与 createTileMesh 比较
+    for (int divisions = 1; divisions <= 64; divisions++)
+    {
+        std::vector<uint16_t> vertices, indices;
+        TileMesh::buildGrid(divisions, vertices, indices);
+        std::vector<Triangle> rowMajorTriangles = sortedTriangles(expandIndexed(vertices.data(), indices.data(), indices.size()));
+        float rowMajor = TileMesh::averageCacheMissRatio(indices, 0, indices.size(), TileMesh::kVertexCacheSize);
+        TileMesh::optimizeGrid(divisions, vertices, indices);
+        float optimized = TileMesh::averageCacheMissRatio(indices, 0, indices.size(), TileMesh::kVertexCacheSize);
+        
+        CHECK(sortedTriangles(expandIndexed(vertices.data(), indices.data(), indices.size())) == rowMajorTriangles);
+        if (Constants::TILE_EXTENT % divisions == 0)
+        {
+            checkGrid(divisions, vertices.data(), static_cast<uint32_t>(vertices.size() / 2), indices.data(),
+                      static_cast<uint32_t>(indices.size()));
+        }
+        CHECK(optimized <= rowMajor);
+        if (divisions >= TileMesh::kVertexCacheSize)
+        {
+            // 行优先遍历每格都要重新读取上一行的顶点（约 1 次未命中 / 三角形），列带把它压到 0.5 附近
+            CHECK(optimized < 0.7f);
+            CHECK(rowMajor > 0.9f);
+        }
+    }
+}
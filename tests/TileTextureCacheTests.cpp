@@ -0,0 +1,132 @@
+#include "TestHarness.h"
+
+#include "TileTextureCache.h"
+#include <cmath>
+
+namespace
+{
+constexpr size_t kSlotBytes = 256 * 256 * 4;
+} // namespace
+
+TEST_CASE(textureCacheConfigure, "TileTextureCache/configure sizes the slots from the budget")
+{
+    TileTextureCache cache;
+    CHECK(!cache.isConfigured());
+    cache.configure(10 * kSlotBytes + kSlotBytes / 2, kSlotBytes, 64);
+    CHECK(cache.isConfigured());
+    CHECK(cache.getSlotCount() == 10);
+    CHECK(cache.getMemoryBudget() == 10 * kSlotBytes);
+    
+    cache.configure(100 * kSlotBytes, kSlotBytes, 16);
+    CHECK(cache.getSlotCount() == 16);
+    
+    // 重新配置清空内容
+    cache.insert(Test::makeTile(1, 0, 0));
+    cache.configure(100 * kSlotBytes, kSlotBytes, 16);
+    CHECK(cache.getResidentCount() == 0);
+    CHECK(!cache.contains(Test::makeTile(1, 0, 0)));
+    
+    cache.configure(100 * kSlotBytes, 0, 16);
+    CHECK(!cache.isConfigured());
+}
+
+TEST_CASE(textureCacheResolve, "TileTextureCache/resolve hits, falls back to ancestors and shares wraps")
+{
+    TileTextureCache cache;
+    cache.configure(8 * kSlotBytes, kSlotBytes, 8);
+    cache.beginFrame();
+    
+    // 其他世界副本插入的瓦片与 wrap 0 共用 slot
+    int slot = cache.insert(Test::makeTile(2, 1, 2, -1));
+    REQUIRE(slot >= 0);
+    CHECK(cache.contains(Test::makeTile(2, 1, 2)));
+    CHECK(cache.insert(Test::makeTile(2, 1, 2, 1)) == slot);
+    CHECK(cache.getResidentCount() == 1);
+    CHECK(cache.getResidentBytes() == kSlotBytes);
+    
+    TileTextureCache::Resolved self = cache.resolve(Test::makeTile(2, 1, 2, 3));
+    CHECK(self.slot == slot);
+    CHECK(self.source == Test::makeTile(2, 1, 2));
+    CHECK(self.textureRect == glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+    CHECK(cache.getStats().hits == 1);
+    
+    // z4 (5, 10) -> z3 (2, 5) -> z2 (1, 2)：两级祖先，x 的低两位 01、y 的低两位 10
+    TileTextureCache::Resolved fallback = cache.resolve(Test::makeTile(4, 5, 10, 1));
+    CHECK(fallback.slot == slot);
+    CHECK(fallback.source == Test::makeTile(2, 1, 2));
+    CHECK(fallback.textureRect == glm::vec4(0.25f, 0.25f, 0.25f, 0.5f));
+    CHECK(cache.getStats().fallbacks == 1);
+    
+    // 祖先超出允许的层级差，或不在同一棵子树中
+    CHECK(cache.resolve(Test::makeTile(4, 5, 10), 1).slot == -1);
+    CHECK(cache.resolve(Test::makeTile(4, 0, 0)).slot == -1);
+    CHECK(cache.getStats().misses == 2);
+}
+
+TEST_CASE(textureCacheAncestorRect, "TileTextureCache/ancestorRect maps the tile onto its sub-rectangle of the ancestor")
+{
+    const int z = 6;
+    for (int dz = 0; dz <= z; dz++)
+    {
+        const float size = std::exp2(static_cast<float>(dz));
+        for (int y = 0; y < (1 << z); y += 3)
+        {
+            for (int x = 0; x < (1 << z); x += 5)
+            {
+                // 瓦片在祖先中的位置：以祖先为单位的坐标的小数部分
+                glm::vec4 rect = TileTextureCache::ancestorRect(Test::makeTile(z, x, y), dz);
+                CHECK(rect.x == 1.0f / size);
+                CHECK(rect.y == 1.0f / size);
+                CHECK(rect.z == x / size - std::floor(x / size));
+                CHECK(rect.w == y / size - std::floor(y / size));
+                CHECK(rect.z + rect.x <= 1.0f);
+                CHECK(rect.w + rect.y <= 1.0f);
+            }
+        }
+    }
+}
+
+TEST_CASE(textureCacheLruAndPinning, "TileTextureCache/LRU eviction never evicts tiles used this frame")
+{
+    TileTextureCache cache;
+    cache.configure(3 * kSlotBytes, kSlotBytes, 3);
+    const TileID a = Test::makeTile(3, 0, 0), b = Test::makeTile(3, 1, 0), c = Test::makeTile(3, 2, 0);
+    const TileID d = Test::makeTile(3, 3, 0), e = Test::makeTile(3, 4, 0), f = Test::makeTile(3, 5, 0);
+    
+    cache.beginFrame();
+    int slotA = cache.insert(a);
+    int slotB = cache.insert(b);
+    cache.insert(c);
+    CHECK(cache.getStats().inserts == 3);
+    
+    // 第二帧使用 a，插入 d 淘汰最久未使用的 b
+    cache.beginFrame();
+    CHECK(cache.resolve(a).slot == slotA);
+    CHECK(cache.insert(d) == slotB);
+    CHECK(!cache.contains(b));
+    CHECK(cache.getStats().evictions == 1);
+    
+    // 第三帧通过子瓦片固定 c（祖先回退），再固定 a：插入 e 只能淘汰 d
+    cache.beginFrame();
+    cache.pin(Test::makeTile(5, 8, 1));
+    cache.pin(a);
+    size_t hits = cache.getStats().hits + cache.getStats().fallbacks;
+    CHECK(cache.insert(e) >= 0);
+    CHECK(!cache.contains(d));
+    CHECK(cache.contains(a));
+    CHECK(cache.contains(c));
+    CHECK(cache.getStats().hits + cache.getStats().fallbacks == hits);
+    
+    // 三个 slot 都在本帧使用过：插入失败，已有内容不变
+    CHECK(cache.insert(f) == -1);
+    CHECK(cache.getStats().failures == 1);
+    CHECK(cache.getResidentCount() == 3);
+    
+    // 主动移除后 slot 回到空闲列表，本帧也可以使用
+    cache.erase(a);
+    CHECK(!cache.contains(a));
+    CHECK(cache.insert(f) == slotA);
+    CHECK(cache.getResidentCount() == 3);
+    cache.erase(Test::makeTile(9, 0, 0));
+    CHECK(cache.getResidentCount() == 3);
+}
@@ -0,0 +1,403 @@
+#include "TestHarness.h"
+
+#include "Constants.h"
+#include "PbfWriter.h"
+#include "VectorTessellator.h"
+#include "VectorTile.h"
+#include "VectorTileLoader.h"
+#include <limits>
+
+namespace
+{
+// 几何命令（命令 id | 次数 << 3）
+uint32_t command(uint32_t id, uint32_t count)
+{
+    return id | (count << 3);
+}
+
+constexpr uint32_t kMoveTo = 1;
+constexpr uint32_t kLineTo = 2;
+constexpr uint32_t kClosePath = 7;
+
+/**
+ * 按 MVT 的写法编码若干条线或环：每段 MoveTo 一个点、LineTo 其余的点，环以 ClosePath 结束
+ */
+std::vector<uint32_t> encodeParts(const std::vector<std::vector<glm::ivec2>>& parts, bool closed)
+{
+    std::vector<uint32_t> commands;
+    glm::ivec2 cursor(0);
+    for (const std::vector<glm::ivec2>& part : parts)
+    {
+        for (size_t i = 0; i < part.size(); i++)
+        {
+            if (i == 0)
+            {
+                commands.push_back(command(kMoveTo, 1));
+            }
+            else if (i == 1)
+            {
+                commands.push_back(command(kLineTo, static_cast<uint32_t>(part.size() - 1)));
+            }
+            commands.push_back(PbfWriter::zigzag(part[i].x - cursor.x));
+            commands.push_back(PbfWriter::zigzag(part[i].y - cursor.y));
+            cursor = part[i];
+        }
+        if (closed)
+        {
+            commands.push_back(command(kClosePath, 1));
+        }
+    }
+    return commands;
+}
+
+PbfWriter makeFeature(uint64_t id, VectorTile::GeometryType type, const std::vector<uint32_t>& geometry,
+                      const std::vector<uint32_t>& tags = {})
+{
+    PbfWriter feature;
+    feature.varint((1u << 3) | PbfReader::Varint);
+    feature.varint(id);
+    if (!tags.empty())
+    {
+        feature.packedField(2, tags);
+    }
+    feature.uint32Field(3, static_cast<uint32_t>(type));
+    feature.packedField(4, geometry);
+    return feature;
+}
+
+/**
+ * 图层：nameFirst 为 false 时名字和 extent 写在要素之后（解析不能依赖字段顺序）
+ */
+PbfWriter makeLayer(const std::string& name, uint32_t extent, const std::vector<PbfWriter>& features, bool nameFirst = true)
+{
+    PbfWriter layer;
+    layer.uint32Field(15, 2);
+    if (nameFirst)
+    {
+        layer.stringField(1, name);
+    }
+    for (const PbfWriter& feature : features)
+    {
+        layer.messageField(2, feature);
+    }
+    layer.stringField(3, "kind");
+    if (!nameFirst)
+    {
+        layer.stringField(1, name);
+    }
+    layer.uint32Field(5, extent);
+    return layer;
+}
+
+const std::vector<std::vector<glm::ivec2>> kRings = {
+    { { 0, 0 }, { 4096, 0 }, { 4096, 4096 }, { 0, 4096 } },
+    { { 1024, 1024 }, { 1024, 2048 }, { 2048, 2048 }, { 2048, 1024 } },
+};
+const std::vector<std::vector<glm::ivec2>> kLines = {
+    { { -64, 100 }, { 200, 300 }, { 4200, 300 } },
+    { { 10, 10 }, { 20, 5000 } },
+};
+const std::vector<std::vector<glm::ivec2>> kPoints = { { { 7, 9 } }, { { 300, -20 } } };
+
+std::vector<uint8_t> makeTile()
+{
+    // 多点要素：一个 MoveTo 带多个点
+    std::vector<uint32_t> points = { command(kMoveTo, 2), PbfWriter::zigzag(7), PbfWriter::zigzag(9),
+                                     PbfWriter::zigzag(293), PbfWriter::zigzag(-29) };
+    PbfWriter tile;
+    tile.messageField(3, makeLayer("water", 4096, { makeFeature(11, VectorTile::GeometryType::Polygon, encodeParts(kRings, true), { 0, 0 }) }));
+    tile.messageField(3, makeLayer("transportation", 512,
+                                   { makeFeature(21, VectorTile::GeometryType::LineString, encodeParts(kLines, false)),
+                                     makeFeature(22, VectorTile::GeometryType::Point, points) },
+                                   false));
+    return tile.data;
+}
+
+/**
+ * 枚举全部图层、要素与几何，返回是否有任何一处报告损坏
+ */
+bool walk(const uint8_t* bytes, size_t size, size_t* featureCount = nullptr)
+{
+    VectorTile tile(bytes, size);
+    VectorTile::Layer layer;
+    bool corrupt = false;
+    size_t features = 0;
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> partEnds;
+    while (tile.nextLayer(layer))
+    {
+        VectorTile::Feature feature;
+        while (layer.nextFeature(feature))
+        {
+            features++;
+            corrupt |= !VectorTile::decodeGeometry(feature, 1.0f, points, partEnds);
+        }
+        corrupt |= layer.hasError();
+    }
+    if (featureCount)
+    {
+        *featureCount = features;
+    }
+    return corrupt || tile.hasError();
+}
+
+std::vector<uint8_t> gzip(const std::vector<uint8_t>& bytes)
+{
+    std::vector<uint8_t> out = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+    Test::appendStoredDeflate(out, bytes.data(), bytes.size());
+    uint32_t crc = Test::crc32(bytes.data(), bytes.size());
+    uint32_t size = static_cast<uint32_t>(bytes.size());
+    for (uint32_t value : { crc, size })
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+    return out;
+}
+
+void setTrailerSize(std::vector<uint8_t>& gz, uint32_t size)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        gz[gz.size() - 4 + i] = static_cast<uint8_t>(size >> (8 * i));
+    }
+}
+
+bool decodeSingleFeature(const std::vector<uint32_t>& geometry, std::vector<glm::vec2>& points, std::vector<uint32_t>& partEnds)
+{
+    PbfWriter tile;
+    tile.messageField(3, makeLayer("test", 4096, { makeFeature(1, VectorTile::GeometryType::LineString, geometry) }));
+    VectorTile view(tile.data.data(), tile.data.size());
+    VectorTile::Layer layer;
+    VectorTile::Feature feature;
+    if (!view.nextLayer(layer) || !layer.nextFeature(feature))
+    {
+        return false;
+    }
+    points.clear();
+    partEnds.clear();
+    return VectorTile::decodeGeometry(feature, 1.0f, points, partEnds);
+}
+} // namespace
+
+TEST_CASE(vectorTileRoundTrip, "VectorTile/round-trips layers, features and geometry written with PbfWriter")
+{
+    std::vector<uint8_t> bytes = makeTile();
+    VectorTile tile(bytes.data(), bytes.size());
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> partEnds;
+    
+    VectorTile::Layer layer;
+    REQUIRE(tile.nextLayer(layer));
+    CHECK(layer.name == "water");
+    CHECK(layer.extent == 4096);
+    CHECK(layer.version == 2);
+    VectorTile::Feature feature;
+    REQUIRE(layer.nextFeature(feature));
+    CHECK(feature.id == 11);
+    CHECK(feature.type == VectorTile::GeometryType::Polygon);
+    uint32_t tag = 1;
+    CHECK(feature.tags.next(tag) && tag == 0);
+    const float waterScale = static_cast<float>(Constants::TILE_EXTENT) / 4096.0f;
+    REQUIRE(VectorTile::decodeGeometry(feature, waterScale, points, partEnds));
+    // 环不重复首点
+    CHECK(partEnds == std::vector<uint32_t>({ 4, 8 }));
+    REQUIRE(points.size() == 8);
+    CHECK(points[2] == glm::vec2(4096.0f, 4096.0f) * waterScale);
+    CHECK(points[5] == glm::vec2(1024.0f, 2048.0f) * waterScale);
+    CHECK(!layer.nextFeature(feature));
+    CHECK(!layer.hasError());
+    
+    // 名字和 extent 写在要素之后
+    REQUIRE(tile.nextLayer(layer));
+    CHECK(layer.name == "transportation");
+    CHECK(layer.extent == 512);
+    REQUIRE(layer.nextFeature(feature));
+    CHECK(feature.id == 21);
+    points.clear();
+    partEnds.clear();
+    REQUIRE(VectorTile::decodeGeometry(feature, 2.0f, points, partEnds));
+    CHECK(partEnds == std::vector<uint32_t>({ 3, 5 }));
+    REQUIRE(points.size() == 5);
+    CHECK(points[0] == glm::vec2(-128.0f, 200.0f));
+    CHECK(points[2] == glm::vec2(8400.0f, 600.0f));
+    CHECK(points[4] == glm::vec2(40.0f, 10000.0f));
+    
+    // 多点：每个点一段
+    REQUIRE(layer.nextFeature(feature));
+    CHECK(feature.type == VectorTile::GeometryType::Point);
+    points.clear();
+    partEnds.clear();
+    REQUIRE(VectorTile::decodeGeometry(feature, 1.0f, points, partEnds));
+    CHECK(partEnds == std::vector<uint32_t>({ 1, 2 }));
+    REQUIRE(points.size() == 2);
+    CHECK(points[1] == glm::vec2(kPoints[1][0]));
+    
+    CHECK(!tile.nextLayer(layer));
+    CHECK(!tile.hasError());
+    
+    // rewind 之后重新枚举
+    tile.rewind();
+    size_t features = 0;
+    CHECK(!walk(bytes.data(), bytes.size(), &features));
+    CHECK(features == 3);
+    CHECK(tile.nextLayer(layer) && layer.name == "water");
+}
+
+TEST_CASE(vectorTileTruncated, "VectorTile/every truncation of a tile is reported without crashing")
+{
+    std::vector<uint8_t> bytes = makeTile();
+    size_t reported = 0;
+    for (size_t size = 1; size < bytes.size(); size++)
+    {
+        // 拷贝到恰好大小的缓冲区，越界读取会被 sanitizer / valgrind 发现
+        std::vector<uint8_t> prefix(bytes.begin(), bytes.begin() + size);
+        reported += walk(prefix.data(), prefix.size()) ? 1 : 0;
+    }
+    // 第一个图层消息结束的位置截断是完整的瓦片，其余都应报告损坏
+    CHECK(reported == bytes.size() - 2);
+}
+
+TEST_CASE(vectorTileCorrupt, "VectorTile/rejects bad varints, lengths, wire types and commands")
+{
+    // 长度的 varint 被截断
+    const std::vector<uint8_t> truncatedVarint = { 0x1A, 0x80 };
+    // varint 超过 10 字节
+    const std::vector<uint8_t> longVarint = { 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    // 长度超出剩余字节
+    const std::vector<uint8_t> oversized = { 0x1A, 0x7F, 0x0A, 0x01, 'a' };
+    // 长度超出 size_t 的一半，指针相加会回绕
+    const std::vector<uint8_t> huge = { 0x1A, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x00 };
+    // 线类型 3（group，已废弃）与字段号 0
+    const std::vector<uint8_t> groupWire = { 0x1B, 0x00 };
+    const std::vector<uint8_t> fieldZero = { 0x02, 0x00 };
+    for (const std::vector<uint8_t>* bytes : { &truncatedVarint, &longVarint, &oversized, &huge, &groupWire, &fieldZero })
+    {
+        VectorTile tile(bytes->data(), bytes->size());
+        VectorTile::Layer layer;
+        while (tile.nextLayer(layer))
+        {
+        }
+        CHECK(tile.hasError());
+    }
+    
+    // 图层内部损坏：extent 为 0，或要素的长度超出图层
+    PbfWriter zeroExtent;
+    zeroExtent.messageField(3, makeLayer("water", 0, {}));
+    CHECK(walk(zeroExtent.data.data(), zeroExtent.data.size()));
+    PbfWriter layer;
+    layer.stringField(1, "water");
+    layer.key(2, PbfReader::LengthDelimited);
+    layer.varint(1000);
+    layer.varint(0);
+    PbfWriter badFeature;
+    badFeature.messageField(3, layer);
+    CHECK(walk(badFeature.data.data(), badFeature.data.size()));
+    
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> partEnds;
+    // 命令 id 3..6 未定义
+    for (uint32_t id : { 0u, 3u, 4u, 5u, 6u })
+    {
+        CHECK(!decodeSingleFeature({ command(id, 1), 0, 0 }, points, partEnds));
+    }
+    // 次数大于实际的参数
+    CHECK(!decodeSingleFeature({ command(kMoveTo, 1), 2, 2, command(kLineTo, 3), 2, 2 }, points, partEnds));
+    CHECK(points.size() == 2);
+    // packed 中的 varint 被截断
+    PbfWriter truncatedGeometry;
+    truncatedGeometry.key(4, PbfReader::LengthDelimited);
+    truncatedGeometry.varint(2);
+    truncatedGeometry.varint(command(kMoveTo, 1));
+    truncatedGeometry.varint(0x80);
+    PbfReader reader(truncatedGeometry.data.data(), truncatedGeometry.data.size());
+    REQUIRE(reader.next(4));
+    VectorTile::Feature feature;
+    feature.geometry = reader.packedUint32();
+    CHECK(!VectorTile::decodeGeometry(feature, 1.0f, points, partEnds));
+}
+
+TEST_CASE(vectorTileCoordinateRange, "VectorTile/coordinates that leave the int32 range are rejected")
+{
+    const int32_t max = std::numeric_limits<int32_t>::max();
+    const int32_t min = std::numeric_limits<int32_t>::min();
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> partEnds;
+    
+    // 恰好到达 int32 的边界是合法的
+    CHECK(decodeSingleFeature({ command(kMoveTo, 1), PbfWriter::zigzag(max), PbfWriter::zigzag(min),
+                                command(kLineTo, 1), PbfWriter::zigzag(-max), PbfWriter::zigzag(max) },
+                              points, partEnds));
+    REQUIRE(points.size() == 2);
+    CHECK(points[0] == glm::vec2(static_cast<float>(max), static_cast<float>(min)));
+    CHECK(points[1] == glm::vec2(0.0f, -1.0f));
+    
+    // 累加超出 int32（原来以 int32 累加时溢出）
+    CHECK(!decodeSingleFeature({ command(kMoveTo, 1), PbfWriter::zigzag(max), 0, command(kLineTo, 1), PbfWriter::zigzag(1), 0 },
+                               points, partEnds));
+    CHECK(points.size() == 1);
+    CHECK(!decodeSingleFeature({ command(kMoveTo, 1), 0, PbfWriter::zigzag(min), command(kLineTo, 1), 0, PbfWriter::zigzag(min) },
+                               points, partEnds));
+    CHECK(!decodeSingleFeature({ command(kMoveTo, 1), 0xFFFFFFFEu, 0xFFFFFFFFu, command(kLineTo, 2), 0xFFFFFFFEu, 0xFFFFFFFFu,
+                                 0xFFFFFFFEu, 0xFFFFFFFFu },
+                               points, partEnds));
+}
+
+TEST_CASE(vectorTileGzip, "VectorTile/gunzip accepts stored deflate and rejects bad trailers")
+{
+    std::vector<uint8_t> bytes = makeTile();
+    std::vector<uint8_t> gz = gzip(bytes);
+    std::vector<uint8_t> inflated;
+    REQUIRE(VectorTileLoader::gunzip(gz.data(), gz.size(), inflated));
+    CHECK(inflated == bytes);
+    
+    // 压缩与未压缩的同一瓦片三角化结果相同
+    VectorStyle style;
+    style.layers.push_back({ "water", VectorStyle::Type::Fill, glm::vec4(1.0f), 1.0f });
+    style.layers.push_back({ "transportation", VectorStyle::Type::Line, glm::vec4(1.0f), 2.0f });
+    VectorTileMesh plain, compressed;
+    REQUIRE(VectorTileLoader::decode(bytes.data(), bytes.size(), style, 14, plain));
+    REQUIRE(VectorTileLoader::decode(gz.data(), gz.size(), style, 14, compressed));
+    CHECK(!plain.empty());
+    CHECK(plain.indices == compressed.indices);
+    CHECK(plain.vertices.size() == compressed.vertices.size());
+    
+    // 尾部的原始长度超过上限：不分配、直接失败
+    std::vector<uint8_t> bomb = gz;
+    setTrailerSize(bomb, 0xFFFFFFFFu);
+    inflated.clear();
+    CHECK(!VectorTileLoader::gunzip(bomb.data(), bomb.size(), inflated));
+    CHECK(inflated.size() < (1u << 20));
+    setTrailerSize(bomb, 64u * 1024u * 1024u + 1u);
+    CHECK(!VectorTileLoader::gunzip(bomb.data(), bomb.size(), inflated));
+    VectorTileMesh mesh;
+    CHECK(!VectorTileLoader::decode(bomb.data(), bomb.size(), style, 14, mesh));
+    
+    // 原始长度与实际不符
+    std::vector<uint8_t> wrongSize = gz;
+    setTrailerSize(wrongSize, static_cast<uint32_t>(bytes.size() - 1));
+    CHECK(!VectorTileLoader::gunzip(wrongSize.data(), wrongSize.size(), inflated));
+    setTrailerSize(wrongSize, static_cast<uint32_t>(bytes.size() + 1));
+    CHECK(!VectorTileLoader::gunzip(wrongSize.data(), wrongSize.size(), inflated));
+    
+    // 头部的可选字段越过数据末尾：FEXTRA 长度过大、FNAME 没有结尾
+    std::vector<uint8_t> extra = gz;
+    extra[3] = 0x04;
+    extra[10] = 0xFF;
+    extra[11] = 0xFF;
+    CHECK(!VectorTileLoader::gunzip(extra.data(), extra.size(), inflated));
+    std::vector<uint8_t> name = { 0x1f, 0x8b, 8, 0x08, 0, 0, 0, 0, 0, 3 };
+    name.insert(name.end(), 20, 'a');
+    CHECK(!VectorTileLoader::gunzip(name.data(), name.size(), inflated));
+    
+    // 任意截断都失败而不崩溃
+    size_t accepted = 0;
+    for (size_t size = 0; size < gz.size(); size++)
+    {
+        std::vector<uint8_t> prefix(gz.begin(), gz.begin() + size);
+        accepted += VectorTileLoader::gunzip(prefix.data(), prefix.size(), inflated) ? 1 : 0;
+    }
+    CHECK(accepted == 0);
+}
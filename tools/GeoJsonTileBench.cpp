@@ -0,0 +1,398 @@
+/**
+ * GeoJSON 切片器基准
+ *
+ *   GeoJsonTileBench <file.geojson> [--paths N] [--cache MB]
+ *   GeoJsonTileBench --synthetic N [--seed S] [--write file.geojson] [--paths N] [--cache MB]
+ *
+ * --synthetic 生成 N 个要素的 FeatureCollection（成簇分布的多边形、带洞多边形、折线和点，带 properties），
+ * 写入 --write 指定的文件或临时文件后按普通文件读取。输出：
+ * - load：读取 + 投影 + 简化的耗时和吞吐、初始索引的耗时、要素数和点数
+ * - memory：索引的估算内存，加载前后的峰值 RSS
+ * - slice：模拟 --paths 次从 z0 放大到 maxZoom（每级请求 3x3 瓦片，中心按要素数加权随机选择子瓦片），
+ *   按层级统计首次请求（cold，可能复用 LRU 中的祖先）和重复请求（warm）的 getTile 延迟，
+ *   以及编码为 MVT 的耗时和大小
+ */
+
+#include "GeoJsonTiler.h"
+#include "TileID.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+/**
+ * 进程的峰值常驻内存（字节）；Windows 上返回 0
+ */
+size_t peakResidentBytes()
+{
+#ifndef _WIN32
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;     // Linux 上单位为 KB
+    }
+#endif
+    return 0;
+}
+
+double megabytes(size_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+// ---------------------------------------------------------------------------
+// 合成 GeoJSON
+
+void writePosition(std::ostream& out, double lon, double lat)
+{
+    out << '[' << lon << ',' << lat << ']';
+}
+
+void writeRing(std::ostream& out, std::mt19937& random, double lon, double lat, double radius, int count, bool clockwise)
+{
+    // GeoJSON 的环首尾相同；外环逆时针、洞顺时针（RFC 7946），读取端不依赖方向
+    std::uniform_real_distribution<double> jitter(0.6, 1.0);
+    std::vector<double> radii(count);
+    for (double& r : radii)
+    {
+        r = radius * jitter(random);
+    }
+    out << '[';
+    for (int i = 0; i <= count; i++)
+    {
+        double angle = 2.0 * 3.14159265358979 * (i % count) / count * (clockwise ? -1.0 : 1.0);
+        double r = radii[i % count];
+        writePosition(out, lon + r * std::cos(angle) / std::cos(lat * 3.14159265358979 / 180.0), lat + r * std::sin(angle));
+        out << (i < count ? "," : "");
+    }
+    out << ']';
+}
+
+/**
+ * 写出 count 个要素；要素围绕 count / 2000 个簇中心分布，高层级的瓦片也有内容
+ */
+bool writeSynthetic(const std::string& path, size_t count, unsigned seed)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    out << std::setprecision(9);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> centerLon(-175.0, 175.0);
+    std::uniform_real_distribution<double> centerLat(-70.0, 70.0);
+    std::normal_distribution<double> spread(0.0, 0.4);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<glm::dvec2> centers(std::max<size_t>(1, count / 2000));
+    for (glm::dvec2& center : centers)
+    {
+        center = glm::dvec2(centerLon(random), centerLat(random));
+    }
+    
+    out << "{\"type\":\"FeatureCollection\",\"features\":[\n";
+    for (size_t i = 0; i < count; i++)
+    {
+        const glm::dvec2& center = centers[random() % centers.size()];
+        const double lon = std::clamp(center.x + spread(random), -179.0, 179.0);
+        const double lat = std::clamp(center.y + spread(random), -80.0, 80.0);
+        const double kind = unit(random);
+        out << "{\"type\":\"Feature\",\"properties\":{\"id\":" << i << ",\"name\":\"feature \\\"" << i
+            << "\\\"\",\"tags\":[1,{\"a\":[2,3]}]},\"geometry\":";
+        if (kind < 0.45)
+        {
+            const double radius = 0.0005 + 0.02 * unit(random) * unit(random);
+            const int vertices = 16 + static_cast<int>(unit(random) * 112);
+            out << "{\"type\":\"Polygon\",\"coordinates\":[";
+            writeRing(out, random, lon, lat, radius, vertices, false);
+            if (kind < 0.1)
+            {
+                out << ',';
+                writeRing(out, random, lon, lat, radius * 0.3, vertices / 2, true);
+            }
+            out << "]}";
+        }
+        else if (kind < 0.9)
+        {
+            std::uniform_real_distribution<double> turn(-0.5, 0.5);
+            const int vertices = 16 + static_cast<int>(unit(random) * unit(random) * 496);
+            double heading = unit(random) * 6.283;
+            glm::dvec2 point(lon, lat);
+            out << "{\"type\":\"LineString\",\"coordinates\":[";
+            for (int v = 0; v < vertices; v++)
+            {
+                writePosition(out, point.x, point.y);
+                out << (v + 1 < vertices ? "," : "");
+                heading += turn(random);
+                point += glm::dvec2(std::cos(heading), std::sin(heading)) * 0.0004;
+            }
+            out << "]}";
+        }
+        else
+        {
+            out << "{\"type\":\"Point\",\"coordinates\":";
+            writePosition(out, lon, lat);
+            out << '}';
+        }
+        out << '}' << (i + 1 < count ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    return static_cast<bool>(out);
+}
+
+// ---------------------------------------------------------------------------
+// 放大路径上的切片延迟
+
+struct ZoomSamples
+{
+    std::vector<double> cold;
+    std::vector<double> warm;
+    std::vector<double> encode;
+    size_t tiles = 0;
+    size_t emptyTiles = 0;
+    size_t features = 0;
+    size_t encodedBytes = 0;
+};
+
+void runPaths(const GeoJsonTiler& tiler, int paths, unsigned seed, std::vector<ZoomSamples>& samples)
+{
+    const int maxZoom = tiler.getOptions().maxZoom;
+    samples.assign(maxZoom + 1, ZoomSamples());
+    std::unordered_set<uint64_t> requested;
+    std::mt19937 random(seed);
+    std::vector<uint8_t> encoded;
+    
+    auto request = [&](const TileID& tile)
+    {
+        const bool cold = requested.insert(tile.key()).second;
+        auto start = Clock::now();
+        std::shared_ptr<const GeoJsonTile> result = tiler.getTile(tile);
+        const double milliseconds = millisecondsSince(start);
+        ZoomSamples& zoom = samples[tile.z];
+        (cold ? zoom.cold : zoom.warm).push_back(milliseconds);
+        if (cold)
+        {
+            start = Clock::now();
+            GeoJsonTileSource::encode(*result, encoded);
+            zoom.encode.push_back(millisecondsSince(start));
+            zoom.tiles++;
+            zoom.emptyTiles += result->features.empty() ? 1 : 0;
+            zoom.features += result->features.size();
+            zoom.encodedBytes += encoded.size();
+        }
+        return result;
+    };
+    
+    for (int path = 0; path < paths; path++)
+    {
+        TileID center;
+        for (int z = 0; z <= maxZoom; z++)
+        {
+            // 本级的 3x3 覆盖瓦片，其中一半再请求一次模拟下一帧的重复请求
+            const int size = 1 << z;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    TileID tile{ center.x + dx, center.y + dy, z, 0 };
+                    if (tile.x >= 0 && tile.y >= 0 && tile.x < size && tile.y < size)
+                    {
+                        request(tile);
+                        if ((dx + dy) % 2 == 0)
+                        {
+                            request(tile);
+                        }
+                    }
+                }
+            }
+            if (z == maxZoom)
+            {
+                break;
+            }
+            
+            // 按要素数加权随机选一个子瓦片放大（各条路径分散到不同区域）；都没有要素时结束这条路径
+            TileID children[4];
+            size_t features[4];
+            size_t total = 0;
+            for (int child = 0; child < 4; child++)
+            {
+                children[child] = TileID{ center.x * 2 + (child & 1), center.y * 2 + (child >> 1), z + 1, 0 };
+                features[child] = request(children[child])->features.size();
+                total += features[child];
+            }
+            if (total == 0)
+            {
+                break;
+            }
+            size_t pick = random() % total;
+            int best = 0;
+            while (pick >= features[best])
+            {
+                pick -= features[best++];
+            }
+            center = children[best];
+        }
+    }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string input;
+    size_t synthetic = 0;
+    unsigned seed = 1;
+    int paths = 8;
+    std::string writePath;
+    GeoJsonTiler::Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--synthetic" && hasValue)
+        {
+            synthetic = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--write" && hasValue)
+        {
+            writePath = argv[++i];
+        }
+        else if (arg == "--paths" && hasValue)
+        {
+            paths = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--cache" && hasValue)
+        {
+            options.cacheBytes = std::strtoul(argv[++i], nullptr, 10) * 1024 * 1024;
+        }
+        else if (arg[0] != '-' && input.empty())
+        {
+            input = arg;
+        }
+        else
+        {
+            input.clear();
+            synthetic = 0;
+            break;
+        }
+    }
+    if (input.empty() == (synthetic == 0))
+    {
+        std::cerr << "usage: GeoJsonTileBench <file.geojson> [--paths N] [--cache MB]\n"
+                  << "       GeoJsonTileBench --synthetic N [--seed S] [--write file.geojson] [--paths N] [--cache MB]" << std::endl;
+        return 2;
+    }
+    
+    bool temporary = false;
+    if (synthetic > 0)
+    {
+        temporary = writePath.empty();
+        input = temporary ? (fs::temp_directory_path() / "GeoJsonTileBench.geojson").string() : writePath;
+        auto start = Clock::now();
+        if (!writeSynthetic(input, synthetic, seed))
+        {
+            return 1;
+        }
+        std::cout << "wrote " << synthetic << " synthetic features to " << input << " in "
+                  << std::fixed << std::setprecision(1) << millisecondsSince(start) / 1000.0 << " s\n";
+    }
+    
+    const size_t residentBefore = peakResidentBytes();
+    GeoJsonTiler tiler(options);
+    std::string error;
+    bool loaded = tiler.load(input, &error);
+    const size_t residentAfter = peakResidentBytes();
+    if (temporary)
+    {
+        std::error_code ignored;
+        fs::remove(input, ignored);
+    }
+    if (!loaded)
+    {
+        std::cerr << "Failed to load " << input << ": " << error << std::endl;
+        return 1;
+    }
+    
+    GeoJsonTiler::Stats stats = tiler.getStats();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "load: " << megabytes(stats.bytesRead) << " MB, " << stats.features << " features ("
+              << stats.invalidGeometries << " invalid), " << stats.points << " points\n";
+    std::cout << "  parse + project + simplify " << stats.parseSeconds * 1000.0 << " ms ("
+              << (stats.parseSeconds > 0.0 ? megabytes(stats.bytesRead) / stats.parseSeconds : 0.0) << " MB/s), index "
+              << stats.indexSeconds * 1000.0 << " ms, " << stats.indexTiles << " index tiles\n";
+    std::cout << "memory: index " << megabytes(stats.indexBytes) << " MB (estimated), peak RSS "
+              << megabytes(residentAfter) << " MB (before load " << megabytes(residentBefore) << " MB)\n";
+    
+    std::vector<ZoomSamples> samples;
+    runPaths(tiler, paths, seed, samples);
+    
+    std::cout << "slice (" << paths << " zoom-in paths, 3x3 tiles per zoom, milliseconds):\n";
+    std::cout << "  zoom  tiles  empty   cold p50    p95     max   warm p50  encode p50  features  KB/tile\n";
+    std::vector<double> allCold;
+    std::vector<double> allWarm;
+    for (size_t z = 0; z < samples.size(); z++)
+    {
+        const ZoomSamples& zoom = samples[z];
+        if (zoom.tiles == 0)
+        {
+            continue;
+        }
+        allCold.insert(allCold.end(), zoom.cold.begin(), zoom.cold.end());
+        allWarm.insert(allWarm.end(), zoom.warm.begin(), zoom.warm.end());
+        std::printf("  %4zu  %5zu  %5zu  %9.3f %7.3f %7.3f  %9.4f  %10.3f  %8.1f  %7.1f\n", z, zoom.tiles, zoom.emptyTiles,
+                    percentile(zoom.cold, 0.5), percentile(zoom.cold, 0.95), percentile(zoom.cold, 1.0),
+                    percentile(zoom.warm, 0.5), percentile(zoom.encode, 0.5),
+                    static_cast<double>(zoom.features) / zoom.tiles, zoom.encodedBytes / 1024.0 / zoom.tiles);
+    }
+    std::fflush(stdout);
+    
+    stats = tiler.getStats();
+    std::cout << std::setprecision(3) << "  all: cold p50 " << percentile(allCold, 0.5) << " p95 " << percentile(allCold, 0.95)
+              << " max " << percentile(allCold, 1.0) << ", warm p50 " << percentile(allWarm, 0.5) << "\n";
+    std::cout << std::setprecision(1) << "cache: " << stats.cachedTiles << " tiles, " << megabytes(stats.cachedBytes) << " MB, "
+              << stats.clippedTiles << " clips, " << stats.cacheHits << " hits / " << stats.requests << " requests, "
+              << stats.evictions << " evictions\n";
+    std::cout << "peak RSS after slicing " << megabytes(peakResidentBytes()) << " MB" << std::endl;
+    return 0;
+}
@@ -0,0 +1,654 @@
+/**
+ * 无窗口渲染基准
+ *
+ *   HeadlessBenchmark [--paths pan,zoom,blend,poles] [--path 文件]... [--tiles 目录或归档] [--vector 目录、归档或 GeoJSON]
+ *                     [--width 1280] [--height 720] [--pipelined] [--pace | --no-pace]
+ *                     [--warmup 帧数] [--out 结果.json] [--trace trace.json] [--shader-cache 目录]
+ *
+ * 通过 EGL 创建离屏 OpenGL 4.5 上下文（优先 Mesa surfaceless 平台，没有 GPU 时使用
+ * llvmpipe 软件渲染），渲染到 FBO，按 60Hz 的固定时间步回放脚本化的相机路径（见 CameraPath）。
+ * 每帧分别记录：
+ * - cpuFrameMs：GL 线程上 render / renderPipelined 调用的耗时
+ * - cpuPrepMs：提交的帧在 FrameBuilder 中的构建耗时（流水线模式下在工作线程上）
+ * - gpuMs：GL_TIME_ELAPSED 计时查询（4 个查询轮转，晚 3 帧读取，避免等待 GPU）
+ * - tiles / draws：提交的 tile 数与 draw call 数
+ * 另外记录每条路径创建 TileRenderer 时 shader 变体的编译 / 缓存加载次数与耗时（shaders），
+ * 以及流式缓冲区的最终容量、单帧峰值用量与等待 GPU 的次数（stream）；
+ * 指定 --vector（MVT 瓦片）时另外记录矢量瓦片的解码、球面细分新增的顶点、上传与最后一帧绘制的三角形数（vector）。
+ * 输出每条路径的 p50/p95/p99 与 tile、draw 计数的 JSON，用于回归跟踪。
+ *
+ * --pace 按墙钟时间节奏回放（帧之间等待到该帧的时刻），预取的相机速度估计与交互时一致；
+ * 指定 --tiles 或 --vector 时默认开启，否则默认关闭（尽快渲染）。每条路径使用新的 TileRenderer，
+ * 栅格和矢量缓存从冷启动开始。
+ *
+ * --trace 在全部路径结束后导出 Chrome trace（需要以 -DGLOBE_PROFILER=ON 编译）。
+ * --shader-cache 指定程序二进制缓存目录（默认不使用缓存，每条路径都从源码编译）。
+ */
+
+#include "CameraPath.h"
+#include "GeoJsonTiler.h"
+#include "GlobeProjection.h"
+#include "Profiler.h"
+#include "TileArchive.h"
+#include "TileRenderer.h"
+#include "TileSource.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// 回放的固定时间步（秒）
+constexpr double kFrameStep = 1.0 / 60.0;
+// 计时查询轮转数：第 i 帧结束后读取第 i - (kQueryCount - 1) 帧的结果
+constexpr int kQueryCount = 4;
+
+struct Options
+{
+    int width = 1280;
+    int height = 720;
+    std::vector<std::string> builtinPaths;
+    std::vector<std::string> pathFiles;
+    std::string tiles;
+    std::string vector;
+    std::string out;
+    std::string trace;
+    std::string shaderCache;
+    bool pipelined = false;
+    int pace = -1;       // -1 表示按是否指定 --tiles / --vector 决定
+    int warmup = 30;
+};
+
+struct FrameSample
+{
+    double cpuFrameMs = 0.0;
+    double cpuPrepMs = 0.0;
+    double gpuMs = -1.0;   // 计时查询不可用时为负
+    size_t tiles = 0;
+    size_t draws = 0;
+};
+
+struct Distribution
+{
+    double p50 = 0.0, p95 = 0.0, p99 = 0.0;
+    double mean = 0.0, max = 0.0;
+};
+
+Distribution distribution(std::vector<double> values)
+{
+    Distribution result;
+    if (values.empty())
+    {
+        return result;
+    }
+    std::sort(values.begin(), values.end());
+    // 最近秩百分位
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(p / 100.0 * values.size() + 0.999999);
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    };
+    result.p50 = percentile(50.0);
+    result.p95 = percentile(95.0);
+    result.p99 = percentile(99.0);
+    double sum = 0.0;
+    for (double value : values)
+    {
+        sum += value;
+    }
+    result.mean = sum / values.size();
+    result.max = values.back();
+    return result;
+}
+
+std::string jsonString(const std::string& text)
+{
+    std::string result = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+std::string jsonDistribution(const Distribution& d)
+{
+    char text[192];
+    std::snprintf(text, sizeof(text), "{ \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"mean\": %.4f, \"max\": %.4f }",
+                  d.p50, d.p95, d.p99, d.mean, d.max);
+    return text;
+}
+
+/**
+ * 离屏 GL 上下文与渲染目标
+ */
+class OffscreenContext
+{
+public:
+    bool create(int width, int height, std::string& error)
+    {
+        // Mesa surfaceless 平台不需要 X/Wayland 显示；不支持时退回默认显示
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+        {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (display == EGL_NO_DISPLAY)
+        {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        EGLint major = 0, minor = 0;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+        {
+            error = "eglInitialize failed";
+            return false;
+        }
+        
+        const EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig config = nullptr;
+        EGLint configCount = 0;
+        eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+        eglBindAPI(EGL_OPENGL_API);
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 5,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE,
+        };
+        // surfaceless 平台可能没有 pbuffer 配置，此时不指定配置（EGL_KHR_no_config_context）
+        context = eglCreateContext(display, configCount > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        {
+            error = "Failed to create an OpenGL 4.5 core context (EGL error 0x" + toHex(eglGetError()) + ")";
+            return false;
+        }
+        if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)))
+        {
+            error = "Failed to initialize GLAD";
+            return false;
+        }
+        
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glGenRenderbuffers(2, renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            error = "Offscreen framebuffer is incomplete";
+            return false;
+        }
+        
+        // 与 Application::initOpenGL 相同的状态
+        glViewport(0, 0, width, height);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        return true;
+    }
+    
+    ~OffscreenContext()
+    {
+        if (context != EGL_NO_CONTEXT)
+        {
+            glDeleteRenderbuffers(2, renderbuffers);
+            glDeleteFramebuffers(1, &framebuffer);
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (display != EGL_NO_DISPLAY)
+        {
+            eglTerminate(display);
+        }
+    }
+    
+private:
+    static std::string toHex(EGLint value)
+    {
+        std::ostringstream text;
+        text << std::hex << value;
+        return text.str();
+    }
+    
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    GLuint framebuffer = 0;
+    GLuint renderbuffers[2] = { 0, 0 };
+};
+
+std::shared_ptr<const TileSource> openTileSource(const std::string& path)
+{
+    // 与 Application 相同：GeoJSON 按需切片，其他普通文件按瓦片归档打开，目录按 z/x/y 读取
+    std::filesystem::path file(path);
+    if (file.extension() == ".geojson" || file.extension() == ".json")
+    {
+        // GeoJSON 在进程内按需切片（打开时读取整个文件并建立索引）
+        auto geojson = std::make_shared<GeoJsonTileSource>(path);
+        if (!geojson->isOpen())
+        {
+            std::cerr << geojson->getError() << std::endl;
+            return nullptr;
+        }
+        GeoJsonTiler::Stats stats = geojson->getTiler().getStats();
+        std::cout << "GeoJSON: " << stats.features << " features, " << stats.points << " points, indexed in "
+                  << (stats.parseSeconds + stats.indexSeconds) * 1000.0 << " ms" << std::endl;
+        return geojson;
+    }
+    if (std::filesystem::is_regular_file(file))
+    {
+        auto archive = std::make_shared<ArchiveTileSource>(path);
+        if (!archive->isOpen())
+        {
+            std::cerr << archive->getError() << std::endl;
+            return nullptr;
+        }
+        return archive;
+    }
+    return std::make_shared<DirectoryTileSource>(path);
+}
+
+/**
+ * 回放一条路径，返回该路径的 JSON 对象
+ */
+std::string runPath(const CameraPath& path, const Options& options, std::shared_ptr<const TileSource> source,
+                    std::shared_ptr<const TileSource> vectorSource, bool pace)
+{
+    TileRenderer renderer(options.shaderCache);
+    renderer.setViewportHeight(options.height);
+    if (source)
+    {
+        renderer.setRasterSource(source);
+    }
+    if (vectorSource)
+    {
+        renderer.setVectorSource(vectorSource);
+    }
+    float aspect = static_cast<float>(options.width) / options.height;
+    GlobeProjection projection;
+    
+    auto renderFrame = [&]() {
+        glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (options.pipelined)
+        {
+            renderer.renderPipelined(projection, aspect);
+        }
+        else
+        {
+            renderer.render(projection, aspect);
+        }
+    };
+    
+    // 预热：在起点渲染若干帧（着色器编译、缓冲区首次分配），不计入结果
+    path.sample(0.0, projection);
+    for (int i = 0; i < options.warmup; i++)
+    {
+        renderFrame();
+    }
+    glFinish();
+    
+    GLuint queries[kQueryCount];
+    glGenQueries(kQueryCount, queries);
+    bool gpuTiming = glGetError() == GL_NO_ERROR;
+    
+    size_t frameCount = static_cast<size_t>(path.getDuration() / kFrameStep) + 1;
+    std::vector<FrameSample> samples(frameCount);
+    auto readQuery = [&](size_t frame) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[frame % kQueryCount], GL_QUERY_RESULT, &nanoseconds);
+        samples[frame].gpuMs = nanoseconds / 1.0e6;
+    };
+    
+    Clock::time_point start = Clock::now();
+    for (size_t frame = 0; frame < frameCount; frame++)
+    {
+        double seconds = frame * kFrameStep;
+        if (pace)
+        {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)));
+        }
+        path.sample(seconds, projection);
+        
+        if (gpuTiming)
+        {
+            glBeginQuery(GL_TIME_ELAPSED, queries[frame % kQueryCount]);
+        }
+        Clock::time_point cpuStart = Clock::now();
+        renderFrame();
+        samples[frame].cpuFrameMs = std::chrono::duration<double, std::milli>(Clock::now() - cpuStart).count();
+        if (gpuTiming)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            if (frame + 1 >= kQueryCount)
+            {
+                readQuery(frame + 1 - kQueryCount);
+            }
+        }
+        
+        if (const FramePacket* packet = renderer.getCurrentFrame())
+        {
+            samples[frame].cpuPrepMs = packet->buildMilliseconds;
+        }
+        samples[frame].tiles = renderer.getTileCount();
+        samples[frame].draws = renderer.getDrawCallCount();
+        if (Profiler::kEnabled)
+        {
+            Profiler::shared().collect();
+        }
+    }
+    if (gpuTiming)
+    {
+        for (size_t frame = frameCount >= kQueryCount ? frameCount + 1 - kQueryCount : 0; frame < frameCount; frame++)
+        {
+            readQuery(frame);
+        }
+    }
+    glFinish();
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    glDeleteQueries(kQueryCount, queries);
+    
+    std::vector<double> cpuFrame, cpuPrep, gpu, tiles, draws;
+    for (const FrameSample& sample : samples)
+    {
+        cpuFrame.push_back(sample.cpuFrameMs);
+        cpuPrep.push_back(sample.cpuPrepMs);
+        if (sample.gpuMs >= 0.0)
+        {
+            gpu.push_back(sample.gpuMs);
+        }
+        tiles.push_back(static_cast<double>(sample.tiles));
+        draws.push_back(static_cast<double>(sample.draws));
+    }
+    
+    std::ostringstream json;
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.3f", wallSeconds);
+    json << "    {\n"
+         << "      \"name\": " << jsonString(path.name) << ",\n"
+         << "      \"frames\": " << frameCount << ",\n"
+         << "      \"wallSeconds\": " << number << ",\n"
+         << "      \"cpuFrameMs\": " << jsonDistribution(distribution(cpuFrame)) << ",\n"
+         << "      \"cpuPrepMs\": " << jsonDistribution(distribution(cpuPrep)) << ",\n"
+         << "      \"gpuMs\": " << (gpu.empty() ? std::string("null") : jsonDistribution(distribution(gpu))) << ",\n"
+         << "      \"tiles\": " << jsonDistribution(distribution(tiles)) << ",\n"
+         << "      \"draws\": " << jsonDistribution(distribution(draws)) << ",\n";
+    const ShaderManager::Stats& shaderStats = renderer.getShaderStats();
+    std::snprintf(number, sizeof(number), "%.3f", shaderStats.milliseconds);
+    json << "      \"shaders\": { \"compiled\": " << shaderStats.compiled
+         << ", \"cached\": " << shaderStats.loadedFromCache
+         << ", \"rejected\": " << shaderStats.cacheRejected
+         << ", \"failed\": " << shaderStats.failed
+         << ", \"ms\": " << number << " },\n";
+    StreamBuffer::Stats streamStats = renderer.getStreamStats();
+    json << "      \"stream\": { \"capacity\": " << streamStats.capacity
+         << ", \"peakFrameBytes\": " << streamStats.peakFrameBytes
+         << ", \"waits\": " << streamStats.waits
+         << ", \"reallocations\": " << streamStats.reallocations << " }";
+    if (const RasterTileLoader* loader = renderer.getRasterLoader())
+    {
+        RasterTileLoader::Stats rasterStats = loader->getStats();
+        const TilePrefetcher::Stats& prefetch = renderer.getPrefetchStats();
+        std::snprintf(number, sizeof(number), "%.4f", prefetch.averageMisses());
+        json << ",\n      \"raster\": { \"requested\": " << rasterStats.requested
+             << ", \"decoded\": " << rasterStats.decoded
+             << ", \"cancelled\": " << rasterStats.cancelled
+             << ", \"uploads\": " << renderer.getRasterTextureStats().uploads
+             << ", \"missesPerFrame\": " << number;
+        std::snprintf(number, sizeof(number), "%.4f", prefetch.hitRate());
+        json << ", \"prefetched\": " << prefetch.prefetched
+             << ", \"prefetchHitRate\": " << number << " }";
+    }
+    if (const VectorTileLayer* vectorLayer = renderer.getVectorLayer())
+    {
+        VectorTileLoader::Stats loaderStats = vectorLayer->getLoader().getStats();
+        VectorTileLayer::Stats layerStats = vectorLayer->getStats();
+        std::snprintf(number, sizeof(number), "%.3f", loaderStats.decoded > 0 ? loaderStats.decodeSeconds * 1000.0 / loaderStats.decoded : 0.0);
+        json << ",\n      \"vector\": { \"requested\": " << loaderStats.requested
+             << ", \"decoded\": " << loaderStats.decoded
+             << ", \"failed\": " << loaderStats.failed
+             << ", \"decodeMsPerTile\": " << number
+             << ", \"subdividedVertices\": " << loaderStats.subdividedVertices
+             << ", \"uploads\": " << layerStats.uploads
+             << ", \"uploadedBytes\": " << layerStats.uploadedBytes
+             << ", \"evictions\": " << layerStats.evictions
+             << ", \"drawnTiles\": " << layerStats.drawnTiles
+             << ", \"drawnTriangles\": " << layerStats.drawnTriangles << " }";
+    }
+    json << "\n    }";
+    return json.str();
+}
+
+std::vector<std::string> split(const std::string& text, char separator)
+{
+    std::vector<std::string> parts;
+    std::istringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator))
+    {
+        if (!part.empty())
+        {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--paths" && hasValue)
+        {
+            for (const std::string& name : split(argv[++i], ','))
+            {
+                options.builtinPaths.push_back(name);
+            }
+        }
+        else if (argument == "--path" && hasValue)
+        {
+            options.pathFiles.push_back(argv[++i]);
+        }
+        else if (argument == "--tiles" && hasValue)
+        {
+            options.tiles = argv[++i];
+        }
+        else if (argument == "--vector" && hasValue)
+        {
+            options.vector = argv[++i];
+        }
+        else if (argument == "--out" && hasValue)
+        {
+            options.out = argv[++i];
+        }
+        else if (argument == "--trace" && hasValue)
+        {
+            options.trace = argv[++i];
+        }
+        else if (argument == "--shader-cache" && hasValue)
+        {
+            options.shaderCache = argv[++i];
+        }
+        else if (argument == "--width" && hasValue)
+        {
+            options.width = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--height" && hasValue)
+        {
+            options.height = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--warmup" && hasValue)
+        {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (argument == "--pipelined")
+        {
+            options.pipelined = true;
+        }
+        else if (argument == "--pace")
+        {
+            options.pace = 1;
+        }
+        else if (argument == "--no-pace")
+        {
+            options.pace = 0;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (options.builtinPaths.empty() && options.pathFiles.empty())
+    {
+        options.builtinPaths = CameraPath::builtinNames();
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: HeadlessBenchmark [--paths pan,zoom,blend,poles] [--path file]... [--tiles dir|archive] [--vector dir|archive]\n"
+                  << "                         [--width W] [--height H] [--pipelined] [--pace|--no-pace]\n"
+                  << "                         [--warmup frames] [--out result.json] [--trace trace.json]\n"
+                  << "                         [--shader-cache dir]" << std::endl;
+        return 2;
+    }
+    
+    std::vector<CameraPath> paths;
+    for (const std::string& name : options.builtinPaths)
+    {
+        CameraPath path;
+        if (!CameraPath::builtin(name, path))
+        {
+            std::cerr << "Unknown camera path: " << name << std::endl;
+            return 2;
+        }
+        paths.push_back(path);
+    }
+    for (const std::string& file : options.pathFiles)
+    {
+        CameraPath path;
+        std::string error;
+        if (!CameraPath::load(file, path, &error))
+        {
+            std::cerr << error << std::endl;
+            return 2;
+        }
+        paths.push_back(path);
+    }
+    
+    OffscreenContext context;
+    std::string error;
+    if (!context.create(options.width, options.height, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::string glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    std::string glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    std::cerr << "GL " << glVersion << " / " << glRenderer << std::endl;
+    PROFILE_THREAD_NAME("GL");
+    
+    std::shared_ptr<const TileSource> source;
+    if (!options.tiles.empty())
+    {
+        source = openTileSource(options.tiles);
+        if (!source)
+        {
+            return 1;
+        }
+    }
+    std::shared_ptr<const TileSource> vectorSource;
+    if (!options.vector.empty())
+    {
+        vectorSource = openTileSource(options.vector);
+        if (!vectorSource)
+        {
+            return 1;
+        }
+    }
+    bool pace = options.pace < 0 ? (source || vectorSource) : options.pace != 0;
+    
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"renderer\": " << jsonString(glRenderer) << ",\n"
+         << "  \"version\": " << jsonString(glVersion) << ",\n"
+         << "  \"width\": " << options.width << ",\n"
+         << "  \"height\": " << options.height << ",\n"
+         << "  \"pipelined\": " << (options.pipelined ? "true" : "false") << ",\n"
+         << "  \"paced\": " << (pace ? "true" : "false") << ",\n"
+         << "  \"tiles\": " << (options.tiles.empty() ? std::string("null") : jsonString(options.tiles)) << ",\n"
+         << "  \"vector\": " << (options.vector.empty() ? std::string("null") : jsonString(options.vector)) << ",\n"
+         << "  \"paths\": [\n";
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        std::cerr << "Running " << paths[i].name << " (" << paths[i].getDuration() << "s)" << std::endl;
+        json << runPath(paths[i], options, source, vectorSource, pace) << (i + 1 < paths.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+    
+    if (!options.trace.empty())
+    {
+        if (!Profiler::kEnabled)
+        {
+            std::cerr << "Profiler is compiled out (configure with -DGLOBE_PROFILER=ON), no trace written" << std::endl;
+        }
+        else if (!Profiler::shared().writeChromeTrace(options.trace))
+        {
+            std::cerr << "Cannot write " << options.trace << std::endl;
+        }
+    }
+    
+    if (options.out.empty())
+    {
+        std::cout << json.str();
+    }
+    else
+    {
+        std::ofstream file(options.out);
+        file << json.str();
+        if (!file)
+        {
+            std::cerr << "Cannot write " << options.out << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,269 @@
+/**
+ * JobSystem 压力测试与扩展性基准
+ *
+ *   JobSystemBench stress [轮数]
+ *   JobSystemBench scale  [瓦片数] [PNG 文件]
+ *
+ * stress 反复构建随机依赖图（混合优先级、部分任务取消、任务内再提交子任务），
+ * 检查每个任务恰好执行一次、依赖总是先完成、取消的任务没有执行，失败时返回非零。
+ * scale 在 1..N 个工作线程上运行合成的瓦片工作负载并输出耗时与相对 1 个工作线程的加速比
+ * （提交任务的主线程在等待时也执行任务）：
+ * - mesh：每个瓦片计算一次 LOD0 网格的球面坐标（TileGeometryCache::computeTile）
+ * - frame：每个瓦片 网格 -> 实例打包 两级依赖，最后一个帧任务依赖所有瓦片
+ * - decode：给定 PNG 文件时，每个瓦片解码一次
+ */
+
+#include "JobSystem.h"
+#include "RasterTileLoader.h"
+#include "TileGeometryCache.h"
+#include "TileMesh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool stress(int rounds)
+{
+    std::mt19937 random(42);
+    JobSystem jobs;
+    bool ok = true;
+    for (int round = 0; round < rounds && ok; round++)
+    {
+        const int count = 2000;
+        std::vector<std::atomic<int>> runs(count);
+        std::vector<std::vector<int>> dependencies(count);
+        std::vector<bool> cancelled(count, false);
+        std::atomic<int> children(0);
+        std::atomic<int> orderViolations(0);
+        for (int i = 0; i < count; i++)
+        {
+            runs[i] = 0;
+        }
+        
+        auto token = std::make_shared<CancellationToken>();
+        token->cancel();
+        
+        std::vector<JobSystem::JobHandle> handles(count);
+        for (int i = 0; i < count; i++)
+        {
+            // 只依赖编号更小的任务，保证无环
+            int dependencyCount = i > 0 ? static_cast<int>(random() % 4) : 0;
+            for (int d = 0; d < dependencyCount; d++)
+            {
+                dependencies[i].push_back(static_cast<int>(random() % i));
+            }
+            cancelled[i] = random() % 10 == 0;
+            auto priority = static_cast<JobSystem::Priority>(random() % JobSystem::kPriorityCount);
+            bool spawnsChild = random() % 8 == 0;
+            handles[i] = jobs.create([&, i, spawnsChild]() {
+                // 取消的依赖没有执行函数体，但同样必须先完成
+                for (int dependency : dependencies[i])
+                {
+                    if (!handles[dependency]->isDone())
+                    {
+                        orderViolations++;
+                    }
+                }
+                runs[i]++;
+                if (spawnsChild)
+                {
+                    JobSystem::JobHandle child = jobs.schedule([&children]() { children++; });
+                    jobs.wait(child);
+                }
+            }, priority, cancelled[i] ? token : nullptr);
+        }
+        
+        // 取消的任务不执行函数体，但依然算完成，依赖它的任务照常执行
+        JobSystem::JobHandle all = jobs.create([]() {}, JobSystem::Priority::High);
+        for (int i = 0; i < count; i++)
+        {
+            for (int dependency : dependencies[i])
+            {
+                jobs.addDependency(handles[i], handles[dependency]);
+            }
+            jobs.addDependency(all, handles[i]);
+        }
+        jobs.submit(all);
+        for (int i = count - 1; i >= 0; i--)
+        {
+            jobs.submit(handles[i]);
+        }
+        jobs.wait(all);
+        
+        int executed = 0;
+        for (int i = 0; i < count; i++)
+        {
+            int expected = cancelled[i] ? 0 : 1;
+            if (runs[i] != expected || !handles[i]->isDone())
+            {
+                std::cerr << "round " << round << ": job " << i << " ran " << runs[i] << " times (expected " << expected << ")" << std::endl;
+                ok = false;
+                break;
+            }
+            executed += expected;
+        }
+        if (orderViolations > 0)
+        {
+            std::cerr << "round " << round << ": " << orderViolations << " jobs ran before a dependency" << std::endl;
+            ok = false;
+        }
+        if ((round + 1) % 10 == 0 || !ok)
+        {
+            JobSystem::Stats stats = jobs.getStats();
+            std::cout << "round " << round + 1 << ": executed " << executed << " + " << children << " children"
+                      << " | total executed " << stats.executed << " stolen " << stats.stolen << " cancelled " << stats.cancelled << std::endl;
+        }
+    }
+    return ok;
+}
+
+struct Workload
+{
+    const char* name;
+    std::function<void(JobSystem&)> run;
+};
+
+void scale(size_t tileCount, const std::string& pngPath)
+{
+    TileMesh mesh;
+    std::vector<TileID> tiles;
+    int z = 8;
+    for (size_t i = 0; i < tileCount; i++)
+    {
+        TileID tile;
+        tile.z = z;
+        tile.x = static_cast<int>(i % (1u << z));
+        tile.y = static_cast<int>((i / (1u << z)) % (1u << z));
+        tiles.push_back(tile);
+    }
+    size_t vertexCount = mesh.getLod(0).vertexCount;
+    std::vector<float> positions(tileCount * vertexCount * 3);
+    std::vector<float> packed(tileCount * 4);
+    
+    std::vector<uint8_t> png;
+    if (!pngPath.empty())
+    {
+        std::ifstream file(pngPath, std::ios::binary);
+        png.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    
+    std::vector<Workload> workloads;
+    workloads.push_back({ "mesh", [&](JobSystem& jobs) {
+        JobSystem::JobHandle frame = jobs.create([]() {}, JobSystem::Priority::High);
+        for (size_t i = 0; i < tileCount; i++)
+        {
+            JobSystem::JobHandle job = jobs.create([&, i]() {
+                TileGeometryCache::computeTile(mesh, tiles[i], 0, &positions[i * vertexCount * 3]);
+            }, JobSystem::Priority::High);
+            jobs.addDependency(frame, job);
+            jobs.submit(job);
+        }
+        jobs.submit(frame);
+        jobs.wait(frame);
+    } });
+    workloads.push_back({ "frame", [&](JobSystem& jobs) {
+        JobSystem::JobHandle frame = jobs.create([]() {}, JobSystem::Priority::High);
+        for (size_t i = 0; i < tileCount; i++)
+        {
+            JobSystem::JobHandle geometry = jobs.schedule([&, i]() {
+                TileGeometryCache::computeTile(mesh, tiles[i], 0, &positions[i * vertexCount * 3]);
+            }, JobSystem::Priority::High);
+            JobSystem::JobHandle instance = jobs.schedule([&, i]() {
+                // 实例打包：取网格包围盒中心
+                const float* p = &positions[i * vertexCount * 3];
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+                for (size_t v = 0; v < vertexCount; v++)
+                {
+                    sum[0] += p[v * 3];
+                    sum[1] += p[v * 3 + 1];
+                    sum[2] += p[v * 3 + 2];
+                }
+                packed[i * 4] = sum[0] / vertexCount;
+                packed[i * 4 + 1] = sum[1] / vertexCount;
+                packed[i * 4 + 2] = sum[2] / vertexCount;
+                packed[i * 4 + 3] = static_cast<float>(tiles[i].z);
+            }, JobSystem::Priority::High, { geometry });
+            jobs.addDependency(frame, instance);
+        }
+        jobs.submit(frame);
+        jobs.wait(frame);
+    } });
+    if (!png.empty())
+    {
+        workloads.push_back({ "decode", [&](JobSystem& jobs) {
+            jobs.parallelFor(tileCount, 1, [&](size_t begin, size_t end) {
+                DecodedTile decoded;
+                for (size_t i = begin; i < end; i++)
+                {
+                    RasterTileLoader::decode(png.data(), png.size(), decoded);
+                }
+            }, static_cast<unsigned>(tileCount), JobSystem::Priority::Normal);
+        } });
+    }
+    
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (const Workload& workload : workloads)
+    {
+        double baseline = 0.0;
+        for (unsigned threads = 1; threads <= maxThreads; threads = threads < 4 ? threads + 1 : threads * 2)
+        {
+            JobSystem jobs(threads);
+            workload.run(jobs);   // 预热
+            const int repeats = 5;
+            double best = 1e30;
+            for (int r = 0; r < repeats; r++)
+            {
+                auto start = Clock::now();
+                workload.run(jobs);
+                best = std::min(best, secondsSince(start));
+            }
+            if (threads == 1)
+            {
+                baseline = best;
+            }
+            std::printf("%-7s workers %2u: %8.2f ms  speedup %5.2fx  stolen %llu\n", workload.name, threads, best * 1000.0,
+                        baseline / best, static_cast<unsigned long long>(jobs.getStats().stolen));
+        }
+    }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "stress")
+    {
+        int rounds = argc > 2 ? std::atoi(argv[2]) : 100;
+        bool ok = stress(rounds);
+        std::cout << (ok ? "stress: ok" : "stress: FAILED") << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (command == "scale")
+    {
+        size_t tiles = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2048;
+        scale(tiles, argc > 3 ? argv[3] : "");
+        return 0;
+    }
+    std::cerr << "usage: JobSystemBench stress [rounds]\n"
+              << "       JobSystemBench scale [tiles] [png]" << std::endl;
+    return 2;
+}
@@ -0,0 +1,283 @@
+/**
+ * 标注碰撞 / 放置基准
+ *
+ *   LabelPlacementBench [--candidates N]... [--seed S] [--threads T] [--width W] [--height H]
+ *
+ * 每个 --candidates（默认 10k、30k、100k）生成一组候选：70% 围绕 N / 500 个中心正态分布（一部分贴着经度 ±180），
+ * 30% 在全球均匀分布；80% 为矩形（40..160 x 14..20 像素），20% 为圆（半径 8..14），优先级 0..9。
+ * --threads 为锚点投影的最大并行段数（默认 1）。对内置相机路径和一个跨越经度 ±180 自转的球面相机，每帧（60 fps）update + advance，输出：
+ * - update / project / place 每帧耗时的 p50 / p95 / max
+ * - 每帧平均的已放置、视口外、球背面、碰撞数，以及放置状态翻转的候选数（稳定性）
+ * - incremental：相机不变时删除 1%、新增 1% 后的增量 update 与整体重新放置的耗时对比，
+ *   以及因候选被优先级更低的标注挡住而改为整体放置的次数
+ *
+ * 放置结果不重叠、增量与整体放置一致由 GlobeCoreTests 的 Label 分组检查。
+ */
+
+#include "CameraPath.h"
+#include "GlobeProjection.h"
+#include "LabelPlacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+std::vector<LabelPlacer::Candidate> generateCandidates(size_t count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> anyLon(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> anyLat(-80.0f, 80.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<glm::vec3> centers(std::max<size_t>(1, count / 500));      // (经度, 纬度, 标准差)
+    for (size_t i = 0; i < centers.size(); i++)
+    {
+        float centerLon = i % 16 == 0 ? 179.5f : anyLon(random);
+        centers[i] = glm::vec3(centerLon, anyLat(random), 0.05f + 3.0f * unit(random) * unit(random));
+    }
+    
+    std::vector<LabelPlacer::Candidate> candidates(count);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    for (size_t i = 0; i < count; i++)
+    {
+        LabelPlacer::Candidate& candidate = candidates[i];
+        if (unit(random) < 0.3f)
+        {
+            candidate.lon = anyLon(random);
+            candidate.lat = anyLat(random);
+        }
+        else
+        {
+            const glm::vec3& center = centers[random() % centers.size()];
+            float x = center.x + normal(random) * center.z;
+            candidate.lon = x > 180.0f ? x - 360.0f : x;
+            candidate.lat = std::clamp(center.y + normal(random) * center.z, -85.0f, 85.0f);
+        }
+        if (unit(random) < 0.8f)
+        {
+            candidate.shape = LabelPlacer::Shape::Box;
+            candidate.size = glm::vec2(40.0f + 120.0f * unit(random), 14.0f + 6.0f * unit(random));
+            candidate.offset = glm::vec2(0.0f, -candidate.size.y);
+        }
+        else
+        {
+            candidate.shape = LabelPlacer::Shape::Circle;
+            candidate.size = glm::vec2(8.0f + 6.0f * unit(random), 0.0f);
+        }
+        candidate.priority = static_cast<float>(random() % 10);
+        candidate.id = static_cast<uint32_t>(i);
+    }
+    return candidates;
+}
+
+struct Scenario
+{
+    std::string name;
+    std::vector<GlobeProjection> cameras;
+};
+
+std::vector<Scenario> scenarios()
+{
+    std::vector<Scenario> result;
+    for (const std::string& name : CameraPath::builtinNames())
+    {
+        CameraPath path;
+        CameraPath::builtin(name, path);
+        Scenario scenario{ name, {} };
+        for (double t = 0.0; t <= path.getDuration(); t += 1.0 / 60.0)
+        {
+            GlobeProjection camera;
+            path.sample(t, camera);
+            scenario.cameras.push_back(camera);
+        }
+        result.push_back(std::move(scenario));
+    }
+    
+    // 球面自转跨过经度 ±180：半个球在背面，由裁剪平面排除
+    Scenario spin{ "globe-spin", {} };
+    for (int i = 0; i < 600; i++)
+    {
+        GlobeProjection camera;
+        camera.centerLon = 120.0f + 0.2f * i;
+        camera.centerLat = 25.0f;
+        camera.zoom = 2.5f;
+        camera.transition = 1.0f;
+        spin.cameras.push_back(camera);
+    }
+    result.push_back(std::move(spin));
+    return result;
+}
+
+/**
+ * 一组候选的完整测试
+ */
+void runBench(size_t count, unsigned seed, unsigned threads, int width, int height)
+{
+    std::printf("== %zu candidates, %dx%d ==\n", count, width, height);
+    const std::vector<LabelPlacer::Candidate> candidates = generateCandidates(count, seed);
+    const float aspect = static_cast<float>(width) / height;
+    LabelPlacer::Options options;
+    options.threadCount = threads;
+    
+    std::printf("  scenario     frames  update p50/p95/max (ms)   project p50   place p50   placed  outside  horizon  collided  flips/frame\n");
+    for (const Scenario& scenario : scenarios())
+    {
+        LabelPlacer placer(options);
+        std::vector<uint32_t> handles;
+        handles.reserve(count);
+        for (const LabelPlacer::Candidate& candidate : candidates)
+        {
+            handles.push_back(placer.add(candidate));
+        }
+        
+        std::vector<double> updates, projects, places;
+        std::vector<uint8_t> previous(count, 0);
+        double placed = 0.0, outside = 0.0, horizon = 0.0, collided = 0.0;
+        size_t flips = 0;
+        for (const GlobeProjection& camera : scenario.cameras)
+        {
+            auto start = Clock::now();
+            placer.update(camera.getState(aspect), width, height);
+            updates.push_back(millisecondsSince(start));
+            placer.advance(1.0f / 60.0f);
+            
+            const LabelPlacer::Stats& stats = placer.getStats();
+            projects.push_back(stats.projectMilliseconds);
+            places.push_back(stats.placeMilliseconds);
+            placed += stats.placed;
+            outside += stats.outsideView;
+            horizon += stats.beyondHorizon;
+            collided += stats.collided;
+            for (size_t i = 0; i < count; i++)
+            {
+                uint8_t now = placer.isPlaced(handles[i]) ? 1 : 0;
+                flips += now != previous[i] ? 1 : 0;
+                previous[i] = now;
+            }
+        }
+        const double frames = static_cast<double>(scenario.cameras.size());
+        std::printf("  %-11s %7zu  %6.2f / %6.2f / %6.2f   %11.2f %11.2f %8.0f %8.0f %8.0f %9.0f %12.1f\n",
+                    scenario.name.c_str(), scenario.cameras.size(), percentile(updates, 0.5), percentile(updates, 0.95),
+                    percentile(updates, 1.0), percentile(projects, 0.5), percentile(places, 0.5), placed / frames,
+                    outside / frames, horizon / frames, collided / frames, flips / frames);
+    }
+    
+    // 相机不变：删除 1%、新增 1%，增量 update 与整体重新放置对比
+    {
+        LabelPlacer placer(options);
+        std::vector<uint32_t> handles;
+        for (const LabelPlacer::Candidate& candidate : candidates)
+        {
+            handles.push_back(placer.add(candidate));
+        }
+        GlobeProjection camera;
+        camera.centerLat = 30.0f;
+        camera.zoom = 3.0f;
+        camera.transition = 0.5f;
+        auto state = camera.getState(aspect);
+        auto start = Clock::now();
+        placer.update(state, width, height);
+        const double fullMs = millisecondsSince(start);
+        
+        std::mt19937 random(seed + 1);
+        std::vector<double> incrementals;
+        size_t fallbacks = 0;
+        const size_t churn = std::max<size_t>(1, count / 100);
+        for (int round = 0; round < 20; round++)
+        {
+            for (size_t i = 0; i < churn; i++)
+            {
+                size_t slot = random() % handles.size();
+                LabelPlacer::Candidate candidate = placer.getCandidate(handles[slot]);
+                placer.remove(handles[slot]);
+                handles[slot] = placer.add(candidate);
+            }
+            start = Clock::now();
+            placer.update(state, width, height);
+            incrementals.push_back(millisecondsSince(start));
+            fallbacks += placer.getStats().incremental ? 0 : 1;
+        }
+        std::printf("incremental: -%zu / +%zu per update, p50 %.3f ms, max %.3f ms vs full %.2f ms (%.1fx), %zu placed, %zu/%zu fell back to full placement\n",
+                    churn, churn, percentile(incrementals, 0.5), percentile(incrementals, 1.0), fullMs,
+                    fullMs / std::max(percentile(incrementals, 0.5), 1e-6), placer.getStats().placed, fallbacks,
+                    incrementals.size());
+    }
+    std::fflush(stdout);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> counts;
+    unsigned seed = 1;
+    unsigned threads = 1;
+    int width = 1920;
+    int height = 1080;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--candidates" && hasValue)
+        {
+            counts.push_back(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--width" && hasValue)
+        {
+            width = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--height" && hasValue)
+        {
+            height = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: LabelPlacementBench [--candidates N]... [--seed S] [--threads T] [--width W] [--height H]\n");
+            return 2;
+        }
+    }
+    if (counts.empty())
+    {
+        counts = { 10000, 30000, 100000 };
+    }
+    
+    for (size_t count : counts)
+    {
+        if (count > 0)
+        {
+            runBench(count, seed, threads, width, height);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,494 @@
+/**
+ * CPU 路径微基准
+ *
+ *   MicroBench [--filter 子串] [--baseline 基线文件] [--threshold 0.25] [--write-baseline 基线文件]
+ *              [--min-time 秒] [--samples 15] [--out 结果.json]
+ *
+ * 覆盖：
+ * - projection/…：GlobeProjection 的 Globe/Mercator 矩阵、裁剪平面、wrap 选择与 ProjectionState 构建，
+ *   以及帧内实际使用的 ProjectionState::mercatorMatrix / wrapForTile
+ * - mesh/grid/N：N × N 网格的生成与顶点缓存重排（原 createTileMesh 的输出），mesh/TileMesh 为全部 LOD
+ * - frame/prep/N：N 个 tile（16 到 10000）的整帧 CPU 准备：剔除、LOD 选择与实例打包、几何缓存
+ * - frame/build/路径：FrameBuilder::build 沿内置相机路径逐帧构建的平均耗时
+ *
+ * 每个用例先自动确定迭代次数（单次采样不少于 min-time），再与固定的参照循环（reference/calibration）
+ * 交替采样 samples 次，报告耗时的中位数（纳秒/次）与相对参照的比值的中位数。
+ * 指定 --baseline 时按比值与基线对比：主频变化、其他进程抢占等对整台机器的影响在比值中相互抵消，
+ * 比基线慢超过 threshold（默认 25%）的用例重新测量，连续 3 次都超过时才算回归并返回 1；
+ * 基线中没有的用例只报告不判定。
+ * 基线与机器相关，不随仓库提交，在做对比的机器上用 --write-baseline 生成；生成前先用同一台机器
+ * 连续运行两次确认用例间的波动明显小于 threshold（单核或超售的虚拟机通常达不到）。
+ */
+
+#include "CameraPath.h"
+#include "FrameBuilder.h"
+#include "GlobeProjection.h"
+#include "ProjectionState.h"
+#include "TileCuller.h"
+#include "TileGeometryCache.h"
+#include "TileInstanceBuffer.h"
+#include "TileMesh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// 超过阈值的用例最多重新测量的次数
+constexpr int kConfirmRuns = 2;
+
+// 防止被测代码的结果被优化掉
+volatile float sink = 0.0f;
+
+struct Case
+{
+    std::string name;
+    std::function<void(size_t)> run;   // 执行 iterations 次
+};
+
+struct Result
+{
+    std::string name;
+    double nanoseconds = 0.0;   // 每次迭代，采样的中位数
+    double relative = 0.0;      // 与紧邻的参照循环采样的耗时比，采样的中位数
+    size_t iterations = 0;
+};
+
+/**
+ * 参照循环：只有整数与浮点运算的依赖链，不访问被测代码，用来抵消整台机器的速度变化
+ */
+Case makeReference()
+{
+    return { "reference/calibration", [](size_t iterations) {
+        uint32_t state = 12345u;
+        float value = 0.0f;
+        for (size_t i = 0; i < iterations; i++)
+        {
+            for (int step = 0; step < 64; step++)
+            {
+                state = state * 1664525u + 1013904223u;
+                value = value * 0.999f + static_cast<float>(state >> 16) * 1e-6f;
+            }
+        }
+        sink = sink + value;
+    } };
+}
+
+double timeRun(const Case& benchCase, size_t iterations)
+{
+    auto start = Clock::now();
+    benchCase.run(iterations);
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+size_t calibrateIterations(const Case& benchCase, double minTime)
+{
+    // 按上一次耗时估算迭代次数，直到单次采样达到 minTime
+    size_t iterations = 1;
+    double seconds = timeRun(benchCase, iterations);
+    while (seconds < minTime && iterations < (size_t(1) << 40))
+    {
+        iterations *= seconds > 0.0 ? std::max<size_t>(2, std::min<size_t>(100, static_cast<size_t>(minTime / seconds * 1.2))) : 100;
+        seconds = timeRun(benchCase, iterations);
+    }
+    return iterations;
+}
+
+double median(std::vector<double> values)
+{
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+Result measure(const Case& benchCase, const Case& reference, size_t referenceIterations, double minTime, int samples)
+{
+    size_t iterations = calibrateIterations(benchCase, minTime);
+    // 每次采样紧接着采一次参照，两者受到相同的主频与抢占影响；
+    // 取中位数而不是最快的一次：最快的一次只反映偶然的最好情况，在共享的机器上波动反而更大
+    std::vector<double> perIteration, relative;
+    for (int i = 0; i < samples; i++)
+    {
+        double referenceSeconds = timeRun(reference, referenceIterations) / referenceIterations;
+        double seconds = timeRun(benchCase, iterations) / iterations;
+        perIteration.push_back(seconds * 1e9);
+        relative.push_back(seconds / referenceSeconds);
+    }
+    Result result;
+    result.name = benchCase.name;
+    result.nanoseconds = median(perIteration);
+    result.relative = median(relative);
+    result.iterations = iterations;
+    return result;
+}
+
+GlobeProjection makeCamera(float lon, float lat, float zoom, float transition)
+{
+    GlobeProjection projection;
+    projection.centerLon = lon;
+    projection.centerLat = lat;
+    projection.zoom = zoom;
+    projection.transition = transition;
+    return projection;
+}
+
+/**
+ * 以 (lon, lat) 所在 tile 为中心、按行优先取 count 个同层级 tile（层级取能容纳 count 的最小层级）
+ */
+std::vector<TileID> tilesAround(float lon, float lat, size_t count)
+{
+    int z = 0;
+    while ((size_t(1) << (2 * z)) < count)
+    {
+        z++;
+    }
+    int n = 1 << z;
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    int centerX = static_cast<int>((lon / 360.0f + 0.5f) * n);
+    int centerY = static_cast<int>(GlobeProjection::mercatorYFromLat(lat) * n);
+    int firstX = centerX - side / 2;
+    int firstY = std::clamp(centerY - side / 2, 0, std::max(0, n - side));
+    std::vector<TileID> tiles;
+    for (int row = 0; row < side && tiles.size() < count; row++)
+    {
+        for (int column = 0; column < side && tiles.size() < count; column++)
+        {
+            int x = ((firstX + column) % n + n) % n;
+            tiles.push_back({ x, std::min(n - 1, firstY + row), z, 0 });
+        }
+    }
+    return tiles;
+}
+
+/**
+ * 用例共享的输入：相机与 tile 在每次迭代间轮换，避免分支预测和常量折叠让结果偏乐观
+ */
+struct Inputs
+{
+    std::vector<GlobeProjection> cameras;                        // 64 个
+    std::vector<std::shared_ptr<const ProjectionState>> states;  // 与 cameras 对应
+    std::vector<TileID> tiles;                                   // 256 个
+    TileMesh mesh;
+    
+    explicit Inputs(float aspect)
+    {
+        for (int i = 0; i < 64; i++)
+        {
+            cameras.push_back(makeCamera(-180.0f + i * 5.7f, -70.0f + (i * 37 % 140), 1.0f + (i % 12) * 0.5f, (i % 5) * 0.25f));
+            states.push_back(std::make_shared<ProjectionState>(cameras.back(), aspect));
+        }
+        tiles = tilesAround(10.0f, 45.0f, 256);
+    }
+};
+
+std::vector<Case> makeCases(const Inputs& inputs, float aspect)
+{
+    std::vector<Case> cases;
+    
+    cases.push_back({ "projection/calculateGlobeMatrix", [&inputs, aspect](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            sink = sink + inputs.cameras[i & 63].calculateGlobeMatrix(aspect)[3][2];
+        }
+    } });
+    cases.push_back({ "projection/calculateMercatorMatrix", [&inputs, aspect](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            const TileID& tile = inputs.tiles[i & 255];
+            sink = sink + inputs.cameras[i & 63].calculateMercatorMatrix(tile.x, tile.y, tile.z, tile.wrap, aspect)[3][2];
+        }
+    } });
+    cases.push_back({ "projection/getWrapForTile", [&inputs](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            const TileID& tile = inputs.tiles[i & 255];
+            sink = sink + static_cast<float>(inputs.cameras[i & 63].getWrapForTile(tile.x, tile.y, tile.z));
+        }
+    } });
+    cases.push_back({ "projection/calculateClippingPlane", [&inputs](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            sink = sink + inputs.cameras[i & 63].calculateClippingPlane().w;
+        }
+    } });
+    cases.push_back({ "projection/ProjectionState", [&inputs, aspect](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            ProjectionState state(inputs.cameras[i & 63], aspect);
+            sink = sink + state.getClippingPlane().w;
+        }
+    } });
+    
+    cases.push_back({ "projection/state.mercatorMatrix", [&inputs](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            sink = sink + inputs.states[i & 63]->mercatorMatrix(inputs.tiles[i & 255])[3][2];
+        }
+    } });
+    cases.push_back({ "projection/state.wrapForTile", [&inputs](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            const TileID& tile = inputs.tiles[i & 255];
+            sink = sink + static_cast<float>(inputs.states[i & 63]->wrapForTile(tile.x, tile.z));
+        }
+    } });
+    
+    for (int divisions = TileMesh::kMinDivisions; divisions <= TileMesh::kMinDivisions << (TileMesh::kLodCount - 1); divisions *= 2)
+    {
+        cases.push_back({ "mesh/grid/" + std::to_string(divisions), [divisions](size_t iterations) {
+            std::vector<uint16_t> vertices, indices;
+            for (size_t i = 0; i < iterations; i++)
+            {
+                TileMesh::buildGrid(divisions, vertices, indices);
+                TileMesh::optimizeGrid(divisions, vertices, indices);
+                sink = sink + indices.back();
+            }
+        } });
+    }
+    cases.push_back({ "mesh/TileMesh", [](size_t iterations) {
+        for (size_t i = 0; i < iterations; i++)
+        {
+            TileMesh mesh;
+            sink = sink + mesh.getIndices().back();
+        }
+    } });
+    
+    // 整帧准备：过渡中（0.5）的相机，所有 tile 都打包（模拟全部可见的最坏情况），剔除结果只计数
+    for (size_t count : { 16, 64, 256, 1024, 4096, 10000 })
+    {
+        cases.push_back({ "frame/prep/" + std::to_string(count), [&inputs, count, aspect](size_t iterations) {
+            GlobeProjection camera = makeCamera(10.0f, 45.0f, 0.5f * std::log2(static_cast<float>(count)), 0.5f);
+            std::vector<TileID> frameTiles = tilesAround(camera.centerLon, camera.centerLat, count);
+            std::shared_ptr<const ProjectionState> state = camera.getState(aspect);
+            TileCuller culler;
+            TileGeometryCache geometryCache(inputs.mesh);
+            TileInstanceBuffer instances;
+            for (size_t i = 0; i < iterations; i++)
+            {
+                culler.update(state);
+                size_t visible = 0;
+                for (const TileID& tile : frameTiles)
+                {
+                    visible += culler.test(tile) == TileCuller::Result::Visible ? 1 : 0;
+                }
+                geometryCache.beginFrame();
+                instances.build(*state, frameTiles, &geometryCache);
+                geometryCache.computePending();
+                sink = sink + static_cast<float>(visible + instances.size());
+            }
+        } });
+    }
+    
+    for (const std::string& name : CameraPath::builtinNames())
+    {
+        cases.push_back({ "frame/build/" + name, [&inputs, name, aspect](size_t iterations) {
+            CameraPath path;
+            CameraPath::builtin(name, path);
+            FrameBuilder builder(inputs.mesh);
+            // 每次迭代为路径上的一帧（按 60Hz 采样，循环回放）
+            size_t frames = static_cast<size_t>(path.getDuration() * 60.0) + 1;
+            GlobeProjection camera;
+            for (size_t i = 0; i < iterations; i++)
+            {
+                path.sample(static_cast<double>(i % frames) / 60.0, camera);
+                sink = sink + static_cast<float>(builder.build(camera, aspect)->tiles.size());
+            }
+        } });
+    }
+    return cases;
+}
+
+struct BaselineEntry
+{
+    double nanoseconds = 0.0;
+    double relative = 0.0;   // 旧格式的基线没有这一列，此时按纳秒对比
+};
+
+bool readBaseline(const std::string& path, std::map<std::string, BaselineEntry>& baseline)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name;
+        BaselineEntry entry;
+        if (fields >> name >> entry.nanoseconds)
+        {
+            fields >> entry.relative;
+            baseline[name] = entry;
+        }
+    }
+    return true;
+}
+
+bool writeBaseline(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream file(path);
+    file << "# MicroBench 基线：用例名 纳秒/次 相对参照循环的耗时比（由 MicroBench --write-baseline 生成）\n";
+    char line[160];
+    for (const Result& result : results)
+    {
+        std::snprintf(line, sizeof(line), "%-36s %14.1f %14.4f\n", result.name.c_str(), result.nanoseconds, result.relative);
+        file << line;
+    }
+    return static_cast<bool>(file);
+}
+
+bool writeJson(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream file(path);
+    file << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        file << "    { \"name\": \"" << results[i].name << "\", \"ns\": " << results[i].nanoseconds
+             << ", \"relative\": " << results[i].relative << ", \"iterations\": " << results[i].iterations << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+    return static_cast<bool>(file);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string filter, baselinePath, writeBaselinePath, out;
+    double threshold = 0.25;
+    double minTime = 0.1;
+    int samples = 15;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--filter" && hasValue)
+        {
+            filter = argv[++i];
+        }
+        else if (argument == "--baseline" && hasValue)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (argument == "--write-baseline" && hasValue)
+        {
+            writeBaselinePath = argv[++i];
+        }
+        else if (argument == "--threshold" && hasValue)
+        {
+            threshold = std::atof(argv[++i]);
+        }
+        else if (argument == "--min-time" && hasValue)
+        {
+            minTime = std::max(0.001, std::atof(argv[++i]));
+        }
+        else if (argument == "--samples" && hasValue)
+        {
+            samples = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--out" && hasValue)
+        {
+            out = argv[++i];
+        }
+        else
+        {
+            std::cerr << "usage: MicroBench [--filter text] [--baseline file] [--threshold 0.25] [--write-baseline file]\n"
+                      << "                  [--min-time seconds] [--samples 15] [--out result.json]" << std::endl;
+            return 2;
+        }
+    }
+    
+    std::map<std::string, BaselineEntry> baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline))
+    {
+        std::cerr << "Cannot read baseline " << baselinePath << std::endl;
+        return 2;
+    }
+    
+    const float aspect = 16.0f / 9.0f;
+    Inputs inputs(aspect);
+    // 参照循环的单次采样取 minTime 的一半，本身也作为一个用例报告（比值恒为 1，不参与判定）
+    const Case reference = makeReference();
+    const size_t referenceIterations = calibrateIterations(reference, minTime * 0.5);
+    std::vector<Case> cases = makeCases(inputs, aspect);
+    cases.insert(cases.begin(), reference);
+    
+    std::vector<Result> results;
+    size_t regressions = 0;
+    for (const Case& benchCase : cases)
+    {
+        if (!filter.empty() && benchCase.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        Result result = measure(benchCase, reference, referenceIterations, minTime, samples);
+        auto entry = baseline.find(result.name);
+        const bool compared = entry != baseline.end() && entry->second.nanoseconds > 0.0;
+        // 参照循环的变化只说明机器整体变快或变慢，不判定
+        const bool isReference = &benchCase == &cases.front();
+        auto changeOf = [&](const Result& measured) {
+            return entry->second.relative > 0.0 && !isReference ? measured.relative / entry->second.relative - 1.0
+                                                                : measured.nanoseconds / entry->second.nanoseconds - 1.0;
+        };
+        // 超过阈值时重新测量，每次都超过才算回归（偶发的抢占很少连续命中同一个用例）
+        for (int retry = 0; compared && !isReference && retry < kConfirmRuns && changeOf(result) > threshold; retry++)
+        {
+            Result again = measure(benchCase, reference, referenceIterations, minTime, samples);
+            result = changeOf(again) < changeOf(result) ? again : result;
+        }
+        results.push_back(result);
+        
+        char line[192];
+        std::snprintf(line, sizeof(line), "%-36s %14.1f ns %10.4f", result.name.c_str(), result.nanoseconds, result.relative);
+        std::cout << line;
+        if (compared)
+        {
+            double change = changeOf(result);
+            bool regressed = change > threshold && !isReference;
+            regressions += regressed ? 1 : 0;
+            std::snprintf(line, sizeof(line), "  baseline %14.1f ns  %+7.1f%%%s", entry->second.nanoseconds, change * 100.0,
+                          regressed ? "  REGRESSION" : "");
+            std::cout << line;
+        }
+        else if (!baselinePath.empty())
+        {
+            std::cout << "  (not in baseline)";
+        }
+        std::cout << std::endl;
+    }
+    
+    if (!writeBaselinePath.empty() && !writeBaseline(writeBaselinePath, results))
+    {
+        std::cerr << "Cannot write " << writeBaselinePath << std::endl;
+        return 2;
+    }
+    if (!out.empty() && !writeJson(out, results))
+    {
+        std::cerr << "Cannot write " << out << std::endl;
+        return 2;
+    }
+    if (regressions > 0)
+    {
+        std::cout << regressions << " case(s) regressed by more than " << threshold * 100.0 << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
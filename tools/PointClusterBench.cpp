@@ -0,0 +1,336 @@
+/**
+ * 点聚类索引基准
+ *
+ *   PointClusterBench [--points N]... [--seed S] [--threads T] [--tiles N] [--no-serial]
+ *
+ * 每个 --points（默认 1M 和 10M）生成一组点：70% 围绕 N / 5000 个簇中心正态分布（一部分贴着经度 ±180），
+ * 30% 在全球均匀分布。输出：
+ * - build：投影 + 排序、逐级聚类的耗时；并行（--threads 限制并行段数，0 为不限制）与单线程的对比
+ * - memory：索引字节数 / 点（超过 PointClusterIndex::kMaxBytesPerPoint 时以非零状态退出），构建前后的峰值 RSS
+ * - levels：每个层级的可见实体数
+ * - tile：每个层级 --tiles 个包含随机输入点的瓦片的 getTile 延迟
+ * - frame：内置相机路径（以及一个跨越经度 ±180 的 Globe 过渡相机）每帧 CoveringTiles 选出的瓦片
+ *   （wrap 由覆盖选择给出）的查询总耗时
+ * - expand：z2..z12 聚类的 getChildren、getLeaves（前 100 个）延迟和展开层级
+ */
+
+#include "CameraPath.h"
+#include "CoveringTiles.h"
+#include "GlobeProjection.h"
+#include "PointClusterIndex.h"
+#include "TileID.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+/**
+ * 进程的峰值常驻内存（字节）；Windows 上返回 0
+ */
+size_t peakResidentBytes()
+{
+#ifndef _WIN32
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;     // Linux 上单位为 KB
+    }
+#endif
+    return 0;
+}
+
+double megabytes(size_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+void generatePoints(size_t count, unsigned seed, std::vector<float>& lon, std::vector<float>& lat)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> anyLon(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> anyLat(-85.0f, 85.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<glm::vec3> centers(std::max<size_t>(1, count / 5000));     // (经度, 纬度, 标准差)
+    for (size_t i = 0; i < centers.size(); i++)
+    {
+        // 每 16 个簇有一个贴着经度 ±180，覆盖缓冲区跨世界的查询
+        float centerLon = i % 16 == 0 ? 179.5f : anyLon(random);
+        centers[i] = glm::vec3(centerLon, anyLat(random) * 0.8f, 0.01f + 2.0f * unit(random) * unit(random));
+    }
+    
+    lon.resize(count);
+    lat.resize(count);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (unit(random) < 0.3f)
+        {
+            lon[i] = anyLon(random);
+            lat[i] = anyLat(random);
+            continue;
+        }
+        const glm::vec3& center = centers[random() % centers.size()];
+        float x = center.x + normal(random) * center.z;
+        lon[i] = x > 180.0f ? x - 360.0f : x;
+        lat[i] = std::clamp(center.y + normal(random) * center.z, -85.0f, 85.0f);
+    }
+}
+
+std::vector<GlobeProjection> frameCameras()
+{
+    std::vector<GlobeProjection> cameras;
+    for (const std::string& name : CameraPath::builtinNames())
+    {
+        CameraPath path;
+        CameraPath::builtin(name, path);
+        for (double t = 0.0; t <= path.getDuration(); t += 1.0 / 10.0)
+        {
+            GlobeProjection camera;
+            path.sample(t, camera);
+            cameras.push_back(camera);
+        }
+    }
+    
+    // 跨越经度 ±180 的 Globe 过渡：部分瓦片选 wrap = ±1
+    for (int i = 0; i <= 40; i++)
+    {
+        GlobeProjection camera;
+        camera.centerLon = 175.0f + 0.25f * i;
+        camera.centerLat = 20.0f;
+        camera.zoom = 2.0f + 0.2f * i;
+        camera.transition = 0.5f;
+        cameras.push_back(camera);
+    }
+    return cameras;
+}
+
+/**
+ * 一组点的完整测试；内存超出上界时返回 false
+ */
+bool runBench(size_t count, unsigned seed, unsigned threads, int tilesPerZoom, bool serial)
+{
+    std::printf("== %zu points ==\n", count);
+    std::vector<float> lon;
+    std::vector<float> lat;
+    generatePoints(count, seed, lon, lat);
+    
+    // 构建
+    const size_t residentBefore = peakResidentBytes();
+    PointClusterIndex::Options options;
+    options.maxParallelism = threads;
+    PointClusterIndex index(options);
+    auto start = Clock::now();
+    index.build(lon.data(), lat.data(), count);
+    const double parallelMs = millisecondsSince(start);
+    const size_t residentAfter = peakResidentBytes();
+    const PointClusterIndex::Stats& stats = index.getStats();
+    std::printf("build: %.1f ms (project + sort %.1f ms, cluster %.1f ms), %.2f M points/s\n", parallelMs,
+                stats.projectSeconds * 1000.0, stats.clusterSeconds * 1000.0, count / parallelMs / 1000.0);
+    if (serial)
+    {
+        PointClusterIndex::Options serialOptions = options;
+        serialOptions.maxParallelism = 1;
+        PointClusterIndex serialIndex(serialOptions);
+        start = Clock::now();
+        serialIndex.build(lon.data(), lat.data(), count);
+        const double serialMs = millisecondsSince(start);
+        std::printf("  single thread %.1f ms, speedup %.2fx\n", serialMs, serialMs / parallelMs);
+    }
+    
+    const bool withinBound = stats.bytesPerPoint() <= PointClusterIndex::kMaxBytesPerPoint;
+    std::printf("memory: %.1f MB, %.2f bytes/point (bound %zu%s), %zu clusters, %zu snapshots (%zu entries), "
+                "peak RSS %.1f MB (before build %.1f MB)\n",
+                megabytes(stats.memoryBytes), stats.bytesPerPoint(), PointClusterIndex::kMaxBytesPerPoint,
+                withinBound ? "" : ", EXCEEDED", stats.clusters, stats.snapshots, stats.snapshotEntries,
+                megabytes(residentAfter), megabytes(residentBefore));
+    std::printf("levels:");
+    for (size_t z = 0; z < stats.visible.size(); z++)
+    {
+        std::printf(" z%zu:%zu", z, stats.visible[z]);
+    }
+    std::printf("\n");
+    
+    // 包含随机输入点的瓦片
+    const int maxZoom = options.maxZoom + 2;
+    std::mt19937 random(seed + 1);
+    std::vector<PointClusterIndex::Feature> features;
+    std::printf("tile (%d tiles per zoom, microseconds):\n", tilesPerZoom);
+    std::printf("  zoom   p50      p95      max   features\n");
+    for (int z = 0; z <= maxZoom; z++)
+    {
+        std::vector<double> samples;
+        size_t total = 0;
+        const double scale = std::ldexp(1.0, z);
+        for (int i = 0; i < tilesPerZoom; i++)
+        {
+            const size_t point = random() % count;
+            TileID tile{ static_cast<int>((lon[point] / 360.0 + 0.5) * scale),
+                         static_cast<int>(GlobeProjection::mercatorYFromLat(lat[point]) * scale), z, 0 };
+            tile.x = std::clamp(tile.x, 0, static_cast<int>(scale) - 1);
+            tile.y = std::clamp(tile.y, 0, static_cast<int>(scale) - 1);
+            auto tileStart = Clock::now();
+            index.getTile(tile, features);
+            samples.push_back(millisecondsSince(tileStart) * 1000.0);
+            total += features.size();
+        }
+        std::printf("  %4d  %7.2f  %7.2f  %7.1f  %9.1f\n", z, percentile(samples, 0.5), percentile(samples, 0.95),
+                    percentile(samples, 1.0), static_cast<double>(total) / tilesPerZoom);
+    }
+    
+    // 每帧覆盖的瓦片
+    CoveringTiles covering;
+    covering.options.viewportHeight = 1080;
+    std::vector<double> frames;
+    size_t frameTiles = 0;
+    size_t frameFeatures = 0;
+    size_t wrappedTiles = 0;
+    for (const GlobeProjection& camera : frameCameras())
+    {
+        std::vector<TileID> tiles = covering.select(*camera.getState(16.0f / 9.0f));
+        auto frameStart = Clock::now();
+        for (const TileID& tile : tiles)
+        {
+            index.getTile(tile, features);
+            frameFeatures += features.size();
+            wrappedTiles += tile.wrap != 0 ? 1 : 0;
+        }
+        frames.push_back(millisecondsSince(frameStart));
+        frameTiles += tiles.size();
+    }
+    std::printf("frame: %zu frames, %.1f tiles/frame (%zu with wrap != 0), %.0f features/frame, p50 %.3f ms, p95 %.3f ms, max %.3f ms\n",
+                frames.size(), static_cast<double>(frameTiles) / frames.size(), wrappedTiles,
+                static_cast<double>(frameFeatures) / frames.size(), percentile(frames, 0.5), percentile(frames, 0.95),
+                percentile(frames, 1.0));
+    
+    // 聚类展开
+    std::vector<double> childrenSamples;
+    std::vector<double> leavesSamples;
+    std::vector<PointClusterIndex::Feature> children;
+    std::vector<uint32_t> leaves;
+    double expansionSum = 0.0;
+    bool consistent = true;
+    for (int z = 2; z <= 12; z++)
+    {
+        const double scale = std::ldexp(1.0, z);
+        for (int i = 0; i < tilesPerZoom / 10; i++)
+        {
+            const size_t point = random() % count;
+            TileID tile{ std::clamp(static_cast<int>((lon[point] / 360.0 + 0.5) * scale), 0, static_cast<int>(scale) - 1),
+                         std::clamp(static_cast<int>(GlobeProjection::mercatorYFromLat(lat[point]) * scale), 0, static_cast<int>(scale) - 1), z, 0 };
+            index.getTile(tile, features);
+            for (const PointClusterIndex::Feature& feature : features)
+            {
+                if (feature.count < 2)
+                {
+                    continue;
+                }
+                auto expandStart = Clock::now();
+                index.getChildren(feature.id, children);
+                childrenSamples.push_back(millisecondsSince(expandStart) * 1000.0);
+                expandStart = Clock::now();
+                leaves.clear();
+                index.getLeaves(feature.id, 100, 0, leaves);
+                leavesSamples.push_back(millisecondsSince(expandStart) * 1000.0);
+                expansionSum += index.getExpansionZoom(feature.id) - z;
+                
+                uint64_t sum = 0;
+                for (const PointClusterIndex::Feature& child : children)
+                {
+                    sum += child.count;
+                }
+                consistent = consistent && sum == feature.count && leaves.size() == std::min<size_t>(100, feature.count);
+                break;
+            }
+        }
+    }
+    std::printf("expand: %zu clusters, getChildren p50 %.2f us p95 %.2f us, getLeaves(100) p50 %.2f us p95 %.2f us, "
+                "expansion zoom +%.2f on average%s\n",
+                childrenSamples.size(), percentile(childrenSamples, 0.5), percentile(childrenSamples, 0.95),
+                percentile(leavesSamples, 0.5), percentile(leavesSamples, 0.95),
+                childrenSamples.empty() ? 0.0 : expansionSum / childrenSamples.size(), consistent ? "" : " (COUNT MISMATCH)");
+    std::fflush(stdout);
+    return withinBound && consistent;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> counts;
+    unsigned seed = 1;
+    unsigned threads = 0;
+    int tilesPerZoom = 1000;
+    bool serial = true;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--points" && hasValue)
+        {
+            counts.push_back(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--tiles" && hasValue)
+        {
+            tilesPerZoom = std::max(10, std::atoi(argv[++i]));
+        }
+        else if (arg == "--no-serial")
+        {
+            serial = false;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: PointClusterBench [--points N]... [--seed S] [--threads T] [--tiles N] [--no-serial]\n");
+            return 2;
+        }
+    }
+    if (counts.empty())
+    {
+        counts = { 1000000, 10000000 };
+    }
+    
+    bool ok = true;
+    for (size_t count : counts)
+    {
+        if (count > 0)
+        {
+            ok = runBench(count, seed, threads, tilesPerZoom, serial) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/**
+ * 性能分析器开销基准
+ *
+ *   ProfilerBench [区段数]
+ *
+ * 本工具总是以 GLOBE_PROFILER 编译（链接的 FrameBuilder 等也带区段），分别测量：
+ * - zone：单线程空区段的平均开销（启用 / 运行时关闭 / 没有区段的同一循环），每 4096 个区段 collect 一次
+ * - threads：多个线程同时记录区段、主线程持续 collect 时的平均开销与丢弃数
+ * - frame：FrameBuilder::build（覆盖选择、实例打包、几何缓存）沿内置相机路径逐帧构建，
+ *   启用与运行时关闭的每帧耗时对比
+ * 编译时关闭（默认配置）时区段宏展开为空语句，开销为零，与"没有区段"一行相同。
+ */
+
+#include "CameraPath.h"
+#include "FrameBuilder.h"
+#include "GlobeProjection.h"
+#include "Profiler.h"
+#include "TileMesh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// 区段内的少量工作，避免循环被整体优化掉
+volatile uint64_t sink = 0;
+
+double measureZones(size_t count, bool zones)
+{
+    Profiler& profiler = Profiler::shared();
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (zones)
+        {
+            PROFILE_ZONE("bench");
+            sink = sink + i;
+        }
+        else
+        {
+            sink = sink + i;
+        }
+        if ((i & 4095) == 4095)
+        {
+            profiler.collect();
+        }
+    }
+    profiler.collect();
+    return secondsSince(start) * 1e9 / count;
+}
+
+void benchZones(size_t count)
+{
+    Profiler& profiler = Profiler::shared();
+    measureZones(count / 10, true);   // 预热（创建时间线）
+    double bare = measureZones(count, false);
+    profiler.setEnabled(false);
+    double disabled = measureZones(count, true);
+    profiler.setEnabled(true);
+    double enabled = measureZones(count, true);
+    std::printf("zone    no zone  %6.1f ns/iteration\n", bare);
+    std::printf("zone    disabled %6.1f ns/iteration  (+%.1f ns)\n", disabled, disabled - bare);
+    std::printf("zone    enabled  %6.1f ns/iteration  (+%.1f ns)\n", enabled, enabled - bare);
+    profiler.clear();
+}
+
+void benchThreads(size_t count)
+{
+    Profiler& profiler = Profiler::shared();
+    unsigned threadCount = std::max(2u, std::thread::hardware_concurrency());
+    uint64_t droppedBefore = profiler.getStats().dropped;
+    std::atomic<unsigned> running(threadCount);
+    std::vector<std::thread> threads;
+    size_t perThread = count / threadCount;
+    auto start = Clock::now();
+    for (unsigned t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&]() {
+            for (size_t i = 0; i < perThread; i++)
+            {
+                PROFILE_ZONE("bench thread");
+                sink = sink + i;
+            }
+            running.fetch_sub(1);
+        });
+    }
+    while (running.load() > 0)
+    {
+        profiler.collect();
+        std::this_thread::yield();
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    profiler.collect();
+    double elapsed = secondsSince(start);
+    std::printf("threads %2u threads %6.1f ns/zone (per thread)  dropped %llu\n", threadCount, elapsed * 1e9 / perThread,
+                static_cast<unsigned long long>(profiler.getStats().dropped - droppedBefore));
+    profiler.clear();
+}
+
+double buildFrames(FrameBuilder& builder, const std::vector<GlobeProjection>& cameras)
+{
+    Profiler& profiler = Profiler::shared();
+    auto start = Clock::now();
+    for (const GlobeProjection& camera : cameras)
+    {
+        builder.build(camera, 16.0f / 9.0f);
+        profiler.collect();
+    }
+    return secondsSince(start) * 1000.0 / cameras.size();
+}
+
+void benchFrames()
+{
+    Profiler& profiler = Profiler::shared();
+    std::vector<GlobeProjection> cameras;
+    for (const std::string& name : CameraPath::builtinNames())
+    {
+        CameraPath path;
+        CameraPath::builtin(name, path);
+        for (double t = 0.0; t <= path.getDuration(); t += 1.0 / 60.0)
+        {
+            GlobeProjection camera;
+            path.sample(t, camera);
+            cameras.push_back(camera);
+        }
+    }
+    
+    TileMesh mesh;
+    FrameBuilder builder(mesh);
+    builder.getCoveringTiles().options.viewportHeight = 1080;
+    buildFrames(builder, cameras);   // 预热几何缓存
+    const int repeats = 5;
+    double enabled = 1e30, disabled = 1e30;
+    for (int r = 0; r < repeats; r++)
+    {
+        profiler.setEnabled(false);
+        disabled = std::min(disabled, buildFrames(builder, cameras));
+        profiler.setEnabled(true);
+        enabled = std::min(enabled, buildFrames(builder, cameras));
+    }
+    std::printf("frame   %zu cameras  disabled %.4f ms/frame  enabled %.4f ms/frame  overhead %+.2f%%\n", cameras.size(),
+                disabled, enabled, (enabled / disabled - 1.0) * 100.0);
+    profiler.clear();
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    if (count == 0)
+    {
+        std::fprintf(stderr, "usage: ProfilerBench [zones]\n");
+        return 2;
+    }
+    benchZones(count);
+    benchThreads(count);
+    benchFrames();
+    return 0;
+}
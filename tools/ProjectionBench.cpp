@@ -0,0 +1,313 @@
+/**
+ * 批量投影基准
+ *
+ *   ProjectionBench [--points N]... [--seed S] [--threads T] [--grid W]
+ *
+ * 每个 --points（默认 1M 和 10M）在全球均匀生成经纬度点，对 Mercator / 过渡 / Globe 三个相机输出：
+ * - forward：BatchProjector::projectToScreen 在每条 SIMD 路径（标量、SSE2、AVX2，本机不支持的跳过）上的
+ *   单线程 M points/s，以及 --threads 段并行（默认硬件线程数，0 表示不做并行测量）的 M points/s
+ * - 每条路径与 ProjectionState::projectToClip（shader 的 CPU 复刻）对比的可见性掩码差异和裁剪坐标最大相对误差
+ *   （掩码只允许在裁剪体边界上有差异；超过 1e-4 的相对误差以非零状态退出）
+ * - unproject：对 0..1 的多个过渡因子、能看到两侧世界副本的低缩放和普通缩放，在 W x W*9/16 的像素网格上
+ *   逐点 GlobeProjection::unproject 和 unprojectBatch 的每点延迟、命中率、落在两侧副本上的命中数，
+ *   命中点正向投影回屏幕的像素误差（p99 / max，超过 1 像素即反投影的收敛阈值时以非零状态退出），
+ *   以及两者结果不同的像素数（低缩放的过渡状态下几个世界副本在屏幕上重叠，同一像素有多个解，
+ *   批量版本以相邻点的解为初值，可能选中另一个副本）
+ */
+
+#include "BatchProjector.h"
+#include "GlobeProjection.h"
+#include "ProjectionState.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Camera
+{
+    const char* name;
+    float transition;
+};
+
+const int kViewportWidth = 1920;
+const int kViewportHeight = 1080;
+
+std::shared_ptr<const ProjectionState> makeState(float transition)
+{
+    GlobeProjection projection;
+    projection.centerLon = 30.0f;
+    projection.centerLat = 20.0f;
+    projection.zoom = 2.0f;
+    projection.transition = transition;
+    return projection.getState(static_cast<float>(kViewportWidth) / kViewportHeight);
+}
+
+/**
+ * 至少运行 0.5 秒（不少于 2 次），返回 M points/s
+ */
+template <typename Fn>
+double measure(size_t count, Fn&& fn)
+{
+    int runs = 0;
+    auto start = Clock::now();
+    do
+    {
+        fn();
+        runs++;
+    } while (runs < 2 || secondsSince(start) < 0.5);
+    return count * static_cast<double>(runs) / secondsSince(start) / 1e6;
+}
+
+/**
+ * 与标量参考实现对比：返回超出边界的掩码差异数；maxError 为裁剪坐标的最大相对误差
+ */
+size_t compareWithReference(const ProjectionState& state, const std::vector<float>& lon, const std::vector<float>& lat,
+                            const BatchProjector& projector, double& maxError)
+{
+    const size_t count = std::min<size_t>(lon.size(), 1000000);
+    std::vector<float> x(count), y(count), z(count), w(count);
+    std::vector<uint8_t> visible(count);
+    BatchProjector::ClipOutput out;
+    out.x = x.data();
+    out.y = y.data();
+    out.z = z.data();
+    out.w = w.data();
+    out.visible = visible.data();
+    projector.projectToClip(lon.data(), lat.data(), count, out);
+    
+    size_t mismatches = 0;
+    maxError = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec2 mercator(state.nearestWrapMercX(lon[i] / 360.0f + 0.5f), GlobeProjection::mercatorYFromLat(lat[i]));
+        glm::vec4 reference = state.projectToClip(mercator);
+        float scale = std::max(1.0f, std::abs(reference.w));
+        double error = std::max({ std::abs(x[i] - reference.x), std::abs(y[i] - reference.y),
+                                  std::abs(z[i] - reference.z), std::abs(w[i] - reference.w) }) / scale;
+        maxError = std::max(maxError, error);
+        
+        bool expected = ProjectionState::isInsideClipVolume(reference);
+        if (expected != (visible[i] != 0))
+        {
+            // 裁剪体边界上的点允许因舍入不同而不同
+            float margin = std::max({ std::abs(reference.x), std::abs(reference.y), std::abs(reference.z) }) - reference.w;
+            if (std::abs(margin) > 1e-4f * scale)
+            {
+                mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+/**
+ * 经纬度在 wrap = -1、0、+1 三个副本中离给定像素最近的屏幕位置，返回像素距离
+ */
+float reprojectionError(const ProjectionState& state, float lon, float lat, float screenX, float screenY)
+{
+    glm::vec2 mercator(lon / 360.0f + 0.5f, GlobeProjection::mercatorYFromLat(lat));
+    float best = std::numeric_limits<float>::max();
+    for (int wrap = -1; wrap <= 2; wrap++)
+    {
+        glm::vec4 clip = state.projectToClip(glm::vec2(mercator.x + wrap, mercator.y));
+        float x = (clip.x / clip.w * 0.5f + 0.5f) * kViewportWidth;
+        float y = (0.5f - clip.y / clip.w * 0.5f) * kViewportHeight;
+        best = std::min(best, std::hypot(x - screenX, y - screenY));
+    }
+    return best;
+}
+
+bool runUnproject(int gridWidth)
+{
+    const int gridHeight = std::max(1, gridWidth * 9 / 16);
+    const size_t count = static_cast<size_t>(gridWidth) * gridHeight;
+    std::vector<float> screenX(count), screenY(count), lon(count), lat(count);
+    std::vector<uint8_t> hit(count);
+    for (int y = 0; y < gridHeight; y++)
+    {
+        for (int x = 0; x < gridWidth; x++)
+        {
+            screenX[y * gridWidth + x] = (x + 0.5f) * kViewportWidth / gridWidth;
+            screenY[y * gridWidth + x] = (y + 0.5f) * kViewportHeight / gridHeight;
+        }
+    }
+    
+    bool ok = true;
+    std::printf("unproject (%d x %d pixel grid):\n", gridWidth, gridHeight);
+    std::printf("  zoom  transition  single (ns/pt)  batch (ns/pt)   hits  side copies  error p99 (px)  max (px)  differ\n");
+    const float zooms[] = { 0.3f, 3.0f };
+    const float transitions[] = { 0.0f, 0.0005f, 0.25f, 0.5f, 0.75f, 1.0f };
+    for (float zoom : zooms)
+    {
+        for (float transition : transitions)
+        {
+            GlobeProjection projection;
+            projection.centerLon = 30.0f;
+            projection.centerLat = 20.0f;
+            projection.zoom = zoom;
+            projection.transition = transition;
+            std::shared_ptr<const ProjectionState> state = projection.getState(static_cast<float>(kViewportWidth) / kViewportHeight);
+            
+            std::vector<uint8_t> singleHit(count);
+            std::vector<glm::vec2> singleLonLat(count);
+            auto start = Clock::now();
+            for (size_t i = 0; i < count; i++)
+            {
+                singleHit[i] = projection.unproject(screenX[i], screenY[i], kViewportWidth, kViewportHeight, singleLonLat[i]) ? 1 : 0;
+            }
+            const double singleNs = secondsSince(start) * 1e9 / count;
+            start = Clock::now();
+            size_t hits = projection.unprojectBatch(screenX.data(), screenY.data(), count, kViewportWidth, kViewportHeight,
+                                                    lon.data(), lat.data(), hit.data());
+            const double batchNs = secondsSince(start) * 1e9 / count;
+            
+            std::vector<double> errors;
+            size_t sideCopies = 0;
+            size_t differ = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                differ += hit[i] != singleHit[i] || (hit[i] && std::abs(singleLonLat[i].x - lon[i]) + std::abs(singleLonLat[i].y - lat[i]) > 1e-3f);
+                if (!hit[i])
+                {
+                    continue;
+                }
+                errors.push_back(reprojectionError(*state, lon[i], lat[i], screenX[i], screenY[i]));
+                // 离 center 最近的副本投影不到该像素时，命中的是两侧的副本
+                glm::vec2 mercator(state->nearestWrapMercX(lon[i] / 360.0f + 0.5f), GlobeProjection::mercatorYFromLat(lat[i]));
+                glm::vec4 clip = state->projectToClip(mercator);
+                float x = (clip.x / clip.w * 0.5f + 0.5f) * kViewportWidth;
+                float y = (0.5f - clip.y / clip.w * 0.5f) * kViewportHeight;
+                sideCopies += std::hypot(x - screenX[i], y - screenY[i]) > 1.0f ? 1 : 0;
+            }
+            std::sort(errors.begin(), errors.end());
+            double p99 = errors.empty() ? 0.0 : errors[std::min(errors.size() - 1, errors.size() * 99 / 100)];
+            double maxError = errors.empty() ? 0.0 : errors.back();
+            ok = ok && maxError <= 1.0;
+            std::printf("  %4.1f  %10.4f  %14.0f  %13.0f  %5.1f%%  %11zu  %14.4f  %8.4f  %6zu%s\n", zoom, transition, singleNs,
+                        batchNs, 100.0 * hits / count, sideCopies, p99, maxError, differ, maxError <= 1.0 ? "" : " (INACCURATE)");
+        }
+    }
+    std::fflush(stdout);
+    return ok;
+}
+
+bool runBench(size_t count, unsigned seed, unsigned threads)
+{
+    std::printf("== %zu points ==\n", count);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> anyLon(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> anyLat(-85.0f, 85.0f);
+    std::vector<float> lon(count), lat(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        lon[i] = anyLon(random);
+        lat[i] = anyLat(random);
+    }
+    std::vector<float> x(count), y(count), depth(count);
+    std::vector<uint8_t> visible(count);
+    BatchProjector::ScreenOutput out;
+    out.x = x.data();
+    out.y = y.data();
+    out.depth = depth.data();
+    out.visible = visible.data();
+    
+    bool ok = true;
+    const Camera cameras[] = { { "mercator", 0.0f }, { "blend", 0.5f }, { "globe", 1.0f } };
+    const BatchProjector::SimdPath paths[] = { BatchProjector::SimdPath::Scalar, BatchProjector::SimdPath::Sse2,
+                                               BatchProjector::SimdPath::Avx2 };
+    std::printf("  camera     path     1 thread (Mpts/s)  %u threads (Mpts/s)  visible  mask diff  max rel error\n", threads);
+    for (const Camera& camera : cameras)
+    {
+        std::shared_ptr<const ProjectionState> state = makeState(camera.transition);
+        for (BatchProjector::SimdPath path : paths)
+        {
+            BatchProjector projector(state, kViewportWidth, kViewportHeight);
+            projector.setSimdPath(path);
+            if (projector.getSimdPath() != path)
+            {
+                continue;
+            }
+            
+            double serial = measure(count, [&]() { projector.projectToScreen(lon.data(), lat.data(), count, out, 1); });
+            size_t visibleCount = std::count(visible.begin(), visible.end(), 1);
+            double parallel = threads > 1
+                ? measure(count, [&]() { projector.projectToScreen(lon.data(), lat.data(), count, out, threads); })
+                : 0.0;
+            double maxError = 0.0;
+            size_t mismatches = compareWithReference(*state, lon, lat, projector, maxError);
+            ok = ok && mismatches == 0 && maxError <= 1e-4;
+            std::printf("  %-9s  %-7s  %17.1f  %19.1f  %7.1f%%  %9zu  %13.2e\n", camera.name,
+                        BatchProjector::simdPathName(path), serial, parallel, 100.0 * visibleCount / count,
+                        mismatches, maxError);
+        }
+    }
+    std::fflush(stdout);
+    return ok;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<size_t> counts;
+    unsigned seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int gridWidth = 192;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--points" && hasValue)
+        {
+            counts.push_back(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--grid" && hasValue)
+        {
+            gridWidth = std::max(16, std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: ProjectionBench [--points N]... [--seed S] [--threads T] [--grid W]\n");
+            return 2;
+        }
+    }
+    if (counts.empty())
+    {
+        counts = { 1000000, 10000000 };
+    }
+    
+    std::printf("detected SIMD path: %s\n", BatchProjector::simdPathName(BatchProjector::detectSimdPath()));
+    bool ok = runUnproject(gridWidth);
+    for (size_t count : counts)
+    {
+        if (count > 0)
+        {
+            ok = runBench(count, seed, threads) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+/**
+ * 瓦片归档工具
+ *
+ *   TileArchiveTool pack  <z/x/y 目录> <归档文件>
+ *   TileArchiveTool bench <z/x/y 目录> <归档文件> [采样次数]
+ *
+ * pack 把目录中的 z/x/y.{png,jpg,jpeg,pbf,mvt} 打包为 TileArchive；
+ * bench 对比归档与逐文件读取的冷启动时间和查找延迟（两者读取相同的瓦片集合）。
+ */
+
+#include "TileArchive.h"
+#include "TileSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct TileFile
+{
+    TileID tile;
+    fs::path path;
+};
+
+bool parseInt(const std::string& text, int& value)
+{
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || parsed < 0 || parsed > (1 << 29))
+    {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+TileArchive::TileType tileTypeOf(const fs::path& path)
+{
+    std::string extension = path.extension().string();
+    if (extension == ".png")
+    {
+        return TileArchive::Png;
+    }
+    if (extension == ".jpg" || extension == ".jpeg")
+    {
+        return TileArchive::Jpeg;
+    }
+    if (extension == ".pbf" || extension == ".mvt")
+    {
+        return TileArchive::Mvt;
+    }
+    return TileArchive::Unknown;
+}
+
+std::vector<TileFile> listTiles(const fs::path& root)
+{
+    std::vector<TileFile> files;
+    for (const fs::directory_entry& zEntry : fs::directory_iterator(root))
+    {
+        TileFile file;
+        if (!zEntry.is_directory() || !parseInt(zEntry.path().filename().string(), file.tile.z) || file.tile.z > 30)
+        {
+            continue;
+        }
+        for (const fs::directory_entry& xEntry : fs::directory_iterator(zEntry.path()))
+        {
+            if (!xEntry.is_directory() || !parseInt(xEntry.path().filename().string(), file.tile.x))
+            {
+                continue;
+            }
+            for (const fs::directory_entry& yEntry : fs::directory_iterator(xEntry.path()))
+            {
+                if (!yEntry.is_regular_file() || tileTypeOf(yEntry.path()) == TileArchive::Unknown
+                    || !parseInt(yEntry.path().stem().string(), file.tile.y))
+                {
+                    continue;
+                }
+                file.path = yEntry.path();
+                files.push_back(file);
+            }
+        }
+    }
+    return files;
+}
+
+bool readFile(const fs::path& path, std::vector<uint8_t>& bytes)
+{
+    FILE* file = std::fopen(path.string().c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    bytes.resize(static_cast<size_t>(fs::file_size(path)));
+    bool ok = std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    std::fclose(file);
+    return ok;
+}
+
+/**
+ * 尽量把文件移出页缓存（只丢弃干净页，不需要特权；Windows 上不做处理）
+ */
+void dropFromPageCache(const fs::path& path)
+{
+#ifndef _WIN32
+    int fd = ::open(path.string().c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#endif
+}
+
+double microsecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+int pack(const fs::path& root, const std::string& output)
+{
+    std::vector<TileFile> files = listTiles(root);
+    if (files.empty())
+    {
+        std::cerr << "No z/x/y tiles found in " << root << std::endl;
+        return 1;
+    }
+    
+    TileArchive::TileType tileType = tileTypeOf(files.front().path);
+    TileArchiveWriter writer;
+    size_t inputBytes = 0;
+    for (const TileFile& file : files)
+    {
+        std::vector<uint8_t> bytes;
+        if (!readFile(file.path, bytes))
+        {
+            std::cerr << "Cannot read " << file.path << std::endl;
+            return 1;
+        }
+        if (tileTypeOf(file.path) != tileType)
+        {
+            tileType = TileArchive::Unknown;
+        }
+        inputBytes += bytes.size();
+        writer.add(file.tile.z, file.tile.x, file.tile.y, std::move(bytes));
+    }
+    
+    std::string error;
+    if (!writer.write(output, tileType, &error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << writer.getTileCount() << " tiles (" << inputBytes << " bytes) into " << output
+              << " (" << fs::file_size(output) << " bytes)" << std::endl;
+    return 0;
+}
+
+int bench(const fs::path& root, const std::string& archivePath, size_t samples)
+{
+    std::vector<TileFile> files = listTiles(root);
+    if (files.empty())
+    {
+        std::cerr << "No z/x/y tiles found in " << root << std::endl;
+        return 1;
+    }
+    DirectoryTileSource directory(root.string());
+    std::vector<uint8_t> buffer;
+    uint64_t checksum = 0;
+    
+    // 冷启动：清空页缓存后，打开数据源并读出前 N 个瓦片
+    const size_t coldCount = std::min<size_t>(files.size(), 64);
+    dropFromPageCache(archivePath);
+    auto start = Clock::now();
+    TileArchive archive;
+    std::string error;
+    if (!archive.open(archivePath, &error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < coldCount; i++)
+    {
+        TileArchive::Span span;
+        if (archive.find(files[i].tile, span))
+        {
+            checksum += span.data[span.size - 1];
+        }
+    }
+    double archiveCold = microsecondsSince(start);
+    
+    for (size_t i = 0; i < coldCount; i++)
+    {
+        dropFromPageCache(files[i].path);
+    }
+    start = Clock::now();
+    for (size_t i = 0; i < coldCount; i++)
+    {
+        if (directory.read(files[i].tile, buffer))
+        {
+            checksum += buffer.back();
+        }
+    }
+    double directoryCold = microsecondsSince(start);
+    
+    // 热查找延迟：随机瓦片，逐次计时（归档返回零拷贝 span，目录每次 open/read/close）
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> pick(0, files.size() - 1);
+    std::vector<double> archiveTimes, directoryTimes;
+    archiveTimes.reserve(samples);
+    directoryTimes.reserve(samples);
+    for (size_t i = 0; i < samples; i++)
+    {
+        const TileID& tile = files[pick(random)].tile;
+        auto t0 = Clock::now();
+        TileArchive::Span span;
+        if (archive.find(tile, span))
+        {
+            checksum += span.data[span.size - 1];
+        }
+        archiveTimes.push_back(microsecondsSince(t0));
+        
+        t0 = Clock::now();
+        if (directory.read(tile, buffer))
+        {
+            checksum += buffer.back();
+        }
+        directoryTimes.push_back(microsecondsSince(t0));
+    }
+    
+    std::printf("tiles: %zu, archive: %zu bytes, samples: %zu (checksum %llu)\n",
+                files.size(), archive.getFileSize(), samples, static_cast<unsigned long long>(checksum));
+    std::printf("%-10s %14s %10s %10s %10s\n", "source", "cold 64 (us)", "p50 (us)", "p99 (us)", "max (us)");
+    std::printf("%-10s %14.1f %10.3f %10.3f %10.3f\n", "archive", archiveCold,
+                percentile(archiveTimes, 0.5), percentile(archiveTimes, 0.99), percentile(archiveTimes, 1.0));
+    std::printf("%-10s %14.1f %10.3f %10.3f %10.3f\n", "directory", directoryCold,
+                percentile(directoryTimes, 0.5), percentile(directoryTimes, 0.99), percentile(directoryTimes, 1.0));
+    return 0;
+}
+
+void usage()
+{
+    std::cerr << "Usage:\n"
+              << "  TileArchiveTool pack  <tile-directory> <archive>\n"
+              << "  TileArchiveTool bench <tile-directory> <archive> [samples]" << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        usage();
+        return 1;
+    }
+    std::string command = argv[1];
+    if (command == "pack")
+    {
+        return pack(argv[2], argv[3]);
+    }
+    if (command == "bench")
+    {
+        size_t samples = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 100000;
+        return bench(argv[2], argv[3], std::max<size_t>(samples, 1));
+    }
+    usage();
+    return 1;
+}
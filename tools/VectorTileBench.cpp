@@ -0,0 +1,745 @@
+/**
+ * 矢量瓦片解码 / 三角化基准
+ *
+ *   VectorTileBench <z/x/y 目录 | 归档> [--repeat N]
+ *   VectorTileBench --synthetic N [--seed S] [--repeat N] [--write 目录]
+ *
+ * 语料为目录中的 z/x/y.{pbf,mvt}（可以是 gzip 压缩的）或 TileArchive 中的全部瓦片，开始前全部读入内存；
+ * 没有样本瓦片时 --synthetic 生成 N 个 OpenMapTiles 结构的合成瓦片（--write 把它们写成 z/x/y.pbf）。
+ * 按默认样式处理，输出：
+ * - single：单线程 VectorTileLoader::decode 的 tiles/s 与编码字节吞吐，以及预热一轮之后
+ *   每个瓦片的平均分配字节数和分配次数（替换全局 operator new 计数，包括交给渲染线程的结果网格）
+ * - loader：VectorTileLoader 在 JobSystem 上并行处理全部瓦片的 tiles/s
+ * - 网格：每瓦片的平均顶点数、三角形数、网格字节；填充图层三角形面积之和相对多边形面积的误差
+ * - globe subdivision：把语料当作 z0..z12 的瓦片，细分前后平面三角形到解析球面的最大距离（像素）、
+ *   顶点膨胀倍数和每个瓦片的解码耗时
+ */
+
+#include "GeodesicSubdivider.h"
+#include "PbfWriter.h"
+#include "RasterTileLoader.h"
+#include "TileArchive.h"
+#include "TileSource.h"
+#include "VectorTessellator.h"
+#include "VectorTile.h"
+#include "VectorTileLoader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+std::atomic<uint64_t> allocatedBytes(0);
+std::atomic<uint64_t> allocationCount(0);
+
+// 所有 operator new / delete 都经过这两个函数；不内联，编译器看不到 malloc 与 operator delete 的配对
+// （否则 -Wmismatched-new-delete 会在内联后的调用点误报）
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void* countedAllocate(std::size_t size, std::size_t alignment)
+{
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment <= alignof(std::max_align_t))
+    {
+        return std::malloc(size);
+    }
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc 要求大小是对齐的整数倍
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void countedFree(void* pointer, std::size_t alignment) noexcept
+{
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t))
+    {
+        _aligned_free(pointer);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(pointer);
+}
+
+void* countedNew(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+{
+    if (void* pointer = countedAllocate(size, alignment))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+} // namespace
+
+// 统计分配：只计数，不改变分配行为。替换整组全局 operator new / delete（普通、数组、nothrow、对齐、带大小），
+// 保证每个指针都由配对的函数释放
+void* operator new(std::size_t size) { return countedNew(size); }
+void* operator new[](std::size_t size) { return countedNew(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedNew(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedNew(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return countedAllocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return countedAllocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* pointer) noexcept { countedFree(pointer, alignof(std::max_align_t)); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer, alignof(std::max_align_t)); }
+void operator delete(void* pointer, std::size_t) noexcept { countedFree(pointer, alignof(std::max_align_t)); }
+void operator delete[](void* pointer, std::size_t) noexcept { countedFree(pointer, alignof(std::max_align_t)); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer, alignof(std::max_align_t)); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer, alignof(std::max_align_t)); }
+void operator delete(void* pointer, std::align_val_t alignment) noexcept { countedFree(pointer, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept { countedFree(pointer, static_cast<std::size_t>(alignment)); }
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept { countedFree(pointer, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept { countedFree(pointer, static_cast<std::size_t>(alignment)); }
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept { countedFree(pointer, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept { countedFree(pointer, static_cast<std::size_t>(alignment)); }
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct CorpusTile
+{
+    TileID tile;
+    std::vector<uint8_t> bytes;
+};
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * 内存中的语料作为数据源（view 零拷贝），loader 测量不受磁盘影响
+ */
+class CorpusTileSource : public TileSource
+{
+public:
+    explicit CorpusTileSource(const std::vector<CorpusTile>& corpus) : corpus(corpus) {}
+    
+    bool read(const TileID& tile, std::vector<uint8_t>& bytes) const override
+    {
+        const CorpusTile* found = find(tile);
+        if (found)
+        {
+            bytes = found->bytes;
+        }
+        return found != nullptr;
+    }
+    
+    bool view(const TileID& tile, const uint8_t*& bytes, size_t& size) const override
+    {
+        const CorpusTile* found = find(tile);
+        if (found)
+        {
+            bytes = found->bytes.data();
+            size = found->bytes.size();
+        }
+        return found != nullptr;
+    }
+    
+    int getMaxZoom() const override { return 22; }
+    
+private:
+    // 请求的 x 为语料下标，避免建立查找表
+    const CorpusTile* find(const TileID& tile) const
+    {
+        return tile.x >= 0 && static_cast<size_t>(tile.x) < corpus.size() ? &corpus[tile.x] : nullptr;
+    }
+    
+    const std::vector<CorpusTile>& corpus;
+};
+
+// ---------------------------------------------------------------------------
+// 合成瓦片：MVT 几何编码
+
+/**
+ * 把若干条线 / 环编码为 MVT 命令流（cursor 在各部分之间延续）
+ */
+std::vector<uint32_t> encodeGeometry(const std::vector<std::vector<glm::ivec2>>& parts, bool closed)
+{
+    std::vector<uint32_t> commands;
+    glm::ivec2 cursor(0);
+    for (const std::vector<glm::ivec2>& part : parts)
+    {
+        commands.push_back(1 | (1 << 3));   // MoveTo 1
+        for (size_t i = 0; i < part.size(); i++)
+        {
+            if (i == 1)
+            {
+                commands.push_back(2 | (static_cast<uint32_t>(part.size() - 1) << 3));   // LineTo n-1
+            }
+            commands.push_back(PbfWriter::zigzag(part[i].x - cursor.x));
+            commands.push_back(PbfWriter::zigzag(part[i].y - cursor.y));
+            cursor = part[i];
+        }
+        if (closed)
+        {
+            commands.push_back(7 | (1 << 3));   // ClosePath
+        }
+    }
+    return commands;
+}
+
+/**
+ * 星形（凹）多边形环；exterior 为 MVT 的外环方向（tile 坐标中面积为正），否则为洞的方向
+ */
+std::vector<glm::ivec2> starRing(std::mt19937& random, glm::vec2 center, float radius, int count, bool exterior)
+{
+    std::uniform_real_distribution<float> jitter(0.55f, 1.0f);
+    std::vector<glm::ivec2> ring;
+    for (int i = 0; i < count; i++)
+    {
+        float angle = 2.0f * 3.14159265f * i / count * (exterior ? 1.0f : -1.0f);
+        float r = radius * jitter(random);
+        ring.push_back(glm::ivec2(static_cast<int>(center.x + r * std::cos(angle)), static_cast<int>(center.y + r * std::sin(angle))));
+    }
+    return ring;
+}
+
+std::vector<glm::ivec2> randomWalk(std::mt19937& random, int count)
+{
+    std::uniform_int_distribution<int> start(-64, 4160);
+    std::uniform_real_distribution<float> turn(-0.6f, 0.6f);
+    std::uniform_real_distribution<float> step(20.0f, 200.0f);
+    glm::vec2 point(start(random), start(random));
+    float heading = turn(random) * 10.0f;
+    std::vector<glm::ivec2> line;
+    for (int i = 0; i < count; i++)
+    {
+        line.push_back(glm::ivec2(point));
+        heading += turn(random);
+        point += glm::vec2(std::cos(heading), std::sin(heading)) * step(random);
+    }
+    return line;
+}
+
+class LayerWriter
+{
+public:
+    explicit LayerWriter(const std::string& name)
+    {
+        layer.uint32Field(15, 2);       // version
+        layer.stringField(1, name);
+        layer.uint32Field(5, 4096);     // extent
+    }
+    
+    void addFeature(VectorTile::GeometryType type, const std::vector<std::vector<glm::ivec2>>& parts, uint32_t classValue)
+    {
+        PbfWriter feature;
+        feature.uint32Field(1, nextId++);
+        feature.packedField(2, { 0, classValue });   // class = values[classValue]
+        feature.uint32Field(3, static_cast<uint32_t>(type));
+        feature.packedField(4, encodeGeometry(parts, type == VectorTile::GeometryType::Polygon));
+        layer.messageField(2, feature);
+    }
+    
+    const PbfWriter& finish(uint32_t valueCount)
+    {
+        layer.stringField(3, "class");
+        for (uint32_t i = 0; i < valueCount; i++)
+        {
+            PbfWriter value;
+            value.stringField(1, "class" + std::to_string(i));
+            layer.messageField(4, value);
+        }
+        return layer;
+    }
+    
+private:
+    PbfWriter layer;
+    uint32_t nextId = 1;
+};
+
+std::vector<uint8_t> syntheticTile(std::mt19937& random)
+{
+    using Type = VectorTile::GeometryType;
+    std::uniform_real_distribution<float> position(0.0f, 4096.0f);
+    PbfWriter tile;
+    
+    // 大块的水域和地表覆盖（带洞）
+    for (const char* name : { "water", "landcover", "landuse" })
+    {
+        LayerWriter layer(name);
+        int count = 2 + static_cast<int>(random() % 4);
+        for (int i = 0; i < count; i++)
+        {
+            glm::vec2 center(position(random), position(random));
+            float radius = 300.0f + position(random) * 0.25f;
+            std::vector<std::vector<glm::ivec2>> rings;
+            rings.push_back(starRing(random, center, radius, 40 + static_cast<int>(random() % 200), true));
+            if (random() % 2 == 0)
+            {
+                rings.push_back(starRing(random, center, radius * 0.3f, 12 + static_cast<int>(random() % 20), false));
+            }
+            layer.addFeature(Type::Polygon, rings, static_cast<uint32_t>(random() % 4));
+        }
+        tile.messageField(3, layer.finish(4));
+    }
+    
+    // 大量小建筑（矩形和 L 形）
+    {
+        LayerWriter layer("building");
+        int count = 100 + static_cast<int>(random() % 300);
+        std::uniform_int_distribution<int> size(8, 48);
+        for (int i = 0; i < count; i++)
+        {
+            glm::ivec2 origin(static_cast<int>(position(random)), static_cast<int>(position(random)));
+            int w = size(random), h = size(random);
+            std::vector<glm::ivec2> ring;
+            if (random() % 3 == 0)
+            {
+                ring = { origin, origin + glm::ivec2(w, 0), origin + glm::ivec2(w, h / 2), origin + glm::ivec2(w / 2, h / 2),
+                         origin + glm::ivec2(w / 2, h), origin + glm::ivec2(0, h) };
+            }
+            else
+            {
+                ring = { origin, origin + glm::ivec2(w, 0), origin + glm::ivec2(w, h), origin + glm::ivec2(0, h) };
+            }
+            layer.addFeature(Type::Polygon, { ring }, 0);
+        }
+        tile.messageField(3, layer.finish(1));
+    }
+    
+    // 道路、水系和边界线
+    for (const char* name : { "transportation", "waterway", "boundary" })
+    {
+        LayerWriter layer(name);
+        int count = std::string(name) == "transportation" ? 60 + static_cast<int>(random() % 120) : 4 + static_cast<int>(random() % 8);
+        for (int i = 0; i < count; i++)
+        {
+            layer.addFeature(Type::LineString, { randomWalk(random, 4 + static_cast<int>(random() % 40)) }, static_cast<uint32_t>(random() % 6));
+        }
+        tile.messageField(3, layer.finish(6));
+    }
+    
+    // 点要素（样式不使用，只经过解码）
+    {
+        LayerWriter layer("poi");
+        for (int i = 0; i < 50; i++)
+        {
+            layer.addFeature(Type::Point, { { glm::ivec2(static_cast<int>(position(random)), static_cast<int>(position(random))) } }, 0);
+        }
+        tile.messageField(3, layer.finish(1));
+    }
+    return tile.data;
+}
+
+// ---------------------------------------------------------------------------
+
+bool readFile(const fs::path& path, std::vector<uint8_t>& bytes)
+{
+    std::ifstream file(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return file.good() || file.eof();
+}
+
+bool parseIndex(const std::string& text, int& value)
+{
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || parsed < 0 || parsed > (1 << 29))
+    {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+std::vector<CorpusTile> loadDirectory(const fs::path& root)
+{
+    std::vector<CorpusTile> corpus;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(root))
+    {
+        std::string extension = entry.path().extension().string();
+        if (!entry.is_regular_file() || (extension != ".pbf" && extension != ".mvt"))
+        {
+            continue;
+        }
+        // root/z/x/y.pbf
+        fs::path relative = fs::relative(entry.path(), root);
+        std::vector<std::string> parts;
+        for (const fs::path& part : relative)
+        {
+            parts.push_back(part.string());
+        }
+        CorpusTile tile;
+        if (parts.size() != 3 || !parseIndex(parts[0], tile.tile.z) || !parseIndex(parts[1], tile.tile.x)
+            || !parseIndex(entry.path().stem().string(), tile.tile.y) || !readFile(entry.path(), tile.bytes))
+        {
+            continue;
+        }
+        corpus.push_back(std::move(tile));
+    }
+    return corpus;
+}
+
+std::vector<CorpusTile> loadArchive(const std::string& path)
+{
+    std::vector<CorpusTile> corpus;
+    TileArchive archive;
+    std::string error;
+    if (!archive.open(path, &error))
+    {
+        std::cerr << error << std::endl;
+        return corpus;
+    }
+    for (size_t i = 0; i < archive.getEntryCount(); i++)
+    {
+        CorpusTile tile;
+        tile.tile = TileArchive::tileFromTileId(archive.getEntries()[i].tileId);
+        TileArchive::Span span;
+        if (archive.find(tile.tile, span))
+        {
+            tile.bytes.assign(span.data, span.data + span.size);
+            corpus.push_back(std::move(tile));
+        }
+    }
+    return corpus;
+}
+
+std::vector<CorpusTile> makeSynthetic(size_t count, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::vector<CorpusTile> corpus(count);
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    for (size_t i = 0; i < count; i++)
+    {
+        corpus[i].tile.z = 14;
+        corpus[i].tile.x = 8000 + static_cast<int>(i) % side;
+        corpus[i].tile.y = 5000 + static_cast<int>(i) / side;
+        corpus[i].bytes = syntheticTile(random);
+    }
+    return corpus;
+}
+
+bool writeCorpus(const std::vector<CorpusTile>& corpus, const fs::path& root)
+{
+    for (const CorpusTile& tile : corpus)
+    {
+        fs::path directory = root / std::to_string(tile.tile.z) / std::to_string(tile.tile.x);
+        std::error_code error;
+        fs::create_directories(directory, error);
+        std::ofstream file(directory / (std::to_string(tile.tile.y) + ".pbf"), std::ios::binary);
+        file.write(reinterpret_cast<const char*>(tile.bytes.data()), static_cast<std::streamsize>(tile.bytes.size()));
+        if (!file)
+        {
+            std::cerr << "Cannot write " << directory << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+double triangleArea(const VectorVertex& a, const VectorVertex& b, const VectorVertex& c)
+{
+    return 0.5 * std::abs((static_cast<double>(b.x) - a.x) * (static_cast<double>(c.y) - a.y)
+                          - (static_cast<double>(c.x) - a.x) * (static_cast<double>(b.y) - a.y));
+}
+
+/**
+ * 填充图层：三角形面积之和与多边形面积（外环减洞，TILE_EXTENT 坐标）
+ */
+void measureFillArea(const CorpusTile& tile, const VectorStyle& style, const VectorTileMesh& mesh, double& polygonArea, double& meshArea)
+{
+    std::vector<uint8_t> inflated;
+    const uint8_t* bytes = tile.bytes.data();
+    size_t size = tile.bytes.size();
+    if (VectorTileLoader::gunzip(bytes, size, inflated))
+    {
+        bytes = inflated.data();
+        size = inflated.size();
+    }
+    std::vector<glm::vec2> points;
+    std::vector<uint32_t> partEnds;
+    for (size_t i = 0; i < style.layers.size(); i++)
+    {
+        if (style.layers[i].type != VectorStyle::Type::Fill)
+        {
+            continue;
+        }
+        VectorTile vectorTile(bytes, size);
+        VectorTile::Layer layer;
+        while (vectorTile.nextLayer(layer))
+        {
+            if (!(layer.name == style.layers[i].sourceLayer.c_str()))
+            {
+                continue;
+            }
+            VectorTile::Feature feature;
+            while (layer.nextFeature(feature))
+            {
+                if (feature.type != VectorTile::GeometryType::Polygon)
+                {
+                    continue;
+                }
+                points.clear();
+                partEnds.clear();
+                VectorTile::decodeGeometry(feature, static_cast<float>(8192.0 / layer.extent), points, partEnds);
+                uint32_t begin = 0;
+                for (uint32_t end : partEnds)
+                {
+                    double sum = 0.0;
+                    for (uint32_t a = begin, b = end - 1; a < end; b = a++)
+                    {
+                        sum += static_cast<double>(points[b].x) * points[a].y - static_cast<double>(points[a].x) * points[b].y;
+                    }
+                    polygonArea += sum * 0.5;
+                    begin = end;
+                }
+            }
+        }
+        const VectorTileMesh::Range& range = mesh.layers[i];
+        for (uint32_t index = range.firstIndex; index < range.firstIndex + range.indexCount; index += 3)
+        {
+            meshArea += triangleArea(mesh.vertices[mesh.indices[index]], mesh.vertices[mesh.indices[index + 1]], mesh.vertices[mesh.indices[index + 2]]);
+        }
+    }
+}
+
+/**
+ * 平面三角形到球面的最大距离（像素）：把网格放到 zoom 层级赤道以南的第一个瓦片上，
+ * 顶点按 shader 的公式（这里用 double）投影到单位球，取每个三角形的边中点和重心到球心的距离，
+ * 按放大到下一层级时的球面半径换算（与 GeodesicSubdivider 的误差定义一致）
+ */
+double maxChordError(const VectorTileMesh& mesh, int zoom)
+{
+    const double pi = 3.14159265358979323846;
+    const double scale = std::exp2(static_cast<double>(zoom));
+    const double tileY = std::floor(scale / 2.0);
+    const double radius = 2.0 * VectorTessellator::kTilePixels * scale / (2.0 * pi);
+    auto toSphere = [&](const VectorVertex& vertex) {
+        double lon = vertex.x / 8192.0 / scale * pi * 2.0 + pi;
+        double lat = 2.0 * std::atan(std::exp(pi - (tileY + vertex.y / 8192.0) / scale * pi * 2.0)) - pi * 0.5;
+        return glm::dvec3(std::sin(lon) * std::cos(lat), std::sin(lat), std::cos(lon) * std::cos(lat));
+    };
+    double maxError = 0.0;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        const glm::dvec3 a = toSphere(mesh.vertices[mesh.indices[i]]);
+        const glm::dvec3 b = toSphere(mesh.vertices[mesh.indices[i + 1]]);
+        const glm::dvec3 c = toSphere(mesh.vertices[mesh.indices[i + 2]]);
+        for (const glm::dvec3& point : { (a + b) * 0.5, (b + c) * 0.5, (c + a) * 0.5, (a + b + c) / 3.0 })
+        {
+            maxError = std::max(maxError, 1.0 - glm::length(point));
+        }
+    }
+    return maxError * radius;
+}
+
+/**
+ * 把语料当作各个层级的瓦片解码：细分前后的最大弦误差、顶点膨胀和解码耗时
+ */
+void measureSubdivision(const std::vector<CorpusTile>& corpus, const VectorStyle& style)
+{
+    // 层级足够高时不细分，用来得到同一份几何的原始网格
+    const int flatZoom = 22;
+    const size_t count = std::min<size_t>(corpus.size(), 50);
+    std::cout << "globe subdivision (max chord error at the next zoom, target " << GeodesicSubdivider::kMaxChordErrorPixels << " px):\n";
+    for (int zoom = 0; zoom <= 12; zoom += 2)
+    {
+        double flatError = 0.0, subdividedError = 0.0, seconds = 0.0;
+        uint64_t flatVertices = 0, subdividedVertices = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const CorpusTile& tile = corpus[i];
+            VectorTileMesh flat, subdivided;
+            if (!VectorTileLoader::decode(tile.bytes.data(), tile.bytes.size(), style, flatZoom, flat))
+            {
+                continue;
+            }
+            auto start = Clock::now();
+            VectorTileLoader::decode(tile.bytes.data(), tile.bytes.size(), style, zoom, subdivided);
+            seconds += secondsSince(start);
+            flatError = std::max(flatError, maxChordError(flat, zoom));
+            subdividedError = std::max(subdividedError, maxChordError(subdivided, zoom));
+            flatVertices += flat.vertices.size();
+            subdividedVertices += subdivided.vertices.size();
+        }
+        std::cout << std::setprecision(3) << "  z" << zoom << ": " << GeodesicSubdivider::gridDivisions(zoom, VectorTessellator::kTilePixels)
+                  << " divisions, " << flatError << " -> " << subdividedError << " px, "
+                  << (flatVertices > 0 ? static_cast<double>(subdividedVertices) / flatVertices : 0.0) << "x vertices, "
+                  << seconds * 1000.0 / count << " ms per tile\n";
+    }
+}
+
+int run(const std::vector<CorpusTile>& corpus, int repeat)
+{
+    const VectorStyle style = VectorStyle::createDefault();
+    size_t encodedBytes = 0;
+    for (const CorpusTile& tile : corpus)
+    {
+        encodedBytes += tile.bytes.size();
+    }
+    
+    // 预热：线程内复用的缓冲区增长到稳定大小；同时检查数据和三角化结果
+    size_t failures = 0;
+    uint64_t vertices = 0, triangles = 0, meshBytes = 0;
+    double polygonArea = 0.0, meshArea = 0.0;
+    for (const CorpusTile& tile : corpus)
+    {
+        VectorTileMesh mesh;
+        if (!VectorTileLoader::decode(tile.bytes.data(), tile.bytes.size(), style, tile.tile.z, mesh))
+        {
+            failures++;
+            continue;
+        }
+        vertices += mesh.vertices.size();
+        triangles += mesh.indices.size() / 3;
+        meshBytes += mesh.sizeInBytes();
+        measureFillArea(tile, style, mesh, polygonArea, meshArea);
+    }
+    
+    // 单线程：每个瓦片一份新的结果网格（与 loader 交给渲染线程的相同）
+    uint64_t bytesBefore = allocatedBytes.load();
+    uint64_t countBefore = allocationCount.load();
+    auto start = Clock::now();
+    for (int r = 0; r < repeat; r++)
+    {
+        for (const CorpusTile& tile : corpus)
+        {
+            VectorTileMesh mesh;
+            VectorTileLoader::decode(tile.bytes.data(), tile.bytes.size(), style, tile.tile.z, mesh);
+        }
+    }
+    double singleSeconds = secondsSince(start);
+    double processed = static_cast<double>(corpus.size()) * repeat;
+    double bytesPerTile = (allocatedBytes.load() - bytesBefore) / processed;
+    double allocationsPerTile = (allocationCount.load() - countBefore) / processed;
+    
+    // VectorTileLoader：所有瓦片作为 JobSystem 任务并行处理，主线程只提交和取结果
+    auto source = std::make_shared<CorpusTileSource>(corpus);
+    VectorTileLoader loader(source, style);
+    start = Clock::now();
+    size_t requested = 0, received = 0;
+    const size_t total = corpus.size() * static_cast<size_t>(repeat);
+    VectorTileData result;
+    auto request = [&](size_t index) {
+        return loader.request(TileID{ static_cast<int>(index), 0, corpus[index].tile.z, 0 });
+    };
+    while (received < total)
+    {
+        while (requested < total && request(requested % corpus.size()))
+        {
+            requested++;
+        }
+        if (loader.poll(result))
+        {
+            received++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    double loaderSeconds = secondsSince(start);
+    
+    const double tiles = static_cast<double>(corpus.size());
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "corpus: " << corpus.size() << " tiles, " << encodedBytes / 1024.0 << " KiB encoded"
+              << (failures ? ", " + std::to_string(failures) + " failed to decode" : std::string()) << "\n";
+    std::cout << "mesh: " << vertices / tiles << " vertices, " << triangles / tiles << " triangles, "
+              << meshBytes / tiles / 1024.0 << " KiB per tile\n";
+    std::cout << std::setprecision(6) << "fill area error: " << (polygonArea > 0.0 ? meshArea / polygonArea - 1.0 : 0.0) << "\n";
+    std::cout << std::setprecision(1);
+    std::cout << "single: " << processed / singleSeconds << " tiles/s, " << encodedBytes * repeat / singleSeconds / (1024.0 * 1024.0)
+              << " MiB/s encoded, " << bytesPerTile << " bytes and " << allocationsPerTile << " allocations per tile\n";
+    std::cout << "loader: " << total / loaderSeconds << " tiles/s on " << JobSystem::shared().getThreadCount() << " workers" << std::endl;
+    measureSubdivision(corpus, style);
+    return failures == corpus.size() ? 1 : 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string input;
+    size_t synthetic = 0;
+    unsigned seed = 1;
+    int repeat = 3;
+    std::string writeDirectory;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--synthetic" && hasValue)
+        {
+            synthetic = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--repeat" && hasValue)
+        {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--write" && hasValue)
+        {
+            writeDirectory = argv[++i];
+        }
+        else if (arg[0] != '-' && input.empty())
+        {
+            input = arg;
+        }
+        else
+        {
+            input.clear();
+            synthetic = 0;
+            break;
+        }
+    }
+    if (input.empty() == (synthetic == 0))
+    {
+        std::cerr << "usage: VectorTileBench <z/x/y directory | archive> [--repeat N]\n"
+                  << "       VectorTileBench --synthetic N [--seed S] [--repeat N] [--write directory]" << std::endl;
+        return 2;
+    }
+    
+    std::vector<CorpusTile> corpus;
+    if (synthetic > 0)
+    {
+        corpus = makeSynthetic(synthetic, seed);
+        if (!writeDirectory.empty() && !writeCorpus(corpus, writeDirectory))
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        corpus = fs::is_directory(input) ? loadDirectory(input) : loadArchive(input);
+    }
+    if (corpus.empty())
+    {
+        std::cerr << "No vector tiles found in " << input << std::endl;
+        return 1;
+    }
+    return run(corpus, repeat);
+}